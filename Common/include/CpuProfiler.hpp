@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace MEngine
+{
+struct CpuProfileEvent
+{
+    const char *name{nullptr};
+    uint64_t begin{0}; // tick
+    uint64_t end{0};
+    uint32_t depth{0}; // 嵌套层级，0为最外层
+};
+struct CpuProfileThread
+{
+    uint32_t id{0};
+    std::string name;
+    std::vector<CpuProfileEvent> events; // 按结束时间排序
+};
+/**
+ * @brief CPU分段计时
+ * 每个线程一个环形缓冲区，zone结束时写入一条事件，写入不加锁；读取时拷贝并丢弃拷贝期间可能被覆盖的事件。
+ * zone名字只保存指针，必须是字符串字面量或InternName返回的字符串。
+ * 用MENGINE_PROFILE_ZONE/MENGINE_PROFILE_FUNCTION插桩，未定义MENGINE_CPU_PROFILER(Release)时宏为空
+ */
+class CpuProfiler final
+{
+  public:
+    static constexpr uint32_t EventCapacity = 8192; // 每个线程，必须是2的幂
+    static constexpr uint32_t MaxDepth = 64;
+    static constexpr uint32_t FrameCapacity = 256;
+
+    CpuProfiler() = delete;
+    static void BeginZone(const char *name);
+    static void EndZone();
+    static uint64_t Now();
+    // 当前线程在trace和火焰图中的名字
+    static void SetThreadName(std::string_view name);
+    static const char *InternName(std::string_view name);
+    // 暂停后不再记录新的zone，已有的事件保留
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+    // 在主线程每帧开始时调用
+    static void MarkFrame();
+    // 最近count帧的起始tick，从旧到新
+    static std::vector<uint64_t> GetFrameMarks(uint32_t count = FrameCapacity);
+    // 与[begin, end)相交的事件，begin和end为0时返回缓冲区中全部事件
+    static std::vector<CpuProfileThread> Capture(uint64_t begin = 0, uint64_t end = 0);
+    static double TicksToMs(uint64_t ticks);
+    static void Clear();
+    // Chrome trace event格式，可直接在chrome://tracing或Perfetto中打开
+    static nlohmann::json ToChromeTrace();
+    static void DumpChromeTrace(const std::filesystem::path &path);
+};
+// 作用域内计入一个zone
+class CpuProfileScope final
+{
+  public:
+    explicit CpuProfileScope(const char *name)
+    {
+        CpuProfiler::BeginZone(name);
+    }
+    ~CpuProfileScope()
+    {
+        CpuProfiler::EndZone();
+    }
+    CpuProfileScope(const CpuProfileScope &) = delete;
+    CpuProfileScope &operator=(const CpuProfileScope &) = delete;
+};
+} // namespace MEngine
+
+#ifdef MENGINE_CPU_PROFILER
+#define MENGINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define MENGINE_PROFILE_CONCAT(a, b) MENGINE_PROFILE_CONCAT_IMPL(a, b)
+#define MENGINE_PROFILE_ZONE(name) ::MEngine::CpuProfileScope MENGINE_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#define MENGINE_PROFILE_FUNCTION() MENGINE_PROFILE_ZONE(__func__)
+#else
+#define MENGINE_PROFILE_ZONE(name) ((void)0)
+#define MENGINE_PROFILE_FUNCTION() ((void)0)
+#endif
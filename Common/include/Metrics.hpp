@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace MEngine
+{
+struct MetricsSetting
+{
+    bool enabled = true;
+    float flushIntervalSeconds = 10.0f;
+    float hitchThresholdMs = 33.3f;         // 超过该值的帧记为卡顿
+    uint32_t maxFileSize = 5 * 1024 * 1024; // 超过后轮转
+    uint32_t maxFiles = 3;
+};
+// 计数器，写入为relaxed原子加
+class MetricCounter final
+{
+  private:
+    std::atomic<uint64_t> mValue{0};
+
+  public:
+    inline void Add(uint64_t value = 1)
+    {
+        mValue.fetch_add(value, std::memory_order_relaxed);
+    }
+    inline uint64_t Get() const
+    {
+        return mValue.load(std::memory_order_relaxed);
+    }
+};
+// 瞬时值，只保留最后一次写入
+class MetricGauge final
+{
+  private:
+    std::atomic<double> mValue{0.0};
+
+  public:
+    inline void Set(double value)
+    {
+        mValue.store(value, std::memory_order_relaxed);
+    }
+    inline double Get() const
+    {
+        return mValue.load(std::memory_order_relaxed);
+    }
+};
+struct MetricHistogramSnapshot
+{
+    std::vector<uint64_t> buckets;
+    uint64_t count{0};
+    double resolution{1.0};
+    double sum{0.0};
+    double max{0.0};
+    double GetMean() const;
+    // percentile为[0, 1]，返回所在桶的上界(不超过max)，没有样本时为0
+    double GetPercentile(double percentile) const;
+    // 严格大于value的样本数，按桶下界判断，误差不超过一个桶
+    uint64_t CountAbove(double value) const;
+};
+/**
+ * @brief HDR风格的对数线性直方图
+ * 值按resolution量化为整数，[2^k, 2^(k+1))每段分SubBucketCount个线性桶，相对误差不超过1/SubBucketCount。
+ * Record只有几个relaxed原子操作，不加锁也不分配内存
+ */
+class MetricHistogram final
+{
+  public:
+    static constexpr uint32_t SubBucketBits = 5;
+    static constexpr uint32_t SubBucketCount = 1u << SubBucketBits;
+    static constexpr uint32_t BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+  private:
+    double mResolution;
+    std::array<std::atomic<uint64_t>, BucketCount> mBuckets{};
+    std::atomic<uint64_t> mSum{0};
+    std::atomic<uint64_t> mMax{0};
+
+  public:
+    // resolution为量化的最小单位，例如毫秒值用0.001保留微秒精度
+    explicit MetricHistogram(double resolution = 1.0);
+    void Record(double value);
+    // reset为true时清空，下一次快照只包含之后的样本
+    MetricHistogramSnapshot Snapshot(bool reset = false);
+    inline double GetResolution() const
+    {
+        return mResolution;
+    }
+    static uint32_t GetBucketIndex(uint64_t value);
+    static uint64_t GetBucketLowerBound(uint32_t index);
+    static uint64_t GetBucketUpperBound(uint32_t index);
+};
+/**
+ * @brief 按名字注册的全局指标
+ * 注册加锁，返回的引用在进程内一直有效，热路径上应缓存引用(例如static局部变量)后直接写入
+ */
+class Metrics final
+{
+  public:
+    Metrics() = delete;
+    static MetricCounter &GetCounter(std::string_view name);
+    static MetricGauge &GetGauge(std::string_view name);
+    // 同名的直方图已存在时忽略resolution
+    static MetricHistogram &GetHistogram(std::string_view name, double resolution = 1.0);
+    // 超过阈值的样本在快照中记为hitches，0为不统计
+    static void SetHitchThreshold(std::string_view histogram, double threshold);
+    /**
+     * @brief 所有指标的快照
+     * 计数器包含累计值和距上次快照的增量，直方图只包含距上次快照的样本
+     */
+    static nlohmann::json Snapshot();
+    static constexpr const char *CsvHeader = "time,name,count,mean,p50,p90,p99,p999,max,hitches\n";
+    // 快照中每个直方图一行，列与CsvHeader对应
+    static std::string ToCsv(const nlohmann::json &snapshot);
+};
+/**
+ * @brief 在后台线程中定期把Metrics快照写入目录下的metrics.jsonl和metrics.csv
+ * 文件超过maxFileSize时按spdlog rotating sink的方式轮转为metrics.1.jsonl等；析构时停止线程并写入最后一次快照。
+ * enabled为false时不启动线程，只在调用Flush时写入
+ */
+class MetricsReporter final
+{
+  private:
+    MetricsSetting mSetting;
+    std::filesystem::path mDirectory;
+    std::mutex mMutex;
+    std::condition_variable_any mCondition;
+    std::jthread mThread;
+
+  private:
+    void Rotate(const std::filesystem::path &path) const;
+    void Append(const std::filesystem::path &path, const std::string &text, const std::string &header) const;
+
+  public:
+    MetricsReporter(const MetricsSetting &setting, const std::filesystem::path &directory);
+    ~MetricsReporter();
+    MetricsReporter(const MetricsReporter &) = delete;
+    MetricsReporter &operator=(const MetricsReporter &) = delete;
+    void Flush();
+    inline const std::filesystem::path &GetDirectory() const
+    {
+        return mDirectory;
+    }
+};
+} // namespace MEngine
+
+namespace nlohmann
+{
+template <> struct adl_serializer<MEngine::MetricsSetting>
+{
+    static void to_json(json &j, const MEngine::MetricsSetting &setting)
+    {
+        j["Metrics"]["Enabled"] = setting.enabled;
+        j["Metrics"]["FlushIntervalSeconds"] = setting.flushIntervalSeconds;
+        j["Metrics"]["HitchThresholdMs"] = setting.hitchThresholdMs;
+        j["Metrics"]["MaxFileSize"] = setting.maxFileSize;
+        j["Metrics"]["MaxFiles"] = setting.maxFiles;
+    }
+    static void from_json(const json &j, MEngine::MetricsSetting &setting)
+    {
+        // 缺少该节时使用默认值
+        auto defaults = MEngine::MetricsSetting{};
+        auto config = j.value("Metrics", json::object());
+        setting.enabled = config.value("Enabled", defaults.enabled);
+        setting.flushIntervalSeconds = config.value("FlushIntervalSeconds", defaults.flushIntervalSeconds);
+        setting.hitchThresholdMs = config.value("HitchThresholdMs", defaults.hitchThresholdMs);
+        setting.maxFileSize = config.value("MaxFileSize", defaults.maxFileSize);
+        setting.maxFiles = config.value("MaxFiles", defaults.maxFiles);
+    }
+};
+} // namespace nlohmann
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace MEngine
+{
+/**
+ * @brief 最近capacity个样本的统计
+ * 样本存放在环形缓冲区中，均值增量维护，百分位和最大值在查询时计算
+ */
+class RollingStatistics final
+{
+  private:
+    std::vector<float> mSamples;
+    uint32_t mCapacity{0};
+    uint32_t mNext{0}; // 下一个写入位置
+    double mSum{0.0};
+    float mLast{0.0f};
+
+  public:
+    explicit RollingStatistics(uint32_t capacity = 256);
+    void Add(float value);
+    void Reset();
+    inline uint32_t GetCount() const
+    {
+        return static_cast<uint32_t>(mSamples.size());
+    }
+    inline uint32_t GetCapacity() const
+    {
+        return mCapacity;
+    }
+    inline float GetLast() const
+    {
+        return mLast;
+    }
+    float GetMean() const;
+    float GetMax() const;
+    // percentile为[0, 1]，按nearest-rank取样本值，没有样本时为0
+    float GetPercentile(float percentile) const;
+};
+} // namespace MEngine
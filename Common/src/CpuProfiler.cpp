@@ -0,0 +1,272 @@
+#include "CpuProfiler.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define MENGINE_PROFILER_RDTSC 1
+#endif
+
+namespace MEngine
+{
+namespace
+{
+static_assert((CpuProfiler::EventCapacity & (CpuProfiler::EventCapacity - 1)) == 0);
+
+struct OpenZone
+{
+    const char *name{nullptr}; // 暂停时开始的zone为空，结束时不记录
+    uint64_t begin{0};
+};
+struct ThreadBuffer
+{
+    uint32_t id{0};
+    std::string name;                    // 由Registry::mutex保护
+    uint64_t readFrom{0};                // Clear之后的第一个事件，由Registry::mutex保护
+    std::atomic<uint64_t> writeIndex{0}; // 只由所属线程写入
+    std::array<CpuProfileEvent, CpuProfiler::EventCapacity> events;
+    std::array<OpenZone, CpuProfiler::MaxDepth> stack;
+    uint32_t depth{0};
+};
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::unordered_set<std::string> names; // 节点不会移动，c_str()在程序生命周期内有效
+    std::atomic<bool> enabled{true};
+    std::array<std::atomic<uint64_t>, CpuProfiler::FrameCapacity> frames{};
+    std::atomic<uint64_t> frameCount{0};
+    uint64_t baseTicks{CpuProfiler::Now()};
+    std::chrono::steady_clock::time_point baseTime{std::chrono::steady_clock::now()};
+};
+Registry &GetRegistry()
+{
+    // 不析构，退出时仍在运行的工作线程可能还会写入
+    static auto *registry = new Registry();
+    return *registry;
+}
+thread_local ThreadBuffer *tThread = nullptr;
+
+ThreadBuffer &RegisterThread()
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto &thread = registry.threads.emplace_back(std::make_unique<ThreadBuffer>());
+    thread->id = static_cast<uint32_t>(registry.threads.size());
+    thread->name = std::format("Thread {}", thread->id);
+    tThread = thread.get();
+    return *thread;
+}
+inline ThreadBuffer &GetThread()
+{
+    if (!tThread) [[unlikely]]
+    {
+        return RegisterThread();
+    }
+    return *tThread;
+}
+} // namespace
+
+uint64_t CpuProfiler::Now()
+{
+#ifdef MENGINE_PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+void CpuProfiler::BeginZone(const char *name)
+{
+    auto &thread = GetThread();
+    if (thread.depth < MaxDepth)
+    {
+        // 暂停时只压栈，不读时钟
+        auto enabled = name && GetRegistry().enabled.load(std::memory_order_relaxed);
+        thread.stack[thread.depth] = enabled ? OpenZone{name, Now()} : OpenZone{};
+    }
+    thread.depth++;
+}
+void CpuProfiler::EndZone()
+{
+    auto &thread = GetThread();
+    if (thread.depth == 0)
+    {
+        return;
+    }
+    thread.depth--;
+    // 超过MaxDepth的zone不记录
+    if (thread.depth >= MaxDepth || !thread.stack[thread.depth].name)
+    {
+        return;
+    }
+    auto end = Now();
+    auto index = thread.writeIndex.load(std::memory_order_relaxed);
+    thread.events[index & (EventCapacity - 1)] = {thread.stack[thread.depth].name, thread.stack[thread.depth].begin,
+                                                  end, thread.depth};
+    thread.writeIndex.store(index + 1, std::memory_order_release);
+}
+void CpuProfiler::SetThreadName(std::string_view name)
+{
+    auto &thread = GetThread();
+    std::lock_guard lock(GetRegistry().mutex);
+    thread.name = name;
+}
+const char *CpuProfiler::InternName(std::string_view name)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    return registry.names.emplace(name).first->c_str();
+}
+void CpuProfiler::SetEnabled(bool enabled)
+{
+    GetRegistry().enabled.store(enabled, std::memory_order_relaxed);
+}
+bool CpuProfiler::IsEnabled()
+{
+    return GetRegistry().enabled.load(std::memory_order_relaxed);
+}
+void CpuProfiler::MarkFrame()
+{
+    auto &registry = GetRegistry();
+    if (!registry.enabled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    auto count = registry.frameCount.load(std::memory_order_relaxed);
+    registry.frames[count % FrameCapacity].store(Now(), std::memory_order_relaxed);
+    registry.frameCount.store(count + 1, std::memory_order_release);
+}
+std::vector<uint64_t> CpuProfiler::GetFrameMarks(uint32_t count)
+{
+    auto &registry = GetRegistry();
+    auto frameCount = registry.frameCount.load(std::memory_order_acquire);
+    auto available = std::min<uint64_t>({frameCount, count, FrameCapacity});
+    std::vector<uint64_t> marks;
+    marks.reserve(available);
+    for (auto i = frameCount - available; i < frameCount; ++i)
+    {
+        marks.push_back(registry.frames[i % FrameCapacity].load(std::memory_order_relaxed));
+    }
+    return marks;
+}
+std::vector<CpuProfileThread> CpuProfiler::Capture(uint64_t begin, uint64_t end)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    std::vector<CpuProfileThread> threads;
+    threads.reserve(registry.threads.size());
+    for (const auto &thread : registry.threads)
+    {
+        auto &captured = threads.emplace_back(CpuProfileThread{thread->id, thread->name, {}});
+        auto writeIndex = thread->writeIndex.load(std::memory_order_acquire);
+        auto first = std::max(thread->readFrom, writeIndex > EventCapacity ? writeIndex - EventCapacity : 0);
+        std::vector<CpuProfileEvent> events;
+        events.reserve(writeIndex - first);
+        for (auto i = first; i < writeIndex; ++i)
+        {
+            events.push_back(thread->events[i & (EventCapacity - 1)]);
+        }
+        // 拷贝期间所属线程可能已经覆盖了最旧的事件，正在写入的槽位也要丢弃
+        auto newWriteIndex = thread->writeIndex.load(std::memory_order_acquire);
+        auto valid = newWriteIndex + 1 > EventCapacity ? newWriteIndex + 1 - EventCapacity : 0;
+        auto skip = valid > first ? std::min<uint64_t>(valid - first, events.size()) : 0;
+        for (auto it = events.begin() + static_cast<std::ptrdiff_t>(skip); it != events.end(); ++it)
+        {
+            if (end == 0 || (it->end > begin && it->begin < end))
+            {
+                captured.events.push_back(*it);
+            }
+        }
+    }
+    return threads;
+}
+double CpuProfiler::TicksToMs(uint64_t ticks)
+{
+#ifdef MENGINE_PROFILER_RDTSC
+    // 用启动以来的steady_clock时间校准tsc频率，至少间隔1ms
+    auto &registry = GetRegistry();
+    auto elapsed = std::chrono::steady_clock::now() - registry.baseTime;
+    if (elapsed < std::chrono::milliseconds(1))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1) - elapsed);
+    }
+    auto nowTicks = Now();
+    elapsed = std::chrono::steady_clock::now() - registry.baseTime;
+    auto ticksPerMs = static_cast<double>(nowTicks - registry.baseTicks) /
+                      std::chrono::duration<double, std::milli>(elapsed).count();
+    return static_cast<double>(ticks) / ticksPerMs;
+#else
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::duration(ticks)).count();
+#endif
+}
+void CpuProfiler::Clear()
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    for (auto &thread : registry.threads)
+    {
+        thread->readFrom = thread->writeIndex.load(std::memory_order_acquire);
+    }
+    registry.frameCount.store(0, std::memory_order_release);
+}
+nlohmann::json CpuProfiler::ToChromeTrace()
+{
+    auto threads = Capture();
+    auto baseTicks = GetRegistry().baseTicks;
+    // ts和dur的单位为微秒
+    auto usPerTick = TicksToMs(1) * 1000.0;
+    auto toUs = [baseTicks, usPerTick](uint64_t ticks) { return static_cast<double>(ticks - baseTicks) * usPerTick; };
+    auto events = nlohmann::json::array();
+    for (const auto &thread : threads)
+    {
+        events.push_back({{"name", "thread_name"},
+                          {"ph", "M"},
+                          {"pid", 1},
+                          {"tid", thread.id},
+                          {"args", {{"name", thread.name}}}});
+        for (const auto &event : thread.events)
+        {
+            events.push_back({{"name", event.name},
+                              {"cat", "cpu"},
+                              {"ph", "X"},
+                              {"pid", 1},
+                              {"tid", thread.id},
+                              {"ts", toUs(event.begin)},
+                              {"dur", static_cast<double>(event.end - event.begin) * usPerTick}});
+        }
+    }
+    for (auto mark : GetFrameMarks())
+    {
+        events.push_back({{"name", "Frame"}, {"ph", "i"}, {"s", "g"}, {"pid", 1}, {"tid", 0}, {"ts", toUs(mark)}});
+    }
+    return {{"displayTimeUnit", "ms"}, {"traceEvents", events}};
+}
+void CpuProfiler::DumpChromeTrace(const std::filesystem::path &path)
+{
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        LogError("Failed to open CPU trace file {}", path.string());
+        throw std::runtime_error("Failed to open CPU trace file");
+    }
+    file << ToChromeTrace().dump();
+    LogInfo("CPU trace written to {}", path.string());
+}
+} // namespace MEngine
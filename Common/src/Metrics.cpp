@@ -0,0 +1,323 @@
+#include "Metrics.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <map>
+#include <memory>
+
+namespace MEngine
+{
+namespace
+{
+struct CounterEntry
+{
+    MetricCounter counter;
+    uint64_t lastValue{0}; // 上次快照时的值
+};
+struct HistogramEntry
+{
+    std::unique_ptr<MetricHistogram> histogram;
+    double hitchThreshold{0.0};
+};
+struct Registry
+{
+    std::mutex mutex;
+    std::map<std::string, std::unique_ptr<CounterEntry>, std::less<>> counters;
+    std::map<std::string, std::unique_ptr<MetricGauge>, std::less<>> gauges;
+    std::map<std::string, HistogramEntry, std::less<>> histograms;
+};
+// 不析构，避免静态析构顺序问题
+Registry &GetRegistry()
+{
+    static auto *registry = new Registry();
+    return *registry;
+}
+} // namespace
+
+double MetricHistogramSnapshot::GetMean() const
+{
+    return count == 0 ? 0.0 : sum / static_cast<double>(count);
+}
+double MetricHistogramSnapshot::GetPercentile(double percentile) const
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 1.0) * static_cast<double>(count)));
+    rank = std::clamp<uint64_t>(rank, 1, count);
+    uint64_t accumulated = 0;
+    for (uint32_t i = 0; i < buckets.size(); ++i)
+    {
+        accumulated += buckets[i];
+        if (accumulated >= rank)
+        {
+            auto value = static_cast<double>(MetricHistogram::GetBucketUpperBound(i)) * resolution;
+            return std::min(value, max);
+        }
+    }
+    return max;
+}
+uint64_t MetricHistogramSnapshot::CountAbove(double value) const
+{
+    uint64_t result = 0;
+    for (uint32_t i = 0; i < buckets.size(); ++i)
+    {
+        if (static_cast<double>(MetricHistogram::GetBucketLowerBound(i)) * resolution > value)
+        {
+            result += buckets[i];
+        }
+    }
+    return result;
+}
+
+MetricHistogram::MetricHistogram(double resolution) : mResolution(resolution > 0.0 ? resolution : 1.0)
+{
+}
+uint32_t MetricHistogram::GetBucketIndex(uint64_t value)
+{
+    if (value < 2 * SubBucketCount)
+    {
+        return static_cast<uint32_t>(value);
+    }
+    // value >> shift落在[SubBucketCount, 2 * SubBucketCount)
+    auto shift = static_cast<uint32_t>(std::bit_width(value)) - 1 - SubBucketBits;
+    return shift * SubBucketCount + static_cast<uint32_t>(value >> shift);
+}
+uint64_t MetricHistogram::GetBucketLowerBound(uint32_t index)
+{
+    if (index < 2 * SubBucketCount)
+    {
+        return index;
+    }
+    auto shift = index / SubBucketCount - 1;
+    return static_cast<uint64_t>(index - shift * SubBucketCount) << shift;
+}
+uint64_t MetricHistogram::GetBucketUpperBound(uint32_t index)
+{
+    if (index < 2 * SubBucketCount)
+    {
+        return index;
+    }
+    auto shift = index / SubBucketCount - 1;
+    return GetBucketLowerBound(index) + ((uint64_t{1} << shift) - 1);
+}
+void MetricHistogram::Record(double value)
+{
+    auto scaled = std::max(value, 0.0) / mResolution + 0.5;
+    auto quantized = scaled >= 1.8e19 ? UINT64_MAX : static_cast<uint64_t>(scaled);
+    mBuckets[GetBucketIndex(quantized)].fetch_add(1, std::memory_order_relaxed);
+    mSum.fetch_add(quantized, std::memory_order_relaxed);
+    auto max = mMax.load(std::memory_order_relaxed);
+    while (quantized > max && !mMax.compare_exchange_weak(max, quantized, std::memory_order_relaxed))
+    {
+    }
+}
+MetricHistogramSnapshot MetricHistogram::Snapshot(bool reset)
+{
+    MetricHistogramSnapshot snapshot;
+    snapshot.resolution = mResolution;
+    snapshot.buckets.resize(BucketCount);
+    for (uint32_t i = 0; i < BucketCount; ++i)
+    {
+        snapshot.buckets[i] = reset ? mBuckets[i].exchange(0, std::memory_order_relaxed)
+                                    : mBuckets[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    auto sum = reset ? mSum.exchange(0, std::memory_order_relaxed) : mSum.load(std::memory_order_relaxed);
+    auto max = reset ? mMax.exchange(0, std::memory_order_relaxed) : mMax.load(std::memory_order_relaxed);
+    snapshot.sum = static_cast<double>(sum) * mResolution;
+    snapshot.max = static_cast<double>(max) * mResolution;
+    return snapshot;
+}
+
+MetricCounter &Metrics::GetCounter(std::string_view name)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto it = registry.counters.find(name);
+    if (it == registry.counters.end())
+    {
+        it = registry.counters.emplace(std::string(name), std::make_unique<CounterEntry>()).first;
+    }
+    return it->second->counter;
+}
+MetricGauge &Metrics::GetGauge(std::string_view name)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto it = registry.gauges.find(name);
+    if (it == registry.gauges.end())
+    {
+        it = registry.gauges.emplace(std::string(name), std::make_unique<MetricGauge>()).first;
+    }
+    return *it->second;
+}
+MetricHistogram &Metrics::GetHistogram(std::string_view name, double resolution)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto it = registry.histograms.find(name);
+    if (it == registry.histograms.end())
+    {
+        HistogramEntry entry{std::make_unique<MetricHistogram>(resolution)};
+        it = registry.histograms.emplace(std::string(name), std::move(entry)).first;
+    }
+    return *it->second.histogram;
+}
+void Metrics::SetHitchThreshold(std::string_view histogram, double threshold)
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto it = registry.histograms.find(histogram);
+    if (it == registry.histograms.end())
+    {
+        LogWarn("Metric histogram {} is not registered", histogram);
+        return;
+    }
+    it->second.hitchThreshold = threshold;
+}
+nlohmann::json Metrics::Snapshot()
+{
+    auto &registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    auto now = std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now());
+    nlohmann::json snapshot;
+    snapshot["time"] = std::format("{:%FT%TZ}", now);
+    snapshot["counters"] = nlohmann::json::object();
+    snapshot["gauges"] = nlohmann::json::object();
+    snapshot["histograms"] = nlohmann::json::object();
+    for (auto &[name, entry] : registry.counters)
+    {
+        auto value = entry->counter.Get();
+        snapshot["counters"][name] = {{"value", value}, {"delta", value - entry->lastValue}};
+        entry->lastValue = value;
+    }
+    for (auto &[name, gauge] : registry.gauges)
+    {
+        snapshot["gauges"][name] = gauge->Get();
+    }
+    for (auto &[name, entry] : registry.histograms)
+    {
+        auto histogram = entry.histogram->Snapshot(true);
+        auto &json = snapshot["histograms"][name];
+        json["count"] = histogram.count;
+        json["mean"] = histogram.GetMean();
+        json["p50"] = histogram.GetPercentile(0.5);
+        json["p90"] = histogram.GetPercentile(0.9);
+        json["p99"] = histogram.GetPercentile(0.99);
+        json["p999"] = histogram.GetPercentile(0.999);
+        json["max"] = histogram.max;
+        json["hitches"] = entry.hitchThreshold > 0.0 ? histogram.CountAbove(entry.hitchThreshold) : 0;
+    }
+    return snapshot;
+}
+std::string Metrics::ToCsv(const nlohmann::json &snapshot)
+{
+    std::string csv;
+    auto time = snapshot.value("time", std::string());
+    auto histograms = snapshot.value("histograms", nlohmann::json::object());
+    for (auto &[name, histogram] : histograms.items())
+    {
+        csv += std::format("{},{},{},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{}\n", time, name,
+                           histogram["count"].get<uint64_t>(), histogram["mean"].get<double>(),
+                           histogram["p50"].get<double>(), histogram["p90"].get<double>(),
+                           histogram["p99"].get<double>(), histogram["p999"].get<double>(),
+                           histogram["max"].get<double>(), histogram["hitches"].get<uint64_t>());
+    }
+    return csv;
+}
+
+MetricsReporter::MetricsReporter(const MetricsSetting &setting, const std::filesystem::path &directory)
+    : mSetting(setting), mDirectory(directory)
+{
+    if (!mSetting.enabled)
+    {
+        return;
+    }
+    auto interval = std::chrono::duration<float>(std::max(mSetting.flushIntervalSeconds, 1.0f));
+    mThread = std::jthread([this, interval](std::stop_token stopToken) {
+        while (true)
+        {
+            {
+                std::unique_lock lock(mMutex);
+                mCondition.wait_for(lock, stopToken, interval, [] { return false; });
+            }
+            if (stopToken.stop_requested())
+            {
+                break;
+            }
+            Flush();
+        }
+    });
+    LogInfo("Metrics are written to {} every {} s", mDirectory.string(), interval.count());
+}
+MetricsReporter::~MetricsReporter()
+{
+    if (!mSetting.enabled)
+    {
+        return;
+    }
+    mThread.request_stop();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    Flush();
+}
+void MetricsReporter::Flush()
+{
+    auto snapshot = Metrics::Snapshot();
+    std::lock_guard lock(mMutex);
+    Append(mDirectory / "metrics.jsonl", snapshot.dump() + "\n", "");
+    Append(mDirectory / "metrics.csv", Metrics::ToCsv(snapshot), Metrics::CsvHeader);
+}
+void MetricsReporter::Rotate(const std::filesystem::path &path) const
+{
+    std::error_code error;
+    if (!std::filesystem::exists(path, error) || std::filesystem::file_size(path, error) < mSetting.maxFileSize)
+    {
+        return;
+    }
+    // metrics.jsonl -> metrics.1.jsonl -> metrics.2.jsonl ...，超过maxFiles的丢弃
+    auto rotated = [&](uint32_t index) {
+        return path.parent_path() / std::format("{}.{}{}", path.stem().string(), index, path.extension().string());
+    };
+    std::filesystem::remove(rotated(mSetting.maxFiles), error);
+    for (uint32_t i = mSetting.maxFiles; i > 1; --i)
+    {
+        std::filesystem::rename(rotated(i - 1), rotated(i), error);
+    }
+    if (mSetting.maxFiles > 0)
+    {
+        std::filesystem::rename(path, rotated(1), error);
+    }
+    else
+    {
+        std::filesystem::remove(path, error);
+    }
+}
+void MetricsReporter::Append(const std::filesystem::path &path, const std::string &text,
+                             const std::string &header) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+    Rotate(path);
+    auto isNew = !std::filesystem::exists(path, error);
+    std::ofstream file(path, std::ios::app);
+    if (!file.is_open())
+    {
+        LogError("Failed to open metrics file {}", path.string());
+        return;
+    }
+    if (isNew)
+    {
+        file << header;
+    }
+    file << text;
+}
+} // namespace MEngine
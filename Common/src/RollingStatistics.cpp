@@ -0,0 +1,52 @@
+#include "RollingStatistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace MEngine
+{
+RollingStatistics::RollingStatistics(uint32_t capacity) : mCapacity(std::max(capacity, 1u))
+{
+    mSamples.reserve(mCapacity);
+}
+void RollingStatistics::Add(float value)
+{
+    mLast = value;
+    mSum += value;
+    if (mSamples.size() < mCapacity)
+    {
+        mSamples.push_back(value);
+        return;
+    }
+    mSum -= mSamples[mNext];
+    mSamples[mNext] = value;
+    mNext = (mNext + 1) % mCapacity;
+}
+void RollingStatistics::Reset()
+{
+    mSamples.clear();
+    mNext = 0;
+    mSum = 0.0;
+    mLast = 0.0f;
+}
+float RollingStatistics::GetMean() const
+{
+    return mSamples.empty() ? 0.0f : static_cast<float>(mSum / static_cast<double>(mSamples.size()));
+}
+float RollingStatistics::GetMax() const
+{
+    return mSamples.empty() ? 0.0f : *std::ranges::max_element(mSamples);
+}
+float RollingStatistics::GetPercentile(float percentile) const
+{
+    if (mSamples.empty())
+    {
+        return 0.0f;
+    }
+    auto count = mSamples.size();
+    auto rank = static_cast<std::size_t>(std::ceil(std::clamp(percentile, 0.0f, 1.0f) * static_cast<float>(count)));
+    auto index = std::clamp<std::size_t>(rank, 1, count) - 1;
+    auto sorted = mSamples;
+    std::ranges::nth_element(sorted, sorted.begin() + static_cast<std::ptrdiff_t>(index));
+    return sorted[index];
+}
+} // namespace MEngine
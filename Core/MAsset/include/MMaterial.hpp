@@ -2,6 +2,7 @@
 
 #include "MAsset.hpp"
 #include "MPipeline.hpp"
+#include <cstdint>
 #include <memory>
 #include <vulkan/vulkan_handles.hpp>
 
@@ -27,6 +28,7 @@ class MMaterial : public MAsset
     std::string mPipelineName = PipelineType::ForwardOpaquePBR;
     MMaterialSetting mSetting{};
     vk::UniqueDescriptorSet mMaterialDescriptorSet;
+    uint32_t mBindlessIndex = UINT32_MAX; // bindless管线下材质在全局材质buffer中的索引
     MMaterialType mMaterialType = MMaterialType::Unknown;
     // 导航属性
     std::shared_ptr<MPipeline> mPipeline;
@@ -50,6 +52,10 @@ class MMaterial : public MAsset
     {
         return mMaterialDescriptorSet.get();
     }
+    inline uint32_t GetBindlessIndex() const
+    {
+        return mBindlessIndex;
+    }
     inline MMaterialType GetMaterialType() const
     {
         return mMaterialType;
@@ -4,7 +4,9 @@
 #include "VMA.hpp"
 #include "Vertex.hpp"
 #include "VulkanContext.hpp"
+#include <algorithm>
 #include <cstdint>
+#include <limits>
 #include <nlohmann/json_fwd.hpp>
 #include <vector>
 #include <vulkan/vulkan_handles.hpp>
@@ -27,15 +29,22 @@ class MMesh : public MAsset
     std::shared_ptr<VulkanContext> mVulkanContext;
     std::vector<Vertex> mVertices;
     std::vector<uint32_t> mIndices;
+    std::vector<glm::vec3> mPositions; // mVertices中的position，用于position顶点流和CPU遮挡剔除
 
     vk::Buffer mVertexBuffer;
     vk::Buffer mIndexBuffer;
+    vk::Buffer mPositionBuffer{}; // 只含position，深度预渲染使用
     VmaAllocation mVertexBufferAllocation;
     VmaAllocation mIndexBufferAllocation;
+    VmaAllocation mPositionBufferAllocation{};
     VmaAllocationInfo mVertexBufferAllocationInfo;
     VmaAllocationInfo mIndexBufferAllocationInfo;
+    VmaAllocationInfo mPositionBufferAllocationInfo;
 
     MMeshSetting mSetting;
+    // 模型空间包围盒
+    glm::vec3 mBoundsMin{0.0f};
+    glm::vec3 mBoundsMax{0.0f};
 
   public:
     MMesh(const UUID &id, const std::string &name, std::shared_ptr<VulkanContext> vulkanContext,
@@ -44,16 +53,24 @@ class MMesh : public MAsset
     {
         mType = MAssetType::Mesh;
         mState = MAssetState::Unloaded;
+        UpdateBounds();
+        UpdatePositions();
     }
     ~MMesh() override
     {
+        // in-flight的帧可能还在使用，延迟释放
+        auto &deletionQueue = mVulkanContext->GetDeletionQueue();
         if (mVertexBufferAllocation)
         {
-            vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mVertexBuffer, mVertexBufferAllocation);
+            deletionQueue.PushBuffer(mVulkanContext->GetVmaAllocator(), mVertexBuffer, mVertexBufferAllocation);
         }
         if (mIndexBufferAllocation)
         {
-            vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mIndexBuffer, mIndexBufferAllocation);
+            deletionQueue.PushBuffer(mVulkanContext->GetVmaAllocator(), mIndexBuffer, mIndexBufferAllocation);
+        }
+        if (mPositionBufferAllocation)
+        {
+            deletionQueue.PushBuffer(mVulkanContext->GetVmaAllocator(), mPositionBuffer, mPositionBufferAllocation);
         }
     }
     inline const std::vector<Vertex> &GetVertices() const
@@ -64,6 +81,10 @@ class MMesh : public MAsset
     {
         return mIndices;
     }
+    inline const std::vector<glm::vec3> &GetPositions() const
+    {
+        return mPositions;
+    }
     inline const vk::Buffer GetVertexBuffer() const
     {
         return mVertexBuffer;
@@ -72,6 +93,10 @@ class MMesh : public MAsset
     {
         return mIndexBuffer;
     }
+    inline const vk::Buffer GetPositionBuffer() const
+    {
+        return mPositionBuffer;
+    }
     inline const MMeshSetting &GetSetting() const
     {
         return mSetting;
@@ -80,5 +105,43 @@ class MMesh : public MAsset
     {
         return static_cast<uint32_t>(mIndices.size());
     }
+    inline const glm::vec3 &GetBoundsMin() const
+    {
+        return mBoundsMin;
+    }
+    inline const glm::vec3 &GetBoundsMax() const
+    {
+        return mBoundsMax;
+    }
+    inline glm::vec3 GetBoundsCenter() const
+    {
+        return (mBoundsMin + mBoundsMax) * 0.5f;
+    }
+    inline float GetBoundsRadius() const
+    {
+        return glm::length(mBoundsMax - mBoundsMin) * 0.5f;
+    }
+
+  private:
+    inline void UpdatePositions()
+    {
+        mPositions.resize(mVertices.size());
+        std::ranges::transform(mVertices, mPositions.begin(), [](const Vertex &vertex) { return vertex.position; });
+    }
+    inline void UpdateBounds()
+    {
+        if (mVertices.empty())
+        {
+            mBoundsMin = mBoundsMax = glm::vec3(0.0f);
+            return;
+        }
+        mBoundsMin = glm::vec3(std::numeric_limits<float>::max());
+        mBoundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        for (const auto &vertex : mVertices)
+        {
+            mBoundsMin = glm::min(mBoundsMin, vertex.position);
+            mBoundsMax = glm::max(mBoundsMax, vertex.position);
+        }
+    }
 };
 } // namespace MEngine::Core::Asset
@@ -62,9 +62,14 @@ class MPBRMaterial final : public MMaterial
     }
     ~MPBRMaterial() override
     {
+        auto &deletionQueue = mVulkanContext->GetDeletionQueue();
+        if (mMaterialDescriptorSet)
+        {
+            deletionQueue.Push([descriptorSet = std::move(mMaterialDescriptorSet)]() mutable { descriptorSet.reset(); });
+        }
         if (mParamsUBO)
         {
-            vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mParamsUBO, mParamsUBOAllocation);
+            deletionQueue.PushBuffer(mVulkanContext->GetVmaAllocator(), mParamsUBO, mParamsUBOAllocation);
         }
     }
     inline const MPBRMaterialProperties &GetProperties() const
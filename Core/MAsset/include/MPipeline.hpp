@@ -25,6 +25,10 @@ struct PipelineType
     static constexpr const char *GBuffer = "GBuffer";
     static constexpr const char *Lighting = "Lighting";
     static constexpr const char *ShadowDepth = "ShadowDepth";
+    static constexpr const char *DepthPrepass = "DepthPrepass";
+    static constexpr const char *HiZBuild = "HiZBuild";
+    static constexpr const char *HiZCull = "HiZCull";
+    static constexpr const char *TiledLighting = "TiledLighting";
 };
 enum class RenderPassType
 {
@@ -44,8 +48,18 @@ class MPipelineSetting final : public MAssetSetting
   public:
     std::filesystem::path VertexShaderPath;
     std::filesystem::path FragmentShaderPath;
+    // 非空时创建compute管线，忽略顶点/片元着色器和所有图形状态；
+    // set:0为MaterialDescriptorSetLayoutBindings，push constant大小为PushConstantSize
+    std::filesystem::path ComputeShaderPath;
+    uint32_t PushConstantSize = 0;
     // RenderPass
     RenderPassType RenderPassType = RenderPassType::ForwardComposition;
+    // set:1 使用BindlessManager的全局描述符集，shader以MENGINE_BINDLESS编译
+    bool Bindless = false;
+    // 只使用MMesh的position顶点流(binding:0 location:0)
+    bool PositionOnly = false;
+    // 额外创建深度测试为eEqual、不写深度的变体，在深度预渲染之后绘制
+    bool DepthEqualVariant = false;
 
     //========== 5. 光栅化状态 ==========
     bool DepthClampEnable = false;
@@ -55,6 +69,8 @@ class MPipelineSetting final : public MAssetSetting
     vk::CullModeFlagBits CullMode = vk::CullModeFlagBits::eBack;
     vk::FrontFace FrontFace = vk::FrontFace::eClockwise;
     bool DepthBiasEnable = false;
+    float DepthBiasConstantFactor = 0.0f;
+    float DepthBiasSlopeFactor = 0.0f;
     // ========= 6. 多重采样 ==========
     bool MultisamplingEnable = false;
     vk::SampleCountFlagBits SampleCount = vk::SampleCountFlagBits::e1;
@@ -109,8 +125,10 @@ class MPipeline : public MAsset
     // vulkan
     vk::UniqueShaderModule mVertexShaderModule;
     vk::UniqueShaderModule mFragmentShaderModule;
+    vk::UniqueShaderModule mComputeShaderModule;
     vk::UniquePipelineLayout mPipelineLayout;
     vk::UniquePipeline mPipeline;
+    vk::UniquePipeline mDepthEqualPipeline;
     vk::UniqueDescriptorSetLayout mMaterialDescriptorSetLayouts;
 
   public:
@@ -133,10 +151,23 @@ class MPipeline : public MAsset
     {
         return mFragmentShaderModule.get();
     }
+    inline const vk::ShaderModule GetComputeShaderModule() const
+    {
+        return mComputeShaderModule.get();
+    }
+    inline bool IsCompute() const
+    {
+        return !mSetting.ComputeShaderPath.empty();
+    }
     inline const vk::Pipeline GetPipeline() const
     {
         return mPipeline.get();
     }
+    // 未设置DepthEqualVariant时为空
+    inline const vk::Pipeline GetDepthEqualPipeline() const
+    {
+        return mDepthEqualPipeline.get();
+    }
     inline const vk::PipelineLayout GetPipelineLayout() const
     {
         return mPipelineLayout.get();
@@ -8,6 +8,7 @@
 #include <imgui_impl_vulkan.h>
 #include <memory>
 #include <nlohmann/json_fwd.hpp>
+#include <tuple>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -20,6 +21,8 @@ class MTextureSetting final : public MAssetSetting
   public:
     vk::ImageViewType ImageType = vk::ImageViewType::e2D;
     uint32_t mipmapLevels = 1;
+    bool isMipmapBaked = false; // mImageData中已包含完整mip链，上传时跳过GPU生成
+    bool isStreamable = false;  // 按渲染反馈和显存预算流式加载高精度mip，需要isMipmapBaked
     uint32_t arrayLayers = 1;
     vk::Format format = vk::Format::eR8G8B8A8Srgb;
     vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1;
@@ -49,6 +52,14 @@ class MTextureSetting final : public MAssetSetting
   public:
     ~MTextureSetting() override = default;
 };
+// mImageData中一级mip的位置
+struct TextureMipLevel
+{
+    uint32_t width;
+    uint32_t height;
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+};
 struct TextureSize
 {
     uint32_t width;
@@ -69,11 +80,19 @@ class MTexture final : public MAsset
     // GPU resources
     vk::Image mImage{};
     vk::UniqueImageView mImageView{};
-    vk::UniqueSampler mSampler{};
+    std::shared_ptr<vk::UniqueSampler> mSampler{}; // MTextureManager的sampler缓存共享
     VmaAllocation mAllocation{};
     VmaAllocationInfo mAllocationInfo{};
     vk::DescriptorSet mThumbnailDescriptorSet{};
 
+    // Streaming
+    uint32_t mResidentMip{0};           // GPU上驻留的最高精度mip，相对完整mip链
+    uint32_t mRequestedMip{UINT32_MAX}; // 本帧渲染反馈请求的mip
+    uint64_t mLastRequestedFrame{0};
+    // MTextureManager缓存的mip布局，计算时的宽、高、格式、mip数任一变化时重新计算
+    std::vector<TextureMipLevel> mMipLevels{};
+    std::tuple<uint32_t, uint32_t, vk::Format, uint32_t> mMipLevelsKey{};
+
   public:
     MTexture(const UUID &id, const std::string &name, std::shared_ptr<VulkanContext> vulkanContext, TextureSize size,
              const std::vector<uint8_t> &imageData, const MTextureSetting &setting)
@@ -86,8 +105,13 @@ class MTexture final : public MAsset
     {
         if (mImage)
         {
-            VkImage image = mImage;
-            vmaDestroyImage(mVulkanContext->GetVmaAllocator(), image, mAllocation);
+            // image view先于image释放
+            mVulkanContext->GetDeletionQueue().Push(
+                [allocator = mVulkanContext->GetVmaAllocator(), image = mImage, allocation = mAllocation,
+                 imageView = std::move(mImageView)]() mutable {
+                    imageView.reset();
+                    vmaDestroyImage(allocator, image, allocation);
+                });
         }
         // TODO: Remove ImGui texture Safely!!!!
         //  if (mThumbnailDescriptorSet)
@@ -113,7 +137,7 @@ class MTexture final : public MAsset
     }
     inline const vk::Sampler &GetSampler() const
     {
-        return *mSampler;
+        return mSampler->get();
     }
     inline const MTextureSetting &GetSetting() const
     {
@@ -131,6 +155,14 @@ class MTexture final : public MAsset
     {
         return mImageData;
     }
+    inline bool IsStreamable() const
+    {
+        return mSetting.isStreamable && mSetting.isMipmapBaked && mSetting.mipmapLevels > 1;
+    }
+    inline uint32_t GetResidentMip() const
+    {
+        return mResidentMip;
+    }
 };
 
 } // namespace MEngine::Core::Asset
\ No newline at end of file
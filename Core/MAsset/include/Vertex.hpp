@@ -11,5 +11,8 @@ class Vertex
     glm::vec2 texCoords;
     static std::array<vk::VertexInputAttributeDescription, 3> GetVertexInputAttributeDescription();
     static vk::VertexInputBindingDescription GetVertexInputBindingDescription();
+    // 只含position的紧凑顶点流，深度预渲染使用
+    static vk::VertexInputAttributeDescription GetPositionInputAttributeDescription();
+    static vk::VertexInputBindingDescription GetPositionInputBindingDescription();
 };
 } // namespace MEngine::Core::Asset
\ No newline at end of file
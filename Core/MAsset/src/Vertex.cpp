@@ -24,4 +24,16 @@ vk::VertexInputBindingDescription Vertex::GetVertexInputBindingDescription()
     bindingDescription.setBinding(0).setStride(sizeof(Vertex)).setInputRate(vk::VertexInputRate::eVertex);
     return bindingDescription;
 }
+vk::VertexInputAttributeDescription Vertex::GetPositionInputAttributeDescription()
+{
+    vk::VertexInputAttributeDescription attributeDescription;
+    attributeDescription.setBinding(0).setLocation(0).setFormat(vk::Format::eR32G32B32Sfloat).setOffset(0);
+    return attributeDescription;
+}
+vk::VertexInputBindingDescription Vertex::GetPositionInputBindingDescription()
+{
+    vk::VertexInputBindingDescription bindingDescription;
+    bindingDescription.setBinding(0).setStride(sizeof(glm::vec3)).setInputRate(vk::VertexInputRate::eVertex);
+    return bindingDescription;
+}
 } // namespace MEngine::Core::Asset
\ No newline at end of file
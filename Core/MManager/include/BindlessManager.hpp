@@ -0,0 +1,94 @@
+#pragma once
+#include "MPBRMaterial.hpp"
+#include "UUID.hpp"
+#include "VMA.hpp"
+#include "VulkanContext.hpp"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_handles.hpp>
+
+using namespace MEngine::Core::Asset;
+namespace MEngine::Core::Manager
+{
+// 与shader中BindlessMaterial的std430布局一致
+struct BindlessMaterialData
+{
+    MPBRMaterialProperties properties{};
+    alignas(16) glm::uvec4 textureIndices{0}; // albedo, normal, arm, emissive
+    alignas(16) glm::uvec4 samplerIndices{0};
+};
+/**
+ * @brief 全局bindless描述符集
+ * set:1 binding 0: 材质参数storage buffer, binding 1: sampled image数组, binding 2: sampler数组
+ * 绘制时只需push材质索引，不再逐draw绑定描述符集
+ */
+class BindlessManager final : public std::enable_shared_from_this<BindlessManager>
+{
+  public:
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+  private:
+    // DI
+    std::shared_ptr<VulkanContext> mVulkanContext;
+
+  private:
+    static constexpr uint32_t MaxTextures = 4096;
+    static constexpr uint32_t MaxSamplers = 256;
+    static constexpr uint32_t MaxMaterials = 4096;
+    bool mEnabled{false};
+    uint32_t mTextureCapacity{0};
+    uint32_t mSamplerCapacity{0};
+    vk::UniqueDescriptorPool mDescriptorPool;
+    vk::UniqueDescriptorSetLayout mDescriptorSetLayout;
+    vk::DescriptorSet mDescriptorSet{};
+    vk::Buffer mMaterialBuffer{};
+    VmaAllocation mMaterialBufferAllocation{};
+    VmaAllocationInfo mMaterialBufferAllocationInfo{};
+    // slot分配
+    struct TextureSlot
+    {
+        uint32_t index;
+        vk::ImageView imageView;
+    };
+    std::unordered_map<UUID, TextureSlot> mTextureSlots;
+    std::vector<uint32_t> mFreeTextureSlots;
+    uint32_t mTextureSlotCount{0};
+    std::unordered_map<VkSampler, uint32_t> mSamplerSlots;
+    std::vector<uint32_t> mFreeMaterialSlots;
+    uint32_t mMaterialSlotCount{0};
+
+  private:
+    void CreateDescriptorSet();
+    void CreateMaterialBuffer();
+    // 旧slot可能还被in-flight帧读取，等这些帧完成后再放回空闲列表
+    void RetireTextureSlot(uint32_t index);
+
+  public:
+    BindlessManager(std::shared_ptr<VulkanContext> vulkanContext);
+    ~BindlessManager();
+    inline bool IsEnabled() const
+    {
+        return mEnabled;
+    }
+    inline vk::DescriptorSetLayout GetDescriptorSetLayout() const
+    {
+        return mDescriptorSetLayout.get();
+    }
+    inline vk::DescriptorSet GetDescriptorSet() const
+    {
+        return mDescriptorSet;
+    }
+    // 注册纹理的image view，返回其在sampled image数组中的索引；image view变化时分配新slot，不重写旧元素
+    uint32_t WriteTexture(const UUID &id, vk::ImageView imageView);
+    // 纹理被移除或image被替换时调用，slot在in-flight帧完成后才会复用
+    void ReleaseTexture(const UUID &id);
+    // sampler已由MTextureManager去重，按句柄分配索引
+    uint32_t WriteSampler(vk::Sampler sampler);
+    uint32_t AllocateMaterial();
+    void WriteMaterial(uint32_t index, const BindlessMaterialData &data);
+    // 同ReleaseTexture，延迟到in-flight帧完成后放回空闲列表
+    void ReleaseMaterial(uint32_t index);
+};
+} // namespace MEngine::Core::Manager
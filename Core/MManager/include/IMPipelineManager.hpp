@@ -11,7 +11,8 @@ class IMPipelineManager : public virtual IMManager<MPipeline>
   public:
     ~IMPipelineManager() override = default;
     virtual std::shared_ptr<MPipeline> Create(const std::string &name, const MPipelineSetting &setting) = 0;
-    virtual vk::UniqueShaderModule CreateShaderModule(const std::filesystem::path &shaderPath) const = 0;
+    virtual vk::UniqueShaderModule CreateShaderModule(const std::filesystem::path &shaderPath,
+                                                      const std::vector<std::string> &macros = {}) const = 0;
     virtual std::shared_ptr<MPipeline> GetByName(const std::string &name) const = 0;
     virtual void RemoveByName(const std::string &name) = 0;
     virtual std::vector<vk::DescriptorSetLayoutBinding> GetGlobalDescriptorSetLayoutBindings() const = 0;
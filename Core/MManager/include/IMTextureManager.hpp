@@ -3,6 +3,7 @@
 #include "MTexture.hpp"
 #include <cstdint>
 #include <memory>
+#include <vector>
 #include <vulkan/vulkan_enums.hpp>
 
 using namespace MEngine::Core::Asset;
@@ -22,6 +23,16 @@ enum class DefaultTextureType
     IrradianceMap,
     BRDFLUT
 };
+struct TextureStreamingStats
+{
+    vk::DeviceSize budget{0};
+    vk::DeviceSize residentBytes{0};
+    vk::DeviceSize requestedBytes{0};
+    uint32_t streamableCount{0};
+    uint32_t uploadCount{0};
+    uint32_t evictCount{0};
+    vk::DeviceSize uploadedBytes{0}; // 启动以来通过staging buffer上传的字节数
+};
 class IMTextureManager : public virtual IMManager<MTexture>
 {
   public:
@@ -42,6 +53,11 @@ class IMTextureManager : public virtual IMManager<MTexture>
     virtual std::shared_ptr<MTexture> GetDefaultTexture(DefaultTextureType type) const = 0;
     virtual std::shared_ptr<MTexture> CreateColorAttachment(uint32_t width, uint32_t height) = 0;
     virtual std::shared_ptr<MTexture> CreateDepthStencilAttachment(uint32_t width, uint32_t height) = 0;
+    // Streaming
+    virtual void RequestMip(std::shared_ptr<MTexture> texture, uint32_t mip) = 0;
+    virtual std::vector<std::shared_ptr<MTexture>> UpdateStreaming() = 0;
+    virtual void SetStreamingBudget(vk::DeviceSize budget) = 0;
+    virtual const TextureStreamingStats &GetStreamingStats() const = 0;
     virtual std::vector<uint8_t> GetWhiteData() const = 0;
     virtual std::vector<uint8_t> GetBlackData() const = 0;
     virtual std::vector<uint8_t> GetNormalData() const = 0;
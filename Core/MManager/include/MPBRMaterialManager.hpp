@@ -1,4 +1,6 @@
 #pragma once
+#include "BindlessManager.hpp"
+#include "DescriptorAllocator.hpp"
 #include "IMPBRMaterialManager.hpp"
 #include "MMaterialManager.hpp"
 #include "MPBRMaterial.hpp"
@@ -6,11 +8,18 @@ namespace MEngine::Core::Manager
 {
 class MPBRMaterialManager final : public MMaterialManager<MPBRMaterial>, public IMPBRMaterialManager
 {
+  private:
+    std::shared_ptr<BindlessManager> mBindlessManager;
+    std::shared_ptr<DescriptorAllocator> mDescriptorAllocator;
+
   public:
     MPBRMaterialManager(std::shared_ptr<VulkanContext> vulkanContext, std::shared_ptr<IUUIDGenerator> uuidGenerator,
                         std::shared_ptr<IMPipelineManager> pipelineManager,
-                        std::shared_ptr<IMTextureManager> textureManager)
-        : MMaterialManager<MPBRMaterial>(vulkanContext, uuidGenerator, pipelineManager, textureManager)
+                        std::shared_ptr<IMTextureManager> textureManager,
+                        std::shared_ptr<BindlessManager> bindlessManager,
+                        std::shared_ptr<DescriptorAllocator> descriptorAllocator)
+        : MMaterialManager<MPBRMaterial>(vulkanContext, uuidGenerator, pipelineManager, textureManager),
+          mBindlessManager(bindlessManager), mDescriptorAllocator(descriptorAllocator)
     {
         CreateDefault();
     }
@@ -21,8 +30,12 @@ class MPBRMaterialManager final : public MMaterialManager<MPBRMaterial>, public
     std::shared_ptr<MPBRMaterial> CreateLightMaterial() override;
     void Update(std::shared_ptr<MPBRMaterial> material) override;
     void Write(std::shared_ptr<MPBRMaterial> material) override;
+    void Remove(const UUID &id) override;
     void CreateDefault() override;
     std::shared_ptr<MPBRMaterial> CreateDefaultForwardOpaquePBRMaterial() override;
     virtual void CreateVulkanResources(std::shared_ptr<MPBRMaterial> asset) override;
+
+  private:
+    void WriteBindless(std::shared_ptr<MPBRMaterial> material);
 };
 } // namespace MEngine::Core::Manager
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "BindlessManager.hpp"
 #include "IMPipelineManager.hpp"
 #include "Logger.hpp"
 #include "MManager.hpp"
@@ -20,14 +21,15 @@ class MPipelineManager final : public MManager<MPipeline>, public IMPipelineMana
 
   private:
     std::shared_ptr<RenderPassManager> mRenderPassManager;
+    std::shared_ptr<BindlessManager> mBindlessManager;
     std::unordered_map<std::string, std::shared_ptr<MPipeline>> mPipelines;
     std::vector<vk::DescriptorSetLayoutBinding> mGlobalDescriptorSetLayoutBindings{
         // set:0
-        // Binding: 0 VP (View Projection Matrix)
-        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBuffer, 1,
+        // Binding: 0 VP (View Projection Matrix), 每帧数据通过dynamic offset定位
+        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eUniformBufferDynamic, 1,
                                        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment},
         // Binding: 1 Light
-        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eUniformBuffer, 1,
+        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eUniformBufferDynamic, 1,
                                        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment},
         // Binding: 2 Environment Map
         vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eCombinedImageSampler, 1,
@@ -38,20 +40,31 @@ class MPipelineManager final : public MManager<MPipeline>, public IMPipelineMana
         // Binding: 4 BRDF LUT
         vk::DescriptorSetLayoutBinding{4, vk::DescriptorType::eCombinedImageSampler, 1,
                                        vk::ShaderStageFlagBits::eFragment},
+        // Binding: 5 级联阴影参数，每帧数据通过dynamic offset定位
+        vk::DescriptorSetLayoutBinding{5, vk::DescriptorType::eUniformBufferDynamic, 1,
+                                       vk::ShaderStageFlagBits::eFragment},
+        // Binding: 6 阴影atlas，比较采样
+        vk::DescriptorSetLayoutBinding{6, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eFragment},
     };
     std::unordered_map<std::string, std::vector<vk::DescriptorSetLayoutBinding>> mDescriptorSetLayoutBindings{};
 
     vk::UniqueDescriptorSetLayout mGlobalDescriptorSetLayout;
     std::unordered_map<std::string, vk::DescriptorSetLayout> mMaterialDescriptorSetLayouts;
 
+  private:
+    void CreateComputeVulkanResources(std::shared_ptr<MPipeline> pipeline);
+
   public:
     MPipelineManager(std::shared_ptr<VulkanContext> vulkanContext, std::shared_ptr<IUUIDGenerator> uuidGenerator,
-                     std::shared_ptr<RenderPassManager> renderPassManager);
+                     std::shared_ptr<RenderPassManager> renderPassManager,
+                     std::shared_ptr<BindlessManager> bindlessManager);
     ~MPipelineManager() override = default;
     std::shared_ptr<MPipeline> Create(const std::string &name, const MPipelineSetting &setting) override;
     std::shared_ptr<MPipeline> GetByName(const std::string &name) const override;
     void Update(std::shared_ptr<MPipeline> pipeline) override;
-    vk::UniqueShaderModule CreateShaderModule(const std::filesystem::path &shaderPath) const override;
+    vk::UniqueShaderModule CreateShaderModule(const std::filesystem::path &shaderPath,
+                                              const std::vector<std::string> &macros = {}) const override;
     void Remove(const UUID &id) override;
     void RemoveByName(const std::string &name) override;
     void CreateDefault() override;
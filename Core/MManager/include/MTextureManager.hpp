@@ -1,10 +1,14 @@
 #pragma once
+#include "BindlessManager.hpp"
+#include "IBLBaker.hpp"
 #include "IMTextureManager.hpp"
 #include "IUUIDGenerator.hpp"
 #include "MManager.hpp"
 #include "MTexture.hpp"
 #include "VulkanContext.hpp"
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -16,8 +20,60 @@ namespace MEngine::Core::Manager
 class MTextureManager final : public MManager<MTexture>, public IMTextureManager
 {
   private:
-    vk::UniqueCommandBuffer mCommandBuffer;
-    vk::UniqueFence mFence;
+    // DI
+    std::shared_ptr<BindlessManager> mBindlessManager;
+
+  private:
+    // 上传: transfer队列拷贝数据后把所有权释放给graphics队列，graphics队列获取后生成mip并转换到shader读布局
+    // 提交后不等待，之后的Write和UpdateStreaming回收已完成的上传
+    struct Upload
+    {
+        vk::UniqueCommandBuffer transferCommandBuffer;
+        vk::UniqueCommandBuffer graphicsCommandBuffer; // 没有独立的transfer family时为空
+        vk::UniqueSemaphore semaphore;
+        vk::UniqueFence fence;
+        vk::Buffer stagingBuffer{};
+        VmaAllocation stagingAllocation{};
+    };
+    static constexpr uint32_t MaxPendingUploads = 16;
+    std::deque<Upload> mPendingUploads;
+    std::vector<Upload> mFreeUploads;
+    // Streaming
+    static constexpr uint32_t StreamingTailSize = 64;    // 不超过该尺寸的mip常驻
+    static constexpr uint64_t StreamingIdleFrames = 120; // 超过该帧数未被请求则降回常驻mip
+    static constexpr uint32_t StreamingMaxUploadsPerFrame = 4;
+    uint64_t mStreamingFrame{0};
+    vk::DeviceSize mStreamingBudget{0}; // 0: 只受VMA报告的显存预算限制
+    TextureStreamingStats mStreamingStats{};
+    // IBL烘焙结果，只在CreateDefault期间持有
+    static constexpr const char *EnvironmentMapPath = "Engine/Textures/EnvironmentMap.hdr";
+    static constexpr const char *IBLCachePath = "Cache/IBL/EnvironmentMap.ibl";
+    std::unique_ptr<Utils::IBLBakeResult> mIBLBake;
+    // Sampler缓存，按MTextureSetting中与采样相关的字段去重，纹理共享引用
+    struct SamplerKey
+    {
+        vk::SamplerAddressMode addressModeU;
+        vk::SamplerAddressMode addressModeV;
+        vk::SamplerAddressMode addressModeW;
+        vk::Filter minFilter;
+        vk::Filter magFilter;
+        vk::SamplerMipmapMode mipmapMode;
+        float mipLodBias;
+        float minLod;
+        float maxLod;
+        vk::BorderColor borderColor;
+        bool compareEnable;
+        vk::CompareOp compareOp;
+        bool anisotropyEnable;
+        float maxAnisotropy;
+        vk::Bool32 unnormalizedCoordinates;
+        bool operator==(const SamplerKey &other) const = default;
+    };
+    struct SamplerKeyHash
+    {
+        std::size_t operator()(const SamplerKey &key) const;
+    };
+    std::unordered_map<SamplerKey, std::shared_ptr<vk::UniqueSampler>, SamplerKeyHash> mSamplers;
     std::unordered_map<DefaultTextureType, UUID> mDefaultTextures{
         {DefaultTextureType::Magenta, UUID{"00000000-0000-0000-0000-000000000000"}},
         {DefaultTextureType::White, UUID{"00000000-0000-0000-0000-000000000001"}},
@@ -32,13 +88,15 @@ class MTextureManager final : public MManager<MTexture>, public IMTextureManager
     };
 
   public:
-    MTextureManager(std::shared_ptr<VulkanContext> vulkanContext, std::shared_ptr<IUUIDGenerator> uuidGenerator);
-    ~MTextureManager() override = default;
+    MTextureManager(std::shared_ptr<VulkanContext> vulkanContext, std::shared_ptr<IUUIDGenerator> uuidGenerator,
+                    std::shared_ptr<BindlessManager> bindlessManager);
+    ~MTextureManager() override;
     std::shared_ptr<MTexture> Create(const std::string &name, TextureSize size, const std::vector<uint8_t> &imageData,
                                      const MTextureSetting &setting) override;
     void Update(std::shared_ptr<MTexture> texture) override;
     // void Write(std::shared_ptr<MTexture> texture, const std::filesystem::path &path) override;
     void Write(std::shared_ptr<MTexture> texture) override;
+    void Remove(const UUID &id) override;
     static vk::ImageType TextureTypeToImageType(vk::ImageViewType type);
     static vk::ImageUsageFlags PickImageUsage(const MTextureSetting &setting);
     static vk::ImageCreateFlags PickImageFlags(const MTextureSetting &setting);
@@ -60,6 +118,17 @@ class MTextureManager final : public MManager<MTexture>, public IMTextureManager
     std::shared_ptr<MTexture> GetDefaultTexture(DefaultTextureType type) const override;
     std::shared_ptr<MTexture> CreateColorAttachment(uint32_t width, uint32_t height) override;
     std::shared_ptr<MTexture> CreateDepthStencilAttachment(uint32_t width, uint32_t height) override;
+    void RequestMip(std::shared_ptr<MTexture> texture, uint32_t mip) override;
+    std::vector<std::shared_ptr<MTexture>> UpdateStreaming() override;
+    void SetStreamingBudget(vk::DeviceSize budget) override;
+    inline const TextureStreamingStats &GetStreamingStats() const override
+    {
+        return mStreamingStats;
+    }
+    inline std::size_t GetSamplerCount() const
+    {
+        return mSamplers.size();
+    }
     inline std::vector<uint8_t> GetWhiteData() const override
     {
         return std::vector<uint8_t>(4, 255);
@@ -102,6 +171,23 @@ class MTextureManager final : public MManager<MTexture>, public IMTextureManager
         }
         return checkerboardData;
     }
+
+  private:
+    void CreateImageResources(std::shared_ptr<MTexture> texture);
+    static SamplerKey MakeSamplerKey(const MTextureSetting &setting, uint32_t imageMipLevels);
+    std::shared_ptr<vk::UniqueSampler> GetOrCreateSampler(const SamplerKey &key);
+    static uint32_t GetStreamingTailMip(const MTexture &texture);
+    // 预烘焙mip链时为完整mip链，否则只有level 0
+    static const std::vector<TextureMipLevel> &GetMipLevels(MTexture &texture);
+    static vk::DeviceSize GetResidentSize(MTexture &texture, uint32_t residentMip);
+    void RetireTexture(MTexture &texture);
+    Upload AcquireUpload();
+    // 回收已完成的上传，未完成的数量超过maxPending时等待最早的上传
+    void CollectUploads(uint32_t maxPending);
+    const Utils::IBLBakeResult &GetIBLBake();
+    // 环境贴图和辐照度图只需要RGB，优先使用共享指数格式(4字节/texel)
+    vk::Format PickHDRFormat() const;
+    static std::vector<uint8_t> ConvertHDRData(const std::vector<uint8_t> &imageData, vk::Format format);
 };
 
 } // namespace MEngine::Core::Manager
\ No newline at end of file
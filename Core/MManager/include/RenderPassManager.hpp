@@ -18,28 +18,80 @@ class RenderPassManager final
   private:
     std::unordered_map<RenderPassType, uint32_t> mSubPasses;
     vk::UniqueRenderPass mCompositionRenderPass;
+    vk::UniqueRenderPass mCompositionLoadRenderPass;
+    vk::UniqueRenderPass mCompositionGBufferRenderPass;
+    vk::UniqueRenderPass mCompositionResumeRenderPass;
+    vk::Format mShadowMapFormat{vk::Format::eD32Sfloat};
+    vk::UniqueRenderPass mShadowRenderPass;
 
   private:
-    void CreateCompositionRenderPass();
-    inline vk::Format GetRenderTargetFormat()
+    // colorInitialLayout不为eUndefined时保留color和depth已有的内容，G-buffer不加载；
+    // storeGBuffer为true时保存G-buffer供render pass之外读取
+    vk::UniqueRenderPass CreateCompositionRenderPass(vk::ImageLayout colorInitialLayout, bool storeGBuffer);
+    // 只有一个depth attachment，保留已有内容，由调用者按级联区域清除
+    vk::UniqueRenderPass CreateShadowRenderPass();
+
+  public:
+    inline vk::Format GetRenderTargetFormat() const
     {
         return vk::Format::eR32G32B32A32Sfloat; // 32位浮点数RGBA
     }
-    inline vk::Format GetDepthStencilFormat()
+    inline vk::Format GetDepthStencilFormat() const
     {
         return vk::Format::eD32SfloatS8Uint; // 32位深度+8位模板存储
     }
-
-  public:
+    // G-buffer通常只在composition render pass内部读写，分块延迟光照时由compute pass采样
+    inline vk::Format GetGBufferFormat() const
+    {
+        return vk::Format::eR32G32B32A32Sfloat;
+    }
+    // 优先eD32Sfloat，不支持采样时使用必然支持的eD16Unorm
+    inline vk::Format GetShadowMapFormat() const
+    {
+        return mShadowMapFormat;
+    }
     RenderPassManager(std::shared_ptr<VulkanContext> vulkanContext) : mVulkanContext(vulkanContext)
     {
-        CreateCompositionRenderPass();
+        mCompositionRenderPass = CreateCompositionRenderPass(vk::ImageLayout::eUndefined, false);
+        mCompositionLoadRenderPass = CreateCompositionRenderPass(vk::ImageLayout::eShaderReadOnlyOptimal, false);
+        mCompositionGBufferRenderPass = CreateCompositionRenderPass(vk::ImageLayout::eUndefined, true);
+        mCompositionResumeRenderPass = CreateCompositionRenderPass(vk::ImageLayout::eColorAttachmentOptimal, false);
+        auto shadowFormatFeatures =
+            mVulkanContext->GetPhysicalDevice().getFormatProperties(mShadowMapFormat).optimalTilingFeatures;
+        if (!(shadowFormatFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment) ||
+            !(shadowFormatFeatures & vk::FormatFeatureFlagBits::eSampledImage))
+        {
+            mShadowMapFormat = vk::Format::eD16Unorm;
+        }
+        mShadowRenderPass = CreateShadowRenderPass();
     }
     std::tuple<vk::RenderPass, uint32_t> GetRenderPass(RenderPassType type) const;
     inline vk::RenderPass GetCompositionRenderPass() const
     {
         return mCompositionRenderPass.get();
     }
+    // 与composition render pass兼容，在同一帧内对已渲染的color/depth继续绘制，
+    // color的initialLayout为eShaderReadOnlyOptimal，depth为eDepthStencilAttachmentOptimal
+    inline vk::RenderPass GetCompositionLoadRenderPass() const
+    {
+        return mCompositionLoadRenderPass.get();
+    }
+    // 与composition render pass兼容，保存G-buffer，之后由compute pass读取
+    inline vk::RenderPass GetCompositionGBufferRenderPass() const
+    {
+        return mCompositionGBufferRenderPass.get();
+    }
+    // 与composition render pass兼容，在compute pass写入color后继续绘制，
+    // color的initialLayout为eColorAttachmentOptimal，depth为eDepthStencilAttachmentOptimal
+    inline vk::RenderPass GetCompositionResumeRenderPass() const
+    {
+        return mCompositionResumeRenderPass.get();
+    }
+    // 级联阴影atlas，initialLayout和finalLayout都是eDepthStencilAttachmentOptimal
+    inline vk::RenderPass GetShadowRenderPass() const
+    {
+        return mShadowRenderPass.get();
+    }
 };
 
 } // namespace MEngine::Core::Manager
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "BindlessManager.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace MEngine::Core::Manager
+{
+BindlessManager::BindlessManager(std::shared_ptr<VulkanContext> vulkanContext) : mVulkanContext(vulkanContext)
+{
+    mEnabled = mVulkanContext->IsBindlessSupported();
+    if (!mEnabled)
+    {
+        LogInfo("Bindless descriptors are not supported, fall back to per-material descriptor sets");
+        return;
+    }
+    CreateDescriptorSet();
+    CreateMaterialBuffer();
+    LogDebug("Bindless descriptor set created: {} textures, {} samplers, {} materials", mTextureCapacity,
+             mSamplerCapacity, MaxMaterials);
+}
+BindlessManager::~BindlessManager()
+{
+    if (mMaterialBuffer)
+    {
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mMaterialBuffer, mMaterialBufferAllocation);
+    }
+}
+void BindlessManager::CreateDescriptorSet()
+{
+    auto properties = mVulkanContext->GetPhysicalDevice()
+                          .getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>();
+    auto &properties12 = properties.get<vk::PhysicalDeviceVulkan12Properties>();
+    mTextureCapacity = std::min(MaxTextures, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages);
+    mSamplerCapacity = std::min(MaxSamplers, properties12.maxPerStageDescriptorUpdateAfterBindSamplers);
+
+    std::array<vk::DescriptorSetLayoutBinding, 3> bindings{
+        // Binding: 0 Materials
+        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eStorageBuffer, 1,
+                                       vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment},
+        // Binding: 1 Textures
+        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eSampledImage, mTextureCapacity,
+                                       vk::ShaderStageFlagBits::eFragment},
+        // Binding: 2 Samplers
+        vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eSampler, mSamplerCapacity,
+                                       vk::ShaderStageFlagBits::eFragment},
+    };
+    // 数组只写入用到的元素，未被pending命令缓冲区使用的元素可以随时更新
+    auto arrayFlags = vk::DescriptorBindingFlagBits::eUpdateAfterBind | vk::DescriptorBindingFlagBits::ePartiallyBound |
+                      vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+    std::array<vk::DescriptorBindingFlags, 3> bindingFlags{vk::DescriptorBindingFlagBits::eUpdateAfterBind, arrayFlags,
+                                                           arrayFlags};
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo;
+    bindingFlagsCreateInfo.setBindingFlags(bindingFlags);
+    vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+    descriptorSetLayoutCreateInfo.setBindings(bindings)
+        .setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool)
+        .setPNext(&bindingFlagsCreateInfo);
+    mDescriptorSetLayout = mVulkanContext->GetDevice().createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo);
+    if (!mDescriptorSetLayout)
+    {
+        LogError("Failed to create bindless descriptor set layout");
+        throw std::runtime_error("Failed to create bindless descriptor set layout");
+    }
+
+    std::array<vk::DescriptorPoolSize, 3> poolSizes{
+        vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, 1},
+        vk::DescriptorPoolSize{vk::DescriptorType::eSampledImage, mTextureCapacity},
+        vk::DescriptorPoolSize{vk::DescriptorType::eSampler, mSamplerCapacity},
+    };
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+    descriptorPoolCreateInfo.setPoolSizes(poolSizes)
+        .setMaxSets(1)
+        .setFlags(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+    mDescriptorPool = mVulkanContext->GetDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
+    if (!mDescriptorPool)
+    {
+        LogError("Failed to create bindless descriptor pool");
+        throw std::runtime_error("Failed to create bindless descriptor pool");
+    }
+    auto descriptorSetLayout = mDescriptorSetLayout.get();
+    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+    descriptorSetAllocateInfo.setDescriptorPool(mDescriptorPool.get()).setSetLayouts(descriptorSetLayout);
+    mDescriptorSet = mVulkanContext->GetDevice().allocateDescriptorSets(descriptorSetAllocateInfo)[0];
+}
+void BindlessManager::CreateMaterialBuffer()
+{
+    vk::BufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.setSize(sizeof(BindlessMaterialData) * MaxMaterials)
+        .setUsage(vk::BufferUsageFlagBits::eStorageBuffer)
+        .setSharingMode(vk::SharingMode::eExclusive);
+    VmaAllocationCreateInfo allocationCreateInfo{};
+    allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+    if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                        &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&mMaterialBuffer),
+                        &mMaterialBufferAllocation, &mMaterialBufferAllocationInfo) != VK_SUCCESS)
+    {
+        LogError("Failed to create bindless material buffer");
+        throw std::runtime_error("Failed to create bindless material buffer");
+    }
+    vk::DescriptorBufferInfo bufferInfo;
+    bufferInfo.setBuffer(mMaterialBuffer).setOffset(0).setRange(vk::WholeSize);
+    vk::WriteDescriptorSet writeDescriptorSet;
+    writeDescriptorSet.setDstSet(mDescriptorSet)
+        .setDstBinding(0)
+        .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+        .setBufferInfo(bufferInfo);
+    mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSet, {});
+}
+uint32_t BindlessManager::WriteTexture(const UUID &id, vk::ImageView imageView)
+{
+    auto it = mTextureSlots.find(id);
+    if (it != mTextureSlots.end() && it->second.imageView == imageView)
+    {
+        return it->second.index;
+    }
+    uint32_t index;
+    if (!mFreeTextureSlots.empty())
+    {
+        index = mFreeTextureSlots.back();
+        mFreeTextureSlots.pop_back();
+    }
+    else if (mTextureSlotCount < mTextureCapacity)
+    {
+        index = mTextureSlotCount++;
+    }
+    else
+    {
+        LogError("Bindless texture array is full ({} textures)", mTextureCapacity);
+        throw std::runtime_error("Bindless texture array is full");
+    }
+    // 例如流式加载替换了image，in-flight帧仍通过旧索引读取旧image view
+    if (it != mTextureSlots.end())
+    {
+        RetireTextureSlot(it->second.index);
+    }
+    mTextureSlots[id] = {index, imageView};
+    vk::DescriptorImageInfo imageInfo;
+    imageInfo.setImageView(imageView).setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+    vk::WriteDescriptorSet writeDescriptorSet;
+    writeDescriptorSet.setDstSet(mDescriptorSet)
+        .setDstBinding(1)
+        .setDstArrayElement(index)
+        .setDescriptorType(vk::DescriptorType::eSampledImage)
+        .setImageInfo(imageInfo);
+    mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSet, {});
+    return index;
+}
+void BindlessManager::ReleaseTexture(const UUID &id)
+{
+    if (auto it = mTextureSlots.find(id); it != mTextureSlots.end())
+    {
+        RetireTextureSlot(it->second.index);
+        mTextureSlots.erase(it);
+    }
+}
+void BindlessManager::RetireTextureSlot(uint32_t index)
+{
+    mVulkanContext->GetDeletionQueue().Push([manager = weak_from_this(), index]() {
+        if (auto self = manager.lock())
+        {
+            self->mFreeTextureSlots.push_back(index);
+        }
+    });
+}
+uint32_t BindlessManager::WriteSampler(vk::Sampler sampler)
+{
+    auto handle = static_cast<VkSampler>(sampler);
+    if (auto it = mSamplerSlots.find(handle); it != mSamplerSlots.end())
+    {
+        return it->second;
+    }
+    if (mSamplerSlots.size() >= mSamplerCapacity)
+    {
+        LogError("Bindless sampler array is full ({} samplers)", mSamplerCapacity);
+        throw std::runtime_error("Bindless sampler array is full");
+    }
+    auto index = static_cast<uint32_t>(mSamplerSlots.size());
+    mSamplerSlots[handle] = index;
+    vk::DescriptorImageInfo imageInfo;
+    imageInfo.setSampler(sampler);
+    vk::WriteDescriptorSet writeDescriptorSet;
+    writeDescriptorSet.setDstSet(mDescriptorSet)
+        .setDstBinding(2)
+        .setDstArrayElement(index)
+        .setDescriptorType(vk::DescriptorType::eSampler)
+        .setImageInfo(imageInfo);
+    mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSet, {});
+    return index;
+}
+uint32_t BindlessManager::AllocateMaterial()
+{
+    if (!mFreeMaterialSlots.empty())
+    {
+        auto index = mFreeMaterialSlots.back();
+        mFreeMaterialSlots.pop_back();
+        return index;
+    }
+    if (mMaterialSlotCount >= MaxMaterials)
+    {
+        LogError("Bindless material buffer is full ({} materials)", MaxMaterials);
+        throw std::runtime_error("Bindless material buffer is full");
+    }
+    return mMaterialSlotCount++;
+}
+void BindlessManager::WriteMaterial(uint32_t index, const BindlessMaterialData &data)
+{
+    auto *materials = static_cast<BindlessMaterialData *>(mMaterialBufferAllocationInfo.pMappedData);
+    std::memcpy(&materials[index], &data, sizeof(BindlessMaterialData));
+    vmaFlushAllocation(mVulkanContext->GetVmaAllocator(), mMaterialBufferAllocation,
+                       sizeof(BindlessMaterialData) * index, sizeof(BindlessMaterialData));
+}
+void BindlessManager::ReleaseMaterial(uint32_t index)
+{
+    if (index == InvalidIndex)
+    {
+        return;
+    }
+    mVulkanContext->GetDeletionQueue().Push([manager = weak_from_this(), index]() {
+        if (auto self = manager.lock())
+        {
+            self->mFreeMaterialSlots.push_back(index);
+        }
+    });
+}
+} // namespace MEngine::Core::Manager
@@ -44,18 +44,37 @@ std::shared_ptr<MMesh> MMeshManager::Create(const std::string &name, const std::
 }
 void MMeshManager::CreateVulkanResources(std::shared_ptr<MMesh> mesh)
 {
+    // 反序列化后顶点可能已变化
+    mesh->UpdateBounds();
+    mesh->UpdatePositions();
+    // 旧buffer可能还被in-flight的帧引用
+    auto &deletionQueue = mVulkanContext->GetDeletionQueue();
+    auto allocator = mVulkanContext->GetVmaAllocator();
     if (mesh->mVertexBuffer)
     {
-        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mesh->mVertexBuffer, mesh->mVertexBufferAllocation);
+        deletionQueue.PushBuffer(allocator, mesh->mVertexBuffer, mesh->mVertexBufferAllocation);
     }
     if (mesh->mIndexBuffer)
     {
-        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mesh->mIndexBuffer, mesh->mIndexBufferAllocation);
+        deletionQueue.PushBuffer(allocator, mesh->mIndexBuffer, mesh->mIndexBufferAllocation);
     }
+    if (mesh->mPositionBuffer)
+    {
+        deletionQueue.PushBuffer(allocator, mesh->mPositionBuffer, mesh->mPositionBufferAllocation);
+    }
+    // 独立的transfer队列写入、graphics队列读取，buffer使用concurrent模式省去所有权转移
+    auto &queueFamilyIndicates = mVulkanContext->GetQueueFamilyIndicates();
+    std::vector<uint32_t> queueFamilies;
+    if (mVulkanContext->IsDedicatedTransferSupported())
+    {
+        queueFamilies = {queueFamilyIndicates.graphicsFamily.value(), queueFamilyIndicates.transferFamily.value()};
+    }
+    auto sharingMode = queueFamilies.empty() ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent;
     vk::BufferCreateInfo vertexBufferCreateInfo{};
     vertexBufferCreateInfo.setSize(mesh->mVertices.size() * sizeof(Vertex))
         .setUsage(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst)
-        .setSharingMode(vk::SharingMode::eExclusive);
+        .setSharingMode(sharingMode)
+        .setQueueFamilyIndices(queueFamilies);
     VmaAllocationCreateInfo vertexBufferAllocationCreateInfo{};
     vertexBufferAllocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
     if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(vertexBufferCreateInfo),
@@ -68,7 +87,8 @@ void MMeshManager::CreateVulkanResources(std::shared_ptr<MMesh> mesh)
     vk::BufferCreateInfo indexBufferCreateInfo{};
     indexBufferCreateInfo.setSize(mesh->mIndices.size() * sizeof(uint32_t))
         .setUsage(vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst)
-        .setSharingMode(vk::SharingMode::eExclusive);
+        .setSharingMode(sharingMode)
+        .setQueueFamilyIndices(queueFamilies);
     VmaAllocationCreateInfo indexBufferAllocationCreateInfo{};
     indexBufferAllocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
     if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(indexBufferCreateInfo),
@@ -78,6 +98,20 @@ void MMeshManager::CreateVulkanResources(std::shared_ptr<MMesh> mesh)
         LogError("Failed to create index buffer for mesh");
         throw std::runtime_error("Failed to create index buffer for mesh");
     }
+    vk::BufferCreateInfo positionBufferCreateInfo{};
+    positionBufferCreateInfo.setSize(mesh->mVertices.size() * sizeof(glm::vec3))
+        .setUsage(vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst)
+        .setSharingMode(sharingMode)
+        .setQueueFamilyIndices(queueFamilies);
+    VmaAllocationCreateInfo positionBufferAllocationCreateInfo{};
+    positionBufferAllocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(positionBufferCreateInfo),
+                        &positionBufferAllocationCreateInfo, reinterpret_cast<VkBuffer *>(&mesh->mPositionBuffer),
+                        &mesh->mPositionBufferAllocation, &mesh->mPositionBufferAllocationInfo) != VK_SUCCESS)
+    {
+        LogError("Failed to create position buffer for mesh");
+        throw std::runtime_error("Failed to create position buffer for mesh");
+    }
 }
 void MMeshManager::Update(std::shared_ptr<MMesh> mesh)
 {
@@ -133,6 +167,9 @@ void MMeshManager::Write(std::shared_ptr<MMesh> mesh)
     // index Staging buffer
     WriteBuffer(mesh->GetIndexBuffer(), const_cast<uint32_t *>(mesh->mIndices.data()),
                 static_cast<uint32_t>(mesh->mIndices.size() * sizeof(uint32_t)));
+    // position Staging buffer
+    WriteBuffer(mesh->GetPositionBuffer(), const_cast<glm::vec3 *>(mesh->mPositions.data()),
+                static_cast<uint32_t>(mesh->mPositions.size() * sizeof(glm::vec3)));
 }
 void MMeshManager::CreateDefault()
 {
@@ -2,6 +2,7 @@
 #include "MPBRMaterial.hpp"
 #include "MPipeline.hpp"
 #include "VMA.hpp"
+#include <array>
 #include <cstring>
 #include <memory>
 #include <vector>
@@ -30,17 +31,29 @@ void MPBRMaterialManager::Update(std::shared_ptr<MPBRMaterial> pbrMaterial)
 }
 void MPBRMaterialManager::CreateVulkanResources(std::shared_ptr<MPBRMaterial> pbrMaterial)
 {
-    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
-    auto descriptorSetLayouts =
-        std::vector<vk::DescriptorSetLayout>{pbrMaterial->GetPipeline()->GetMaterialDescriptorSetLayout()};
-    descriptorSetAllocateInfo.setDescriptorPool(mVulkanContext->GetDescriptorPool())
-        .setDescriptorSetCount(1)
-        .setSetLayouts(descriptorSetLayouts);
-    auto descriptorSets = mVulkanContext->GetDevice().allocateDescriptorSetsUnique(descriptorSetAllocateInfo);
-    if (!descriptorSets.empty())
+    // bindless管线只需要在全局材质buffer中占一个位置
+    if (pbrMaterial->GetPipeline()->GetSetting().Bindless)
     {
-        pbrMaterial->mMaterialDescriptorSet = std::move(descriptorSets[0]);
+        // 重建时换一个新位置，旧位置可能还被in-flight的帧读取，由ReleaseMaterial延迟释放
+        mBindlessManager->ReleaseMaterial(pbrMaterial->mBindlessIndex);
+        pbrMaterial->mBindlessIndex = mBindlessManager->AllocateMaterial();
+        return;
     }
+    // 重建时旧资源可能还被in-flight的帧引用
+    auto &deletionQueue = mVulkanContext->GetDeletionQueue();
+    if (pbrMaterial->mMaterialDescriptorSet)
+    {
+        deletionQueue.Push(
+            [descriptorSet = std::move(pbrMaterial->mMaterialDescriptorSet)]() mutable { descriptorSet.reset(); });
+    }
+    if (pbrMaterial->mParamsUBO)
+    {
+        deletionQueue.PushBuffer(mVulkanContext->GetVmaAllocator(), pbrMaterial->mParamsUBO,
+                                 pbrMaterial->mParamsUBOAllocation);
+        pbrMaterial->mParamsUBO = nullptr;
+    }
+    pbrMaterial->mMaterialDescriptorSet =
+        mDescriptorAllocator->Allocate(pbrMaterial->GetPipeline()->GetMaterialDescriptorSetLayout());
     vk::BufferCreateInfo paramsBufferCreateInfo{};
     paramsBufferCreateInfo.setSize(sizeof(MPBRMaterialProperties))
         .setUsage(vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst)
@@ -58,6 +71,11 @@ void MPBRMaterialManager::CreateVulkanResources(std::shared_ptr<MPBRMaterial> pb
 }
 void MPBRMaterialManager::Write(std::shared_ptr<MPBRMaterial> material)
 {
+    if (material->mPipeline->GetSetting().Bindless)
+    {
+        WriteBindless(material);
+        return;
+    }
     // 写入材质参数
     memcpy(material->mParamsUBOAllocationInfo.pMappedData, &material->mProperties, sizeof(MPBRMaterialProperties));
 
@@ -118,6 +136,33 @@ void MPBRMaterialManager::Write(std::shared_ptr<MPBRMaterial> material)
         .setDescriptorCount(1);
     mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSets, {});
 }
+void MPBRMaterialManager::WriteBindless(std::shared_ptr<MPBRMaterial> material)
+{
+    // 纹理按UUID占用slot，image view变化时(例如流式加载替换了image)换新slot
+    BindlessMaterialData data{};
+    data.properties = material->mProperties;
+    auto &textures = material->GetTextures();
+    std::array<std::shared_ptr<MTexture>, 4> slots{textures.Albedo, textures.Normal, textures.ARM, textures.Emissive};
+    for (glm::length_t i = 0; i < static_cast<glm::length_t>(slots.size()); ++i)
+    {
+        if (!slots[i])
+        {
+            slots[i] = mTextureManager->GetDefaultTexture(DefaultTextureType::Magenta);
+        }
+        data.textureIndices[i] = mBindlessManager->WriteTexture(slots[i]->GetID(), slots[i]->GetImageView());
+        data.samplerIndices[i] = mBindlessManager->WriteSampler(slots[i]->GetSampler());
+    }
+    mBindlessManager->WriteMaterial(material->mBindlessIndex, data);
+}
+void MPBRMaterialManager::Remove(const UUID &id)
+{
+    if (auto material = Get(id))
+    {
+        mBindlessManager->ReleaseMaterial(material->mBindlessIndex);
+        material->mBindlessIndex = BindlessManager::InvalidIndex;
+    }
+    MMaterialManager<MPBRMaterial>::Remove(id);
+}
 
 void MPBRMaterialManager::CreateDefault()
 {
@@ -14,12 +14,14 @@ namespace MEngine::Core::Manager
 
 MPipelineManager::MPipelineManager(std::shared_ptr<VulkanContext> vulkanContext,
                                    std::shared_ptr<IUUIDGenerator> uuidGenerator,
-                                   std::shared_ptr<RenderPassManager> renderPassManager)
-    : MManager(vulkanContext, uuidGenerator), mRenderPassManager(renderPassManager)
+                                   std::shared_ptr<RenderPassManager> renderPassManager,
+                                   std::shared_ptr<BindlessManager> bindlessManager)
+    : MManager(vulkanContext, uuidGenerator), mRenderPassManager(renderPassManager),
+      mBindlessManager(bindlessManager)
 {
+    // 含dynamic uniform buffer，不能带eUpdateAfterBindPool；全局描述符集只在初始化时写入一次，不需要绑定后更新
     vk::DescriptorSetLayoutCreateInfo globalDescriptorSetLayoutCreateInfo;
-    globalDescriptorSetLayoutCreateInfo.setBindings(mGlobalDescriptorSetLayoutBindings)
-        .setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+    globalDescriptorSetLayoutCreateInfo.setBindings(mGlobalDescriptorSetLayoutBindings);
     auto globalDescriptorSetLayout =
         mVulkanContext->GetDevice().createDescriptorSetLayoutUnique(globalDescriptorSetLayoutCreateInfo);
     if (!globalDescriptorSetLayout)
@@ -41,11 +43,27 @@ std::shared_ptr<MPipeline> MPipelineManager::Create(const std::string &name, con
 }
 void MPipelineManager::CreateVulkanResources(std::shared_ptr<MPipeline> pipeline)
 {
+    if (pipeline->IsCompute())
+    {
+        CreateComputeVulkanResources(pipeline);
+        return;
+    }
+    if (pipeline->mSetting.Bindless && !mBindlessManager->IsEnabled())
+    {
+        LogWarn("Pipeline {} requests bindless descriptors which are not supported, fall back to descriptor sets",
+                pipeline->GetName());
+        pipeline->mSetting.Bindless = false;
+    }
+    std::vector<std::string> macros;
+    if (pipeline->mSetting.Bindless)
+    {
+        macros.push_back("MENGINE_BINDLESS");
+    }
     // 创建着色器模块
     // vertex shader
-    pipeline->mVertexShaderModule = CreateShaderModule(pipeline->GetSetting().VertexShaderPath);
+    pipeline->mVertexShaderModule = CreateShaderModule(pipeline->GetSetting().VertexShaderPath, macros);
     // fragment shader
-    pipeline->mFragmentShaderModule = CreateShaderModule(pipeline->mSetting.FragmentShaderPath);
+    pipeline->mFragmentShaderModule = CreateShaderModule(pipeline->mSetting.FragmentShaderPath, macros);
     LogDebug("Shader modules created successfully: {} and {}", pipeline->mSetting.VertexShaderPath.string(),
              pipeline->mSetting.FragmentShaderPath.string());
     // 创建pipeline layout
@@ -62,10 +80,12 @@ void MPipelineManager::CreateVulkanResources(std::shared_ptr<MPipeline> pipeline
     pipeline->mMaterialDescriptorSetLayouts = std::move(materialDescriptorSetLayout);
 
     vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
-    auto descriptorSetLayouts = std::vector<vk::DescriptorSetLayout>{mGlobalDescriptorSetLayout.get(),
-                                                                     pipeline->GetMaterialDescriptorSetLayout()};
+    // bindless管线的set:1为全局bindless集，push constant在modelMatrix后追加材质索引
+    auto descriptorSetLayouts = std::vector<vk::DescriptorSetLayout>{
+        mGlobalDescriptorSetLayout.get(), pipeline->mSetting.Bindless ? mBindlessManager->GetDescriptorSetLayout()
+                                                                      : pipeline->GetMaterialDescriptorSetLayout()};
     vk::PushConstantRange pushConstantRange;
-    pushConstantRange.setSize(sizeof(glm::mat4))
+    pushConstantRange.setSize(pipeline->mSetting.Bindless ? sizeof(glm::mat4) + sizeof(uint32_t) : sizeof(glm::mat4))
         .setOffset(0)
         .setStageFlags(vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment);
     pipelineLayoutCreateInfo.setSetLayouts(descriptorSetLayouts).setPushConstantRanges(pushConstantRange);
@@ -83,6 +103,11 @@ void MPipelineManager::CreateVulkanResources(std::shared_ptr<MPipeline> pipeline
     auto vertexInputAttributeDescriptions = Vertex::GetVertexInputAttributeDescription();
     auto vertexAttributeDescriptions = std::vector<vk::VertexInputAttributeDescription>(
         vertexInputAttributeDescriptions.begin(), vertexInputAttributeDescriptions.end());
+    if (pipeline->mSetting.PositionOnly)
+    {
+        vertexBindingDescription = Vertex::GetPositionInputBindingDescription();
+        vertexAttributeDescriptions = {Vertex::GetPositionInputAttributeDescription()};
+    }
     vk::PipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.setVertexBindingDescriptions(vertexBindingDescription)
         .setVertexAttributeDescriptions(vertexAttributeDescriptions);
@@ -112,7 +137,9 @@ void MPipelineManager::CreateVulkanResources(std::shared_ptr<MPipeline> pipeline
         .setLineWidth(pipeline->mSetting.LineWidth)
         .setCullMode(pipeline->mSetting.CullMode)
         .setFrontFace(pipeline->mSetting.FrontFace)
-        .setDepthBiasEnable(pipeline->mSetting.DepthBiasEnable);
+        .setDepthBiasEnable(pipeline->mSetting.DepthBiasEnable)
+        .setDepthBiasConstantFactor(pipeline->mSetting.DepthBiasConstantFactor)
+        .setDepthBiasSlopeFactor(pipeline->mSetting.DepthBiasSlopeFactor);
     // ========= 6. 多重采样 ==========
     vk::PipelineMultisampleStateCreateInfo multisampleInfo{};
     multisampleInfo.setSampleShadingEnable(pipeline->mSetting.MultisamplingEnable)
@@ -165,13 +192,75 @@ void MPipelineManager::CreateVulkanResources(std::shared_ptr<MPipeline> pipeline
         LogError("Failed to create Forward Forward Opaque PBR pipeline");
     }
     pipeline->mPipeline = std::move(pipelineResult.value);
+    if (pipeline->mSetting.DepthEqualVariant)
+    {
+        // 深度已由预渲染写入，只着色深度相等的片元
+        depthStencilInfo.setDepthCompareOp(vk::CompareOp::eEqual).setDepthWriteEnable(vk::False);
+        auto depthEqualPipelineResult =
+            mVulkanContext->GetDevice().createGraphicsPipelineUnique(vk::PipelineCache(), pipelineInfo, nullptr);
+        if (depthEqualPipelineResult.result != vk::Result::eSuccess)
+        {
+            LogError("Failed to create depth equal variant of pipeline {}", pipeline->GetName());
+        }
+        pipeline->mDepthEqualPipeline = std::move(depthEqualPipelineResult.value);
+    }
+}
+void MPipelineManager::CreateComputeVulkanResources(std::shared_ptr<MPipeline> pipeline)
+{
+    pipeline->mComputeShaderModule = CreateShaderModule(pipeline->mSetting.ComputeShaderPath);
+    LogDebug("Compute shader module created successfully: {}", pipeline->mSetting.ComputeShaderPath.string());
+    vk::DescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo;
+    descriptorSetLayoutCreateInfo.setBindings(pipeline->mSetting.MaterialDescriptorSetLayoutBindings);
+    auto descriptorSetLayout =
+        mVulkanContext->GetDevice().createDescriptorSetLayoutUnique(descriptorSetLayoutCreateInfo);
+    if (!descriptorSetLayout)
+    {
+        LogError("Failed to create compute descriptor set layout");
+        throw std::runtime_error("Failed to create compute descriptor set layout");
+    }
+    pipeline->mMaterialDescriptorSetLayouts = std::move(descriptorSetLayout);
+    // compute管线不使用全局描述符集，set:0即为自身的描述符集
+    auto descriptorSetLayouts = std::vector<vk::DescriptorSetLayout>{pipeline->GetMaterialDescriptorSetLayout()};
+    vk::PushConstantRange pushConstantRange;
+    pushConstantRange.setSize(pipeline->mSetting.PushConstantSize)
+        .setOffset(0)
+        .setStageFlags(vk::ShaderStageFlagBits::eCompute);
+    vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+    pipelineLayoutCreateInfo.setSetLayouts(descriptorSetLayouts);
+    if (pipeline->mSetting.PushConstantSize > 0)
+    {
+        pipelineLayoutCreateInfo.setPushConstantRanges(pushConstantRange);
+    }
+    auto pipelineLayout = mVulkanContext->GetDevice().createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+    if (!pipelineLayout)
+    {
+        LogError("Failed to create compute pipeline layout");
+        throw std::runtime_error("Failed to create compute pipeline layout");
+    }
+    pipeline->mPipelineLayout = std::move(pipelineLayout);
+    vk::ComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo
+        .setStage(vk::PipelineShaderStageCreateInfo()
+                      .setStage(vk::ShaderStageFlagBits::eCompute)
+                      .setModule(pipeline->GetComputeShaderModule())
+                      .setPName("main"))
+        .setLayout(pipeline->mPipelineLayout.get());
+    auto pipelineResult =
+        mVulkanContext->GetDevice().createComputePipelineUnique(vk::PipelineCache(), pipelineInfo, nullptr);
+    if (pipelineResult.result != vk::Result::eSuccess)
+    {
+        LogError("Failed to create compute pipeline {}", pipeline->GetName());
+        throw std::runtime_error("Failed to create compute pipeline");
+    }
+    pipeline->mPipeline = std::move(pipelineResult.value);
 }
 void MPipelineManager::Update(std::shared_ptr<MPipeline> pipeline)
 {
     mAssets[pipeline->GetID()] = pipeline;
     mPipelines[pipeline->GetName()] = pipeline;
 }
-vk::UniqueShaderModule MPipelineManager::CreateShaderModule(const std::filesystem::path &shaderPath) const
+vk::UniqueShaderModule MPipelineManager::CreateShaderModule(const std::filesystem::path &shaderPath,
+                                                            const std::vector<std::string> &macros) const
 
 {
     if (!std::filesystem::exists(shaderPath))
@@ -191,7 +280,7 @@ vk::UniqueShaderModule MPipelineManager::CreateShaderModule(const std::filesyste
     shaderStream << shaderFile.rdbuf();
     std::string shaderCode = shaderStream.str();
     auto kind = Utils::ShaderUtils::GetShaderKindFromExtension(extension.string());
-    auto result = Utils::ShaderUtils::CompileShader(shaderCode, kind, shaderPath.string());
+    auto result = Utils::ShaderUtils::CompileShader(shaderCode, kind, shaderPath.string(), macros);
     std::vector<uint32_t> spirv(result.cbegin(), result.cend());
     vk::ShaderModuleCreateInfo shaderModuleCreateInfo;
     shaderModuleCreateInfo.setCode(spirv);
@@ -261,8 +350,22 @@ void MPipelineManager::CreateDefault()
     pbrSetting.FragmentShaderPath = "Engine/Shaders/ForwardOpaquePBR.frag";
     pbrSetting.RenderPassType = RenderPassType::ForwardComposition;
     pbrSetting.MaterialDescriptorSetLayoutBindings = PBRDescriptorSetLayoutBindings;
+    pbrSetting.Bindless = mBindlessManager->IsEnabled();
+    pbrSetting.DepthEqualVariant = true;
     auto pbrPipeline = Create(PipelineType::ForwardOpaquePBR, pbrSetting);
     CreateVulkanResources(pbrPipeline);
+    // DepthPrepass: 只写深度，与ForwardOpaquePBR使用相同的顶点变换
+    auto depthPrepassSetting = MPipelineSetting{};
+    depthPrepassSetting.VertexShaderPath = "Engine/Shaders/DepthPrepass.vert";
+    depthPrepassSetting.FragmentShaderPath = "Engine/Shaders/DepthPrepass.frag";
+    depthPrepassSetting.RenderPassType = RenderPassType::ForwardComposition;
+    depthPrepassSetting.PositionOnly = true;
+    depthPrepassSetting.DepthCompareOp = vk::CompareOp::eLess;
+    depthPrepassSetting.colorBlendAttachments = {
+        vk::PipelineColorBlendAttachmentState().setBlendEnable(false).setColorWriteMask({})};
+    depthPrepassSetting.MaterialDescriptorSetLayoutBindings = {};
+    auto depthPrepassPipeline = Create(PipelineType::DepthPrepass, depthPrepassSetting);
+    CreateVulkanResources(depthPrepassPipeline);
     // Sky
     PBRDescriptorSetLayoutBindings = {
         // Binding: 0 Environment Map
@@ -321,6 +424,7 @@ void MPipelineManager::CreateDefault()
     gBufferSetting.RenderPassType = RenderPassType::GBuffer;
     gBufferSetting.MaterialDescriptorSetLayoutBindings = GBufferDescriptorSetLayoutBindings;
     gBufferSetting.colorBlendAttachments = colorBlendAttachments;
+    gBufferSetting.Bindless = mBindlessManager->IsEnabled();
     auto gBufferPipeline = Create(PipelineType::GBuffer, gBufferSetting);
     CreateVulkanResources(gBufferPipeline);
     // Lighting
@@ -342,6 +446,85 @@ void MPipelineManager::CreateDefault()
     lightingSetting.MaterialDescriptorSetLayoutBindings = LightingDescriptorSetLayoutBindings;
     auto lightingPipeline = Create(PipelineType::Lighting, lightingSetting);
     CreateVulkanResources(lightingPipeline);
+    // HiZBuild: 从深度缓冲逐级取最大值生成Hi-Z金字塔，每个dispatch写一级
+    auto hiZBuildSetting = MPipelineSetting{};
+    hiZBuildSetting.ComputeShaderPath = "Engine/Shaders/HiZBuild.comp";
+    hiZBuildSetting.MaterialDescriptorSetLayoutBindings = {
+        // Binding: 0 Depth
+        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 1 上一级
+        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 2 当前级
+        vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute},
+    };
+    hiZBuildSetting.PushConstantSize = sizeof(int32_t) * 6 + sizeof(uint32_t); // srcSize, dstSize, validSize, level
+    auto hiZBuildPipeline = Create(PipelineType::HiZBuild, hiZBuildSetting);
+    CreateVulkanResources(hiZBuildPipeline);
+    // HiZCull: 用Hi-Z测试包围盒，把可见性写入indirect draw命令的instanceCount
+    auto hiZCullSetting = MPipelineSetting{};
+    hiZCullSetting.ComputeShaderPath = "Engine/Shaders/HiZCull.comp";
+    hiZCullSetting.MaterialDescriptorSetLayoutBindings = {
+        // Binding: 0 Hi-Z
+        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 1 包围盒和模型矩阵
+        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 2 indirect draw命令
+        vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+    };
+    // viewProjection, viewportSize, drawCount, phase, levelCount, hiZValid
+    hiZCullSetting.PushConstantSize = sizeof(glm::mat4) + sizeof(glm::vec2) + sizeof(uint32_t) * 4;
+    auto hiZCullPipeline = Create(PipelineType::HiZCull, hiZCullSetting);
+    CreateVulkanResources(hiZCullPipeline);
+    // TiledLighting: 按16x16 tile的深度范围剔除光源后计算延迟光照，结果写回color
+    auto tiledLightingSetting = MPipelineSetting{};
+    tiledLightingSetting.ComputeShaderPath = "Engine/Shaders/TiledLighting.comp";
+    tiledLightingSetting.MaterialDescriptorSetLayoutBindings = {
+        // Binding: 0 Depth
+        vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 1 Normal Map
+        vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 2 ARM
+        vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 3 Position Map
+        vk::DescriptorSetLayoutBinding{3, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 4 Color，读取albedo并写入光照结果
+        vk::DescriptorSetLayoutBinding{4, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 5 相机
+        vk::DescriptorSetLayoutBinding{5, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 6 光源
+        vk::DescriptorSetLayoutBinding{6, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 7-9 环境贴图、辐照度贴图、BRDF LUT
+        vk::DescriptorSetLayoutBinding{7, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eCompute},
+        vk::DescriptorSetLayoutBinding{8, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eCompute},
+        vk::DescriptorSetLayoutBinding{9, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eCompute},
+        // Binding: 10 统计
+        vk::DescriptorSetLayoutBinding{10, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 11 级联阴影参数
+        vk::DescriptorSetLayoutBinding{11, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        // Binding: 12 阴影atlas
+        vk::DescriptorSetLayoutBinding{12, vk::DescriptorType::eCombinedImageSampler, 1,
+                                       vk::ShaderStageFlagBits::eCompute},
+    };
+    tiledLightingSetting.PushConstantSize = sizeof(glm::uvec2); // viewportSize
+    auto tiledLightingPipeline = Create(PipelineType::TiledLighting, tiledLightingSetting);
+    CreateVulkanResources(tiledLightingPipeline);
+    // ShadowDepth: 级联阴影只写深度，push constant为级联viewProjection与modelMatrix的乘积
+    auto shadowDepthSetting = MPipelineSetting{};
+    shadowDepthSetting.VertexShaderPath = "Engine/Shaders/ShadowDepth.vert";
+    shadowDepthSetting.FragmentShaderPath = "Engine/Shaders/ShadowDepth.frag";
+    shadowDepthSetting.RenderPassType = RenderPassType::ShadowDepth;
+    shadowDepthSetting.PositionOnly = true;
+    shadowDepthSetting.CullMode = vk::CullModeFlagBits::eNone;
+    shadowDepthSetting.DepthBiasEnable = true;
+    shadowDepthSetting.DepthBiasConstantFactor = 1.25f;
+    shadowDepthSetting.DepthBiasSlopeFactor = 1.75f;
+    shadowDepthSetting.colorBlendAttachments = {};
+    shadowDepthSetting.MaterialDescriptorSetLayoutBindings = {};
+    auto shadowDepthPipeline = Create(PipelineType::ShadowDepth, shadowDepthSetting);
+    CreateVulkanResources(shadowDepthPipeline);
 }
 
 } // namespace MEngine::Core::Manager
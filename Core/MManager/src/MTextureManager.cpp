@@ -1,14 +1,14 @@
 #include "MTextureManager.hpp"
 #include "IMTextureManager.hpp"
-#include "ImageUtil.hpp"
 #include "Logger.hpp"
 #include "MTexture.hpp"
+#include "MipmapGenerator.hpp"
+#include "ImageUtil.hpp"
 #include "VulkanContext.hpp"
 #include <cstdint>
 #include <imgui_impl_vulkan.h>
-#include <ktx.h>
-#include <ktxvulkan.h>
 #include <memory>
+#include <ranges>
 #include <vulkan/vulkan_enums.hpp>
 
 namespace MEngine::Core::Manager
@@ -40,7 +40,12 @@ vk::ImageUsageFlags MTextureManager::PickImageUsage(const MTextureSetting &setti
     vk::ImageUsageFlags ret = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
 
     if (setting.isShaderResource)
-        ret |= vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eInputAttachment;
+    {
+        ret |= vk::ImageUsageFlagBits::eSampled;
+        // 共享指数格式不能作为attachment，也就不能作为input attachment
+        if (setting.format != vk::Format::eE5B9G9R9UfloatPack32)
+            ret |= vk::ImageUsageFlagBits::eInputAttachment;
+    }
 
     if (setting.isRenderTarget)
     {
@@ -145,6 +150,10 @@ std::pair<uint32_t, uint32_t> MTextureManager::PickPixelSize(vk::Format format)
     case vk::Format::eR32Sfloat:
         return {1, 4};
 
+    case vk::Format::eE5B9G9R9UfloatPack32:
+    case vk::Format::eB10G11R11UfloatPack32:
+        return {3, 4};
+
     case vk::Format::eR32G32Uint:
     case vk::Format::eR32G32Sint:
     case vk::Format::eR32G32Sfloat:
@@ -199,30 +208,68 @@ vk::ImageAspectFlags MTextureManager::GuessImageAspectFlags(vk::Format format)
     }
 }
 MTextureManager::MTextureManager(std::shared_ptr<VulkanContext> vulkanContext,
-                                 std::shared_ptr<IUUIDGenerator> uuidGenerator)
-    : MManager(vulkanContext, uuidGenerator)
+                                 std::shared_ptr<IUUIDGenerator> uuidGenerator,
+                                 std::shared_ptr<BindlessManager> bindlessManager)
+    : MManager(vulkanContext, uuidGenerator), mBindlessManager(bindlessManager)
+{
+    CreateDefault();
+}
+MTextureManager::~MTextureManager()
+{
+    CollectUploads(0);
+}
+MTextureManager::Upload MTextureManager::AcquireUpload()
 {
-    // 创建命令缓冲区
-    auto device = vulkanContext->GetDevice();
+    if (!mFreeUploads.empty())
+    {
+        auto upload = std::move(mFreeUploads.back());
+        mFreeUploads.pop_back();
+        return upload;
+    }
+    auto device = mVulkanContext->GetDevice();
+    Upload upload;
     vk::CommandBufferAllocateInfo commandBufferAllocateInfo{};
-    commandBufferAllocateInfo.setCommandPool(vulkanContext->GetTransferCommandPool())
+    commandBufferAllocateInfo.setCommandPool(mVulkanContext->GetTransferCommandPool())
         .setLevel(vk::CommandBufferLevel::ePrimary)
         .setCommandBufferCount(1);
-    mCommandBuffer = std::move(device.allocateCommandBuffersUnique(commandBufferAllocateInfo)[0]);
-    if (!mCommandBuffer)
+    upload.transferCommandBuffer = std::move(device.allocateCommandBuffersUnique(commandBufferAllocateInfo)[0]);
+    if (mVulkanContext->IsDedicatedTransferSupported())
     {
-        LogError("Failed to create command buffer for MTextureManager");
-        throw std::runtime_error("Failed to create command buffer for MTextureManager");
+        commandBufferAllocateInfo.setCommandPool(mVulkanContext->GetGraphicsCommandPool());
+        upload.graphicsCommandBuffer = std::move(device.allocateCommandBuffersUnique(commandBufferAllocateInfo)[0]);
+        upload.semaphore = device.createSemaphoreUnique({});
     }
-    // 创建同步对象
-    vk::FenceCreateInfo fenceCreateInfo{};
-    mFence = device.createFenceUnique(fenceCreateInfo);
-    if (!mFence)
+    upload.fence = device.createFenceUnique({});
+    if (!upload.transferCommandBuffer || !upload.fence)
     {
-        LogError("Failed to create fence for MTextureManager");
-        throw std::runtime_error("Failed to create fence for MTextureManager");
+        LogError("Failed to create upload command buffer for MTextureManager");
+        throw std::runtime_error("Failed to create upload command buffer for MTextureManager");
+    }
+    return upload;
+}
+void MTextureManager::CollectUploads(uint32_t maxPending)
+{
+    auto device = mVulkanContext->GetDevice();
+    while (!mPendingUploads.empty())
+    {
+        auto &upload = mPendingUploads.front();
+        if (mPendingUploads.size() <= maxPending && device.getFenceStatus(upload.fence.get()) != vk::Result::eSuccess)
+        {
+            break;
+        }
+        auto result = device.waitForFences(upload.fence.get(), vk::True, 1000000000); // 1s
+        if (result != vk::Result::eSuccess)
+        {
+            LogError("Failed to wait for texture upload fence: {}", vk::to_string(result));
+            throw std::runtime_error("Failed to wait for fence");
+        }
+        device.resetFences(upload.fence.get());
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), upload.stagingBuffer, upload.stagingAllocation);
+        upload.stagingBuffer = nullptr;
+        upload.stagingAllocation = nullptr;
+        mFreeUploads.push_back(std::move(upload));
+        mPendingUploads.pop_front();
     }
-    CreateDefault();
 }
 std::shared_ptr<MTexture> MTextureManager::Create(const std::string &name, TextureSize size,
                                                   const std::vector<uint8_t> &imageData, const MTextureSetting &setting)
@@ -236,19 +283,107 @@ void MTextureManager::Update(std::shared_ptr<MTexture> texture)
     mAssets[texture->mID] = texture;
 }
 void MTextureManager::CreateVulkanResources(std::shared_ptr<MTexture> texture)
+{
+    // 流式纹理加载时只驻留低精度mip，高精度mip由UpdateStreaming按需上传
+    texture->mResidentMip = texture->IsStreamable() ? GetStreamingTailMip(*texture) : 0;
+    CreateImageResources(texture);
+}
+MTextureManager::SamplerKey MTextureManager::MakeSamplerKey(const MTextureSetting &setting, uint32_t imageMipLevels)
+{
+    // maxLod覆盖整个image view时与VK_LOD_CLAMP_NONE等价，归一化后不同mip数的纹理可共享sampler
+    auto maxLod = setting.maxLod >= static_cast<float>(imageMipLevels) ? VK_LOD_CLAMP_NONE : setting.maxLod;
+    return SamplerKey{
+        .addressModeU = setting.addressModeU,
+        .addressModeV = setting.addressModeV,
+        .addressModeW = setting.addressModeW,
+        .minFilter = setting.minFilter,
+        .magFilter = setting.magFilter,
+        .mipmapMode = setting.mipmapMode,
+        .mipLodBias = setting.mipLodBias,
+        .minLod = setting.minLod,
+        .maxLod = maxLod,
+        .borderColor = setting.borderColor,
+        .compareEnable = setting.compareEnable,
+        .compareOp = setting.compareOp,
+        .anisotropyEnable = setting.anisotropyEnable,
+        .maxAnisotropy = setting.anisotropyEnable ? setting.maxAnisotropy : 1.0f,
+        .unnormalizedCoordinates = setting.unnormalizedCoordinates,
+    };
+}
+std::size_t MTextureManager::SamplerKeyHash::operator()(const SamplerKey &key) const
+{
+    std::size_t hash = 14695981039346656037ULL; // FNV-1a
+    auto combine = [&hash](auto value) {
+        hash ^= std::hash<decltype(value)>{}(value);
+        hash *= 1099511628211ULL;
+    };
+    combine(key.addressModeU);
+    combine(key.addressModeV);
+    combine(key.addressModeW);
+    combine(key.minFilter);
+    combine(key.magFilter);
+    combine(key.mipmapMode);
+    combine(key.mipLodBias);
+    combine(key.minLod);
+    combine(key.maxLod);
+    combine(key.borderColor);
+    combine(key.compareEnable);
+    combine(key.compareOp);
+    combine(key.anisotropyEnable);
+    combine(key.maxAnisotropy);
+    combine(key.unnormalizedCoordinates);
+    return hash;
+}
+std::shared_ptr<vk::UniqueSampler> MTextureManager::GetOrCreateSampler(const SamplerKey &key)
+{
+    if (auto it = mSamplers.find(key); it != mSamplers.end())
+    {
+        return it->second;
+    }
+    vk::SamplerCreateInfo samplerCreateInfo{};
+    samplerCreateInfo.setAddressModeU(key.addressModeU)
+        .setAddressModeV(key.addressModeV)
+        .setAddressModeW(key.addressModeW)
+        .setMinFilter(key.minFilter)
+        .setMagFilter(key.magFilter)
+        .setMipmapMode(key.mipmapMode)
+        .setMipLodBias(key.mipLodBias)
+        .setMinLod(key.minLod)
+        .setMaxLod(key.maxLod)
+        .setBorderColor(key.borderColor)
+        .setUnnormalizedCoordinates(key.unnormalizedCoordinates)
+        .setCompareEnable(key.compareEnable)
+        .setCompareOp(key.compareOp)
+        .setAnisotropyEnable(key.anisotropyEnable)
+        .setMaxAnisotropy(key.maxAnisotropy);
+    auto sampler = mVulkanContext->GetDevice().createSamplerUnique(samplerCreateInfo);
+    if (!sampler)
+    {
+        LogError("Failed to create texture sampler");
+        throw std::runtime_error("Failed to create texture sampler");
+    }
+    auto shared = std::make_shared<vk::UniqueSampler>(std::move(sampler));
+    mSamplers.emplace(key, shared);
+    return shared;
+}
+void MTextureManager::CreateImageResources(std::shared_ptr<MTexture> texture)
 {
     if (texture->mImage)
     {
-        VkImage image = texture->mImage;
-        vmaDestroyImage(mVulkanContext->GetVmaAllocator(), image, texture->mAllocation);
+        RetireTexture(*texture);
     }
     vk::ImageCreateInfo imageCreateInfo{};
     texture->mSetting.mipmapLevels = std::min(
         static_cast<uint32_t>(std::floor(std::log2(std::max(texture->mSize.width, texture->mSize.height)))) + 1,
         texture->mSetting.mipmapLevels);
+    // 流式纹理只为驻留的mip分配显存，image的level 0对应完整mip链的mResidentMip
+    texture->mResidentMip =
+        texture->IsStreamable() ? std::min(texture->mResidentMip, texture->mSetting.mipmapLevels - 1) : 0;
+    auto imageMipLevels = texture->mSetting.mipmapLevels - texture->mResidentMip;
     imageCreateInfo.setImageType(TextureTypeToImageType(texture->mSetting.ImageType))
-        .setExtent({texture->mSize.width, texture->mSize.height, 1})
-        .setMipLevels(texture->mSetting.mipmapLevels)
+        .setExtent({std::max(1u, texture->mSize.width >> texture->mResidentMip),
+                    std::max(1u, texture->mSize.height >> texture->mResidentMip), 1})
+        .setMipLevels(imageMipLevels)
         .setArrayLayers(texture->mSetting.arrayLayers)
         .setFormat(texture->mSetting.format)
         .setInitialLayout(vk::ImageLayout::eUndefined)
@@ -270,27 +405,7 @@ void MTextureManager::CreateVulkanResources(std::shared_ptr<MTexture> texture)
         LogError("Failed to create Vulkan image");
         throw std::runtime_error("Failed to create Vulkan image");
     }
-    vk::SamplerCreateInfo samplerCreateInfo{};
-    samplerCreateInfo.setAddressModeU(texture->mSetting.addressModeU)
-        .setAddressModeV(texture->mSetting.addressModeV)
-        .setAddressModeW(texture->mSetting.addressModeW)
-        .setMinFilter(texture->mSetting.minFilter)
-        .setMagFilter(texture->mSetting.magFilter)
-        .setMipmapMode(texture->mSetting.mipmapMode)
-        .setMipLodBias(texture->mSetting.mipLodBias)
-        .setMinLod(texture->mSetting.minLod)
-        .setMaxLod(texture->mSetting.maxLod)
-        .setBorderColor(texture->mSetting.borderColor)
-        .setUnnormalizedCoordinates(texture->mSetting.unnormalizedCoordinates)
-        .setCompareEnable(texture->mSetting.compareEnable)
-        .setCompareOp(texture->mSetting.compareOp)
-        .setAnisotropyEnable(texture->mSetting.anisotropyEnable)
-        .setMaxAnisotropy(texture->mSetting.maxAnisotropy);
-    texture->mSampler = mVulkanContext->GetDevice().createSamplerUnique(samplerCreateInfo);
-    if (!texture->mSampler)
-    {
-        LogError("Failed to create texture sampler");
-    }
+    texture->mSampler = GetOrCreateSampler(MakeSamplerKey(texture->mSetting, imageMipLevels));
 
     vk::ImageViewCreateInfo imageViewCreateInfo{};
     imageViewCreateInfo.setImage(texture->mImage)
@@ -299,7 +414,7 @@ void MTextureManager::CreateVulkanResources(std::shared_ptr<MTexture> texture)
         .setSubresourceRange(vk::ImageSubresourceRange()
                                  .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
                                  .setBaseMipLevel(0)
-                                 .setLevelCount(texture->mSetting.mipmapLevels)
+                                 .setLevelCount(imageMipLevels)
                                  .setBaseArrayLayer(0)
                                  .setLayerCount(texture->mSetting.arrayLayers));
     texture->mImageView = mVulkanContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
@@ -310,12 +425,35 @@ void MTextureManager::CreateVulkanResources(std::shared_ptr<MTexture> texture)
 }
 void MTextureManager::Write(std::shared_ptr<MTexture> texture)
 {
-    mCommandBuffer->reset();
-    mVulkanContext->GetDevice().resetFences(mFence.get());
+    // 上传不等待完成，之后所有采样纹理的阶段都要等待布局转换：片元着色器和计算着色器(TiledLighting的IBL纹理)
+    constexpr vk::PipelineStageFlags SampledStages =
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader;
+    // 预烘焙的mip链直接逐级拷贝，否则只上传level 0并用blit生成
+    auto isMipmapBaked = texture->mSetting.isMipmapBaked && texture->mSetting.mipmapLevels > 1;
+    auto &mipLevels = GetMipLevels(*texture);
+    // 只上传驻留的mip
+    auto residentMip = isMipmapBaked ? texture->mResidentMip : 0;
+    auto imageMipLevels = texture->mSetting.mipmapLevels - residentMip;
+    auto dataOffset = mipLevels[residentMip].offset;
+    auto dataSize = mipLevels.back().offset + mipLevels.back().size;
+    if (texture->mImageData.size() < dataSize)
+    {
+        LogError("Texture {} image data size {} is smaller than expected {}", texture->mName,
+                 texture->mImageData.size(), dataSize);
+        throw std::runtime_error("Texture image data size mismatch");
+    }
+    auto stagingSize = dataSize - dataOffset;
+    CollectUploads(MaxPendingUploads - 1);
+    auto upload = AcquireUpload();
+    // 独立的transfer队列不支持blit，数据拷贝后由graphics队列获取所有权再生成mip
+    auto ownershipTransfer = mVulkanContext->IsDedicatedTransferSupported();
+    auto transferCommandBuffer = upload.transferCommandBuffer.get();
+    auto graphicsCommandBuffer = ownershipTransfer ? upload.graphicsCommandBuffer.get() : transferCommandBuffer;
+    auto &queueFamilyIndicates = mVulkanContext->GetQueueFamilyIndicates();
+    auto aspectMask = GuessImageAspectFlags(texture->mSetting.format);
     vk::Buffer stagingBuffer;
     vk::BufferCreateInfo stagingBufferCreateInfo{};
-    stagingBufferCreateInfo
-        .setSize(texture->mSize.width * texture->mSize.height * PickPixelSize(texture->mSetting.format).second)
+    stagingBufferCreateInfo.setSize(stagingSize)
         .setUsage(vk::BufferUsageFlagBits::eTransferSrc)
         .setSharingMode(vk::SharingMode::eExclusive);
 
@@ -330,127 +468,353 @@ void MTextureManager::Write(std::shared_ptr<MTexture> texture)
                         &stagingAllocationInfo) != VK_SUCCESS)
     {
         LogError("Failed to create staging buffer");
+        throw std::runtime_error("Failed to create staging buffer");
+    }
+    upload.stagingBuffer = stagingBuffer;
+    upload.stagingAllocation = stagingAllocation;
+    memcpy(stagingAllocationInfo.pMappedData, texture->mImageData.data() + dataOffset, stagingSize);
+    mStreamingStats.uploadedBytes += stagingSize;
+    transferCommandBuffer.reset();
+    transferCommandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+    // 转换图像布局UNDEFINED → TRANSFER_DST
+    vk::ImageMemoryBarrier imageBarrier{};
+    imageBarrier.setImage(texture->mImage)
+        .setOldLayout(vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eNone)
+        .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+        .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+        .setSubresourceRange(vk::ImageSubresourceRange()
+                                 .setAspectMask(aspectMask)
+                                 .setBaseMipLevel(0)
+                                 .setLevelCount(imageMipLevels)
+                                 .setBaseArrayLayer(0)
+                                 .setLayerCount(texture->mSetting.arrayLayers));
+    transferCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                          {}, {}, {}, {imageBarrier});
+    // 复制数据到图像
+    std::vector<vk::BufferImageCopy> bufferImageCopies;
+    for (uint32_t mipmapLevel = residentMip; mipmapLevel < mipLevels.size(); mipmapLevel++)
+    {
+        bufferImageCopies.push_back(
+            vk::BufferImageCopy()
+                .setBufferOffset(mipLevels[mipmapLevel].offset - dataOffset)
+                .setBufferRowLength(0)
+                .setBufferImageHeight(0)
+                .setImageSubresource(vk::ImageSubresourceLayers()
+                                         .setAspectMask(aspectMask)
+                                         .setMipLevel(mipmapLevel - residentMip)
+                                         .setBaseArrayLayer(0)
+                                         .setLayerCount(texture->mSetting.arrayLayers))
+                .setImageOffset({0, 0, 0})
+                .setImageExtent({mipLevels[mipmapLevel].width, mipLevels[mipmapLevel].height, 1}));
     }
-    memcpy(stagingAllocationInfo.pMappedData, texture->mImageData.data(),
-           texture->mSize.width * texture->mSize.height * PickPixelSize(texture->mSetting.format).second);
-    mCommandBuffer->begin(vk::CommandBufferBeginInfo{});
+    transferCommandBuffer.copyBufferToImage(stagingBuffer, texture->mImage, vk::ImageLayout::eTransferDstOptimal,
+                                            bufferImageCopies);
+    if (ownershipTransfer)
     {
-        // 转换图像布局UNDEFINED → TRANSFER_DST
-        vk::ImageMemoryBarrier imageBarrier{};
-        imageBarrier.setImage(texture->mImage)
-            .setOldLayout(vk::ImageLayout::eUndefined)
+        // release和acquire使用相同的布局和family，布局转换留给graphics队列
+        vk::ImageMemoryBarrier ownershipBarrier{};
+        ownershipBarrier.setImage(texture->mImage)
+            .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
             .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
-            .setSrcAccessMask(vk::AccessFlagBits::eNone)
-            .setDstAccessMask(vk::AccessFlagBits::eTransferWrite)
-            .setSrcQueueFamilyIndex(mVulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setDstQueueFamilyIndex(mVulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
+            .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eNone)
+            .setSrcQueueFamilyIndex(queueFamilyIndicates.transferFamily.value())
+            .setDstQueueFamilyIndex(queueFamilyIndicates.graphicsFamily.value())
+            .setSubresourceRange(imageBarrier.subresourceRange);
+        transferCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                              vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {}, {ownershipBarrier});
+        transferCommandBuffer.end();
+        graphicsCommandBuffer.reset();
+        graphicsCommandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        ownershipBarrier.setSrcAccessMask(vk::AccessFlagBits::eNone)
+            .setDstAccessMask(vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+        graphicsCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                              vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, {ownershipBarrier});
+    }
+    // 如果需要生成mipmap，则生成mipmap
+    for (uint32_t mipmapLevel = 1; !isMipmapBaked && mipmapLevel < texture->mSetting.mipmapLevels; mipmapLevel++)
+    {
+        imageBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+            .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
+            .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
             .setSubresourceRange(vk::ImageSubresourceRange()
-                                     .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                     .setBaseMipLevel(0)
-                                     .setLevelCount(texture->mSetting.mipmapLevels)
+                                     .setAspectMask(aspectMask)
+                                     .setBaseMipLevel(mipmapLevel - 1)
+                                     .setLevelCount(1)
                                      .setBaseArrayLayer(0)
                                      .setLayerCount(texture->mSetting.arrayLayers));
-        mCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {},
-                                        {}, {}, {imageBarrier});
-        // 复制数据到图像
-        vk::BufferImageCopy bufferImageCopy{};
-        bufferImageCopy.setBufferOffset(0)
-            .setBufferRowLength(0)
-            .setBufferImageHeight(0)
-            .setImageSubresource(vk::ImageSubresourceLayers()
-                                     .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                     .setMipLevel(0)
-                                     .setBaseArrayLayer(0)
-                                     .setLayerCount(texture->mSetting.arrayLayers))
-            .setImageOffset({0, 0, 0})
-            .setImageExtent({texture->mSize.width, texture->mSize.height, 1});
-        mCommandBuffer->copyBufferToImage(stagingBuffer, texture->mImage, vk::ImageLayout::eTransferDstOptimal,
-                                          {bufferImageCopy});
-        // 如果需要生成mipmap，则生成mipmap
-        for (uint32_t mipmapLevel = 1; mipmapLevel < texture->mSetting.mipmapLevels; mipmapLevel++)
-        {
-            imageBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
-                .setNewLayout(vk::ImageLayout::eTransferSrcOptimal)
-                .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
-                .setDstAccessMask(vk::AccessFlagBits::eTransferRead)
-                .setSubresourceRange(vk::ImageSubresourceRange()
-                                         .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                         .setBaseMipLevel(mipmapLevel - 1)
-                                         .setLevelCount(1)
-                                         .setBaseArrayLayer(0)
-                                         .setLayerCount(texture->mSetting.arrayLayers));
-            mCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
-                                            {}, {}, {}, {imageBarrier});
-            int32_t mipWidth = std::max(1u, texture->mSize.width >> (mipmapLevel - 1));
-            int32_t mipHeight = std::max(1u, texture->mSize.height >> (mipmapLevel - 1));
-            vk::ImageBlit imageBlit{};
-            imageBlit.setSrcOffsets({vk::Offset3D{0, 0, 0}, vk::Offset3D{mipWidth, mipHeight, 1}})
-                .setSrcSubresource(vk::ImageSubresourceLayers()
-                                       .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                       .setMipLevel(mipmapLevel - 1)
-                                       .setBaseArrayLayer(0)
-                                       .setLayerCount(texture->mSetting.arrayLayers))
-                .setDstOffsets(
-                    {vk::Offset3D{0, 0, 0}, vk::Offset3D{std::max(mipWidth / 2, 1), std::max(mipHeight / 2, 1), 1}})
-                .setDstSubresource(vk::ImageSubresourceLayers()
-                                       .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                       .setMipLevel(mipmapLevel)
-                                       .setBaseArrayLayer(0)
-                                       .setLayerCount(texture->mSetting.arrayLayers));
-            mCommandBuffer->blitImage(texture->mImage, vk::ImageLayout::eTransferSrcOptimal, texture->mImage,
-                                      vk::ImageLayout::eTransferDstOptimal, {imageBlit}, vk::Filter::eLinear);
-
-            imageBarrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
-                .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-                .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
-                .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
-                .setSubresourceRange(vk::ImageSubresourceRange()
-                                         .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                         .setBaseMipLevel(mipmapLevel - 1)
-                                         .setLevelCount(1)
-                                         .setBaseArrayLayer(0)
-                                         .setLayerCount(texture->mSetting.arrayLayers));
-            mCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                            vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, {imageBarrier});
-        }
-        // 转换图像布局：TRANSFER_DST → SHADER_READ
-        imageBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        graphicsCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                              vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, {imageBarrier});
+        int32_t mipWidth = std::max(1u, texture->mSize.width >> (mipmapLevel - 1));
+        int32_t mipHeight = std::max(1u, texture->mSize.height >> (mipmapLevel - 1));
+        vk::ImageBlit imageBlit{};
+        imageBlit.setSrcOffsets({vk::Offset3D{0, 0, 0}, vk::Offset3D{mipWidth, mipHeight, 1}})
+            .setSrcSubresource(vk::ImageSubresourceLayers()
+                                   .setAspectMask(aspectMask)
+                                   .setMipLevel(mipmapLevel - 1)
+                                   .setBaseArrayLayer(0)
+                                   .setLayerCount(texture->mSetting.arrayLayers))
+            .setDstOffsets(
+                {vk::Offset3D{0, 0, 0}, vk::Offset3D{std::max(mipWidth / 2, 1), std::max(mipHeight / 2, 1), 1}})
+            .setDstSubresource(vk::ImageSubresourceLayers()
+                                   .setAspectMask(aspectMask)
+                                   .setMipLevel(mipmapLevel)
+                                   .setBaseArrayLayer(0)
+                                   .setLayerCount(texture->mSetting.arrayLayers));
+        graphicsCommandBuffer.blitImage(texture->mImage, vk::ImageLayout::eTransferSrcOptimal, texture->mImage,
+                                        vk::ImageLayout::eTransferDstOptimal, {imageBlit}, vk::Filter::eLinear);
+
+        imageBarrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal)
             .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-            .setSrcQueueFamilyIndex(mVulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setDstQueueFamilyIndex(mVulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
             .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
             .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
             .setSubresourceRange(vk::ImageSubresourceRange()
-                                     .setAspectMask(GuessImageAspectFlags(texture->mSetting.format))
-                                     .setBaseMipLevel(texture->mSetting.mipmapLevels - 1)
+                                     .setAspectMask(aspectMask)
+                                     .setBaseMipLevel(mipmapLevel - 1)
                                      .setLevelCount(1)
                                      .setBaseArrayLayer(0)
                                      .setLayerCount(texture->mSetting.arrayLayers));
-        mCommandBuffer->pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
-                                        vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, {imageBarrier});
-    }
-    mCommandBuffer->end();
-    // 提交命令缓冲区
-    vk::SubmitInfo submitInfo{};
-    submitInfo.setCommandBuffers(mCommandBuffer.get());
-    mVulkanContext->GetTransferQueue().submit(submitInfo, mFence.get());
-    // 等待提交完成
-    auto result = mVulkanContext->GetDevice().waitForFences(mFence.get(), vk::True, 100000000); // 10秒超时
-    if (result != vk::Result::eSuccess)
-    {
-        LogError("Failed to wait for fence: {}", vk::to_string(result));
-        throw std::runtime_error("Failed to wait for fence");
-    }
-    // 清理临时资源
-    vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), stagingBuffer, stagingAllocation);
+        graphicsCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, SampledStages, {}, {}, {},
+                                              {imageBarrier});
+    }
+    // 转换图像布局：TRANSFER_DST → SHADER_READ
+    imageBarrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+        .setSubresourceRange(vk::ImageSubresourceRange()
+                                 .setAspectMask(aspectMask)
+                                 .setBaseMipLevel(isMipmapBaked ? 0 : imageMipLevels - 1)
+                                 .setLevelCount(isMipmapBaked ? imageMipLevels : 1)
+                                 .setBaseArrayLayer(0)
+                                 .setLayerCount(texture->mSetting.arrayLayers));
+    graphicsCommandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, SampledStages, {}, {}, {},
+                                          {imageBarrier});
+    graphicsCommandBuffer.end();
+    // 不等待完成: 之后的渲染在graphics队列上排在本次提交之后，staging buffer在fence之后回收
+    auto fence = upload.fence.get();
+    if (ownershipTransfer)
+    {
+        auto semaphore = upload.semaphore.get();
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTransfer;
+        vk::SubmitInfo transferSubmitInfo{};
+        transferSubmitInfo.setCommandBuffers(transferCommandBuffer).setSignalSemaphores(semaphore);
+        mVulkanContext->GetTransferQueue().submit(transferSubmitInfo);
+        vk::SubmitInfo graphicsSubmitInfo{};
+        graphicsSubmitInfo.setCommandBuffers(graphicsCommandBuffer)
+            .setWaitSemaphores(semaphore)
+            .setWaitDstStageMask(waitStage);
+        mVulkanContext->GetGraphicsQueue().submit(graphicsSubmitInfo, fence);
+    }
+    else
+    {
+        vk::SubmitInfo submitInfo{};
+        submitInfo.setCommandBuffers(transferCommandBuffer);
+        mVulkanContext->GetTransferQueue().submit(submitInfo, fence);
+    }
+    mPendingUploads.push_back(std::move(upload));
     // 创建缩略图描述集
     if (!texture->mSetting.isDepthStencil)
     {
         texture->mThumbnailDescriptorSet =
-            ImGui_ImplVulkan_AddTexture(texture->mSampler.get(), texture->mImageView.get(),
+            ImGui_ImplVulkan_AddTexture(texture->mSampler->get(), texture->mImageView.get(),
                                         static_cast<VkImageLayout>(vk::ImageLayout::eShaderReadOnlyOptimal));
     }
 }
+uint32_t MTextureManager::GetStreamingTailMip(const MTexture &texture)
+{
+    uint32_t tailMip = 0;
+    while (tailMip + 1 < texture.mSetting.mipmapLevels &&
+           std::max(texture.mSize.width, texture.mSize.height) >> tailMip > StreamingTailSize)
+    {
+        ++tailMip;
+    }
+    return tailMip;
+}
+const std::vector<TextureMipLevel> &MTextureManager::GetMipLevels(MTexture &texture)
+{
+    auto isMipmapBaked = texture.mSetting.isMipmapBaked && texture.mSetting.mipmapLevels > 1;
+    auto levelCount = isMipmapBaked ? texture.mSetting.mipmapLevels : 1;
+    auto key = std::make_tuple(texture.mSize.width, texture.mSize.height, texture.mSetting.format, levelCount);
+    auto &cache = texture.mMipLevels;
+    if (cache.empty() || texture.mMipLevelsKey != key)
+    {
+        auto mipLevels = Utils::MipmapGenerator::GetMipLevels(texture.mSize.width, texture.mSize.height, levelCount,
+                                                              PickPixelSize(texture.mSetting.format).second);
+        cache.clear();
+        cache.reserve(mipLevels.size());
+        for (const auto &level : mipLevels)
+        {
+            cache.push_back({level.width, level.height, level.offset, level.size});
+        }
+        texture.mMipLevelsKey = key;
+    }
+    return cache;
+}
+vk::DeviceSize MTextureManager::GetResidentSize(MTexture &texture, uint32_t residentMip)
+{
+    auto &mipLevels = GetMipLevels(texture);
+    residentMip = std::min(residentMip, static_cast<uint32_t>(mipLevels.size() - 1));
+    return mipLevels.back().offset + mipLevels.back().size - mipLevels[residentMip].offset;
+}
+void MTextureManager::RequestMip(std::shared_ptr<MTexture> texture, uint32_t mip)
+{
+    texture->mRequestedMip = std::min(texture->mRequestedMip, mip);
+    texture->mLastRequestedFrame = mStreamingFrame;
+}
+void MTextureManager::SetStreamingBudget(vk::DeviceSize budget)
+{
+    mStreamingBudget = budget;
+}
+std::vector<std::shared_ptr<MTexture>> MTextureManager::UpdateStreaming()
+{
+    mStreamingFrame++;
+    CollectUploads(MaxPendingUploads);
+
+    struct StreamingEntry
+    {
+        std::shared_ptr<MTexture> texture;
+        uint32_t tailMip;
+        uint32_t targetMip;
+        vk::DeviceSize targetBytes;
+    };
+    std::vector<StreamingEntry> entries;
+    vk::DeviceSize residentBytes = 0;
+    vk::DeviceSize targetBytes = 0;
+    for (auto &texture : mAssets | std::views::values)
+    {
+        if (!texture->IsStreamable() || !texture->mImage)
+        {
+            continue;
+        }
+        auto tailMip = GetStreamingTailMip(*texture);
+        auto targetMip = texture->mResidentMip;
+        if (texture->mRequestedMip != UINT32_MAX)
+        {
+            // 只在请求更高精度时立即升级，降级交给空闲超时和预算压力，避免来回抖动
+            targetMip = std::min(targetMip, std::min(texture->mRequestedMip, tailMip));
+        }
+        else if (mStreamingFrame - texture->mLastRequestedFrame > StreamingIdleFrames)
+        {
+            targetMip = tailMip;
+        }
+        texture->mRequestedMip = UINT32_MAX;
+        auto entryBytes = GetResidentSize(*texture, targetMip);
+        residentBytes += GetResidentSize(*texture, texture->mResidentMip);
+        targetBytes += entryBytes;
+        entries.push_back({texture, tailMip, targetMip, entryBytes});
+    }
+
+    // 预算: 配置值与(VMA报告的可用显存 - 非流式占用)取较小值
+    auto memoryBudget = mVulkanContext->GetDeviceLocalMemoryBudget();
+    auto otherUsage = memoryBudget.usage > residentBytes ? memoryBudget.usage - residentBytes : 0;
+    auto available = memoryBudget.budget > otherUsage ? (memoryBudget.budget - otherUsage) / 10 * 9 : 0;
+    auto budget = mStreamingBudget != 0 ? std::min(mStreamingBudget, available) : available;
+
+    // 超出预算时优先降级最久未使用、占用最大的纹理，每次降一级后按新的大小放回堆中
+    auto hasLowerEvictionPriority = [&entries](uint32_t a, uint32_t b) {
+        auto &entryA = entries[a];
+        auto &entryB = entries[b];
+        if (entryA.texture->mLastRequestedFrame != entryB.texture->mLastRequestedFrame)
+        {
+            return entryA.texture->mLastRequestedFrame > entryB.texture->mLastRequestedFrame;
+        }
+        return entryA.targetBytes < entryB.targetBytes;
+    };
+    std::vector<uint32_t> victims;
+    for (uint32_t i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].targetMip < entries[i].tailMip)
+        {
+            victims.push_back(i);
+        }
+    }
+    std::ranges::make_heap(victims, hasLowerEvictionPriority);
+    uint32_t evictCount = 0;
+    while (targetBytes > budget && !victims.empty())
+    {
+        std::ranges::pop_heap(victims, hasLowerEvictionPriority);
+        auto &victim = entries[victims.back()];
+        victim.targetMip++;
+        auto targetSize = GetResidentSize(*victim.texture, victim.targetMip);
+        targetBytes -= victim.targetBytes - targetSize;
+        victim.targetBytes = targetSize;
+        evictCount++;
+        if (victim.targetMip < victim.tailMip)
+        {
+            std::ranges::push_heap(victims, hasLowerEvictionPriority);
+        }
+        else
+        {
+            victims.pop_back();
+        }
+    }
+
+    // 降级立即执行，升级每帧限量，缺口最大的优先
+    std::ranges::sort(entries, [](const StreamingEntry &a, const StreamingEntry &b) {
+        return a.texture->mResidentMip - std::min(a.targetMip, a.texture->mResidentMip) >
+               b.texture->mResidentMip - std::min(b.targetMip, b.texture->mResidentMip);
+    });
+    std::vector<std::shared_ptr<MTexture>> changedTextures;
+    uint32_t uploadCount = 0;
+    for (auto &entry : entries)
+    {
+        auto &texture = entry.texture;
+        if (entry.targetMip == texture->mResidentMip)
+        {
+            continue;
+        }
+        if (entry.targetMip < texture->mResidentMip)
+        {
+            if (uploadCount >= StreamingMaxUploadsPerFrame)
+            {
+                continue;
+            }
+            uploadCount++;
+        }
+        residentBytes -= GetResidentSize(*texture, texture->mResidentMip);
+        texture->mResidentMip = entry.targetMip;
+        CreateImageResources(texture);
+        Write(texture);
+        residentBytes += GetResidentSize(*texture, texture->mResidentMip);
+        changedTextures.push_back(texture);
+    }
+    mStreamingStats.budget = budget;
+    mStreamingStats.residentBytes = residentBytes;
+    mStreamingStats.requestedBytes = targetBytes;
+    mStreamingStats.streamableCount = static_cast<uint32_t>(entries.size());
+    mStreamingStats.uploadCount = uploadCount;
+    mStreamingStats.evictCount = evictCount;
+    return changedTextures;
+}
+void MTextureManager::Remove(const UUID &id)
+{
+    mBindlessManager->ReleaseTexture(id);
+    MManager<MTexture>::Remove(id);
+}
+void MTextureManager::RetireTexture(MTexture &texture)
+{
+    // 旧image view所在的bindless slot同样延迟释放，下一次WriteTexture分配新slot
+    mBindlessManager->ReleaseTexture(texture.mID);
+    // in-flight的帧可能还在采样旧image，交给延迟释放队列
+    mVulkanContext->GetDeletionQueue().Push(
+        [allocator = mVulkanContext->GetVmaAllocator(), image = texture.mImage, allocation = texture.mAllocation,
+         imageView = std::move(texture.mImageView), thumbnail = texture.mThumbnailDescriptorSet]() mutable {
+            if (thumbnail)
+            {
+                ImGui_ImplVulkan_RemoveTexture(thumbnail);
+            }
+            imageView.reset();
+            vmaDestroyImage(allocator, image, allocation);
+        });
+    texture.mImage = nullptr;
+    texture.mAllocation = nullptr;
+    texture.mThumbnailDescriptorSet = nullptr;
+}
 void MTextureManager::CreateDefault()
 {
     auto whiteTexture = CreateWhiteTexture();
@@ -494,6 +858,7 @@ void MTextureManager::CreateDefault()
     mAssets[mDefaultTextures[DefaultTextureType::EnvironmentMap]] = environmentMap;
     mAssets[mDefaultTextures[DefaultTextureType::IrradianceMap]] = irradianceMap;
     mAssets[mDefaultTextures[DefaultTextureType::BRDFLUT]] = brdfLUT;
+    mIBLBake.reset();
 }
 std::shared_ptr<MTexture> MTextureManager::CreateWhiteTexture()
 {
@@ -566,6 +931,7 @@ std::shared_ptr<MTexture> MTextureManager::CreateColorAttachment(uint32_t width,
     auto colorAttachmentSetting = MTextureSetting();
     colorAttachmentSetting.isRenderTarget = true;
     colorAttachmentSetting.isShaderResource = true;
+    colorAttachmentSetting.isUAV = true; // 分块延迟光照的compute pass直接写入
     colorAttachmentSetting.format = vk::Format::eR32G32B32A32Sfloat;
     colorAttachmentSetting.ImageType = vk::ImageViewType::e2D;
     auto colorAttachment = Create("Color Attachment", {width, height, 4}, {}, colorAttachmentSetting);
@@ -585,58 +951,89 @@ std::shared_ptr<MTexture> MTextureManager::CreateDepthStencilAttachment(uint32_t
     CreateVulkanResources(depthStencilAttachment);
     return depthStencilAttachment;
 }
+const Utils::IBLBakeResult &MTextureManager::GetIBLBake()
+{
+    if (!mIBLBake)
+    {
+        mIBLBake = std::make_unique<Utils::IBLBakeResult>(
+            Utils::IBLBaker::LoadOrBake(EnvironmentMapPath, IBLCachePath, Utils::IBLBakeSetting{}));
+    }
+    return *mIBLBake;
+}
+vk::Format MTextureManager::PickHDRFormat() const
+{
+    // E5B9G9R9必须支持采样和线性过滤，这里只做防御
+    auto format = vk::Format::eE5B9G9R9UfloatPack32;
+    auto features = mVulkanContext->GetPhysicalDevice().getFormatProperties(format).optimalTilingFeatures;
+    if (features & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)
+    {
+        return format;
+    }
+    return vk::Format::eR16G16B16A16Sfloat;
+}
+std::vector<uint8_t> MTextureManager::ConvertHDRData(const std::vector<uint8_t> &imageData, vk::Format format)
+{
+    switch (format)
+    {
+    case vk::Format::eE5B9G9R9UfloatPack32:
+        return Utils::ImageUtil::ConvertRGBA32FToRGB9E5(imageData);
+    case vk::Format::eR16G16B16A16Sfloat:
+        return Utils::ImageUtil::ConvertRGBA32FToRGBA16F(imageData);
+    case vk::Format::eR32G32B32A32Sfloat:
+        return imageData;
+    default:
+        LogError("Unsupported HDR format: {}", vk::to_string(format));
+        throw std::runtime_error("Unsupported HDR format");
+    }
+}
 std::shared_ptr<MTexture> MTextureManager::CreateEnvironmentMap()
 {
+    const auto &bake = GetIBLBake();
     auto environmentMapSetting = MTextureSetting();
     environmentMapSetting.isShaderResource = true;
-    environmentMapSetting.format = vk::Format::eR32G32B32A32Sfloat;
+    environmentMapSetting.format = PickHDRFormat();
     environmentMapSetting.ImageType = vk::ImageViewType::e2D;
-    environmentMapSetting.mipmapLevels = 9;
-    environmentMapSetting.maxLod = 8;
-    auto &&[W, H, C, data] = Utils::ImageUtil::LoadHDRImage("Engine/Textures/EnvironmentMap.hdr");
+    environmentMapSetting.mipmapLevels = bake.specularMipLevels;
+    environmentMapSetting.maxLod = static_cast<float>(bake.specularMipLevels - 1);
+    environmentMapSetting.isMipmapBaked = true;
+    auto &&[C, S] = PickPixelSize(environmentMapSetting.format);
     auto environmentMap =
-        Create("Environment Map", {static_cast<uint32_t>(W), static_cast<uint32_t>(H), static_cast<uint32_t>(C)}, data,
-               environmentMapSetting);
+        Create("Environment Map", {bake.environmentWidth, bake.environmentHeight, C},
+               ConvertHDRData(bake.specular, environmentMapSetting.format), environmentMapSetting);
     CreateVulkanResources(environmentMap);
     Write(environmentMap);
     return environmentMap;
 }
 std::shared_ptr<MTexture> MTextureManager::CreateIrradianceMap()
 {
+    const auto &bake = GetIBLBake();
+    auto bakeSetting = Utils::IBLBakeSetting{};
     auto irradianceMapSetting = MTextureSetting();
     irradianceMapSetting.isShaderResource = true;
-    irradianceMapSetting.format = vk::Format::eR32G32B32A32Sfloat;
+    irradianceMapSetting.format = PickHDRFormat();
     irradianceMapSetting.ImageType = vk::ImageViewType::e2D;
     irradianceMapSetting.mipmapLevels = 1;
-    auto &&[W, H, C, data] = Utils::ImageUtil::LoadHDRImage("Engine/Textures/IrradianceMap.hdr");
+    auto &&[C, S] = PickPixelSize(irradianceMapSetting.format);
     auto irradianceMap =
-        Create("Irradiance Map", {static_cast<uint32_t>(W), static_cast<uint32_t>(H), static_cast<uint32_t>(C)}, data,
-               irradianceMapSetting);
+        Create("Irradiance Map", {bakeSetting.irradianceWidth, bakeSetting.irradianceHeight, C},
+               ConvertHDRData(bake.irradiance, irradianceMapSetting.format), irradianceMapSetting);
     CreateVulkanResources(irradianceMap);
     Write(irradianceMap);
     return irradianceMap;
 }
 std::shared_ptr<MTexture> MTextureManager::CreateBRDFLUT()
 {
-    ktxTexture *brdfLUTTexture = nullptr;
-    if (ktxTexture_CreateFromNamedFile("E:/Code/MEngineV3/Resource/Engine/Textures/BRDFLUT.ktx",
-                                       KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &brdfLUTTexture) != KTX_SUCCESS)
-    {
-        LogError("Failed to load BRDF LUT texture");
-        throw std::runtime_error("Failed to load BRDF LUT texture");
-    }
+    const auto &bake = GetIBLBake();
+    auto bakeSetting = Utils::IBLBakeSetting{};
     auto brdfLUTSetting = MTextureSetting();
     brdfLUTSetting.isShaderResource = true;
-    brdfLUTSetting.format = static_cast<vk::Format>(ktxTexture_GetVkFormat(ktxTexture(brdfLUTTexture)));
-    brdfLUTSetting.mipmapLevels = brdfLUTTexture->numLevels;
+    brdfLUTSetting.format = vk::Format::eR32G32Sfloat;
+    brdfLUTSetting.mipmapLevels = 1;
+    brdfLUTSetting.addressModeU = vk::SamplerAddressMode::eClampToEdge;
+    brdfLUTSetting.addressModeV = vk::SamplerAddressMode::eClampToEdge;
+    brdfLUTSetting.addressModeW = vk::SamplerAddressMode::eClampToEdge;
     auto &&[C, S] = PickPixelSize(brdfLUTSetting.format);
-    auto brdfLUT = Create("BRDF LUT",
-                          {
-                              static_cast<uint32_t>(brdfLUTTexture->baseWidth),
-                              static_cast<uint32_t>(brdfLUTTexture->baseHeight),
-                              static_cast<uint32_t>(C),
-                          },
-                          std::vector<uint8_t>(brdfLUTTexture->pData, brdfLUTTexture->pData + brdfLUTTexture->dataSize),
+    auto brdfLUT = Create("BRDF LUT", {bakeSetting.brdfLUTSize, bakeSetting.brdfLUTSize, C}, bake.brdfLUT,
                           brdfLUTSetting);
     CreateVulkanResources(brdfLUT);
     Write(brdfLUT);
@@ -5,55 +5,62 @@
 namespace MEngine::Core::Manager
 {
 
-void RenderPassManager::CreateCompositionRenderPass()
+vk::UniqueRenderPass RenderPassManager::CreateCompositionRenderPass(vk::ImageLayout colorInitialLayout,
+                                                                   bool storeGBuffer)
 {
+    // load/store op和layout不影响render pass兼容性，各变体可以共用管线和framebuffer
+    auto loadAttachments = colorInitialLayout != vk::ImageLayout::eUndefined;
+    auto loadOp = loadAttachments ? vk::AttachmentLoadOp::eLoad : vk::AttachmentLoadOp::eClear;
+    auto gBufferLoadOp = loadAttachments ? vk::AttachmentLoadOp::eDontCare : vk::AttachmentLoadOp::eClear;
+    auto gBufferStoreOp = storeGBuffer ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare;
     std::vector<vk::AttachmentDescription> attachments{
         // 0：Render Target: Color
         vk::AttachmentDescription()
             .setFormat(GetRenderTargetFormat())
             .setSamples(vk::SampleCountFlagBits::e1)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
+            .setLoadOp(loadOp)
             .setStoreOp(vk::AttachmentStoreOp::eStore)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-            .setInitialLayout(vk::ImageLayout::eUndefined)
-            .setFinalLayout(vk::ImageLayout::eColorAttachmentOptimal),
+            .setInitialLayout(colorInitialLayout)
+            .setFinalLayout(vk::ImageLayout::eShaderReadOnlyOptimal), // 之后由Viewport采样
         // 1: Render Target: Depth
         vk::AttachmentDescription()
             .setFormat(GetDepthStencilFormat()) // 32位深度+8位模板存储
             .setSamples(vk::SampleCountFlagBits::e1)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
+            .setLoadOp(loadOp)
             .setStoreOp(vk::AttachmentStoreOp::eStore)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
-            .setInitialLayout(vk::ImageLayout::eUndefined)
+            .setInitialLayout(loadAttachments ? vk::ImageLayout::eDepthStencilAttachmentOptimal
+                                              : vk::ImageLayout::eUndefined)
             .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal),
         // 2: Normal Map
         vk::AttachmentDescription()
-            .setFormat(vk::Format::eR32G32B32A32Sfloat)
+            .setFormat(GetGBufferFormat())
             .setSamples(vk::SampleCountFlagBits::e1)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
-            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setLoadOp(gBufferLoadOp)
+            .setStoreOp(gBufferStoreOp)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
             .setInitialLayout(vk::ImageLayout::eUndefined)
             .setFinalLayout(vk::ImageLayout::eShaderReadOnlyOptimal),
         // 3: ARM Map
         vk::AttachmentDescription()
-            .setFormat(vk::Format::eR32G32B32A32Sfloat)
+            .setFormat(GetGBufferFormat())
             .setSamples(vk::SampleCountFlagBits::e1)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
-            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setLoadOp(gBufferLoadOp)
+            .setStoreOp(gBufferStoreOp)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
             .setInitialLayout(vk::ImageLayout::eUndefined)
             .setFinalLayout(vk::ImageLayout::eShaderReadOnlyOptimal),
         // 4. Position Map
         vk::AttachmentDescription()
-            .setFormat(vk::Format::eR32G32B32A32Sfloat)
+            .setFormat(GetGBufferFormat())
             .setSamples(vk::SampleCountFlagBits::e1)
-            .setLoadOp(vk::AttachmentLoadOp::eClear)
-            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setLoadOp(gBufferLoadOp)
+            .setStoreOp(gBufferStoreOp)
             .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
             .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
             .setInitialLayout(vk::ImageLayout::eUndefined)
@@ -118,7 +125,22 @@ void RenderPassManager::CreateCompositionRenderPass()
         environmentSubpass,
     };
     // subpass dependencies
+    // G-buffer和depth在各in-flight帧间共享，外部依赖保证上一帧的attachment读写完成后才开始写入
+    auto attachmentStages = vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                            vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                            vk::PipelineStageFlagBits::eLateFragmentTests;
+    auto attachmentWrites =
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite;
     std::vector<vk::SubpassDependency> dependencies{
+        // External -> Subpass 0
+        vk::SubpassDependency()
+            .setSrcSubpass(vk::SubpassExternal)
+            .setDstSubpass(0)
+            .setSrcStageMask(attachmentStages | vk::PipelineStageFlagBits::eFragmentShader)
+            .setDstStageMask(attachmentStages)
+            .setSrcAccessMask(attachmentWrites)
+            .setDstAccessMask(attachmentWrites | vk::AccessFlagBits::eColorAttachmentRead |
+                              vk::AccessFlagBits::eDepthStencilAttachmentRead),
         // Subpass 0 -> Subpass 1
         vk::SubpassDependency()
             .setSrcSubpass(0)
@@ -143,6 +165,14 @@ void RenderPassManager::CreateCompositionRenderPass()
             .setDstStageMask(vk::PipelineStageFlagBits::eFragmentShader)
             .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
             .setDstAccessMask(vk::AccessFlagBits::eShaderRead),
+        // Subpass 3 -> External: Color在Viewport中采样
+        vk::SubpassDependency()
+            .setSrcSubpass(3)
+            .setDstSubpass(vk::SubpassExternal)
+            .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput)
+            .setDstStageMask(vk::PipelineStageFlagBits::eFragmentShader)
+            .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eShaderRead),
     };
     vk::RenderPassCreateInfo renderPassCreateInfo{};
     renderPassCreateInfo.setAttachments(attachments).setSubpasses(subpasses).setDependencies(dependencies);
@@ -151,11 +181,51 @@ void RenderPassManager::CreateCompositionRenderPass()
     {
         LogError("Failed to create Forward render pass");
     }
-    mCompositionRenderPass = std::move(renderPass);
     LogDebug("Forward render pass created successfully");
+    return renderPass;
+}
+vk::UniqueRenderPass RenderPassManager::CreateShadowRenderPass()
+{
+    vk::AttachmentDescription depthAttachment{};
+    depthAttachment.setFormat(mShadowMapFormat)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setLoadOp(vk::AttachmentLoadOp::eLoad)
+        .setStoreOp(vk::AttachmentStoreOp::eStore)
+        .setStencilLoadOp(vk::AttachmentLoadOp::eDontCare)
+        .setStencilStoreOp(vk::AttachmentStoreOp::eDontCare)
+        .setInitialLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal)
+        .setFinalLayout(vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    vk::AttachmentReference depthRef{0, vk::ImageLayout::eDepthStencilAttachmentOptimal};
+    vk::SubpassDescription subpass{};
+    subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics).setPDepthStencilAttachment(&depthRef);
+    // 布局转换和render pass之外的读写由render graph的barrier同步，这里只保证连续的阴影render pass之间的写入顺序
+    auto depthStages =
+        vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+    vk::SubpassDependency dependency{};
+    dependency.setSrcSubpass(vk::SubpassExternal)
+        .setDstSubpass(0)
+        .setSrcStageMask(depthStages)
+        .setDstStageMask(depthStages)
+        .setSrcAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eDepthStencilAttachmentRead |
+                          vk::AccessFlagBits::eDepthStencilAttachmentWrite);
+    vk::RenderPassCreateInfo renderPassCreateInfo{};
+    renderPassCreateInfo.setAttachments(depthAttachment).setSubpasses(subpass).setDependencies(dependency);
+    auto renderPass = mVulkanContext->GetDevice().createRenderPassUnique(renderPassCreateInfo);
+    if (!renderPass)
+    {
+        LogError("Failed to create shadow render pass");
+        throw std::runtime_error("Failed to create shadow render pass");
+    }
+    LogDebug("Shadow render pass created successfully, format {}", vk::to_string(mShadowMapFormat));
+    return renderPass;
 }
 std::tuple<vk::RenderPass, uint32_t> RenderPassManager::GetRenderPass(RenderPassType type) const
 {
+    if (type == RenderPassType::ShadowDepth)
+    {
+        return {mShadowRenderPass.get(), 0};
+    }
     if (mSubPasses.contains(type))
     {
         return {mCompositionRenderPass.get(), mSubPasses.at(type)};
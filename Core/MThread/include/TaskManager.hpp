@@ -15,6 +15,8 @@ class TaskManager
     TaskManager &operator=(TaskManager &&) = delete;
     ~TaskManager() = default;
     static tf::Executor &GetExecutor();
+    // 运行taskflow并等待完成；在executor的工作线程上调用时协作执行(corun)，不阻塞工作线程
+    static void Run(tf::Taskflow &taskflow);
 };
 
 } // namespace MEngine::Core::Thread
\ No newline at end of file
@@ -1,9 +1,78 @@
 #include "TaskManager.hpp"
+#include "CpuProfiler.hpp"
+#include <format>
+#include <unordered_map>
 namespace MEngine::Core::Thread
 {
+#ifdef MENGINE_CPU_PROFILER
+namespace
+{
+// 每个task在工作线程上记为一个CPU zone
+class CpuProfilerObserver final : public tf::ObserverInterface
+{
+  public:
+    void set_up(size_t numWorkers) override
+    {
+    }
+    void on_entry(tf::WorkerView worker, tf::TaskView task) override
+    {
+        thread_local bool named = false;
+        if (!named)
+        {
+            CpuProfiler::SetThreadName(std::format("Worker {}", worker.id()));
+            named = true;
+        }
+        // 暂停时仍需压栈，与on_exit的EndZone配对
+        CpuProfiler::BeginZone(CpuProfiler::IsEnabled() ? GetZoneName(task) : nullptr);
+    }
+    void on_exit(tf::WorkerView worker, tf::TaskView task) override
+    {
+        CpuProfiler::EndZone();
+    }
+
+  private:
+    // InternName需要加锁，按task节点缓存在工作线程本地；节点地址可能被新的task复用，命中时再比较一次名字
+    static const char *GetZoneName(tf::TaskView task)
+    {
+        constexpr size_t MaxCachedNames = 4096;
+        thread_local std::unordered_map<size_t, const char *> names;
+        const auto &name = task.name();
+        if (name.empty())
+        {
+            return "Task";
+        }
+        auto it = names.find(task.hash_value());
+        if (it != names.end() && name == it->second)
+        {
+            return it->second;
+        }
+        if (names.size() >= MaxCachedNames)
+        {
+            names.clear();
+        }
+        auto interned = CpuProfiler::InternName(name);
+        names.insert_or_assign(task.hash_value(), interned);
+        return interned;
+    }
+};
+} // namespace
+#endif
 tf::Executor &TaskManager::GetExecutor()
 {
     static tf::Executor executor;
+#ifdef MENGINE_CPU_PROFILER
+    static auto observer = executor.make_observer<CpuProfilerObserver>();
+#endif
     return executor;
 }
-} // namespace MEngine::Core::Thread
\ No newline at end of file
+void TaskManager::Run(tf::Taskflow &taskflow)
+{
+    auto &executor = GetExecutor();
+    if (executor.this_worker_id() >= 0)
+    {
+        executor.corun(taskflow);
+        return;
+    }
+    executor.run(taskflow).wait();
+}
+} // namespace MEngine::Core::Thread
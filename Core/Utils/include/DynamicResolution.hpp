@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+namespace MEngine::Core::Utils
+{
+struct DynamicResolutionSetting
+{
+    bool enabled = false;
+    float targetFrameMs = 16.0f; // GPU帧时间预算
+    float minScale = 0.5f;       // 每个轴的缩放比例
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;           // 缩放比例按步长取整，避免每帧微小变化
+    float headroom = 0.1f;             // GPU时间低于(1 - headroom) * targetFrameMs时才放大
+    uint32_t increaseDelayFrames = 30; // 任何调整之后至少等待的帧数才放大
+    float smoothing = 0.1f;            // GPU时间指数平均的权重
+};
+/**
+ * @brief 根据GPU帧时间选择渲染分辨率的缩放比例
+ * 假设GPU时间与像素数成正比：超出预算时按sqrt(target / time)一次降到预算内，
+ * 有余量时每次放大一个步长；调整后按新的面积预估平滑后的时间，避免平均值滞后造成连续调整
+ */
+class DynamicResolutionController
+{
+  private:
+    DynamicResolutionSetting mSetting{};
+    float mScale{1.0f};
+    float mFilteredFrameMs{0.0f}; // 0: 还没有样本
+    uint32_t mFramesSinceChange{0};
+
+  public:
+    explicit DynamicResolutionController(const DynamicResolutionSetting &setting = {});
+    void SetSetting(const DynamicResolutionSetting &setting);
+    inline const DynamicResolutionSetting &GetSetting() const
+    {
+        return mSetting;
+    }
+    // 输入一帧的GPU时间(ms)，返回本帧使用的缩放比例；关闭时为1
+    float Update(float gpuFrameMs);
+    void Reset();
+    inline float GetScale() const
+    {
+        return mScale;
+    }
+    inline float GetFilteredFrameMs() const
+    {
+        return mFilteredFrameMs;
+    }
+
+  private:
+    float Quantize(float scale) const;
+};
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,20 @@
+#pragma once
+#include "Math.hpp"
+#include <cstdint>
+
+namespace MEngine::Core::Utils
+{
+/**
+ * @brief Hi-Z金字塔的尺寸和mip选择，与HiZBuild.comp/HiZCull.comp保持一致
+ * 第0级与深度缓冲同尺寸，之后每级宽高向上取整减半并取2x2最大值，
+ * 因此第level级的texel t覆盖像素[t << level, (t + 1) << level)，奇数边不会遗漏像素
+ */
+class HiZPyramid
+{
+  public:
+    static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+    static glm::uvec2 GetMipExtent(uint32_t width, uint32_t height, uint32_t level);
+    // 像素矩形(含两端)最多覆盖2x2个texel的最精细一级
+    static uint32_t SelectMipLevel(const glm::ivec2 &pixelMin, const glm::ivec2 &pixelMax, uint32_t levelCount);
+};
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,67 @@
+#pragma once
+#include "Math.hpp"
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace MEngine::Core::Utils
+{
+struct IBLBakeSetting
+{
+    uint32_t specularMipLevels = 9;
+    uint32_t specularSampleCount = 128;
+    uint32_t irradianceWidth = 128;
+    uint32_t irradianceHeight = 64;
+    uint32_t brdfLUTSize = 256;
+    uint32_t brdfSampleCount = 512;
+    // 着色器采样环境贴图后按pow(x, gamma)解码，滤波在解码后的空间进行，结果重新编码
+    float gamma = 2.2f;
+};
+struct IBLBakeResult
+{
+    uint32_t environmentWidth{0};
+    uint32_t environmentHeight{0};
+    uint32_t specularMipLevels{0};           // 不超过完整mip链的级数
+    std::vector<uint8_t> specular;           // RGBA32F，mip链紧密排列，level 0为原图
+    std::vector<uint8_t> irradiance;         // RGBA32F，irradianceWidth x irradianceHeight
+    std::vector<uint8_t> brdfLUT;            // RG32F，u为NoV，v为roughness
+    std::array<glm::vec3, 9> irradianceSH{}; // 辐射度的L2球谐投影
+};
+/**
+ * @brief 环境光照的CPU烘焙，替代外部工具生成的BRDF LUT和irradiance map
+ * 输入输出均为等距柱状投影，坐标与着色器中的DirectionToUV一致。
+ * level m的预滤波粗糙度为m / log2(width)，与着色器lod = roughness * log2(width)对应；
+ * 按行在TaskManager的executor上并行，累加使用SSE
+ */
+class IBLBaker
+{
+  public:
+    static constexpr uint32_t SHCoefficientCount = 9;
+
+  public:
+    // 缓存与源文件(大小、修改时间)和设置都一致时直接读取，否则重新烘焙并写入缓存
+    static IBLBakeResult LoadOrBake(const std::filesystem::path &environmentPath,
+                                    const std::filesystem::path &cachePath, const IBLBakeSetting &setting);
+    // environment为RGBA32F
+    static IBLBakeResult Bake(const std::vector<uint8_t> &environment, uint32_t width, uint32_t height,
+                              const IBLBakeSetting &setting);
+    // split-sum的scale和bias
+    static std::vector<uint8_t> BakeBRDFLUT(uint32_t size, uint32_t sampleCount);
+    static std::vector<uint8_t> BakeSpecular(const std::vector<uint8_t> &environment, uint32_t width,
+                                             uint32_t height, const IBLBakeSetting &setting);
+    static std::array<glm::vec3, SHCoefficientCount> ProjectSH(const std::vector<uint8_t> &environment,
+                                                               uint32_t width, uint32_t height, float gamma);
+    // 返回E / PI，着色器中直接与albedo相乘
+    static glm::vec3 EvaluateIrradiance(const std::array<glm::vec3, SHCoefficientCount> &sh,
+                                        const glm::vec3 &normal);
+    static std::vector<uint8_t> BakeIrradiance(const std::array<glm::vec3, SHCoefficientCount> &sh, uint32_t width,
+                                               uint32_t height, float gamma);
+    static glm::vec3 UVToDirection(const glm::vec2 &uv);
+    static glm::vec2 DirectionToUV(const glm::vec3 &direction);
+
+  private:
+    static bool LoadCache(const std::filesystem::path &cachePath, uint64_t key, IBLBakeResult &result);
+    static void SaveCache(const std::filesystem::path &cachePath, uint64_t key, const IBLBakeResult &result);
+};
+} // namespace MEngine::Core::Utils
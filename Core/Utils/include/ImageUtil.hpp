@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
 #include <ktx.h>
 #include <stb_image.h>
@@ -17,5 +19,15 @@ class ImageUtil
   public:
     static std::tuple<int, int, int, std::vector<uint8_t>> LoadImage(const std::filesystem::path &path);
     static std::tuple<int, int, int, std::vector<uint8_t>> LoadHDRImage(const std::filesystem::path &path);
+
+    // RGBA32F转换为紧凑的HDR格式，像素按块在TaskManager的executor上并行，SSE2批量转换
+    // R16G16B16A16Sfloat，舍入到最近偶数，超出范围为Inf
+    static std::vector<uint8_t> ConvertRGBA32FToRGBA16F(const std::vector<uint8_t> &imageData);
+    // E5B9G9R9UfloatPack32，alpha丢弃，负数和NaN为0
+    static std::vector<uint8_t> ConvertRGBA32FToRGB9E5(const std::vector<uint8_t> &imageData);
+    static uint16_t FloatToHalf(float value);
+    static float HalfToFloat(uint16_t value);
+    static uint32_t PackRGB9E5(float r, float g, float b);
+    static std::array<float, 3> UnpackRGB9E5(uint32_t value);
 };
 } // namespace MEngine::Core::Utils
\ No newline at end of file
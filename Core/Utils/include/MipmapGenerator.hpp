@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tf
+{
+class Subflow;
+}
+namespace MEngine::Core::Utils
+{
+enum class MipmapFilter
+{
+    Box,
+    Kaiser,
+    Lanczos,
+};
+struct MipmapSetting
+{
+    MipmapFilter filter = MipmapFilter::Kaiser;
+    uint32_t mipmapLevels = 0;          // 0: 生成完整mip链
+    bool isSRGB = true;                 // RGB在线性空间滤波
+    bool isNormalMap = false;           // 每级重新归一化法线
+    bool preserveAlphaCoverage = false; // 保持alpha test覆盖率
+    float alphaCutoff = 0.5f;
+    bool wrap = true; // 边界按Repeat采样，否则Clamp
+};
+struct MipLevelInfo
+{
+    uint32_t width;
+    uint32_t height;
+    size_t offset;
+    size_t size;
+};
+/**
+ * @brief CPU mip链生成，数据按level 0..N-1紧密排列
+ * 输入为RGBA8或RGBA32F，可分离滤波，按行在TaskManager的executor上并行
+ */
+class MipmapGenerator
+{
+  public:
+    static uint32_t GetMipLevelCount(uint32_t width, uint32_t height);
+    static std::vector<MipLevelInfo> GetMipLevels(uint32_t width, uint32_t height, uint32_t mipmapLevels,
+                                                  uint32_t bytesPerPixel);
+    static size_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t mipmapLevels, uint32_t bytesPerPixel);
+
+    static std::vector<uint8_t> GenerateRGBA8(const std::vector<uint8_t> &imageData, uint32_t width,
+                                              uint32_t height, const MipmapSetting &setting);
+    static std::vector<uint8_t> GenerateRGBA32F(const std::vector<uint8_t> &imageData, uint32_t width,
+                                                uint32_t height, const MipmapSetting &setting);
+    // alpha * scale > cutoff 的像素比例
+    static float ComputeAlphaCoverage(const float *pixels, uint32_t width, uint32_t height, float cutoff,
+                                      float scale = 1.0f);
+
+  private:
+    static std::vector<std::vector<float>> GenerateLevels(std::vector<float> &&level0, uint32_t width,
+                                                          uint32_t height, const MipmapSetting &setting);
+    static void Downsample(tf::Subflow &subflow, const std::vector<float> &src, uint32_t srcWidth,
+                           uint32_t srcHeight, std::vector<float> &dst, uint32_t dstWidth, uint32_t dstHeight,
+                           const MipmapSetting &setting);
+    static float FindAlphaScale(const float *pixels, uint32_t width, uint32_t height, float cutoff,
+                                float targetCoverage);
+    static void RenormalizeNormals(std::vector<float> &pixels);
+};
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,98 @@
+#pragma once
+#include "Math.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace MEngine::Core::Utils
+{
+struct OcclusionCullerStats
+{
+    uint32_t occluderCount{0};
+    uint32_t occluderTriangleCount{0}; // 通过近平面检查、实际光栅化的三角形
+    uint32_t testedCount{0};
+    uint32_t culledCount{0};
+    inline float GetCulledPercentage() const
+    {
+        return testedCount == 0 ? 0.0f : 100.0f * static_cast<float>(culledCount) / static_cast<float>(testedCount);
+    }
+};
+// 模型空间包围盒和模型矩阵
+struct OcclusionBounds
+{
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+    glm::mat4 modelMatrix{1.0f};
+};
+/**
+ * @brief CPU软件光栅化的遮挡剔除
+ * 每帧把少量遮挡体光栅化到低分辨率深度缓冲(深度0..1，越小越近)，并为每个TileSize x TileSize的tile记录最远深度；
+ * 测试时先用tile最远深度快速判断，只有不确定的tile才逐像素比较。光栅化按tile行、测试按物体在TaskManager的executor上并行，
+ * x86上AVX2内核单独编译，运行时CPU支持AVX2时一次处理8个像素。
+ * 跨越近平面的遮挡体三角形被丢弃，跨越近平面的包围盒总是可见，因此结果是保守的
+ */
+class OcclusionCuller final
+{
+  public:
+    static constexpr uint32_t TileSize = 8;
+
+  private:
+    struct Triangle
+    {
+        glm::vec3 v0, v1, v2; // x, y为像素坐标，z为深度
+    };
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mTileCountX;
+    uint32_t mTileCountY;
+    glm::mat4 mViewProjection{1.0f};
+    std::vector<Triangle> mTriangles;
+    std::vector<float> mDepth;        // mWidth x mHeight
+    std::vector<float> mTileMaxDepth; // mTileCountX x mTileCountY
+    OcclusionCullerStats mStats{};
+    bool mAVX2Enabled;
+
+  private:
+    void RasterizeTileRow(uint32_t tileY);
+
+  public:
+    // 宽高向上对齐到TileSize
+    OcclusionCuller(uint32_t width = 256, uint32_t height = 144);
+    // 清空深度缓冲和遮挡体，viewProjection与渲染使用的相同
+    void BeginFrame(const glm::mat4 &viewProjection);
+    void AddOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                     const glm::mat4 &modelMatrix);
+    // 光栅化本帧添加的所有遮挡体并生成tile最远深度
+    void Rasterize();
+    bool IsVisible(const OcclusionBounds &bounds) const;
+    // 并行测试，visible[i]对应bounds[i]，同时更新统计
+    void TestVisibility(std::span<const OcclusionBounds> bounds, std::vector<uint8_t> &visible);
+    inline uint32_t GetWidth() const
+    {
+        return mWidth;
+    }
+    inline uint32_t GetHeight() const
+    {
+        return mHeight;
+    }
+    inline const std::vector<float> &GetDepth() const
+    {
+        return mDepth;
+    }
+    inline const OcclusionCullerStats &GetStats() const
+    {
+        return mStats;
+    }
+    // 编译了AVX2内核且CPU支持
+    static bool IsAVX2Supported();
+    // 默认在支持时启用，关闭后使用标量路径(用于对比测试)
+    inline void SetAVX2Enabled(bool enabled)
+    {
+        mAVX2Enabled = enabled && IsAVX2Supported();
+    }
+    inline bool IsAVX2Enabled() const
+    {
+        return mAVX2Enabled;
+    }
+};
+} // namespace MEngine::Core::Utils
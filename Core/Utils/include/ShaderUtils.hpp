@@ -1,6 +1,8 @@
 #pragma once
 #include <shaderc/shaderc.h>
 #include <shaderc/shaderc.hpp>
+#include <string>
+#include <vector>
 
 namespace MEngine::Core::Utils
 {
@@ -10,7 +12,8 @@ class ShaderUtils
     static shaderc::Compiler &GetCompiler();
     static shaderc::CompileOptions &GetCompileOptions();
     static shaderc::SpvCompilationResult CompileShader(const std::string &source, shaderc_shader_kind kind,
-                                                       const std::string &name = "shader");
+                                                       const std::string &name = "shader",
+                                                       const std::vector<std::string> &macros = {});
     static shaderc_shader_kind GetShaderKindFromExtension(const std::string &extension);
 };
 } // namespace MEngine::Core::Utils
@@ -0,0 +1,43 @@
+#pragma once
+#include "Math.hpp"
+#include <array>
+#include <cstdint>
+
+namespace MEngine::Core::Utils
+{
+struct ShadowCascade
+{
+    glm::mat4 viewProjection{1.0f};
+    float splitNear{0.0f}; // 相机空间距离
+    float splitFar{0.0f};
+    float texelWorldSize{0.0f}; // 一个shadow map texel在世界空间的边长
+    bool operator==(const ShadowCascade &) const = default;
+};
+/**
+ * @brief 平行光级联阴影的划分和拟合
+ * 每级用视锥切片的包围球拟合正交投影，半径与相机朝向无关；投影中心在光源空间按1/SnapDivisions个级联宽度取整，
+ * 相机小范围移动时矩阵保持不变，缓存的静态阴影可以继续使用，只有跨过取整步长时该级才需要重绘。
+ * 取整步长是texel的整数倍，重绘前后静态阴影不会在texel内游移
+ */
+class ShadowCascades
+{
+  public:
+    static constexpr uint32_t CascadeCount = 4;
+    static constexpr uint32_t SnapDivisions = 8;
+    static constexpr float SplitLambda = 0.75f;
+
+  public:
+    // 对数划分和均匀划分按lambda混合，返回CascadeCount + 1个边界
+    static std::array<float, CascadeCount + 1> ComputeSplits(float nearPlane, float farPlane, float lambda);
+    // viewMatrix/projectionMatrix与相机一致，nearPlane/farPlane为projectionMatrix的近远平面，
+    // shadowDistance之外不产生阴影；casterDistance为级联之前仍可能投射阴影的距离，resolution为每级的边长(texel)
+    static std::array<ShadowCascade, CascadeCount> ComputeCascades(const glm::mat4 &viewMatrix,
+                                                                   const glm::mat4 &projectionMatrix, float nearPlane,
+                                                                   float farPlane, float shadowDistance,
+                                                                   const glm::vec3 &lightDirection,
+                                                                   uint32_t resolution, float casterDistance);
+    // 模型空间包围盒与级联的正交投影范围是否相交
+    static bool Intersects(const glm::mat4 &viewProjection, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax,
+                           const glm::mat4 &modelMatrix);
+};
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,76 @@
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace MEngine::Core::Utils
+{
+DynamicResolutionController::DynamicResolutionController(const DynamicResolutionSetting &setting)
+{
+    SetSetting(setting);
+}
+void DynamicResolutionController::SetSetting(const DynamicResolutionSetting &setting)
+{
+    mSetting = setting;
+    mSetting.minScale = std::clamp(mSetting.minScale, 0.1f, 1.0f);
+    mSetting.maxScale = std::clamp(mSetting.maxScale, mSetting.minScale, 1.0f);
+    mSetting.scaleStep = std::max(mSetting.scaleStep, 0.0f);
+    mSetting.smoothing = std::clamp(mSetting.smoothing, 0.01f, 1.0f);
+    Reset();
+}
+void DynamicResolutionController::Reset()
+{
+    mScale = mSetting.enabled ? mSetting.maxScale : 1.0f;
+    mFilteredFrameMs = 0.0f;
+    mFramesSinceChange = 0;
+}
+float DynamicResolutionController::Update(float gpuFrameMs)
+{
+    if (!mSetting.enabled || mSetting.targetFrameMs <= 0.0f)
+    {
+        mScale = 1.0f;
+        return mScale;
+    }
+    if (gpuFrameMs <= 0.0f)
+    {
+        return mScale;
+    }
+    mFilteredFrameMs = mFilteredFrameMs == 0.0f
+                           ? gpuFrameMs
+                           : mFilteredFrameMs + (gpuFrameMs - mFilteredFrameMs) * mSetting.smoothing;
+    mFramesSinceChange++;
+    auto scale = mScale;
+    if (mFilteredFrameMs > mSetting.targetFrameMs)
+    {
+        // 向下取整，保证降到预算内
+        auto desired = mScale * std::sqrt(mSetting.targetFrameMs / mFilteredFrameMs);
+        scale = std::max(Quantize(desired), mSetting.minScale);
+    }
+    else if (mFilteredFrameMs < (1.0f - mSetting.headroom) * mSetting.targetFrameMs &&
+             mFramesSinceChange >= mSetting.increaseDelayFrames)
+    {
+        // 放大后的预估时间仍需留在预算内
+        auto next = std::min(mScale + std::max(mSetting.scaleStep, 0.01f), mSetting.maxScale);
+        auto predicted = mFilteredFrameMs * (next * next) / (mScale * mScale);
+        if (predicted <= mSetting.targetFrameMs)
+        {
+            scale = next;
+        }
+    }
+    if (scale != mScale)
+    {
+        mFilteredFrameMs *= (scale * scale) / (mScale * mScale);
+        mScale = scale;
+        mFramesSinceChange = 0;
+    }
+    return mScale;
+}
+float DynamicResolutionController::Quantize(float scale) const
+{
+    if (mSetting.scaleStep <= 0.0f)
+    {
+        return scale;
+    }
+    // 留一点容差，避免浮点误差把正好在步长上的值降一级
+    return std::floor(scale / mSetting.scaleStep + 1e-3f) * mSetting.scaleStep;
+}
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,27 @@
+#include "HiZPyramid.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace MEngine::Core::Utils
+{
+uint32_t HiZPyramid::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+    // 向上取整减半到1x1所需的级数
+    return std::bit_width(std::max({width, height, 1u}) - 1) + 1;
+}
+glm::uvec2 HiZPyramid::GetMipExtent(uint32_t width, uint32_t height, uint32_t level)
+{
+    auto divisor = 1u << level;
+    return glm::uvec2(std::max(1u, (width + divisor - 1) >> level), std::max(1u, (height + divisor - 1) >> level));
+}
+uint32_t HiZPyramid::SelectMipLevel(const glm::ivec2 &pixelMin, const glm::ivec2 &pixelMax, uint32_t levelCount)
+{
+    uint32_t level = 0;
+    while (level + 1 < levelCount && ((pixelMax.x >> level) - (pixelMin.x >> level) > 1 ||
+                                      (pixelMax.y >> level) - (pixelMin.y >> level) > 1))
+    {
+        level++;
+    }
+    return level;
+}
+} // namespace MEngine::Core::Utils
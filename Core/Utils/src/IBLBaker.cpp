@@ -0,0 +1,502 @@
+#include "IBLBaker.hpp"
+#include "ImageUtil.hpp"
+#include "Logger.hpp"
+#include "MipmapGenerator.hpp"
+#include "TaskManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numbers>
+#include <stdexcept>
+#include <taskflow/algorithm/for_each.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define MENGINE_IBL_SSE 1
+#endif
+
+namespace MEngine::Core::Utils
+{
+namespace
+{
+constexpr float Pi = std::numbers::pi_v<float>;
+constexpr uint32_t CacheMagic = 0x4C42494D; // "MIBL"
+constexpr uint32_t CacheVersion = 1;
+
+#ifdef MENGINE_IBL_SSE
+using Pixel = __m128;
+inline Pixel PixelZero()
+{
+    return _mm_setzero_ps();
+}
+inline Pixel PixelLoad(const float *pixel)
+{
+    return _mm_loadu_ps(pixel);
+}
+inline void PixelStore(float *pixel, Pixel value)
+{
+    _mm_storeu_ps(pixel, value);
+}
+inline Pixel PixelMulAdd(Pixel sum, Pixel value, float weight)
+{
+    return _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weight)));
+}
+inline Pixel PixelLerp(Pixel a, Pixel b, float t)
+{
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), _mm_set1_ps(t)));
+}
+#else
+using Pixel = glm::vec4;
+inline Pixel PixelZero()
+{
+    return glm::vec4(0.0f);
+}
+inline Pixel PixelLoad(const float *pixel)
+{
+    return glm::vec4(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+inline void PixelStore(float *pixel, Pixel value)
+{
+    std::memcpy(pixel, &value.x, sizeof(float) * 4);
+}
+inline Pixel PixelMulAdd(Pixel sum, Pixel value, float weight)
+{
+    return sum + value * weight;
+}
+inline Pixel PixelLerp(Pixel a, Pixel b, float t)
+{
+    return a + (b - a) * t;
+}
+#endif
+
+struct EnvironmentLevel
+{
+    const float *pixels;
+    uint32_t width;
+    uint32_t height;
+};
+// 水平方向环绕，垂直方向夹紧
+Pixel SampleBilinear(const EnvironmentLevel &level, const glm::vec2 &uv)
+{
+    auto width = static_cast<int32_t>(level.width);
+    auto height = static_cast<int32_t>(level.height);
+    auto x = uv.x * static_cast<float>(width) - 0.5f;
+    auto y = uv.y * static_cast<float>(height) - 0.5f;
+    auto x0f = std::floor(x);
+    auto y0f = std::floor(y);
+    auto fx = x - x0f;
+    auto fy = y - y0f;
+    auto x0 = (static_cast<int32_t>(x0f) % width + width) % width;
+    auto x1 = (x0 + 1) % width;
+    auto y0 = std::clamp(static_cast<int32_t>(y0f), 0, height - 1);
+    auto y1 = std::clamp(static_cast<int32_t>(y0f) + 1, 0, height - 1);
+    auto load = [&level](int32_t px, int32_t py) {
+        return PixelLoad(level.pixels + (static_cast<size_t>(py) * level.width + static_cast<size_t>(px)) * 4);
+    };
+    auto top = PixelLerp(load(x0, y0), load(x1, y0), fx);
+    auto bottom = PixelLerp(load(x0, y1), load(x1, y1), fx);
+    return PixelLerp(top, bottom, fy);
+}
+glm::vec2 Hammersley(uint32_t index, uint32_t count)
+{
+    auto bits = index;
+    bits = (bits << 16u) | (bits >> 16u);
+    bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+    bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+    bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+    bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+    return glm::vec2(static_cast<float>(index) / static_cast<float>(count),
+                     static_cast<float>(bits) * 2.3283064365386963e-10f);
+}
+// 切线空间(法线为+z)的GGX半程向量
+glm::vec3 ImportanceSampleGGX(const glm::vec2 &xi, float roughness)
+{
+    auto a = roughness * roughness;
+    auto phi = 2.0f * Pi * xi.x;
+    auto cosTheta = std::sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+    auto sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+    return glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+float DistributionGGX(float NoH, float roughness)
+{
+    auto a = roughness * roughness;
+    auto a2 = a * a;
+    auto d = NoH * NoH * (a2 - 1.0f) + 1.0f;
+    return a2 / (Pi * d * d);
+}
+float GeometrySchlickGGX(float NoX, float k)
+{
+    return NoX / (NoX * (1.0f - k) + k);
+}
+std::array<float, IBLBaker::SHCoefficientCount> SHBasis(const glm::vec3 &direction)
+{
+    auto x = direction.x;
+    auto y = direction.y;
+    auto z = direction.z;
+    return {0.282095f,
+            0.488603f * y,
+            0.488603f * z,
+            0.488603f * x,
+            1.092548f * x * y,
+            1.092548f * y * z,
+            0.315392f * (3.0f * z * z - 1.0f),
+            1.092548f * x * z,
+            0.546274f * (x * x - y * y)};
+}
+} // namespace
+IBLBakeResult IBLBaker::LoadOrBake(const std::filesystem::path &environmentPath, const std::filesystem::path &cachePath,
+                                   const IBLBakeSetting &setting)
+{
+    uint64_t key = 14695981039346656037ULL; // FNV-1a
+    auto combine = [&key](auto value) {
+        key ^= std::hash<decltype(value)>{}(value);
+        key *= 1099511628211ULL;
+    };
+    std::error_code error;
+    combine(CacheVersion);
+    combine(static_cast<uint64_t>(std::filesystem::file_size(environmentPath, error)));
+    combine(static_cast<int64_t>(std::filesystem::last_write_time(environmentPath, error).time_since_epoch().count()));
+    combine(setting.specularMipLevels);
+    combine(setting.specularSampleCount);
+    combine(setting.irradianceWidth);
+    combine(setting.irradianceHeight);
+    combine(setting.brdfLUTSize);
+    combine(setting.brdfSampleCount);
+    combine(setting.gamma);
+    IBLBakeResult result;
+    if (LoadCache(cachePath, key, result))
+    {
+        LogDebug("IBL loaded from cache {}", cachePath.string());
+        return result;
+    }
+    auto start = std::chrono::steady_clock::now();
+    auto &&[width, height, channels, data] = ImageUtil::LoadHDRImage(environmentPath);
+    result = Bake(data, static_cast<uint32_t>(width), static_cast<uint32_t>(height), setting);
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LogInfo("IBL baked from {} ({}x{}) in {} ms", environmentPath.string(), width, height, elapsed.count());
+    SaveCache(cachePath, key, result);
+    return result;
+}
+IBLBakeResult IBLBaker::Bake(const std::vector<uint8_t> &environment, uint32_t width, uint32_t height,
+                             const IBLBakeSetting &setting)
+{
+    if (environment.size() < static_cast<size_t>(width) * height * 4 * sizeof(float))
+    {
+        throw std::runtime_error("IBL environment data is smaller than width * height * 16");
+    }
+    IBLBakeResult result;
+    result.environmentWidth = width;
+    result.environmentHeight = height;
+    result.specularMipLevels =
+        std::min(std::max(setting.specularMipLevels, 1u), MipmapGenerator::GetMipLevelCount(width, height));
+    auto specularSetting = setting;
+    specularSetting.specularMipLevels = result.specularMipLevels;
+    result.specular = BakeSpecular(environment, width, height, specularSetting);
+    result.irradianceSH = ProjectSH(environment, width, height, setting.gamma);
+    result.irradiance =
+        BakeIrradiance(result.irradianceSH, setting.irradianceWidth, setting.irradianceHeight, setting.gamma);
+    result.brdfLUT = BakeBRDFLUT(setting.brdfLUTSize, setting.brdfSampleCount);
+    return result;
+}
+std::vector<uint8_t> IBLBaker::BakeBRDFLUT(uint32_t size, uint32_t sampleCount)
+{
+    std::vector<uint8_t> data(static_cast<size_t>(size) * size * 2 * sizeof(float));
+    auto pixels = reinterpret_cast<float *>(data.data());
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(0u, size, 1u, [&](uint32_t y) {
+        auto roughness = (static_cast<float>(y) + 0.5f) / static_cast<float>(size);
+        // IBL使用k = a / 2
+        auto k = roughness * roughness / 2.0f;
+        std::vector<glm::vec3> halfVectors(sampleCount);
+        for (uint32_t i = 0; i < sampleCount; ++i)
+        {
+            halfVectors[i] = ImportanceSampleGGX(Hammersley(i, sampleCount), roughness);
+        }
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            auto NoV = (static_cast<float>(x) + 0.5f) / static_cast<float>(size);
+            auto V = glm::vec3(std::sqrt(1.0f - NoV * NoV), 0.0f, NoV);
+            auto scale = 0.0f;
+            auto bias = 0.0f;
+            for (const auto &H : halfVectors)
+            {
+                auto VoH = std::max(glm::dot(V, H), 0.0f);
+                auto NoL = 2.0f * VoH * H.z - V.z;
+                if (NoL <= 0.0f)
+                {
+                    continue;
+                }
+                auto G = GeometrySchlickGGX(NoV, k) * GeometrySchlickGGX(NoL, k);
+                auto visibility = G * VoH / (H.z * NoV);
+                auto fresnel = std::pow(1.0f - VoH, 5.0f);
+                scale += (1.0f - fresnel) * visibility;
+                bias += fresnel * visibility;
+            }
+            auto pixel = pixels + (static_cast<size_t>(y) * size + x) * 2;
+            pixel[0] = scale / static_cast<float>(sampleCount);
+            pixel[1] = bias / static_cast<float>(sampleCount);
+        }
+    });
+    Thread::TaskManager::Run(taskflow);
+    return data;
+}
+std::vector<uint8_t> IBLBaker::BakeSpecular(const std::vector<uint8_t> &environment, uint32_t width, uint32_t height,
+                                            const IBLBakeSetting &setting)
+{
+    auto levels = MipmapGenerator::GetMipLevels(width, height, setting.specularMipLevels, 4 * sizeof(float));
+    std::vector<uint8_t> result(levels.back().offset + levels.back().size);
+    std::memcpy(result.data(), environment.data(), levels[0].size);
+    if (levels.size() == 1)
+    {
+        return result;
+    }
+    // 解码后生成box滤波的mip链，按每个样本覆盖的立体角选择level(filtered importance sampling)，少量样本即可去除噪点
+    std::vector<uint8_t> decoded(levels[0].size);
+    auto sourcePixels = reinterpret_cast<const float *>(environment.data());
+    auto decodedPixels = reinterpret_cast<float *>(decoded.data());
+    for (size_t i = 0; i < static_cast<size_t>(width) * height * 4; ++i)
+    {
+        decodedPixels[i] = i % 4 == 3 ? sourcePixels[i] : std::pow(std::max(sourcePixels[i], 0.0f), setting.gamma);
+    }
+    auto sourceSetting = MipmapSetting{};
+    sourceSetting.filter = MipmapFilter::Box;
+    sourceSetting.isSRGB = false;
+    auto sourceChain = MipmapGenerator::GenerateRGBA32F(decoded, width, height, sourceSetting);
+    auto sourceLevelInfos =
+        MipmapGenerator::GetMipLevels(width, height, MipmapGenerator::GetMipLevelCount(width, height), 16);
+    std::vector<EnvironmentLevel> sources;
+    for (const auto &info : sourceLevelInfos)
+    {
+        sources.push_back({reinterpret_cast<const float *>(sourceChain.data() + info.offset), info.width, info.height});
+    }
+    auto texelSolidAngle = 4.0f * Pi / (static_cast<float>(width) * static_cast<float>(height));
+    auto maxLod = std::log2(static_cast<float>(width));
+    auto inverseGamma = 1.0f / setting.gamma;
+    struct Sample
+    {
+        glm::vec3 direction; // 切线空间
+        float weight;
+        uint32_t sourceLevel;
+    };
+    // 各级只读取源mip链，互不依赖，放在同一个taskflow中并行
+    std::vector<std::vector<Sample>> levelSamples(levels.size());
+    tf::Taskflow taskflow;
+    for (uint32_t level = 1; level < levels.size(); ++level)
+    {
+        auto roughness = std::min(1.0f, static_cast<float>(level) / maxLod);
+        // 假设N = V，样本在切线空间的方向与texel无关
+        auto &samples = levelSamples[level];
+        auto totalWeight = 0.0f;
+        for (uint32_t i = 0; i < setting.specularSampleCount; ++i)
+        {
+            auto H = ImportanceSampleGGX(Hammersley(i, setting.specularSampleCount), roughness);
+            auto L = 2.0f * H.z * H - glm::vec3(0.0f, 0.0f, 1.0f);
+            if (L.z <= 0.0f)
+            {
+                continue;
+            }
+            auto pdf = DistributionGGX(H.z, roughness) / 4.0f;
+            auto sampleSolidAngle = 1.0f / (static_cast<float>(setting.specularSampleCount) * pdf + 1e-4f);
+            auto lod = 0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f;
+            auto sourceLevel = std::clamp(static_cast<int32_t>(std::round(lod)), 0,
+                                          static_cast<int32_t>(sources.size()) - 1);
+            samples.push_back({L, L.z, static_cast<uint32_t>(sourceLevel)});
+            totalWeight += L.z;
+        }
+        const auto &info = levels[level];
+        auto dst = reinterpret_cast<float *>(result.data() + info.offset);
+        // 任务在循环结束后执行，按值或绑定到容器元素捕获
+        auto rowTask = [&sources, &samples = levelSamples[level], &info = levels[level], dst, totalWeight,
+                        inverseGamma](uint32_t y) {
+            for (uint32_t x = 0; x < info.width; ++x)
+            {
+                auto N = UVToDirection(glm::vec2((static_cast<float>(x) + 0.5f) / static_cast<float>(info.width),
+                                                 (static_cast<float>(y) + 0.5f) / static_cast<float>(info.height)));
+                auto up = std::abs(N.y) < 0.999f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+                auto T = glm::normalize(glm::cross(up, N));
+                auto B = glm::cross(N, T);
+                auto sum = PixelZero();
+                for (const auto &sample : samples)
+                {
+                    auto L = T * sample.direction.x + B * sample.direction.y + N * sample.direction.z;
+                    sum = PixelMulAdd(sum, SampleBilinear(sources[sample.sourceLevel], DirectionToUV(L)),
+                                      sample.weight);
+                }
+                float color[4];
+                PixelStore(color, sum);
+                auto pixel = dst + (static_cast<size_t>(y) * info.width + x) * 4;
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    pixel[c] = std::pow(std::max(color[c] / totalWeight, 0.0f), inverseGamma);
+                }
+                pixel[3] = 1.0f;
+            }
+        };
+        taskflow.for_each_index(0u, info.height, 1u, rowTask);
+    }
+    Thread::TaskManager::Run(taskflow);
+    return result;
+}
+std::array<glm::vec3, IBLBaker::SHCoefficientCount> IBLBaker::ProjectSH(const std::vector<uint8_t> &environment,
+                                                                         uint32_t width, uint32_t height, float gamma)
+{
+    auto pixels = reinterpret_cast<const float *>(environment.data());
+    // 每行单独累加，最后按行序合并，结果与线程数无关
+    std::vector<std::array<glm::vec4, SHCoefficientCount>> rowSums(height);
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(0u, height, 1u, [&](uint32_t y) {
+        auto v = (static_cast<float>(y) + 0.5f) / static_cast<float>(height);
+        auto latitude = v * Pi - Pi / 2.0f;
+        auto solidAngle = (2.0f * Pi / static_cast<float>(width)) * (Pi / static_cast<float>(height)) *
+                          std::cos(latitude);
+        std::array<Pixel, SHCoefficientCount> sums;
+        sums.fill(PixelZero());
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            auto direction = UVToDirection(glm::vec2((static_cast<float>(x) + 0.5f) / static_cast<float>(width), v));
+            auto basis = SHBasis(direction);
+            auto source = pixels + (static_cast<size_t>(y) * width + x) * 4;
+            float decoded[4]{std::pow(std::max(source[0], 0.0f), gamma), std::pow(std::max(source[1], 0.0f), gamma),
+                             std::pow(std::max(source[2], 0.0f), gamma), 0.0f};
+            auto radiance = PixelLoad(decoded);
+            for (uint32_t k = 0; k < SHCoefficientCount; ++k)
+            {
+                sums[k] = PixelMulAdd(sums[k], radiance, basis[k] * solidAngle);
+            }
+        }
+        for (uint32_t k = 0; k < SHCoefficientCount; ++k)
+        {
+            PixelStore(&rowSums[y][k].x, sums[k]);
+        }
+    });
+    Thread::TaskManager::Run(taskflow);
+    std::array<glm::vec3, SHCoefficientCount> sh{};
+    for (const auto &row : rowSums)
+    {
+        for (uint32_t k = 0; k < SHCoefficientCount; ++k)
+        {
+            sh[k] += glm::vec3(row[k]);
+        }
+    }
+    return sh;
+}
+glm::vec3 IBLBaker::EvaluateIrradiance(const std::array<glm::vec3, SHCoefficientCount> &sh, const glm::vec3 &normal)
+{
+    // 余弦卷积的各阶系数A_l / PI
+    constexpr std::array<float, SHCoefficientCount> bandFactors{
+        1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+    auto basis = SHBasis(normal);
+    auto irradiance = glm::vec3(0.0f);
+    for (uint32_t k = 0; k < SHCoefficientCount; ++k)
+    {
+        irradiance += sh[k] * basis[k] * bandFactors[k];
+    }
+    // L2截断在高对比度环境下会出现负值
+    return glm::max(irradiance, glm::vec3(0.0f));
+}
+std::vector<uint8_t> IBLBaker::BakeIrradiance(const std::array<glm::vec3, SHCoefficientCount> &sh, uint32_t width,
+                                              uint32_t height, float gamma)
+{
+    std::vector<uint8_t> data(static_cast<size_t>(width) * height * 4 * sizeof(float));
+    auto pixels = reinterpret_cast<float *>(data.data());
+    auto inverseGamma = 1.0f / gamma;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            auto normal = UVToDirection(glm::vec2((static_cast<float>(x) + 0.5f) / static_cast<float>(width),
+                                                  (static_cast<float>(y) + 0.5f) / static_cast<float>(height)));
+            auto irradiance = EvaluateIrradiance(sh, normal);
+            auto pixel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+            pixel[0] = std::pow(irradiance.r, inverseGamma);
+            pixel[1] = std::pow(irradiance.g, inverseGamma);
+            pixel[2] = std::pow(irradiance.b, inverseGamma);
+            pixel[3] = 1.0f;
+        }
+    }
+    return data;
+}
+glm::vec3 IBLBaker::UVToDirection(const glm::vec2 &uv)
+{
+    auto longitude = uv.x * 2.0f * Pi - Pi;
+    auto latitude = uv.y * Pi - Pi / 2.0f;
+    return glm::vec3(std::cos(latitude) * std::cos(longitude), std::sin(latitude),
+                     std::cos(latitude) * std::sin(longitude));
+}
+glm::vec2 IBLBaker::DirectionToUV(const glm::vec3 &direction)
+{
+    auto u = (std::atan2(direction.z, direction.x) + Pi) / (2.0f * Pi);
+    auto v = (std::asin(std::clamp(direction.y, -1.0f, 1.0f)) + Pi / 2.0f) / Pi;
+    return glm::vec2(u, v);
+}
+bool IBLBaker::LoadCache(const std::filesystem::path &cachePath, uint64_t key, IBLBakeResult &result)
+{
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    auto read = [&file](auto &value) { file.read(reinterpret_cast<char *>(&value), sizeof(value)); };
+    auto readBlob = [&file](std::vector<uint8_t> &blob) {
+        uint64_t size = 0;
+        file.read(reinterpret_cast<char *>(&size), sizeof(size));
+        if (!file || size > (1ull << 32))
+        {
+            return false;
+        }
+        blob.resize(size);
+        file.read(reinterpret_cast<char *>(blob.data()), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    };
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint64_t cachedKey = 0;
+    read(magic);
+    read(version);
+    read(cachedKey);
+    if (!file || magic != CacheMagic || version != CacheVersion || cachedKey != key)
+    {
+        return false;
+    }
+    read(result.environmentWidth);
+    read(result.environmentHeight);
+    read(result.specularMipLevels);
+    read(result.irradianceSH);
+    if (!file || !readBlob(result.specular) || !readBlob(result.irradiance) || !readBlob(result.brdfLUT))
+    {
+        LogWarn("IBL cache {} is truncated, baking again", cachePath.string());
+        return false;
+    }
+    return true;
+}
+void IBLBaker::SaveCache(const std::filesystem::path &cachePath, uint64_t key, const IBLBakeResult &result)
+{
+    std::error_code error;
+    std::filesystem::create_directories(cachePath.parent_path(), error);
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        // 缓存只影响下次启动的速度
+        LogWarn("Failed to write IBL cache {}", cachePath.string());
+        return;
+    }
+    auto write = [&file](const auto &value) { file.write(reinterpret_cast<const char *>(&value), sizeof(value)); };
+    auto writeBlob = [&file](const std::vector<uint8_t> &blob) {
+        uint64_t size = blob.size();
+        file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        file.write(reinterpret_cast<const char *>(blob.data()), static_cast<std::streamsize>(size));
+    };
+    write(CacheMagic);
+    write(CacheVersion);
+    write(key);
+    write(result.environmentWidth);
+    write(result.environmentHeight);
+    write(result.specularMipLevels);
+    write(result.irradianceSH);
+    writeBlob(result.specular);
+    writeBlob(result.irradiance);
+    writeBlob(result.brdfLUT);
+}
+} // namespace MEngine::Core::Utils
@@ -3,9 +3,91 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "ImageUtil.hpp"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "TaskManager.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
 #include <stb_image_write.h>
+#include <taskflow/algorithm/for_each.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define MENGINE_IMAGE_SSE 1
+#endif
+
 namespace MEngine::Core::Utils
 {
+namespace
+{
+constexpr size_t ConvertBlockPixels = 16384;
+// E5B9G9R9: N = 9, B = 15, Emax = 31
+constexpr float RGB9E5Max = 65408.0f; // (2^N - 1) / 2^N * 2^(Emax - B)
+
+#ifdef MENGINE_IMAGE_SSE
+inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+// 与ImageUtil::FloatToHalf相同的舍入，结果在每个32位lane的低16位
+__m128i FloatToHalf4(__m128 value)
+{
+    auto bits = _mm_castps_si128(value);
+    auto sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    auto absBits = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+    auto mantissaOdd = _mm_and_si128(_mm_srli_epi32(absBits, 13), _mm_set1_epi32(1));
+    auto normal = _mm_add_epi32(_mm_add_epi32(absBits, _mm_set1_epi32(static_cast<int>(0xC8000FFFu))), mantissaOdd);
+    normal = _mm_srli_epi32(normal, 13);
+    auto subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(absBits), _mm_set1_ps(0.5f))),
+                                   _mm_set1_epi32(0x3F000000));
+    auto result = Select(_mm_cmplt_epi32(absBits, _mm_set1_epi32(0x38800000)), subnormal, normal);
+    result = Select(_mm_cmpgt_epi32(absBits, _mm_set1_epi32(0x477FEFFF)), _mm_set1_epi32(0x7C00), result);
+    result = Select(_mm_cmpgt_epi32(absBits, _mm_set1_epi32(0x7F800000)), _mm_set1_epi32(0x7E00), result);
+    return _mm_or_si128(result, sign);
+}
+__m128i PackRGB9E5x4(__m128 r, __m128 g, __m128 b)
+{
+    auto zero = _mm_setzero_ps();
+    auto maxValue = _mm_set1_ps(RGB9E5Max);
+    // max_ps在任一操作数为NaN时返回第二个操作数
+    r = _mm_min_ps(_mm_max_ps(r, zero), maxValue);
+    g = _mm_min_ps(_mm_max_ps(g, zero), maxValue);
+    b = _mm_min_ps(_mm_max_ps(b, zero), maxValue);
+    auto maxChannel = _mm_max_ps(r, _mm_max_ps(g, b));
+    // floor(log2(maxChannel))直接取指数位，不小于-B-1
+    auto exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxChannel), 23), _mm_set1_epi32(127));
+    auto lowerBound = _mm_set1_epi32(-16);
+    exponent = Select(_mm_cmplt_epi32(exponent, lowerBound), lowerBound, exponent);
+    auto sharedExponent = _mm_add_epi32(exponent, _mm_set1_epi32(16));
+    // 2^(B + N - sharedExponent)
+    auto scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(127 + 24), sharedExponent), 23));
+    auto half = _mm_set1_ps(0.5f);
+    auto maxMantissa = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxChannel, scale), half));
+    auto overflow = _mm_cmpeq_epi32(maxMantissa, _mm_set1_epi32(512));
+    sharedExponent = _mm_sub_epi32(sharedExponent, overflow);
+    auto overflowMask = _mm_castsi128_ps(overflow);
+    auto one = _mm_set1_ps(1.0f);
+    scale = _mm_mul_ps(scale, _mm_or_ps(_mm_and_ps(overflowMask, half), _mm_andnot_ps(overflowMask, one)));
+    auto rs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+    auto gs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+    auto bs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+    return _mm_or_si128(_mm_or_si128(rs, _mm_slli_epi32(gs, 9)),
+                        _mm_or_si128(_mm_slli_epi32(bs, 18), _mm_slli_epi32(sharedExponent, 27)));
+}
+#endif
+
+// 按块并行处理像素区间[begin, end)
+template <typename Function> void ForEachPixelBlock(size_t pixelCount, Function &&function)
+{
+    auto blockCount = (pixelCount + ConvertBlockPixels - 1) / ConvertBlockPixels;
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t{0}, blockCount, size_t{1}, [&](size_t block) {
+        auto begin = block * ConvertBlockPixels;
+        function(begin, std::min(begin + ConvertBlockPixels, pixelCount));
+    });
+    Thread::TaskManager::Run(taskflow);
+}
+} // namespace
 std::tuple<int, int, int, std::vector<uint8_t>> ImageUtil::LoadImage(const std::filesystem::path &path)
 {
     std::vector<uint8_t> imageData;
@@ -38,4 +120,131 @@ std::tuple<int, int, int, std::vector<uint8_t>> ImageUtil::LoadHDRImage(const st
     std::memcpy(byteData.data(), imageData.data(), byteData.size());
     return {width, height, channels, byteData};
 }
-} // namespace MEngine::Core::Utils
\ No newline at end of file
+std::vector<uint8_t> ImageUtil::ConvertRGBA32FToRGBA16F(const std::vector<uint8_t> &imageData)
+{
+    if (imageData.size() % (4 * sizeof(float)) != 0)
+    {
+        throw std::runtime_error("RGBA32F image data size is not a multiple of 16");
+    }
+    auto pixelCount = imageData.size() / (4 * sizeof(float));
+    std::vector<uint8_t> result(pixelCount * 4 * sizeof(uint16_t));
+    auto src = reinterpret_cast<const float *>(imageData.data());
+    auto dst = reinterpret_cast<uint16_t *>(result.data());
+    ForEachPixelBlock(pixelCount, [src, dst](size_t begin, size_t end) {
+        auto i = begin;
+#ifdef MENGINE_IMAGE_SSE
+        for (; i + 2 <= end; i += 2)
+        {
+            // 符号扩展后packs不会饱和
+            auto first = FloatToHalf4(_mm_loadu_ps(src + i * 4));
+            auto second = FloatToHalf4(_mm_loadu_ps(src + i * 4 + 4));
+            first = _mm_srai_epi32(_mm_slli_epi32(first, 16), 16);
+            second = _mm_srai_epi32(_mm_slli_epi32(second, 16), 16);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i * 4), _mm_packs_epi32(first, second));
+        }
+#endif
+        for (auto j = i * 4; j < end * 4; ++j)
+        {
+            dst[j] = FloatToHalf(src[j]);
+        }
+    });
+    return result;
+}
+std::vector<uint8_t> ImageUtil::ConvertRGBA32FToRGB9E5(const std::vector<uint8_t> &imageData)
+{
+    if (imageData.size() % (4 * sizeof(float)) != 0)
+    {
+        throw std::runtime_error("RGBA32F image data size is not a multiple of 16");
+    }
+    auto pixelCount = imageData.size() / (4 * sizeof(float));
+    std::vector<uint8_t> result(pixelCount * sizeof(uint32_t));
+    auto src = reinterpret_cast<const float *>(imageData.data());
+    auto dst = reinterpret_cast<uint32_t *>(result.data());
+    ForEachPixelBlock(pixelCount, [src, dst](size_t begin, size_t end) {
+        auto i = begin;
+#ifdef MENGINE_IMAGE_SSE
+        for (; i + 4 <= end; i += 4)
+        {
+            auto r = _mm_loadu_ps(src + i * 4);
+            auto g = _mm_loadu_ps(src + i * 4 + 4);
+            auto b = _mm_loadu_ps(src + i * 4 + 8);
+            auto a = _mm_loadu_ps(src + i * 4 + 12);
+            _MM_TRANSPOSE4_PS(r, g, b, a);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), PackRGB9E5x4(r, g, b));
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            dst[i] = PackRGB9E5(src[i * 4], src[i * 4 + 1], src[i * 4 + 2]);
+        }
+    });
+    return result;
+}
+uint16_t ImageUtil::FloatToHalf(float value)
+{
+    auto bits = std::bit_cast<uint32_t>(value);
+    auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+    if (bits > 0x7F800000)
+    {
+        return sign | 0x7E00;
+    }
+    // 舍入后不小于65520的值为Inf
+    if (bits > 0x477FEFFF)
+    {
+        return sign | 0x7C00;
+    }
+    if (bits < 0x38800000)
+    {
+        // 非规格化：加0.5f后由FPU完成舍入
+        auto rounded = std::bit_cast<uint32_t>(std::bit_cast<float>(bits) + 0.5f) - 0x3F000000;
+        return sign | static_cast<uint16_t>(rounded);
+    }
+    auto mantissaOdd = (bits >> 13) & 1;
+    bits += 0xC8000FFF + mantissaOdd;
+    return sign | static_cast<uint16_t>(bits >> 13);
+}
+float ImageUtil::HalfToFloat(uint16_t value)
+{
+    auto sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    auto exponent = static_cast<uint32_t>(value >> 10) & 0x1F;
+    auto mantissa = static_cast<uint32_t>(value) & 0x3FF;
+    if (exponent == 0)
+    {
+        auto magnitude = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -magnitude : magnitude;
+    }
+    if (exponent == 31)
+    {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+uint32_t ImageUtil::PackRGB9E5(float r, float g, float b)
+{
+    // NaN比较为false，夹紧为0
+    auto clampChannel = [](float value) { return value > 0.0f ? std::min(value, RGB9E5Max) : 0.0f; };
+    r = clampChannel(r);
+    g = clampChannel(g);
+    b = clampChannel(b);
+    auto maxChannel = std::max(r, std::max(g, b));
+    auto exponent = static_cast<int32_t>(std::bit_cast<uint32_t>(maxChannel) >> 23) - 127;
+    auto sharedExponent = std::max(exponent, -16) + 16;
+    auto scale = std::ldexp(1.0f, 24 - sharedExponent);
+    if (static_cast<uint32_t>(maxChannel * scale + 0.5f) == 512)
+    {
+        sharedExponent += 1;
+        scale *= 0.5f;
+    }
+    auto rs = static_cast<uint32_t>(r * scale + 0.5f);
+    auto gs = static_cast<uint32_t>(g * scale + 0.5f);
+    auto bs = static_cast<uint32_t>(b * scale + 0.5f);
+    return rs | (gs << 9) | (bs << 18) | (static_cast<uint32_t>(sharedExponent) << 27);
+}
+std::array<float, 3> ImageUtil::UnpackRGB9E5(uint32_t value)
+{
+    auto scale = std::ldexp(1.0f, static_cast<int>(value >> 27) - 24);
+    return {static_cast<float>(value & 0x1FF) * scale, static_cast<float>((value >> 9) & 0x1FF) * scale,
+            static_cast<float>((value >> 18) & 0x1FF) * scale};
+}
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,422 @@
+#include "MipmapGenerator.hpp"
+#include "TaskManager.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <stdexcept>
+#include <taskflow/algorithm/for_each.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <immintrin.h>
+#define MENGINE_MIPMAP_SSE 1
+#endif
+
+namespace MEngine::Core::Utils
+{
+namespace
+{
+// 滤波核半径，单位为目标像素
+constexpr float KaiserWidth = 3.0f;
+constexpr float KaiserAlpha = 4.0f;
+constexpr float LanczosWidth = 3.0f;
+
+float Sinc(float x)
+{
+    if (std::abs(x) < 1e-5f)
+    {
+        return 1.0f;
+    }
+    auto px = std::numbers::pi_v<float> * x;
+    return std::sin(px) / px;
+}
+float Bessel0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    for (int k = 1; k < 32; ++k)
+    {
+        auto t = x / (2.0f * static_cast<float>(k));
+        term *= t * t;
+        sum += term;
+        if (term < sum * 1e-8f)
+        {
+            break;
+        }
+    }
+    return sum;
+}
+float FilterRadius(MipmapFilter filter)
+{
+    switch (filter)
+    {
+    case MipmapFilter::Kaiser:
+        return KaiserWidth;
+    case MipmapFilter::Lanczos:
+        return LanczosWidth;
+    case MipmapFilter::Box:
+    default:
+        return 0.5f;
+    }
+}
+float FilterWeight(MipmapFilter filter, float x)
+{
+    x = std::abs(x);
+    switch (filter)
+    {
+    case MipmapFilter::Kaiser: {
+        if (x >= KaiserWidth)
+            return 0.0f;
+        auto r = x / KaiserWidth;
+        return Sinc(x) * Bessel0(KaiserAlpha * std::sqrt(1.0f - r * r)) / Bessel0(KaiserAlpha);
+    }
+    case MipmapFilter::Lanczos:
+        return x < LanczosWidth ? Sinc(x) * Sinc(x / LanczosWidth) : 0.0f;
+    case MipmapFilter::Box:
+    default:
+        return x < 0.5f ? 1.0f : 0.0f;
+    }
+}
+// 每个目标像素对应的源像素索引和权重
+struct FilterTaps
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> indices;
+    std::vector<float> weights;
+};
+FilterTaps BuildFilterTaps(uint32_t srcSize, uint32_t dstSize, const MipmapSetting &setting)
+{
+    FilterTaps taps{};
+    taps.offsets.resize(dstSize);
+    taps.counts.resize(dstSize);
+    auto scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+    auto support = FilterRadius(setting.filter) * scale;
+    for (uint32_t i = 0; i < dstSize; ++i)
+    {
+        auto center = (static_cast<float>(i) + 0.5f) * scale;
+        auto left = static_cast<int64_t>(std::floor(center - support));
+        auto right = static_cast<int64_t>(std::ceil(center + support));
+        auto offset = static_cast<uint32_t>(taps.indices.size());
+        float sum = 0.0f;
+        for (auto s = left; s <= right; ++s)
+        {
+            auto weight = FilterWeight(setting.filter, (static_cast<float>(s) + 0.5f - center) / scale);
+            if (weight == 0.0f)
+            {
+                continue;
+            }
+            auto size = static_cast<int64_t>(srcSize);
+            auto index = setting.wrap ? ((s % size) + size) % size : std::clamp<int64_t>(s, 0, size - 1);
+            taps.indices.push_back(static_cast<uint32_t>(index));
+            taps.weights.push_back(weight);
+            sum += weight;
+        }
+        auto count = static_cast<uint32_t>(taps.indices.size()) - offset;
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            taps.weights[offset + k] /= sum;
+        }
+        taps.offsets[i] = offset;
+        taps.counts[i] = count;
+    }
+    return taps;
+}
+const std::array<float, 256> &SRGBToLinearTable()
+{
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (int i = 0; i < 256; ++i)
+        {
+            auto c = static_cast<float>(i) / 255.0f;
+            t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return t;
+    }();
+    return table;
+}
+float LinearToSRGB(float c)
+{
+    c = std::clamp(c, 0.0f, 1.0f);
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+uint8_t ToUnorm8(float c)
+{
+    return static_cast<uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+} // namespace
+
+uint32_t MipmapGenerator::GetMipLevelCount(uint32_t width, uint32_t height)
+{
+    return static_cast<uint32_t>(std::floor(std::log2(std::max({width, height, 1u})))) + 1;
+}
+std::vector<MipLevelInfo> MipmapGenerator::GetMipLevels(uint32_t width, uint32_t height, uint32_t mipmapLevels,
+                                                        uint32_t bytesPerPixel)
+{
+    auto levelCount = GetMipLevelCount(width, height);
+    if (mipmapLevels != 0)
+    {
+        levelCount = std::min(levelCount, mipmapLevels);
+    }
+    std::vector<MipLevelInfo> levels(levelCount);
+    size_t offset = 0;
+    for (uint32_t level = 0; level < levelCount; ++level)
+    {
+        auto &info = levels[level];
+        info.width = std::max(1u, width >> level);
+        info.height = std::max(1u, height >> level);
+        info.offset = offset;
+        info.size = static_cast<size_t>(info.width) * info.height * bytesPerPixel;
+        offset += info.size;
+    }
+    return levels;
+}
+size_t MipmapGenerator::GetMipChainSize(uint32_t width, uint32_t height, uint32_t mipmapLevels,
+                                        uint32_t bytesPerPixel)
+{
+    auto levels = GetMipLevels(width, height, mipmapLevels, bytesPerPixel);
+    return levels.back().offset + levels.back().size;
+}
+std::vector<uint8_t> MipmapGenerator::GenerateRGBA8(const std::vector<uint8_t> &imageData, uint32_t width,
+                                                    uint32_t height, const MipmapSetting &setting)
+{
+    auto pixelCount = static_cast<size_t>(width) * height;
+    if (imageData.size() < pixelCount * 4)
+    {
+        throw std::runtime_error("Mipmap source data is smaller than width * height * 4");
+    }
+    auto isSRGB = setting.isSRGB && !setting.isNormalMap;
+    auto &srgbTable = SRGBToLinearTable();
+    std::vector<float> level0(pixelCount * 4);
+    for (size_t i = 0; i < pixelCount * 4; ++i)
+    {
+        auto isAlpha = (i & 3) == 3;
+        level0[i] = isSRGB && !isAlpha ? srgbTable[imageData[i]] : static_cast<float>(imageData[i]) / 255.0f;
+    }
+    auto levels = GenerateLevels(std::move(level0), width, height, setting);
+    auto targetCoverage =
+        setting.preserveAlphaCoverage ? ComputeAlphaCoverage(levels[0].data(), width, height, setting.alphaCutoff) : 0;
+
+    auto levelInfos = GetMipLevels(width, height, static_cast<uint32_t>(levels.size()), 4);
+    std::vector<uint8_t> result(levelInfos.back().offset + levelInfos.back().size);
+    // level 0 原样拷贝，避免量化误差
+    std::memcpy(result.data(), imageData.data(), levelInfos[0].size);
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        auto &info = levelInfos[level];
+        auto &pixels = levels[level];
+        float alphaScale = 1.0f;
+        if (setting.preserveAlphaCoverage)
+        {
+            alphaScale = FindAlphaScale(pixels.data(), info.width, info.height, setting.alphaCutoff, targetCoverage);
+        }
+        auto *dst = result.data() + info.offset;
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                dst[i + c] = ToUnorm8(isSRGB ? LinearToSRGB(pixels[i + c]) : pixels[i + c]);
+            }
+            dst[i + 3] = ToUnorm8(pixels[i + 3] * alphaScale);
+        }
+    }
+    return result;
+}
+std::vector<uint8_t> MipmapGenerator::GenerateRGBA32F(const std::vector<uint8_t> &imageData, uint32_t width,
+                                                      uint32_t height, const MipmapSetting &setting)
+{
+    auto pixelCount = static_cast<size_t>(width) * height;
+    if (imageData.size() < pixelCount * 4 * sizeof(float))
+    {
+        throw std::runtime_error("Mipmap source data is smaller than width * height * 16");
+    }
+    std::vector<float> level0(pixelCount * 4);
+    std::memcpy(level0.data(), imageData.data(), level0.size() * sizeof(float));
+    auto levels = GenerateLevels(std::move(level0), width, height, setting);
+    auto targetCoverage =
+        setting.preserveAlphaCoverage ? ComputeAlphaCoverage(levels[0].data(), width, height, setting.alphaCutoff) : 0;
+
+    auto levelInfos = GetMipLevels(width, height, static_cast<uint32_t>(levels.size()), 4 * sizeof(float));
+    std::vector<uint8_t> result(levelInfos.back().offset + levelInfos.back().size);
+    for (size_t level = 0; level < levels.size(); ++level)
+    {
+        auto &info = levelInfos[level];
+        auto &pixels = levels[level];
+        if (level > 0)
+        {
+            float alphaScale = 1.0f;
+            if (setting.preserveAlphaCoverage)
+            {
+                alphaScale =
+                    FindAlphaScale(pixels.data(), info.width, info.height, setting.alphaCutoff, targetCoverage);
+            }
+            // 负瓣可能产生负值
+            for (size_t i = 0; i < pixels.size(); i += 4)
+            {
+                pixels[i + 0] = std::max(pixels[i + 0], 0.0f);
+                pixels[i + 1] = std::max(pixels[i + 1], 0.0f);
+                pixels[i + 2] = std::max(pixels[i + 2], 0.0f);
+                pixels[i + 3] = std::clamp(pixels[i + 3] * alphaScale, 0.0f, 1.0f);
+            }
+        }
+        std::memcpy(result.data() + info.offset, pixels.data(), info.size);
+    }
+    return result;
+}
+float MipmapGenerator::ComputeAlphaCoverage(const float *pixels, uint32_t width, uint32_t height, float cutoff,
+                                            float scale)
+{
+    auto pixelCount = static_cast<size_t>(width) * height;
+    size_t covered = 0;
+    for (size_t i = 0; i < pixelCount; ++i)
+    {
+        if (pixels[i * 4 + 3] * scale > cutoff)
+        {
+            ++covered;
+        }
+    }
+    return static_cast<float>(covered) / static_cast<float>(pixelCount);
+}
+std::vector<std::vector<float>> MipmapGenerator::GenerateLevels(std::vector<float> &&level0, uint32_t width,
+                                                                uint32_t height, const MipmapSetting &setting)
+{
+    auto levelInfos = GetMipLevels(width, height, setting.mipmapLevels, 4);
+    std::vector<std::vector<float>> levels(levelInfos.size());
+    levels[0] = std::move(level0);
+    // 整条mip链一个taskflow，每级在subflow中按行并行，上一级完成后开始下一级
+    tf::Taskflow taskflow;
+    tf::Task previous;
+    for (size_t level = 1; level < levelInfos.size(); ++level)
+    {
+        auto task = taskflow.emplace([&, level](tf::Subflow &subflow) {
+            auto &src = levelInfos[level - 1];
+            auto &dst = levelInfos[level];
+            Downsample(subflow, levels[level - 1], src.width, src.height, levels[level], dst.width, dst.height,
+                       setting);
+            if (setting.isNormalMap)
+            {
+                RenormalizeNormals(levels[level]);
+            }
+        });
+        if (!previous.empty())
+        {
+            previous.precede(task);
+        }
+        previous = task;
+    }
+    Thread::TaskManager::Run(taskflow);
+    return levels;
+}
+void MipmapGenerator::Downsample(tf::Subflow &subflow, const std::vector<float> &src, uint32_t srcWidth,
+                                 uint32_t srcHeight, std::vector<float> &dst, uint32_t dstWidth, uint32_t dstHeight,
+                                 const MipmapSetting &setting)
+{
+    auto horizontalTaps = BuildFilterTaps(srcWidth, dstWidth, setting);
+    auto verticalTaps = BuildFilterTaps(srcHeight, dstHeight, setting);
+    std::vector<float> temp(static_cast<size_t>(dstWidth) * srcHeight * 4);
+    dst.assign(static_cast<size_t>(dstWidth) * dstHeight * 4, 0.0f);
+
+    // 水平方向: src(srcWidth x srcHeight) -> temp(dstWidth x srcHeight)
+    auto horizontal = subflow.for_each_index(0u, srcHeight, 1u, [&](uint32_t y) {
+        const float *srcRow = src.data() + static_cast<size_t>(y) * srcWidth * 4;
+        float *tempRow = temp.data() + static_cast<size_t>(y) * dstWidth * 4;
+        for (uint32_t x = 0; x < dstWidth; ++x)
+        {
+            auto offset = horizontalTaps.offsets[x];
+            auto count = horizontalTaps.counts[x];
+#ifdef MENGINE_MIPMAP_SSE
+            __m128 sum = _mm_setzero_ps();
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                __m128 weight = _mm_set1_ps(horizontalTaps.weights[offset + k]);
+                __m128 pixel = _mm_loadu_ps(srcRow + static_cast<size_t>(horizontalTaps.indices[offset + k]) * 4);
+                sum = _mm_add_ps(sum, _mm_mul_ps(weight, pixel));
+            }
+            _mm_storeu_ps(tempRow + static_cast<size_t>(x) * 4, sum);
+#else
+            float sum[4]{};
+            for (uint32_t k = 0; k < count; ++k)
+            {
+                auto weight = horizontalTaps.weights[offset + k];
+                const float *pixel = srcRow + static_cast<size_t>(horizontalTaps.indices[offset + k]) * 4;
+                for (int c = 0; c < 4; ++c)
+                    sum[c] += weight * pixel[c];
+            }
+            std::memcpy(tempRow + static_cast<size_t>(x) * 4, sum, sizeof(sum));
+#endif
+        }
+    });
+    // 垂直方向: temp(dstWidth x srcHeight) -> dst(dstWidth x dstHeight)，按整行累加以顺序访存
+    auto vertical = subflow.for_each_index(0u, dstHeight, 1u, [&](uint32_t y) {
+        float *dstRow = dst.data() + static_cast<size_t>(y) * dstWidth * 4;
+        auto offset = verticalTaps.offsets[y];
+        auto count = verticalTaps.counts[y];
+        auto rowLength = static_cast<size_t>(dstWidth) * 4;
+        for (uint32_t k = 0; k < count; ++k)
+        {
+            const float *tempRow = temp.data() + static_cast<size_t>(verticalTaps.indices[offset + k]) * rowLength;
+            auto weight = verticalTaps.weights[offset + k];
+            size_t i = 0;
+#ifdef MENGINE_MIPMAP_SSE
+            __m128 weight4 = _mm_set1_ps(weight);
+            for (; i + 8 <= rowLength; i += 8)
+            {
+                __m128 a = _mm_add_ps(_mm_loadu_ps(dstRow + i), _mm_mul_ps(weight4, _mm_loadu_ps(tempRow + i)));
+                __m128 b =
+                    _mm_add_ps(_mm_loadu_ps(dstRow + i + 4), _mm_mul_ps(weight4, _mm_loadu_ps(tempRow + i + 4)));
+                _mm_storeu_ps(dstRow + i, a);
+                _mm_storeu_ps(dstRow + i + 4, b);
+            }
+#endif
+            for (; i < rowLength; ++i)
+            {
+                dstRow[i] += weight * tempRow[i];
+            }
+        }
+    });
+    horizontal.precede(vertical);
+    // join时当前工作线程参与执行子任务，taps和temp在此之前保持有效
+    subflow.join();
+}
+float MipmapGenerator::FindAlphaScale(const float *pixels, uint32_t width, uint32_t height, float cutoff,
+                                      float targetCoverage)
+{
+    // 二分查找缩放系数，使覆盖率接近level 0
+    float low = 0.0f;
+    float high = 4.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        auto mid = (low + high) * 0.5f;
+        if (ComputeAlphaCoverage(pixels, width, height, cutoff, mid) < targetCoverage)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return (low + high) * 0.5f;
+}
+void MipmapGenerator::RenormalizeNormals(std::vector<float> &pixels)
+{
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        auto x = pixels[i + 0] * 2.0f - 1.0f;
+        auto y = pixels[i + 1] * 2.0f - 1.0f;
+        auto z = pixels[i + 2] * 2.0f - 1.0f;
+        auto length = std::sqrt(x * x + y * y + z * z);
+        if (length < 1e-6f)
+        {
+            x = 0.0f;
+            y = 0.0f;
+            z = 1.0f;
+            length = 1.0f;
+        }
+        pixels[i + 0] = x / length * 0.5f + 0.5f;
+        pixels[i + 1] = y / length * 0.5f + 0.5f;
+        pixels[i + 2] = z / length * 0.5f + 0.5f;
+    }
+}
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,276 @@
+#include "OcclusionCuller.hpp"
+#include "TaskManager.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <taskflow/algorithm/for_each.hpp>
+#include <utility>
+
+// MENGINE_OCCLUSION_AVX2由CMake在x86上定义，内核在OcclusionCullerAVX2.cpp中以AVX2编译
+#if defined(MENGINE_OCCLUSION_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace MEngine::Core::Utils
+{
+#if defined(MENGINE_OCCLUSION_AVX2)
+// 定义在OcclusionCullerAVX2.cpp
+void RasterizeSpanAVX2(float *depthRow, int beginX, int endX, const float *a, const float *rowEdge, float zA,
+                       float rowZ);
+#endif
+namespace
+{
+// w小于该值的顶点视为在近平面之后
+constexpr float NearW = 1e-4f;
+// 更新一行中[beginX, endX]内被覆盖像素的深度
+void RasterizeSpan(float *depthRow, int beginX, int endX, const std::array<float, 3> &a,
+                   const std::array<float, 3> &rowEdge, float zA, float rowZ)
+{
+    for (int x = beginX; x <= endX; ++x)
+    {
+        auto px = static_cast<float>(x) + 0.5f;
+        if (a[0] * px + rowEdge[0] >= 0.0f && a[1] * px + rowEdge[1] >= 0.0f && a[2] * px + rowEdge[2] >= 0.0f)
+        {
+            depthRow[x] = std::min(depthRow[x], zA * px + rowZ);
+        }
+    }
+}
+} // namespace
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height) : mAVX2Enabled(IsAVX2Supported())
+{
+    mTileCountX = std::max(1u, (width + TileSize - 1) / TileSize);
+    mTileCountY = std::max(1u, (height + TileSize - 1) / TileSize);
+    mWidth = mTileCountX * TileSize;
+    mHeight = mTileCountY * TileSize;
+    mDepth.assign(static_cast<size_t>(mWidth) * mHeight, 1.0f);
+    mTileMaxDepth.assign(static_cast<size_t>(mTileCountX) * mTileCountY, 1.0f);
+}
+void OcclusionCuller::BeginFrame(const glm::mat4 &viewProjection)
+{
+    mViewProjection = viewProjection;
+    mTriangles.clear();
+    std::ranges::fill(mDepth, 1.0f);
+    std::ranges::fill(mTileMaxDepth, 1.0f);
+    mStats = {};
+}
+void OcclusionCuller::AddOccluder(std::span<const glm::vec3> positions, std::span<const uint32_t> indices,
+                                  const glm::mat4 &modelMatrix)
+{
+    auto mvp = mViewProjection * modelMatrix;
+    auto width = static_cast<float>(mWidth);
+    auto height = static_cast<float>(mHeight);
+    mStats.occluderCount++;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+    {
+        std::array<glm::vec3, 3> vertices;
+        bool behindNear = false;
+        for (int k = 0; k < 3; ++k)
+        {
+            auto clip = mvp * glm::vec4(positions[indices[i + k]], 1.0f);
+            if (clip.w < NearW)
+            {
+                behindNear = true;
+                break;
+            }
+            auto ndc = glm::vec3(clip) / clip.w;
+            vertices[k] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z);
+        }
+        // 裁剪会让遮挡体变小，直接丢弃仍然保守
+        if (behindNear)
+        {
+            continue;
+        }
+        auto &v0 = vertices[0];
+        auto &v1 = vertices[1];
+        auto &v2 = vertices[2];
+        auto area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (std::abs(area) < 1e-6f)
+        {
+            continue;
+        }
+        // 两面都光栅化，统一为正面积
+        if (area < 0.0f)
+        {
+            std::swap(v1, v2);
+        }
+        auto maxX = std::max({v0.x, v1.x, v2.x});
+        auto minX = std::min({v0.x, v1.x, v2.x});
+        auto maxY = std::max({v0.y, v1.y, v2.y});
+        auto minY = std::min({v0.y, v1.y, v2.y});
+        if (maxX < 0.0f || maxY < 0.0f || minX > width || minY > height)
+        {
+            continue;
+        }
+        mTriangles.push_back({v0, v1, v2});
+        mStats.occluderTriangleCount++;
+    }
+}
+void OcclusionCuller::Rasterize()
+{
+    // 每个任务独占一行tile，不需要同步
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(0u, mTileCountY, 1u, [this](uint32_t tileY) { RasterizeTileRow(tileY); });
+    Thread::TaskManager::Run(taskflow);
+}
+void OcclusionCuller::RasterizeTileRow(uint32_t tileY)
+{
+    auto rowBegin = static_cast<int>(tileY * TileSize);
+    auto rowEnd = rowBegin + static_cast<int>(TileSize) - 1;
+    for (const auto &triangle : mTriangles)
+    {
+        const auto &v0 = triangle.v0;
+        const auto &v1 = triangle.v1;
+        const auto &v2 = triangle.v2;
+        // 像素中心(x + 0.5, y + 0.5)在三角形内时覆盖该像素
+        auto minY = std::max(rowBegin, static_cast<int>(std::ceil(std::min({v0.y, v1.y, v2.y}) - 0.5f)));
+        auto maxY = std::min(rowEnd, static_cast<int>(std::floor(std::max({v0.y, v1.y, v2.y}) - 0.5f)));
+        auto minX = std::max(0, static_cast<int>(std::ceil(std::min({v0.x, v1.x, v2.x}) - 0.5f)));
+        auto maxX =
+            std::min(static_cast<int>(mWidth) - 1, static_cast<int>(std::floor(std::max({v0.x, v1.x, v2.x}) - 0.5f)));
+        if (minY > maxY || minX > maxX)
+        {
+            continue;
+        }
+        // 边函数e_i = A_i * x + B_i * y + C_i，e_i为对边的有向面积，全部非负时在三角形内
+        std::array<float, 3> a{v1.y - v2.y, v2.y - v0.y, v0.y - v1.y};
+        std::array<float, 3> b{v2.x - v1.x, v0.x - v2.x, v1.x - v0.x};
+        std::array<float, 3> c{v1.x * v2.y - v1.y * v2.x, v2.x * v0.y - v2.y * v0.x, v0.x * v1.y - v0.y * v1.x};
+        // 深度在屏幕空间线性，z = zA * x + zB * y + zC
+        auto invArea = 1.0f / (c[0] + c[1] + c[2]);
+        auto zA = (a[0] * v0.z + a[1] * v1.z + a[2] * v2.z) * invArea;
+        auto zB = (b[0] * v0.z + b[1] * v1.z + b[2] * v2.z) * invArea;
+        auto zC = (c[0] * v0.z + c[1] * v1.z + c[2] * v2.z) * invArea;
+        // mWidth是8的倍数，按8对齐起点后整组读写都在行内
+        auto alignedMinX = minX & ~7;
+        for (int y = minY; y <= maxY; ++y)
+        {
+            auto py = static_cast<float>(y) + 0.5f;
+            float *depthRow = mDepth.data() + static_cast<size_t>(y) * mWidth;
+            std::array<float, 3> rowEdge{b[0] * py + c[0], b[1] * py + c[1], b[2] * py + c[2]};
+            auto rowZ = zB * py + zC;
+#if defined(MENGINE_OCCLUSION_AVX2)
+            if (mAVX2Enabled)
+            {
+                RasterizeSpanAVX2(depthRow, alignedMinX, maxX, a.data(), rowEdge.data(), zA, rowZ);
+                continue;
+            }
+#endif
+            RasterizeSpan(depthRow, alignedMinX, maxX, a, rowEdge, zA, rowZ);
+        }
+    }
+    // tile中最远的深度，比它更近的包围盒一定不被整个tile遮挡
+    for (uint32_t tileX = 0; tileX < mTileCountX; ++tileX)
+    {
+        float maxDepth = 0.0f;
+        for (uint32_t y = 0; y < TileSize; ++y)
+        {
+            const float *depthRow = mDepth.data() + static_cast<size_t>(rowBegin + y) * mWidth + tileX * TileSize;
+            for (uint32_t x = 0; x < TileSize; ++x)
+            {
+                maxDepth = std::max(maxDepth, depthRow[x]);
+            }
+        }
+        mTileMaxDepth[static_cast<size_t>(tileY) * mTileCountX + tileX] = maxDepth;
+    }
+}
+bool OcclusionCuller::IsAVX2Supported()
+{
+#if defined(MENGINE_OCCLUSION_AVX2) && defined(_MSC_VER) && !defined(__clang__)
+    static const bool supported = [] {
+        // 还需要OS保存了YMM寄存器状态
+        std::array<int, 4> info{};
+        __cpuid(info.data(), 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info.data(), 1);
+        constexpr int OSXSAVE = 1 << 27;
+        constexpr int AVX = 1 << 28;
+        if ((info[2] & OSXSAVE) == 0 || (info[2] & AVX) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+        __cpuidex(info.data(), 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#elif defined(MENGINE_OCCLUSION_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+bool OcclusionCuller::IsVisible(const OcclusionBounds &bounds) const
+{
+    auto mvp = mViewProjection * bounds.modelMatrix;
+    glm::vec2 screenMin{std::numeric_limits<float>::max()};
+    glm::vec2 screenMax{std::numeric_limits<float>::lowest()};
+    float nearestDepth = 1.0f;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        glm::vec3 corner{(i & 1) ? bounds.boundsMax.x : bounds.boundsMin.x,
+                         (i & 2) ? bounds.boundsMax.y : bounds.boundsMin.y,
+                         (i & 4) ? bounds.boundsMax.z : bounds.boundsMin.z};
+        auto clip = mvp * glm::vec4(corner, 1.0f);
+        if (clip.w < NearW)
+        {
+            return true;
+        }
+        auto ndc = glm::vec3(clip) / clip.w;
+        auto screen = glm::vec2((ndc.x * 0.5f + 0.5f) * mWidth, (ndc.y * 0.5f + 0.5f) * mHeight);
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z);
+    }
+    // 完全在屏幕外
+    if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= mWidth || screenMin.y >= mHeight)
+    {
+        return false;
+    }
+    // 包围盒覆盖的所有像素，向外取整保持保守
+    auto minX = static_cast<uint32_t>(std::max(0.0f, std::floor(screenMin.x)));
+    auto minY = static_cast<uint32_t>(std::max(0.0f, std::floor(screenMin.y)));
+    auto maxX = std::min(mWidth - 1, static_cast<uint32_t>(std::floor(screenMax.x)));
+    auto maxY = std::min(mHeight - 1, static_cast<uint32_t>(std::floor(screenMax.y)));
+    for (auto tileY = minY / TileSize; tileY <= maxY / TileSize; ++tileY)
+    {
+        for (auto tileX = minX / TileSize; tileX <= maxX / TileSize; ++tileX)
+        {
+            // 整个tile都比包围盒最近点更近
+            if (mTileMaxDepth[static_cast<size_t>(tileY) * mTileCountX + tileX] < nearestDepth)
+            {
+                continue;
+            }
+            auto y0 = std::max(minY, tileY * TileSize);
+            auto y1 = std::min(maxY, tileY * TileSize + TileSize - 1);
+            auto x0 = std::max(minX, tileX * TileSize);
+            auto x1 = std::min(maxX, tileX * TileSize + TileSize - 1);
+            for (auto y = y0; y <= y1; ++y)
+            {
+                const float *depthRow = mDepth.data() + static_cast<size_t>(y) * mWidth;
+                for (auto x = x0; x <= x1; ++x)
+                {
+                    if (depthRow[x] >= nearestDepth)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+void OcclusionCuller::TestVisibility(std::span<const OcclusionBounds> bounds, std::vector<uint8_t> &visible)
+{
+    visible.assign(bounds.size(), 1);
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(size_t{0}, bounds.size(), size_t{1},
+                            [this, bounds, &visible](size_t i) { visible[i] = IsVisible(bounds[i]) ? 1 : 0; });
+    Thread::TaskManager::Run(taskflow);
+    mStats.testedCount += static_cast<uint32_t>(bounds.size());
+    mStats.culledCount += static_cast<uint32_t>(std::ranges::count(visible, uint8_t{0}));
+}
+} // namespace MEngine::Core::Utils
@@ -0,0 +1,33 @@
+// 本文件在x86上以AVX2编译(见CMakeLists.txt)，只在OcclusionCuller::IsAVX2Supported()为true时调用。
+// 不包含带内联函数的头文件，避免链接时其它翻译单元选中这里生成的AVX2版本
+#if defined(MENGINE_OCCLUSION_AVX2)
+#include <immintrin.h>
+
+namespace MEngine::Core::Utils
+{
+// 与OcclusionCuller.cpp中的RasterizeSpan相同，一次处理8个像素，beginX按8对齐，行宽是8的倍数
+void RasterizeSpanAVX2(float *depthRow, int beginX, int endX, const float *a, const float *rowEdge, float zA,
+                       float rowZ)
+{
+    const __m256 laneOffset = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+    const __m256 zero = _mm256_setzero_ps();
+    for (int x = beginX; x <= endX; x += 8)
+    {
+        __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffset);
+        __m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a[0]), px), _mm256_set1_ps(rowEdge[0]));
+        __m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a[1]), px), _mm256_set1_ps(rowEdge[1]));
+        __m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(a[2]), px), _mm256_set1_ps(rowEdge[2]));
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+            _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+        if (_mm256_movemask_ps(inside) == 0)
+        {
+            continue;
+        }
+        __m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(zA), px), _mm256_set1_ps(rowZ));
+        __m256 depth = _mm256_loadu_ps(depthRow + x);
+        _mm256_storeu_ps(depthRow + x, _mm256_blendv_ps(depth, _mm256_min_ps(depth, z), inside));
+    }
+}
+} // namespace MEngine::Core::Utils
+#endif
@@ -23,10 +23,16 @@ shaderc::CompileOptions &ShaderUtils::GetCompileOptions()
     return options;
 }
 shaderc::SpvCompilationResult ShaderUtils::CompileShader(const std::string &source, shaderc_shader_kind kind,
-                                                         const std::string &name)
+                                                         const std::string &name,
+                                                         const std::vector<std::string> &macros)
 {
     shaderc::Compiler &compiler = GetCompiler();
-    shaderc::CompileOptions &options = GetCompileOptions();
+    // 宏定义只作用于本次编译，不修改共享的编译选项
+    shaderc::CompileOptions options = GetCompileOptions();
+    for (const auto &macro : macros)
+    {
+        options.AddMacroDefinition(macro);
+    }
 
     shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(source, kind, name.c_str(), options);
     if (result.GetCompilationStatus() != shaderc_compilation_status_success)
@@ -0,0 +1,101 @@
+#include "ShadowCascades.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace MEngine::Core::Utils
+{
+std::array<float, ShadowCascades::CascadeCount + 1> ShadowCascades::ComputeSplits(float nearPlane, float farPlane,
+                                                                                  float lambda)
+{
+    std::array<float, CascadeCount + 1> splits{};
+    for (uint32_t i = 0; i <= CascadeCount; ++i)
+    {
+        auto ratio = static_cast<float>(i) / static_cast<float>(CascadeCount);
+        auto logSplit = nearPlane * std::pow(farPlane / nearPlane, ratio);
+        auto uniformSplit = nearPlane + (farPlane - nearPlane) * ratio;
+        splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+    }
+    splits.front() = nearPlane;
+    splits.back() = farPlane;
+    return splits;
+}
+std::array<ShadowCascade, ShadowCascades::CascadeCount> ShadowCascades::ComputeCascades(
+    const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix, float nearPlane, float farPlane,
+    float shadowDistance, const glm::vec3 &lightDirection, uint32_t resolution, float casterDistance)
+{
+    // 整个视锥的近/远平面角点，各级的角点沿侧棱插值
+    auto inverseViewProjection = glm::inverse(projectionMatrix * viewMatrix);
+    std::array<glm::vec3, 4> nearCorners;
+    std::array<glm::vec3, 4> farCorners;
+    const std::array<glm::vec2, 4> ndcCorners{glm::vec2(-1.0f, -1.0f), glm::vec2(1.0f, -1.0f), glm::vec2(1.0f, 1.0f),
+                                              glm::vec2(-1.0f, 1.0f)};
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        auto nearCorner = inverseViewProjection * glm::vec4(ndcCorners[i], 0.0f, 1.0f);
+        auto farCorner = inverseViewProjection * glm::vec4(ndcCorners[i], 1.0f, 1.0f);
+        nearCorners[i] = glm::vec3(nearCorner) / nearCorner.w;
+        farCorners[i] = glm::vec3(farCorner) / farCorner.w;
+    }
+    auto splits = ComputeSplits(nearPlane, std::min(farPlane, shadowDistance), SplitLambda);
+    // 光源空间只包含旋转，级联中心的取整与相机位置无关
+    auto direction = glm::normalize(lightDirection);
+    auto up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    auto lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+    std::array<ShadowCascade, CascadeCount> cascades;
+    for (uint32_t cascadeIndex = 0; cascadeIndex < CascadeCount; ++cascadeIndex)
+    {
+        auto &cascade = cascades[cascadeIndex];
+        cascade.splitNear = splits[cascadeIndex];
+        cascade.splitFar = splits[cascadeIndex + 1];
+        auto nearT = (cascade.splitNear - nearPlane) / (farPlane - nearPlane);
+        auto farT = (cascade.splitFar - nearPlane) / (farPlane - nearPlane);
+        std::array<glm::vec3, 8> corners;
+        auto center = glm::vec3(0.0f);
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            auto edge = farCorners[i] - nearCorners[i];
+            corners[i] = nearCorners[i] + edge * nearT;
+            corners[i + 4] = nearCorners[i] + edge * farT;
+            center += corners[i] + corners[i + 4];
+        }
+        center /= 8.0f;
+        auto radius = 0.0f;
+        for (const auto &corner : corners)
+        {
+            radius = std::max(radius, glm::length(corner - center));
+        }
+        // 去掉浮点误差，相机旋转时半径不变
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        // 中心最多偏移半个取整步长，扩大范围后仍能包含整个切片
+        auto halfExtent = radius * static_cast<float>(SnapDivisions) / static_cast<float>(SnapDivisions - 1);
+        auto snap = 2.0f * halfExtent / static_cast<float>(SnapDivisions);
+        auto lightCenter = glm::round(glm::vec3(lightView * glm::vec4(center, 1.0f)) / snap) * snap;
+        // 观察方向为-z，近平面向光源方向延伸casterDistance以包含级联之外的投射者
+        auto projection = glm::ortho(lightCenter.x - halfExtent, lightCenter.x + halfExtent,
+                                     lightCenter.y - halfExtent, lightCenter.y + halfExtent,
+                                     -lightCenter.z - halfExtent - casterDistance, -lightCenter.z + halfExtent);
+        cascade.viewProjection = projection * lightView;
+        cascade.texelWorldSize = 2.0f * halfExtent / static_cast<float>(resolution);
+    }
+    return cascades;
+}
+bool ShadowCascades::Intersects(const glm::mat4 &viewProjection, const glm::vec3 &boundsMin,
+                                const glm::vec3 &boundsMax, const glm::mat4 &modelMatrix)
+{
+    auto matrix = viewProjection * modelMatrix;
+    auto clipMin = glm::vec3(std::numeric_limits<float>::max());
+    auto clipMax = glm::vec3(std::numeric_limits<float>::lowest());
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        auto corner = glm::vec3(i & 1 ? boundsMax.x : boundsMin.x, i & 2 ? boundsMax.y : boundsMin.y,
+                                i & 4 ? boundsMax.z : boundsMin.z);
+        // 正交投影，w恒为1
+        auto clip = glm::vec3(matrix * glm::vec4(corner, 1.0f));
+        clipMin = glm::min(clipMin, clip);
+        clipMax = glm::max(clipMax, clip);
+    }
+    return clipMax.x >= -1.0f && clipMin.x <= 1.0f && clipMax.y >= -1.0f && clipMin.y <= 1.0f && clipMax.z >= 0.0f &&
+           clipMin.z <= 1.0f;
+}
+} // namespace MEngine::Core::Utils
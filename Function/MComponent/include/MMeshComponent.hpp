@@ -10,6 +10,8 @@ struct MMeshComponent : public MComponent
 {
     UUID meshID;
     std::shared_ptr<MEngine::Core::Asset::MMesh> mesh;
+    // 参与CPU遮挡剔除的遮挡体，适合墙体等大而简单的网格
+    bool isOccluder = false;
 };
 
 } // namespace MEngine::Function::Component
\ No newline at end of file
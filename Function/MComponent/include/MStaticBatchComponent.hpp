@@ -0,0 +1,29 @@
+#pragma once
+#include "MComponent.hpp"
+#include <cstdint>
+#include <entt/entt.hpp>
+#include <glm/vec3.hpp>
+#include <vector>
+
+namespace MEngine::Function::Component
+{
+// 合并网格中一个源实体对应的索引区间，包围盒为世界空间
+struct MStaticBatchSection
+{
+    uint32_t firstIndex{0};
+    uint32_t indexCount{0};
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+};
+// 静态合批生成的实体，网格已变换到世界空间，sections[i]对应sources[i]
+struct MStaticBatchComponent : public MComponent
+{
+    std::vector<MStaticBatchSection> sections;
+    std::vector<entt::entity> sources;
+};
+// 已合并进静态批次的实体，渲染时跳过
+struct MStaticBatchedComponent : public MComponent
+{
+    entt::entity batch = entt::null;
+};
+} // namespace MEngine::Function::Component
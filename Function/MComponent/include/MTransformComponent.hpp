@@ -21,6 +21,8 @@ struct MTransformComponent : public MComponent
 
     glm::mat4 modelMatrix = glm::identity<glm::mat4>();
     bool dirty = true;
+    // 不会移动，可参与静态合批
+    bool isStatic = false;
 
     entt::entity parent = entt::null;
     std::vector<entt::entity> children;
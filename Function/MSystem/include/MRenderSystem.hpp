@@ -1,30 +1,88 @@
 #pragma once
+#include "BindlessManager.hpp"
+#include "DescriptorAllocator.hpp"
+#include "DynamicResolution.hpp"
+#include "GpuProfiler.hpp"
 #include "IMPipelineManager.hpp"
 #include "MLightComponent.hpp"
+#include "MMesh.hpp"
 #include "MPipeline.hpp"
 #include "MPipelineManager.hpp"
+#include "MStaticBatchComponent.hpp"
 #include "MSystem.hpp"
 #include "MTexture.hpp"
+#include "OcclusionCuller.hpp"
+#include "RenderGraph.hpp"
 #include "RenderPassManager.hpp"
+#include "RenderStatistics.hpp"
 #include "ResourceManager.hpp"
+#include "ShadowCascades.hpp"
+#include "UniformArena.hpp"
+#include "VMA.hpp"
 #include "VulkanContext.hpp"
 #include <array>
 #include <cstdint>
+#include <deque>
 #include <entt/entity/fwd.hpp>
 #include <glm/ext/vector_float3.hpp>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace MEngine::Function::System
 {
+struct DepthPrepassStats
+{
+    uint64_t shadedFragments{0}; // 前向不透明物体的fragment shader调用次数
+    float overdraw{0.0f};        // shadedFragments / 渲染区域像素数，开启预渲染时接近覆盖率
+};
+struct HiZCullingStats
+{
+    uint32_t drawCount{0};
+    uint32_t firstPhaseCount{0};  // 上一帧Hi-Z判定可见，先绘制
+    uint32_t secondPhaseCount{0}; // 本帧Hi-Z判定新出现的物体，补绘制
+    inline uint32_t GetCulledCount() const
+    {
+        return drawCount - firstPhaseCount - secondPhaseCount;
+    }
+    inline float GetCulledPercentage() const
+    {
+        return drawCount == 0 ? 0.0f : 100.0f * static_cast<float>(GetCulledCount()) / static_cast<float>(drawCount);
+    }
+};
+struct TiledLightingStats
+{
+    uint32_t tileCount{0};
+    uint32_t backgroundTileCount{0}; // 整个tile都是背景，跳过光照
+    uint32_t tileLightCount{0};      // 所有tile的光源数之和
+    inline float GetAverageLightsPerTile() const
+    {
+        auto litTileCount = tileCount - backgroundTileCount;
+        return litTileCount == 0 ? 0.0f : static_cast<float>(tileLightCount) / static_cast<float>(litTileCount);
+    }
+    inline float GetBackgroundPercentage() const
+    {
+        return tileCount == 0 ? 0.0f
+                              : 100.0f * static_cast<float>(backgroundTileCount) / static_cast<float>(tileCount);
+    }
+};
+struct ShadowStats
+{
+    uint32_t cachedCascadeCount{0}; // 直接沿用atlas的级联
+    uint32_t staticRedrawCount{0};  // 重绘静态缓存的级联
+    uint32_t staticDrawCount{0};
+    uint32_t dynamicDrawCount{0};
+};
 class MRenderSystem final : public MSystem
 {
   private:
     std::shared_ptr<VulkanContext> mVulkanContext;
     std::shared_ptr<IMPipelineManager> mPipelineManager;
     std::shared_ptr<RenderPassManager> mRenderPassManager;
+    std::shared_ptr<BindlessManager> mBindlessManager;
+    std::shared_ptr<DescriptorAllocator> mDescriptorAllocator;
 
   private:
     uint32_t mFrameCount{1};
@@ -33,22 +91,24 @@ class MRenderSystem final : public MSystem
     std::vector<vk::UniqueFence> mInFlightFences;
     std::vector<vk::Semaphore> mImageAvailableSemaphores;
     std::vector<vk::UniqueSemaphore> mRenderFinishedSemaphores;
+    // 异步计算: 第一阶段Hi-Z剔除在独立的compute队列上执行，与本帧的阴影pass并行
+    // compute提交等待上一帧graphics提交(Hi-Z生成)，graphics提交在indirect draw之前等待compute提交
+    bool mAsyncComputeEnabled{true};
+    bool mAsyncComputeRecorded{false};
+    std::vector<uint32_t> mAsyncComputeQueueFamilies; // 两个队列共同访问的资源使用concurrent模式，为空时独占
+    std::vector<vk::UniqueCommandBuffer> mComputeCommandBuffers;
+    std::vector<vk::UniqueSemaphore> mComputeFinishedSemaphores;
+    std::vector<vk::UniqueSemaphore> mGraphicsFinishedSemaphores;
+    vk::Semaphore mPendingGraphicsSemaphore{}; // 已发出signal但尚未被等待的graphics信号量
     std::unordered_map<RenderPassType, std::unordered_map<std::shared_ptr<MPipeline>, std::vector<entt::entity>>>
         mRenderQueue;
     struct RenderTarget
     {
         uint32_t width{1280};
         uint32_t height{720};
-        // Render target 0: Color
+        // Render target 0: Color，每个in-flight帧一份，之后在Viewport中采样
         std::shared_ptr<MTexture> colorTexture;
-        // Render target 1: Depth/Stencil
-        std::shared_ptr<MTexture> depthStencilTexture;
-        // Render target 2: Normal
-        std::shared_ptr<MTexture> normalTexture;
-        // Render target 3: ARM (Ambient Occlusion, Roughness, Metallic)
-        std::shared_ptr<MTexture> armTexture;
-        // Render target 4: WorldPos
-        std::shared_ptr<MTexture> worldPosTexture;
+        // Render target 1-4: Depth/Stencil, Normal, ARM, WorldPos由mRenderGraph作为transient分配，各帧共享
         // Render target 5: Emissive
         // Asset::MTexture emissiveTexture;
         // vk::ClearValue emissiveClearValue{vk::ClearColorValue(std::array<float, 4>{0.0f, 0.0f, 0.0f, 1.0f})};
@@ -69,16 +129,41 @@ class MRenderSystem final : public MSystem
         }
     };
     std::vector<RenderTarget> mRenderTargets;
+    std::unique_ptr<RenderGraph> mRenderGraph;
+    // framebuffer引用color和render graph的transient，两者任一被替换时重建
     std::vector<vk::UniqueFramebuffer> mFramebuffers;
+    std::vector<std::pair<uint64_t, uint64_t>> mFramebufferVersions; // render target, render graph
+    // 最近用过的几种尺寸的render target，来回切换尺寸时直接复用
+    struct RenderTargetSet
+    {
+        std::vector<RenderTarget> renderTargets;
+    };
+    static constexpr uint32_t RenderTargetPoolSize = 3;
+    static constexpr uint32_t RenderTargetAlignment = 64;
+    static constexpr uint32_t ResizeDebounceFrames = 8;
+    std::deque<RenderTargetSet> mRenderTargetPool; // front为最近使用
+    vk::Extent2D mRequestedExtent{1280, 720};
+    vk::Extent2D mRenderExtent{1280, 720}; // 实际渲染区域，可以小于render target
+    vk::Extent2D mOutputExtent{1280, 720}; // 分辨率缩放前的渲染区域，显示时拉伸到该尺寸
+    uint32_t mStableFrames{0};
+    // 动态分辨率: 在该帧的fence之后读取整帧的GPU时间，按控制器的缩放比例缩小下一帧的渲染区域，
+    // render target不重新分配
+    Core::Utils::DynamicResolutionController mDynamicResolution;
+    float mGpuFrameMs{0.0f};
+    // GPU分段计时: 整帧一个zone，render graph的每个pass一个zone，编辑器UI可以在同一帧内继续记录
+    static constexpr const char *FrameZoneName = "Frame";
+    std::unique_ptr<GpuProfiler> mGpuProfiler;
+    uint32_t mFrameZone{GpuProfiler::InvalidZone};
+    std::unique_ptr<RenderStatistics> mRenderStatistics;
+    vk::DeviceSize mTextureUploadedBytes{0}; // 上一帧结束时纹理的累计上传量
+    uint64_t mRenderTargetVersion{0};
 
     entt::entity mMainCameraEntity{};
-    std::vector<vk::UniqueDescriptorSet> mGlobalDescriptorSets;
-    vk::Buffer mCameraUBO;
-    VmaAllocation mCameraUBOAllocation;
-    VmaAllocationInfo mCameraUBOAllocationInfo;
-    vk::Buffer mLightUBO;
-    VmaAllocation mLightUBOAllocation;
-    VmaAllocationInfo mLightUBOAllocationInfo;
+    // 全局描述符集只写入一次，相机和光照数据每帧写入mUniformArena，绑定时通过dynamic offset切换
+    static constexpr vk::DeviceSize UniformArenaBytesPerFrame = 64 * 1024;
+    std::unique_ptr<UniformArena> mUniformArena;
+    vk::UniqueDescriptorSet mGlobalDescriptorSet;
+    std::array<uint32_t, 3> mGlobalDynamicOffsets{}; // camera, light, shadow
     struct CameraParameters
     {
         alignas(16) glm::vec3 Position = glm::vec3(0.0f);
@@ -86,6 +171,8 @@ class MRenderSystem final : public MSystem
         alignas(16) glm::mat4 ProjectionMatrix = glm::identity<glm::mat4>();
         alignas(16) glm::mat4 ViewMatrix = glm::identity<glm::mat4>();
     } mCameraParameters{};
+    float mCameraNearPlane{0.1f};
+    float mCameraFarPlane{1000.0f};
     static constexpr uint32_t MAX_LIGHT_COUNT = 6;
     struct LightParameters
     {
@@ -111,37 +198,259 @@ class MRenderSystem final : public MSystem
     std::shared_ptr<MTexture> mEnvironmentMap;
     std::shared_ptr<MTexture> mIrradianceMap;
     std::shared_ptr<MTexture> mBRDFLUT;
+    // 深度预渲染: 先用position顶点流写入深度，前向不透明物体再以eEqual深度测试着色
+    bool mDepthPrepassEnabled{true};
+    // 每个in-flight帧一个fragment shader调用次数的query，在该帧的fence之后读取
+    vk::UniqueQueryPool mOverdrawQueryPool;
+    std::vector<uint64_t> mOverdrawPixelCounts; // 为0表示该帧没有写入query
+    DepthPrepassStats mDepthPrepassStats{};
+    // Batch前把isOccluder的网格光栅化到CPU深度缓冲，剔除被完全遮挡的物体
+    bool mOcclusionCullingEnabled{true};
+    std::unique_ptr<Core::Utils::OcclusionCuller> mOcclusionCuller;
+    Core::Utils::OcclusionCullerStats mOcclusionCullingStats{};
+    // 静态批次本帧可见的索引区间，逐段剔除后相邻的段合并为一次绘制；没有记录时绘制整个网格
+    std::unordered_map<entt::entity, std::vector<Component::MStaticBatchSection>> mStaticBatchRanges;
+    // GPU Hi-Z遮挡剔除，只作用于前向不透明物体，每个物体(静态批次为每个可见区间)对应一条drawIndexedIndirect:
+    // 第一阶段用上一帧的Hi-Z和相机选出物体并绘制，然后由本帧深度生成Hi-Z，
+    // 第二阶段用新的Hi-Z测试第一阶段未绘制的物体，在composition load render pass中补绘制，避免遮挡解除时物体闪现
+    struct HiZDrawData
+    {
+        glm::vec4 boundsMin;
+        glm::vec4 boundsMax;
+        glm::mat4 modelMatrix;
+    };
+    struct HiZFrameBuffers
+    {
+        vk::Buffer drawBuffer{};
+        VmaAllocation drawAllocation{};
+        VmaAllocationInfo drawAllocationInfo{};
+        vk::Buffer commandBuffer{}; // 两个阶段各drawCount条命令，instanceCount由HiZCull.comp写入
+        VmaAllocation commandAllocation{};
+        VmaAllocationInfo commandAllocationInfo{};
+        uint32_t capacity{0};
+        uint32_t drawCount{0};
+    };
+    bool mHiZCullingEnabled{true};
+    bool mHiZSupported{false}; // 深度格式支持采样，分块延迟光照同样需要
+    vk::Image mHiZImage{};
+    VmaAllocation mHiZAllocation{};
+    vk::UniqueImageView mHiZImageView;
+    std::vector<vk::UniqueImageView> mHiZMipImageViews;
+    vk::Extent2D mHiZExtent{0, 0};
+    uint32_t mHiZLevelCount{0};
+    vk::ImageLayout mHiZLayout{vk::ImageLayout::eUndefined};
+    // 生成当前Hi-Z时的相机和视口，下一帧第一阶段按此投影
+    bool mHiZValid{false};
+    glm::mat4 mHiZViewProjection{1.0f};
+    vk::Extent2D mHiZViewport{0, 0};
+    vk::UniqueImageView mDepthSampledImageView; // 只包含depth aspect，随render graph的transient重建
+    uint64_t mDepthSampledImageViewVersion{0};
+    std::vector<HiZFrameBuffers> mHiZFrameBuffers;
+    std::unordered_map<entt::entity, uint32_t> mHiZDraws; // 物体的第一条命令在本阶段命令中的序号
+    uint32_t mHiZPhase{0};
+    HiZCullingStats mHiZCullingStats{};
+    // 分块延迟光照: 保存G-buffer后由compute pass按16x16 tile的深度范围剔除光源并着色，替代全屏lighting subpass，
+    // 背景tile直接跳过。需要深度可以采样
+    static constexpr uint32_t LightingTileSize = 16;
+    bool mTiledLightingEnabled{true};
+    struct TiledLightingStatsBuffer
+    {
+        vk::Buffer buffer{};
+        VmaAllocation allocation{};
+        VmaAllocationInfo allocationInfo{};
+    };
+    std::vector<TiledLightingStatsBuffer> mTiledLightingStatsBuffers;
+    TiledLightingStats mTiledLightingStats{};
+    // 级联阴影: 第一个平行光的4级级联按2x2排列在一张atlas中。静态投射者渲染到同样大小的缓存，
+    // 只在级联矩阵或静态投射者变化时重绘；需要更新的级联先从缓存复制到atlas再叠加动态投射者，
+    // 没有动态投射者的级联直接沿用上一帧的atlas
+    static constexpr uint32_t ShadowAtlasSize = 4096;
+    static constexpr uint32_t ShadowCascadeSize = ShadowAtlasSize / 2;
+    static constexpr float ShadowDistance = 100.0f;
+    static constexpr float ShadowCasterDistance = 100.0f; // 级联之外朝向光源仍然投射阴影的距离
+    static constexpr uint32_t ShadowCascadeCount = Core::Utils::ShadowCascades::CascadeCount;
+    static_assert(ShadowCascadeCount == 4, "Shadow atlas and shaders assume 4 cascades");
+    struct ShadowParameters
+    {
+        alignas(16) std::array<glm::mat4, ShadowCascadeCount> CascadeViewProjections{};
+        alignas(16) glm::mat4 InverseViewMatrix = glm::identity<glm::mat4>();
+        alignas(16) glm::vec4 CascadeSplits = glm::vec4(0.0f); // 每级的远端距离
+        alignas(16) glm::vec4 CascadeTexelSizes = glm::vec4(0.0f);
+        int LightIndex = -1; // 为-1时不计算阴影
+        float AtlasTexelSize = 1.0f / static_cast<float>(ShadowAtlasSize);
+    } mShadowParameters{};
+    struct ShadowMap
+    {
+        vk::Image image{};
+        VmaAllocation allocation{};
+        vk::UniqueImageView imageView;
+        vk::UniqueFramebuffer framebuffer;
+        vk::ImageLayout layout{vk::ImageLayout::eUndefined};
+    };
+    bool mShadowsEnabled{true};
+    ShadowMap mShadowAtlas;
+    ShadowMap mShadowCache;
+    vk::UniqueSampler mShadowSampler;
+    std::array<Core::Utils::ShadowCascade, ShadowCascadeCount> mShadowCascades{};
+    std::array<bool, ShadowCascadeCount> mShadowCacheValid{};
+    std::array<std::size_t, ShadowCascadeCount> mShadowStaticSignatures{}; // 静态投射者及其变换的哈希
+    std::array<bool, ShadowCascadeCount> mShadowHadDynamic{};              // atlas中包含动态投射者
+    std::array<std::vector<entt::entity>, ShadowCascadeCount> mShadowStaticCasters;
+    std::array<std::vector<entt::entity>, ShadowCascadeCount> mShadowDynamicCasters;
+    uint32_t mShadowStaticRedrawMask{0};
+    uint32_t mShadowRefreshMask{0};
+    ShadowStats mShadowStats{};
 
   public:
+    // 在该帧的fence之后记录的GPU整帧时间，单位毫秒
+    static constexpr const char *GpuFrameMetric = "render.gpu_frame_ms";
     MRenderSystem(std::shared_ptr<VulkanContext> context, std::shared_ptr<entt::registry> registry,
                   std::shared_ptr<ResourceManager> resourceManager,
                   std::shared_ptr<RenderPassManager> renderPassManager,
-                  std::shared_ptr<IMPipelineManager> pipelineManager)
+                  std::shared_ptr<IMPipelineManager> pipelineManager,
+                  std::shared_ptr<BindlessManager> bindlessManager,
+                  std::shared_ptr<DescriptorAllocator> descriptorAllocator)
         : MSystem(registry, resourceManager), mVulkanContext(context), mRenderPassManager(renderPassManager),
-          mPipelineManager(pipelineManager)
+          mPipelineManager(pipelineManager), mBindlessManager(bindlessManager),
+          mDescriptorAllocator(descriptorAllocator)
     {
     }
     ~MRenderSystem() override = default;
     void Init() override;
     void Update(float deltaTime) override;
     void Shutdown() override;
+    // 立即切换到指定尺寸的render target
     void ReSizeFrameBuffer(uint32_t width, uint32_t height);
+    // 交互式调整尺寸时每帧调用，尺寸稳定ResizeDebounceFrames帧后才重新分配render target，
+    // 在此之前保持宽高比渲染到现有render target的左上角
+    void RequestExtent(uint32_t width, uint32_t height);
     inline void SetFrameCount(uint32_t count)
     {
         mFrameCount = count;
     }
+    // Init前设置初始尺寸
     void SetExtent(uint32_t width, uint32_t height)
     {
-        for (auto &renderTarget : mRenderTargets)
-        {
-            renderTarget.width = width;
-            renderTarget.height = height;
-        }
+        mRequestedExtent = vk::Extent2D{width, height};
+        mRenderExtent = mRequestedExtent;
+        mOutputExtent = mRequestedExtent;
+    }
+    inline vk::Extent2D GetRenderExtent() const
+    {
+        return mRenderExtent;
+    }
+    inline vk::Extent2D GetOutputExtent() const
+    {
+        return mOutputExtent;
+    }
+    void SetDynamicResolutionSetting(const Core::Utils::DynamicResolutionSetting &setting);
+    inline const Core::Utils::DynamicResolutionSetting &GetDynamicResolutionSetting() const
+    {
+        return mDynamicResolution.GetSetting();
+    }
+    inline float GetResolutionScale() const
+    {
+        return mDynamicResolution.GetScale();
+    }
+    // 在该帧的fence之后读取，落后mFrameCount帧；设备不支持timestamp时为0
+    inline float GetGpuFrameMs() const
+    {
+        return mGpuFrameMs;
+    }
+    inline GpuProfiler &GetGpuProfiler()
+    {
+        return *mGpuProfiler;
+    }
+    // 每帧按pass统计的draw call、绑定次数等，开启pipeline statistics时会停止overdraw统计
+    inline RenderStatistics &GetRenderStatistics()
+    {
+        return *mRenderStatistics;
+    }
+    // render target被替换时递增，外部持有的image view需要随之更新
+    inline uint64_t GetRenderTargetVersion() const
+    {
+        return mRenderTargetVersion;
     }
     inline RenderTarget &GetRenderTarget(uint32_t index)
     {
         return mRenderTargets[index];
     }
+    inline const RenderGraphStats &GetRenderGraphStats() const
+    {
+        return mRenderGraph->GetStats();
+    }
+    inline void SetDepthPrepassEnabled(bool enabled)
+    {
+        mDepthPrepassEnabled = enabled;
+    }
+    inline bool IsDepthPrepassEnabled() const
+    {
+        return mDepthPrepassEnabled;
+    }
+    inline void SetOcclusionCullingEnabled(bool enabled)
+    {
+        mOcclusionCullingEnabled = enabled;
+    }
+    inline bool IsOcclusionCullingEnabled() const
+    {
+        return mOcclusionCullingEnabled;
+    }
+    inline const Core::Utils::OcclusionCullerStats &GetOcclusionCullingStats() const
+    {
+        return mOcclusionCullingStats;
+    }
+    inline void SetHiZCullingEnabled(bool enabled)
+    {
+        mHiZCullingEnabled = enabled;
+    }
+    inline bool IsHiZCullingEnabled() const
+    {
+        return mHiZCullingEnabled && mHiZSupported;
+    }
+    inline void SetAsyncComputeEnabled(bool enabled)
+    {
+        mAsyncComputeEnabled = enabled;
+    }
+    // 没有独立的compute family时所有计算都记录在graphics命令缓冲区中
+    inline bool IsAsyncComputeEnabled() const
+    {
+        return mAsyncComputeEnabled && !mAsyncComputeQueueFamilies.empty();
+    }
+    // 在该帧的fence之后读取，落后mFrameCount帧
+    inline const HiZCullingStats &GetHiZCullingStats() const
+    {
+        return mHiZCullingStats;
+    }
+    inline void SetTiledLightingEnabled(bool enabled)
+    {
+        mTiledLightingEnabled = enabled;
+    }
+    inline bool IsTiledLightingEnabled() const
+    {
+        return mTiledLightingEnabled && mHiZSupported;
+    }
+    // 在该帧的fence之后读取，落后mFrameCount帧
+    inline const TiledLightingStats &GetTiledLightingStats() const
+    {
+        return mTiledLightingStats;
+    }
+    inline void SetShadowsEnabled(bool enabled)
+    {
+        mShadowsEnabled = enabled;
+    }
+    inline bool IsShadowsEnabled() const
+    {
+        return mShadowsEnabled;
+    }
+    inline const ShadowStats &GetShadowStats() const
+    {
+        return mShadowStats;
+    }
+    // 设备不支持pipeline statistics query时shadedFragments和overdraw为0
+    inline const DepthPrepassStats &GetDepthPrepassStats() const
+    {
+        return mDepthPrepassStats;
+    }
     inline vk::Semaphore GetRenderFinishedSemaphore(uint32_t index) const
     {
         return mRenderFinishedSemaphores[index].get();
@@ -152,18 +461,62 @@ class MRenderSystem final : public MSystem
     }
 
   private:
-    // void RenderShadowPass();
-    void CreateRenderTarget();
-    void CreateFramebuffer();
+    void CreateRenderTarget(uint32_t width, uint32_t height);
+    void BuildRenderGraph();
+    void BeginCompositionRenderPass(vk::CommandBuffer commandBuffer, vk::RenderPass renderPass);
+    void ScenePass(vk::CommandBuffer commandBuffer);
+    void GBufferScenePass(vk::CommandBuffer commandBuffer);
+    void TiledLightingPass(vk::CommandBuffer commandBuffer, vk::Image depthImage,
+                           const std::array<vk::ImageView, 3> &gBufferViews);
+    void ForwardScenePass(vk::CommandBuffer commandBuffer);
+    void ReadTiledLightingStats();
+    void CreateShadowMaps();
+    void DestroyShadowMaps();
+    void UpdateShadows();
+    void BeginShadowRenderPass(vk::CommandBuffer commandBuffer, const ShadowMap &shadowMap);
+    void ShadowStaticPass(vk::CommandBuffer commandBuffer);
+    void ShadowCopyPass(vk::CommandBuffer commandBuffer);
+    void ShadowDynamicPass(vk::CommandBuffer commandBuffer);
+    void DrawShadowCasters(vk::CommandBuffer commandBuffer, uint32_t cascadeIndex,
+                           const std::vector<entt::entity> &entities);
+    vk::ImageView GetDepthSampledImageView(vk::Image depthImage);
+    void SetViewportAndScissor(vk::CommandBuffer commandBuffer);
+    void CreateHiZPyramid(uint32_t width, uint32_t height);
+    void DestroyHiZPyramid();
+    void DestroyHiZFrameBuffers(HiZFrameBuffers &frameBuffers);
+    void UpdateHiZDraws();
+    void HiZCullPass(vk::CommandBuffer commandBuffer, uint32_t phase);
+    void RecordAsyncCompute();
+    void SubmitAsyncCompute();
+    void HiZBuildPass(vk::CommandBuffer commandBuffer, vk::Image depthImage);
+    void LateScenePass(vk::CommandBuffer commandBuffer);
+    void ReadHiZCullingStats();
+    void DrawMesh(vk::CommandBuffer commandBuffer, entt::entity entity, const std::shared_ptr<MMesh> &mesh);
+    void UseRenderTargets(uint32_t width, uint32_t height);
+    void RetireRenderTargets(RenderTargetSet &renderTargetSet);
     void CreateEnvironmentMap();
+    void WaitForFrame();
+    void UpdateCamera();
+    void CullOccluded(std::vector<entt::entity> &entities);
     void Batch();
     void Prepare();
+    void UpdateTextureStreaming();
     void GBufferPass();
     void LightingPass();
+    void DepthPrepass(vk::CommandBuffer commandBuffer);
     void RenderForwardCompositePass();
+    void ReadOverdrawStats();
+    void ReadGpuFrameTime();
+    void RecordMetrics();
+    void ApplyResolutionScale();
     void RenderSkyPass();
     void End();
-    void WriteGlobalDescriptorSet(uint32_t globalDescriptorSetIndex);
+    void WriteGlobalDescriptorSet();
+    void UpdateGlobalUniforms();
+    void BindPipeline(vk::CommandBuffer commandBuffer, const std::shared_ptr<MPipeline> &pipeline,
+                      bool depthEqual = false);
+    void BindMaterial(vk::CommandBuffer commandBuffer, const std::shared_ptr<MPipeline> &pipeline,
+                      const std::shared_ptr<MMaterial> &material, const glm::mat4 &modelMatrix);
     // void RenderPostProcessPass();
 };
 } // namespace MEngine::Function::System
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "MCameraSystem.hpp"
+#include "CpuProfiler.hpp"
 #include "MCameraComponent.hpp"
 #include "MTransformComponent.hpp"
 #include <entt/entt.hpp>
@@ -12,6 +13,7 @@ void MCameraSystem::Init()
 }
 void MCameraSystem::Update(float deltaTime)
 {
+    MENGINE_PROFILE_ZONE("MCameraSystem::Update");
     auto view = mRegistry->view<MCameraComponent, MTransformComponent>();
     for (auto entity : view)
     {
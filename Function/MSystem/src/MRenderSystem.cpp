@@ -1,25 +1,47 @@
 #include "MRenderSystem.hpp"
+#include "CpuProfiler.hpp"
+#include "HiZPyramid.hpp"
 #include "IMTextureManager.hpp"
 #include "Logger.hpp"
 #include "MCameraComponent.hpp"
 #include "MMaterialComponent.hpp"
 #include "MMeshComponent.hpp"
+#include "MPBRMaterial.hpp"
 #include "MPipeline.hpp"
 #include "MPipelineManager.hpp"
 #include "MTexture.hpp"
 #include "MTransformComponent.hpp"
 #include "MTransformSystem.hpp"
+#include "Metrics.hpp"
 #include "VulkanContext.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <glm/fwd.hpp>
+#include <optional>
 #include <vector>
 namespace MEngine::Function::System
 {
+namespace
+{
+// 级联在atlas中按2x2排列，与着色器中的tile偏移一致
+vk::Rect2D GetShadowCascadeRegion(uint32_t cascadeIndex, uint32_t cascadeSize)
+{
+    return vk::Rect2D{{static_cast<int32_t>(cascadeIndex % 2 * cascadeSize),
+                       static_cast<int32_t>(cascadeIndex / 2 * cascadeSize)},
+                      {cascadeSize, cascadeSize}};
+}
+} // namespace
 void MRenderSystem::Init()
 {
-    CreateRenderTarget();
-    CreateFramebuffer();
+    CreateRenderTarget(mRenderExtent.width, mRenderExtent.height);
+    mRenderGraph = std::make_unique<RenderGraph>(mVulkanContext);
+    mOcclusionCuller = std::make_unique<Core::Utils::OcclusionCuller>();
+    mFramebuffers.resize(mFrameCount);
+    mFramebufferVersions.resize(mFrameCount);
     CreateEnvironmentMap();
     mImageAvailableSemaphores.resize(mFrameCount);
     mRenderFinishedSemaphores.resize(mFrameCount);
@@ -40,113 +62,1111 @@ void MRenderSystem::Init()
 
         vk::SemaphoreCreateInfo semaphoreCreateInfo;
         mRenderFinishedSemaphores[i] = mVulkanContext->GetDevice().createSemaphoreUnique(semaphoreCreateInfo);
-
-        vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
-        auto globalDescriptorSetLayouts =
-            std::vector<vk::DescriptorSetLayout>{mPipelineManager->GetGlobalDescriptorSetLayout()};
-        descriptorSetAllocateInfo.setDescriptorPool(mVulkanContext->GetDescriptorPool())
-            .setDescriptorSetCount(1)
-            .setSetLayouts(globalDescriptorSetLayouts);
-        auto descriptorSets = mVulkanContext->GetDevice().allocateDescriptorSetsUnique(descriptorSetAllocateInfo);
-        if (!descriptorSets.empty())
-        {
-            mGlobalDescriptorSets.push_back(std::move(descriptorSets[0]));
-        }
-    }
-    vk::BufferCreateInfo cameraUBOCreateInfo{};
-    cameraUBOCreateInfo.setSize(sizeof(CameraParameters))
-        .setUsage(vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst)
-        .setSharingMode(vk::SharingMode::eExclusive);
-    VmaAllocationCreateInfo cameraUBOAllocationCreateInfo{};
-    cameraUBOAllocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    cameraUBOAllocationCreateInfo.flags =
-        VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
-    if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(cameraUBOCreateInfo),
-                        &cameraUBOAllocationCreateInfo, reinterpret_cast<VkBuffer *>(&mCameraUBO),
-                        &mCameraUBOAllocation, &mCameraUBOAllocationInfo) != VK_SUCCESS)
-    {
-        LogError("Failed to create camera UBO");
-        throw std::runtime_error("Failed to create camera UBO");
-    }
-    vk::BufferCreateInfo lightUBOCreateInfo{};
-    lightUBOCreateInfo.setSize(sizeof(LightParameters) * MAX_LIGHT_COUNT)
-        .setUsage(vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eTransferDst)
-        .setSharingMode(vk::SharingMode::eExclusive);
-    VmaAllocationCreateInfo lightUBOAllocationCreateInfo{};
-    lightUBOAllocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-    lightUBOAllocationCreateInfo.flags =
-        VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
-    if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(lightUBOCreateInfo),
-                        &lightUBOAllocationCreateInfo, reinterpret_cast<VkBuffer *>(&mLightUBO), &mLightUBOAllocation,
-                        &mLightUBOAllocationInfo) != VK_SUCCESS)
-    {
-        LogError("Failed to create light UBO");
-        throw std::runtime_error("Failed to create light UBO");
+    }
+    if (mVulkanContext->IsAsyncComputeSupported())
+    {
+        auto &queueFamilyIndicates = mVulkanContext->GetQueueFamilyIndicates();
+        mAsyncComputeQueueFamilies = {queueFamilyIndicates.graphicsFamily.value(),
+                                      queueFamilyIndicates.computeFamily.value()};
+        vk::CommandBufferAllocateInfo computeCommandBufferAllocateInfo;
+        computeCommandBufferAllocateInfo.setCommandPool(mVulkanContext->GetComputeCommandPool())
+            .setLevel(vk::CommandBufferLevel::ePrimary)
+            .setCommandBufferCount(mFrameCount);
+        mComputeCommandBuffers =
+            mVulkanContext->GetDevice().allocateCommandBuffersUnique(computeCommandBufferAllocateInfo);
+        for (uint32_t i = 0; i < mFrameCount; ++i)
+        {
+            mComputeFinishedSemaphores.push_back(mVulkanContext->GetDevice().createSemaphoreUnique({}));
+            mGraphicsFinishedSemaphores.push_back(mVulkanContext->GetDevice().createSemaphoreUnique({}));
+        }
+    }
+    mUniformArena = std::make_unique<UniformArena>(mVulkanContext, mFrameCount, UniformArenaBytesPerFrame);
+    CreateShadowMaps();
+    WriteGlobalDescriptorSet();
+    mOverdrawPixelCounts.assign(mFrameCount, 0);
+    if (mVulkanContext->IsPipelineStatisticsSupported())
+    {
+        vk::QueryPoolCreateInfo queryPoolCreateInfo;
+        queryPoolCreateInfo.setQueryType(vk::QueryType::ePipelineStatistics)
+            .setQueryCount(mFrameCount)
+            .setPipelineStatistics(vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations);
+        mOverdrawQueryPool = mVulkanContext->GetDevice().createQueryPoolUnique(queryPoolCreateInfo);
+    }
+    // 整帧的GPU时间同时驱动动态分辨率，不支持timestamp时动态分辨率不生效
+    mGpuProfiler = std::make_unique<GpuProfiler>(mVulkanContext, mFrameCount);
+    mRenderStatistics = std::make_unique<RenderStatistics>(mVulkanContext, mFrameCount);
+    // Hi-Z从深度缓冲生成，深度格式需要支持采样
+    auto depthFormatProperties =
+        mVulkanContext->GetPhysicalDevice().getFormatProperties(mRenderPassManager->GetDepthStencilFormat());
+    mHiZSupported =
+        static_cast<bool>(depthFormatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage);
+    if (!mHiZSupported)
+    {
+        LogWarn("Depth format {} can not be sampled, GPU Hi-Z culling is disabled",
+                vk::to_string(mRenderPassManager->GetDepthStencilFormat()));
+    }
+    mHiZFrameBuffers.resize(mFrameCount);
+    // 每帧一个统计buffer，由TiledLighting.comp累加，在该帧的fence之后读取并清零
+    mTiledLightingStatsBuffers.resize(mFrameCount);
+    for (auto &statsBuffer : mTiledLightingStatsBuffers)
+    {
+        vk::BufferCreateInfo bufferCreateInfo{};
+        bufferCreateInfo.setSize(sizeof(TiledLightingStats))
+            .setUsage(vk::BufferUsageFlagBits::eStorageBuffer)
+            .setSharingMode(vk::SharingMode::eExclusive);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+        allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+        if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                            &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&statsBuffer.buffer),
+                            &statsBuffer.allocation, &statsBuffer.allocationInfo) != VK_SUCCESS)
+        {
+            LogError("Failed to create tiled lighting stats buffer");
+            throw std::runtime_error("Failed to create tiled lighting stats buffer");
+        }
+        std::memset(statsBuffer.allocationInfo.pMappedData, 0, sizeof(TiledLightingStats));
+        vmaFlushAllocation(mVulkanContext->GetVmaAllocator(), statsBuffer.allocation, 0, sizeof(TiledLightingStats));
     }
 }
 void MRenderSystem::Update(float deltaTime)
 {
+    MENGINE_PROFILE_ZONE("MRenderSystem::Update");
+    // 只在复用本帧的资源前等待，此时CPU已领先GPU mFrameCount帧
+    WaitForFrame();
+    UpdateCamera();
     Batch();
-    auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
     Prepare();
-    GBufferPass();
-    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    LightingPass();
-    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    RenderForwardCompositePass();
-    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
-    RenderSkyPass();
+    BuildRenderGraph();
+    {
+        MENGINE_PROFILE_ZONE("RenderGraph::Execute");
+        mRenderGraph->Execute(mGraphicsCommandBuffers[mCurrentFrameIndex].get(), mGpuProfiler.get(),
+                              mRenderStatistics.get());
+    }
     End();
+    // 在下一帧的UI之前更新，显示时的裁剪区域与渲染区域一致
+    ApplyResolutionScale();
     mCurrentFrameIndex = (mCurrentFrameIndex + 1) % mFrameCount;
 }
 void MRenderSystem::Shutdown()
 {
-    if (mCameraUBO)
+    mGlobalDescriptorSet.reset();
+    mUniformArena.reset();
+    mOverdrawQueryPool.reset();
+    mGpuProfiler.reset();
+    mRenderStatistics.reset();
+    DestroyHiZPyramid();
+    for (auto &frameBuffers : mHiZFrameBuffers)
     {
-        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mCameraUBO, mCameraUBOAllocation);
+        DestroyHiZFrameBuffers(frameBuffers);
     }
-    if (mLightUBO)
+    for (auto &statsBuffer : mTiledLightingStatsBuffers)
     {
-        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mLightUBO, mLightUBOAllocation);
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), statsBuffer.buffer, statsBuffer.allocation);
     }
+    mTiledLightingStatsBuffers.clear();
+    DestroyShadowMaps();
+    mDepthSampledImageView.reset();
+    mFramebuffers.clear();
+    mRenderGraph.reset();
 }
-void MRenderSystem::CreateRenderTarget()
+void MRenderSystem::CreateRenderTarget(uint32_t width, uint32_t height)
 {
+    mRenderTargets.clear();
     mRenderTargets.resize(mFrameCount);
     auto textureManager = mResourceManager->GetManager<MTexture, IMTextureManager>();
     for (uint32_t i = 0; i < mFrameCount; ++i)
     {
+        mRenderTargets[i].width = width;
+        mRenderTargets[i].height = height;
         mRenderTargets[i].colorTexture =
             textureManager->CreateColorAttachment(mRenderTargets[i].width, mRenderTargets[i].height);
-        mRenderTargets[i].depthStencilTexture =
-            textureManager->CreateDepthStencilAttachment(mRenderTargets[i].width, mRenderTargets[i].height);
-        mRenderTargets[i].normalTexture =
-            textureManager->CreateColorAttachment(mRenderTargets[i].width, mRenderTargets[i].height);
-        mRenderTargets[i].armTexture =
-            textureManager->CreateColorAttachment(mRenderTargets[i].width, mRenderTargets[i].height);
-        mRenderTargets[i].worldPosTexture =
-            textureManager->CreateColorAttachment(mRenderTargets[i].width, mRenderTargets[i].height);
     }
 }
-void MRenderSystem::CreateFramebuffer()
+void MRenderSystem::BuildRenderGraph()
 {
-    mFramebuffers.resize(mFrameCount);
-    for (uint32_t i = 0; i < mFrameCount; ++i)
+    MENGINE_PROFILE_ZONE("MRenderSystem::BuildRenderGraph");
+    auto &renderTarget = mRenderTargets[mCurrentFrameIndex];
+    vk::Extent2D extent{renderTarget.width, renderTarget.height};
+    mRenderGraph->Reset();
+    // atlas和缓存跨帧保留，本帧写入前等待之前提交的帧对它们的读取
+    auto shadowAtlas = mRenderGraph->ImportImage("Shadow Atlas", mShadowAtlas.image, mShadowAtlas.imageView.get(),
+                                                 vk::ImageAspectFlagBits::eDepth, mShadowAtlas.layout,
+                                                 vk::PipelineStageFlagBits::eFragmentShader |
+                                                     vk::PipelineStageFlagBits::eComputeShader);
+    if (mShadowRefreshMask != 0)
+    {
+        auto shadowCache = mRenderGraph->ImportImage("Shadow Cache", mShadowCache.image, mShadowCache.imageView.get(),
+                                                     vk::ImageAspectFlagBits::eDepth, mShadowCache.layout,
+                                                     vk::PipelineStageFlagBits::eTransfer);
+        if (mShadowStaticRedrawMask != 0)
+        {
+            mRenderGraph->AddPass("Shadow Static",
+                                  {{shadowCache, RenderGraphAccessType::DepthStencilAttachment, {},
+                                    vk::ImageLayout::eDepthStencilAttachmentOptimal}},
+                                  [this](vk::CommandBuffer commandBuffer) { ShadowStaticPass(commandBuffer); });
+        }
+        mRenderGraph->AddPass("Shadow Copy",
+                              {{shadowCache, RenderGraphAccessType::TransferRead},
+                               {shadowAtlas, RenderGraphAccessType::TransferWrite}},
+                              [this](vk::CommandBuffer commandBuffer) { ShadowCopyPass(commandBuffer); });
+        auto hasDynamicCasters = false;
+        for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+        {
+            hasDynamicCasters |= (mShadowRefreshMask & (1u << i)) && !mShadowDynamicCasters[i].empty();
+        }
+        if (hasDynamicCasters)
+        {
+            mRenderGraph->AddPass("Shadow Dynamic",
+                                  {{shadowAtlas, RenderGraphAccessType::DepthStencilAttachment, {},
+                                    vk::ImageLayout::eDepthStencilAttachmentOptimal}},
+                                  [this](vk::CommandBuffer commandBuffer) { ShadowDynamicPass(commandBuffer); });
+        }
+        mRenderGraph->ExportImage(shadowCache, vk::ImageLayout::eTransferSrcOptimal);
+        mShadowCache.layout = vk::ImageLayout::eTransferSrcOptimal;
+    }
+    auto shadowStages = vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader;
+    // 本帧没有参与剔除的物体时不生成Hi-Z，下一帧第一阶段全部绘制
+    auto hiZEnabled = !mHiZDraws.empty();
+    RenderGraphResource hiZ{};
+    if (hiZEnabled)
     {
-        std::vector<vk::ImageView> attachments;
-        attachments.push_back(mRenderTargets[i].colorTexture->GetImageView());
-        attachments.push_back(mRenderTargets[i].depthStencilTexture->GetImageView());
-        attachments.push_back(mRenderTargets[i].normalTexture->GetImageView());
-        attachments.push_back(mRenderTargets[i].armTexture->GetImageView());
-        attachments.push_back(mRenderTargets[i].worldPosTexture->GetImageView());
-        // 创建Framebuffer
+        if (mHiZExtent != extent)
+        {
+            CreateHiZPyramid(extent.width, extent.height);
+        }
+        hiZ = mRenderGraph->ImportImage("HiZ", mHiZImage, mHiZImageView.get(), vk::ImageAspectFlagBits::eColor,
+                                        mHiZLayout);
+        // 新建的Hi-Z还没有转换到eGeneral，这一帧仍在graphics队列上剔除
+        if (IsAsyncComputeEnabled() && mHiZLayout == vk::ImageLayout::eGeneral)
+        {
+            RecordAsyncCompute();
+        }
+        else
+        {
+            mRenderGraph->AddPass(
+                "HiZ Cull Early",
+                {{hiZ, RenderGraphAccessType::StorageRead, vk::PipelineStageFlagBits::eComputeShader}},
+                [this](vk::CommandBuffer commandBuffer) { HiZCullPass(commandBuffer, 0); });
+        }
+    }
+    else
+    {
+        mHiZValid = false;
+    }
+    auto color = mRenderGraph->ImportImage("Color", renderTarget.colorTexture->GetImage(),
+                                           renderTarget.colorTexture->GetImageView(), vk::ImageAspectFlagBits::eColor,
+                                           vk::ImageLayout::eUndefined);
+    // depth和G-buffer不跨帧保留，G-buffer只在render pass内部读写，支持时不占用实际显存
+    auto depthUsage = mHiZSupported
+                          ? vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled
+                          : vk::ImageUsageFlags(vk::ImageUsageFlagBits::eDepthStencilAttachment);
+    auto depth = mRenderGraph->CreateImage(
+        "Depth", RenderGraphImageDesc{mRenderPassManager->GetDepthStencilFormat(), extent, depthUsage,
+                                      vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil, false});
+    // 分块延迟光照在render pass之外采样G-buffer，此时G-buffer需要实际存储
+    auto tiledLighting = IsTiledLightingEnabled();
+    auto gBufferUsage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eInputAttachment;
+    auto gBufferDesc = RenderGraphImageDesc{
+        mRenderPassManager->GetGBufferFormat(), extent,
+        tiledLighting ? gBufferUsage | vk::ImageUsageFlagBits::eSampled : gBufferUsage,
+        vk::ImageAspectFlagBits::eColor, !tiledLighting};
+    auto normal = mRenderGraph->CreateImage("GBuffer Normal", gBufferDesc);
+    auto arm = mRenderGraph->CreateImage("GBuffer ARM", gBufferDesc);
+    auto worldPos = mRenderGraph->CreateImage("GBuffer WorldPos", gBufferDesc);
+    // composition render pass的各变体使用相同的attachment
+    std::vector<RenderGraphAccess> sceneAccesses{
+        {color, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {depth, RenderGraphAccessType::DepthStencilAttachment, {}, vk::ImageLayout::eDepthStencilAttachmentOptimal},
+        {normal, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {arm, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {worldPos, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal},
+        {shadowAtlas, RenderGraphAccessType::SampledRead, shadowStages},
+    };
+    if (tiledLighting)
+    {
+        mRenderGraph->AddPass("Scene GBuffer", sceneAccesses,
+                              [this](vk::CommandBuffer commandBuffer) { GBufferScenePass(commandBuffer); });
+        auto computeStage = vk::PipelineStageFlagBits::eComputeShader;
+        mRenderGraph->AddPass("Tiled Lighting",
+                              {
+                                  {depth, RenderGraphAccessType::SampledRead, computeStage},
+                                  {normal, RenderGraphAccessType::SampledRead, computeStage},
+                                  {arm, RenderGraphAccessType::SampledRead, computeStage},
+                                  {worldPos, RenderGraphAccessType::SampledRead, computeStage},
+                                  {shadowAtlas, RenderGraphAccessType::SampledRead, shadowStages},
+                                  {color, RenderGraphAccessType::StorageWrite, computeStage},
+                              },
+                              [this, depth, normal, arm, worldPos](vk::CommandBuffer commandBuffer) {
+                                  TiledLightingPass(commandBuffer, mRenderGraph->GetImage(depth),
+                                                    {mRenderGraph->GetImageView(normal),
+                                                     mRenderGraph->GetImageView(arm),
+                                                     mRenderGraph->GetImageView(worldPos)});
+                              });
+        mRenderGraph->AddPass("Scene Forward", sceneAccesses,
+                              [this](vk::CommandBuffer commandBuffer) { ForwardScenePass(commandBuffer); });
+    }
+    else
+    {
+        mRenderGraph->AddPass("Scene", sceneAccesses,
+                              [this](vk::CommandBuffer commandBuffer) { ScenePass(commandBuffer); });
+    }
+    if (hiZEnabled)
+    {
+        mRenderGraph->AddPass(
+            "HiZ Build",
+            {{depth, RenderGraphAccessType::SampledRead, vk::PipelineStageFlagBits::eComputeShader},
+             {hiZ, RenderGraphAccessType::StorageWrite, vk::PipelineStageFlagBits::eComputeShader}},
+            [this, depth](vk::CommandBuffer commandBuffer) {
+                HiZBuildPass(commandBuffer, mRenderGraph->GetImage(depth));
+            });
+        mRenderGraph->AddPass("HiZ Cull Late",
+                              {{hiZ, RenderGraphAccessType::StorageRead, vk::PipelineStageFlagBits::eComputeShader}},
+                              [this](vk::CommandBuffer commandBuffer) { HiZCullPass(commandBuffer, 1); });
+        // depth从采样布局回到attachment布局，与load render pass的initialLayout一致
+        mRenderGraph->AddPass("Scene Late", sceneAccesses,
+                              [this](vk::CommandBuffer commandBuffer) { LateScenePass(commandBuffer); });
+        mHiZLayout = vk::ImageLayout::eGeneral;
+    }
+    mRenderGraph->ExportImage(color, vk::ImageLayout::eShaderReadOnlyOptimal);
+    mRenderGraph->ExportImage(shadowAtlas, vk::ImageLayout::eShaderReadOnlyOptimal);
+    mShadowAtlas.layout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    mRenderGraph->Compile();
+
+    auto version = std::make_pair(mRenderTargetVersion, mRenderGraph->GetPhysicalVersion());
+    auto &framebuffer = mFramebuffers[mCurrentFrameIndex];
+    if (framebuffer && mFramebufferVersions[mCurrentFrameIndex] == version)
+    {
+        return;
+    }
+    if (framebuffer)
+    {
+        mVulkanContext->GetDeletionQueue().Push(
+            [framebuffer = std::move(framebuffer)]() mutable { framebuffer.reset(); });
+    }
+    // attachment顺序与RenderPassManager中composition render pass一致
+    std::array<vk::ImageView, 5> attachments{
+        mRenderGraph->GetImageView(color),  mRenderGraph->GetImageView(depth),
+        mRenderGraph->GetImageView(normal), mRenderGraph->GetImageView(arm),
+        mRenderGraph->GetImageView(worldPos),
+    };
+    vk::FramebufferCreateInfo framebufferCreateInfo;
+    framebufferCreateInfo.setRenderPass(mRenderPassManager->GetCompositionRenderPass())
+        .setAttachments(attachments)
+        .setWidth(extent.width)
+        .setHeight(extent.height)
+        .setLayers(1);
+    framebuffer = mVulkanContext->GetDevice().createFramebufferUnique(framebufferCreateInfo);
+    mFramebufferVersions[mCurrentFrameIndex] = version;
+}
+void MRenderSystem::SetViewportAndScissor(vk::CommandBuffer commandBuffer)
+{
+    // render target可能大于渲染区域，只渲染左上角mRenderExtent的部分
+    auto width = mRenderExtent.width;
+    auto height = mRenderExtent.height;
+    vk::Viewport viewport;
+    viewport.setX(0.0f)
+        .setY(height)
+        .setWidth(static_cast<float>(width))
+        .setHeight(-static_cast<float>(height))
+        .setMinDepth(0.0f)
+        .setMaxDepth(1.0f);
+    commandBuffer.setViewport(0, {viewport});
+    vk::Rect2D scissor;
+    scissor.setOffset({0, 0}).setExtent({width, height});
+    commandBuffer.setScissor(0, {scissor});
+}
+void MRenderSystem::BeginCompositionRenderPass(vk::CommandBuffer commandBuffer, vk::RenderPass renderPass)
+{
+    SetViewportAndScissor(commandBuffer);
+    auto clearValues = RenderTarget::GetClearValues();
+    vk::RenderPassBeginInfo renderPassBeginInfo;
+    renderPassBeginInfo.setRenderPass(renderPass)
+        .setFramebuffer(mFramebuffers[mCurrentFrameIndex].get())
+        .setRenderArea({{0, 0}, mRenderExtent})
+        .setClearValues(clearValues);
+    commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+}
+void MRenderSystem::ScenePass(vk::CommandBuffer commandBuffer)
+{
+    BeginCompositionRenderPass(commandBuffer, mRenderPassManager->GetCompositionRenderPass());
+    GBufferPass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    LightingPass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    RenderForwardCompositePass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    RenderSkyPass();
+    commandBuffer.endRenderPass();
+}
+void MRenderSystem::GBufferScenePass(vk::CommandBuffer commandBuffer)
+{
+    // 只绘制G-buffer，光照由TiledLightingPass计算，其余subpass为空
+    BeginCompositionRenderPass(commandBuffer, mRenderPassManager->GetCompositionGBufferRenderPass());
+    GBufferPass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.endRenderPass();
+}
+void MRenderSystem::ForwardScenePass(vk::CommandBuffer commandBuffer)
+{
+    BeginCompositionRenderPass(commandBuffer, mRenderPassManager->GetCompositionResumeRenderPass());
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    RenderForwardCompositePass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    RenderSkyPass();
+    commandBuffer.endRenderPass();
+}
+void MRenderSystem::TiledLightingPass(vk::CommandBuffer commandBuffer, vk::Image depthImage,
+                                      const std::array<vk::ImageView, 3> &gBufferViews)
+{
+    auto pipeline = mPipelineManager->GetByName(PipelineType::TiledLighting);
+    auto &statsBuffer = mTiledLightingStatsBuffers[mCurrentFrameIndex];
+    auto &renderTarget = mRenderTargets[mCurrentFrameIndex];
+    auto sampledImage = [](vk::ImageView imageView) {
+        return vk::DescriptorImageInfo{{}, imageView, vk::ImageLayout::eShaderReadOnlyOptimal};
+    };
+    auto texture = [](const std::shared_ptr<MTexture> &texture) {
+        return vk::DescriptorImageInfo{texture->GetSampler(), texture->GetImageView(),
+                                       vk::ImageLayout::eShaderReadOnlyOptimal};
+    };
+    // 相机和光源直接引用本帧写入mUniformArena的数据
+    std::array<DescriptorWrite, 13> writes{
+        DescriptorWrite{0, vk::DescriptorType::eSampledImage, {}, sampledImage(GetDepthSampledImageView(depthImage))},
+        DescriptorWrite{1, vk::DescriptorType::eSampledImage, {}, sampledImage(gBufferViews[0])},
+        DescriptorWrite{2, vk::DescriptorType::eSampledImage, {}, sampledImage(gBufferViews[1])},
+        DescriptorWrite{3, vk::DescriptorType::eSampledImage, {}, sampledImage(gBufferViews[2])},
+        DescriptorWrite{4, vk::DescriptorType::eStorageImage, {},
+                        vk::DescriptorImageInfo{{}, renderTarget.colorTexture->GetImageView(),
+                                                vk::ImageLayout::eGeneral}},
+        DescriptorWrite{5, vk::DescriptorType::eUniformBuffer,
+                        vk::DescriptorBufferInfo{mUniformArena->GetBuffer(), mGlobalDynamicOffsets[0],
+                                                 sizeof(CameraParameters)}},
+        DescriptorWrite{6, vk::DescriptorType::eUniformBuffer,
+                        vk::DescriptorBufferInfo{mUniformArena->GetBuffer(), mGlobalDynamicOffsets[1],
+                                                 sizeof(LightParameters) * MAX_LIGHT_COUNT}},
+        DescriptorWrite{7, vk::DescriptorType::eCombinedImageSampler, {}, texture(mEnvironmentMap)},
+        DescriptorWrite{8, vk::DescriptorType::eCombinedImageSampler, {}, texture(mIrradianceMap)},
+        DescriptorWrite{9, vk::DescriptorType::eCombinedImageSampler, {}, texture(mBRDFLUT)},
+        DescriptorWrite{10, vk::DescriptorType::eStorageBuffer,
+                        vk::DescriptorBufferInfo{statsBuffer.buffer, 0, sizeof(TiledLightingStats)}},
+        DescriptorWrite{11, vk::DescriptorType::eUniformBuffer,
+                        vk::DescriptorBufferInfo{mUniformArena->GetBuffer(), mGlobalDynamicOffsets[2],
+                                                 sizeof(ShadowParameters)}},
+        DescriptorWrite{12, vk::DescriptorType::eCombinedImageSampler, {},
+                        vk::DescriptorImageInfo{mShadowSampler.get(), mShadowAtlas.imageView.get(),
+                                                vk::ImageLayout::eShaderReadOnlyOptimal}},
+    };
+    auto descriptorSet =
+        mDescriptorAllocator->AllocateTransient(mCurrentFrameIndex, pipeline->GetMaterialDescriptorSetLayout(), writes);
+    glm::uvec2 viewportSize{mRenderExtent.width, mRenderExtent.height};
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->GetPipeline());
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline->GetPipelineLayout(), 0, descriptorSet,
+                                     {});
+    commandBuffer.pushConstants(pipeline->GetPipelineLayout(), vk::ShaderStageFlagBits::eCompute, 0,
+                                sizeof(viewportSize), &viewportSize);
+    commandBuffer.dispatch((viewportSize.x + LightingTileSize - 1) / LightingTileSize,
+                           (viewportSize.y + LightingTileSize - 1) / LightingTileSize, 1);
+    mRenderStatistics->BindPipeline();
+    mRenderStatistics->BindDescriptorSets();
+    mRenderStatistics->Dispatch();
+    // 统计在fence之后由CPU读取
+    vk::BufferMemoryBarrier barrier;
+    barrier.setBuffer(statsBuffer.buffer)
+        .setOffset(0)
+        .setSize(sizeof(TiledLightingStats))
+        .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eHostRead)
+        .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+        .setDstQueueFamilyIndex(vk::QueueFamilyIgnored);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {},
+                                  {}, barrier, {});
+}
+void MRenderSystem::ReadTiledLightingStats()
+{
+    if (mTiledLightingStatsBuffers.empty())
+    {
+        return;
+    }
+    auto &statsBuffer = mTiledLightingStatsBuffers[mCurrentFrameIndex];
+    auto allocator = mVulkanContext->GetVmaAllocator();
+    vmaInvalidateAllocation(allocator, statsBuffer.allocation, 0, sizeof(TiledLightingStats));
+    auto stats = static_cast<TiledLightingStats *>(statsBuffer.allocationInfo.pMappedData);
+    // 该帧没有执行分块光照时保留上一次的结果
+    if (stats->tileCount != 0 || !IsTiledLightingEnabled())
+    {
+        mTiledLightingStats = *stats;
+    }
+    *stats = TiledLightingStats{};
+    vmaFlushAllocation(allocator, statsBuffer.allocation, 0, sizeof(TiledLightingStats));
+}
+vk::ImageView MRenderSystem::GetDepthSampledImageView(vk::Image depthImage)
+{
+    if (!mDepthSampledImageView || mDepthSampledImageViewVersion != mRenderGraph->GetPhysicalVersion())
+    {
+        if (mDepthSampledImageView)
+        {
+            mVulkanContext->GetDeletionQueue().Push(
+                [imageView = std::move(mDepthSampledImageView)]() mutable { imageView.reset(); });
+        }
+        // render graph的view包含depth和stencil，采样只能使用单个aspect
+        vk::ImageViewCreateInfo imageViewCreateInfo{};
+        imageViewCreateInfo.setImage(depthImage)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(mRenderPassManager->GetDepthStencilFormat())
+            .setSubresourceRange({vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1});
+        mDepthSampledImageView = mVulkanContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
+        mDepthSampledImageViewVersion = mRenderGraph->GetPhysicalVersion();
+    }
+    return mDepthSampledImageView.get();
+}
+void MRenderSystem::CreateShadowMaps()
+{
+    auto format = mRenderPassManager->GetShadowMapFormat();
+    auto createShadowMap = [this, format](ShadowMap &shadowMap, vk::ImageUsageFlags usage, const char *name) {
+        vk::ImageCreateInfo imageCreateInfo{};
+        imageCreateInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(format)
+            .setExtent({ShadowAtlasSize, ShadowAtlasSize, 1})
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setTiling(vk::ImageTiling::eOptimal)
+            .setUsage(vk::ImageUsageFlagBits::eDepthStencilAttachment | usage)
+            .setSharingMode(vk::SharingMode::eExclusive)
+            .setInitialLayout(vk::ImageLayout::eUndefined);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (vmaCreateImage(mVulkanContext->GetVmaAllocator(), &static_cast<VkImageCreateInfo &>(imageCreateInfo),
+                           &allocationCreateInfo, reinterpret_cast<VkImage *>(&shadowMap.image),
+                           &shadowMap.allocation, nullptr) != VK_SUCCESS)
+        {
+            LogError("Failed to create {} {}x{}", name, ShadowAtlasSize, ShadowAtlasSize);
+            throw std::runtime_error("Failed to create shadow map");
+        }
+        vk::ImageViewCreateInfo imageViewCreateInfo{};
+        imageViewCreateInfo.setImage(shadowMap.image)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(format)
+            .setSubresourceRange({vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1});
+        shadowMap.imageView = mVulkanContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
         vk::FramebufferCreateInfo framebufferCreateInfo;
-        framebufferCreateInfo.setRenderPass(mRenderPassManager->GetCompositionRenderPass())
-            .setAttachments(attachments)
-            .setWidth(mRenderTargets[i].width)
-            .setHeight(mRenderTargets[i].height)
+        framebufferCreateInfo.setRenderPass(mRenderPassManager->GetShadowRenderPass())
+            .setAttachments(shadowMap.imageView.get())
+            .setWidth(ShadowAtlasSize)
+            .setHeight(ShadowAtlasSize)
             .setLayers(1);
-        mFramebuffers[i] = mVulkanContext->GetDevice().createFramebufferUnique(framebufferCreateInfo);
+        shadowMap.framebuffer = mVulkanContext->GetDevice().createFramebufferUnique(framebufferCreateInfo);
+        shadowMap.layout = vk::ImageLayout::eUndefined;
+    };
+    createShadowMap(mShadowAtlas, vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+                    "shadow atlas");
+    createShadowMap(mShadowCache, vk::ImageUsageFlagBits::eTransferSrc, "shadow cache");
+    // 硬件比较深度，线性过滤时得到2x2的PCF；atlas之外视为不在阴影中
+    vk::SamplerCreateInfo samplerCreateInfo{};
+    samplerCreateInfo.setMagFilter(vk::Filter::eLinear)
+        .setMinFilter(vk::Filter::eLinear)
+        .setMipmapMode(vk::SamplerMipmapMode::eNearest)
+        .setAddressModeU(vk::SamplerAddressMode::eClampToBorder)
+        .setAddressModeV(vk::SamplerAddressMode::eClampToBorder)
+        .setAddressModeW(vk::SamplerAddressMode::eClampToBorder)
+        .setBorderColor(vk::BorderColor::eFloatOpaqueWhite)
+        .setCompareEnable(vk::True)
+        .setCompareOp(vk::CompareOp::eLessOrEqual)
+        .setMinLod(0.0f)
+        .setMaxLod(0.0f);
+    mShadowSampler = mVulkanContext->GetDevice().createSamplerUnique(samplerCreateInfo);
+    mShadowCacheValid.fill(false);
+}
+void MRenderSystem::DestroyShadowMaps()
+{
+    auto &deletionQueue = mVulkanContext->GetDeletionQueue();
+    for (auto shadowMap : {&mShadowAtlas, &mShadowCache})
+    {
+        if (!shadowMap->image)
+        {
+            continue;
+        }
+        deletionQueue.Push([imageView = std::move(shadowMap->imageView),
+                            framebuffer = std::move(shadowMap->framebuffer)]() mutable {
+            framebuffer.reset();
+            imageView.reset();
+        });
+        deletionQueue.PushImage(mVulkanContext->GetVmaAllocator(), shadowMap->image, shadowMap->allocation);
+        *shadowMap = ShadowMap{};
+    }
+    mShadowSampler.reset();
+}
+void MRenderSystem::UpdateShadows()
+{
+    mShadowStats = {};
+    mShadowStaticRedrawMask = 0;
+    mShadowRefreshMask = 0;
+    for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+    {
+        mShadowStaticCasters[i].clear();
+        mShadowDynamicCasters[i].clear();
+    }
+    mShadowParameters.LightIndex = -1;
+    auto light = std::ranges::find_if(mLightParameters, [](const LightParameters &lightParams) {
+        return lightParams.enable && lightParams.LightType == Component::LightType::Directional;
+    });
+    if (!mShadowsEnabled || light == mLightParameters.end())
+    {
+        mShadowCacheValid.fill(false);
+        return;
+    }
+    auto cascades = Core::Utils::ShadowCascades::ComputeCascades(
+        mCameraParameters.ViewMatrix, mCameraParameters.ProjectionMatrix, mCameraNearPlane, mCameraFarPlane,
+        ShadowDistance, light->Direction, ShadowCascadeSize, ShadowCasterDistance);
+    // 只有不透明物体投射阴影，isStatic的物体和静态批次进入缓存
+    std::array<std::size_t, ShadowCascadeCount> signatures;
+    signatures.fill(14695981039346656037ULL); // FNV-1a
+    auto view = mRegistry->view<MTransformComponent, MMeshComponent, MMaterialComponent>(
+        entt::exclude<MStaticBatchedComponent>);
+    for (auto entity : view)
+    {
+        auto &meshComponent = view.get<MMeshComponent>(entity);
+        auto &materialComponent = view.get<MMaterialComponent>(entity);
+        if (!meshComponent.mesh || !materialComponent.material)
+        {
+            continue;
+        }
+        auto pipeline = materialComponent.material->GetPipeline();
+        if (!pipeline->GetDepthEqualPipeline() && pipeline->GetSetting().RenderPassType != RenderPassType::GBuffer)
+        {
+            continue;
+        }
+        auto &transformComponent = view.get<MTransformComponent>(entity);
+        auto isStatic = transformComponent.isStatic || mRegistry->all_of<MStaticBatchComponent>(entity);
+        for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+        {
+            if (!Core::Utils::ShadowCascades::Intersects(cascades[i].viewProjection, meshComponent.mesh->GetBoundsMin(),
+                                                         meshComponent.mesh->GetBoundsMax(),
+                                                         transformComponent.modelMatrix))
+            {
+                continue;
+            }
+            if (!isStatic)
+            {
+                mShadowDynamicCasters[i].push_back(entity);
+                continue;
+            }
+            mShadowStaticCasters[i].push_back(entity);
+            auto combine = [&hash = signatures[i]](auto value) {
+                hash ^= std::hash<decltype(value)>{}(value);
+                hash *= 1099511628211ULL;
+            };
+            combine(static_cast<uint32_t>(entity));
+            combine(reinterpret_cast<uintptr_t>(meshComponent.mesh.get()));
+            for (uint32_t column = 0; column < 4; ++column)
+            {
+                for (uint32_t row = 0; row < 4; ++row)
+                {
+                    combine(transformComponent.modelMatrix[column][row]);
+                }
+            }
+        }
+    }
+    for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+    {
+        // 级联矩阵只在相机跨过取整步长或光源转动时变化
+        auto staticRedraw = !mShadowCacheValid[i] || cascades[i] != mShadowCascades[i] ||
+                            signatures[i] != mShadowStaticSignatures[i];
+        auto hasDynamic = !mShadowDynamicCasters[i].empty();
+        if (staticRedraw)
+        {
+            mShadowStaticRedrawMask |= 1u << i;
+            mShadowStats.staticRedrawCount++;
+            mShadowStats.staticDrawCount += static_cast<uint32_t>(mShadowStaticCasters[i].size());
+        }
+        // 上一帧的动态投射者同样需要从atlas中移除
+        if (staticRedraw || hasDynamic || mShadowHadDynamic[i])
+        {
+            mShadowRefreshMask |= 1u << i;
+            mShadowStats.dynamicDrawCount += static_cast<uint32_t>(mShadowDynamicCasters[i].size());
+        }
+        else
+        {
+            mShadowStats.cachedCascadeCount++;
+        }
+        mShadowHadDynamic[i] = hasDynamic;
+        mShadowCacheValid[i] = true;
+        mShadowStaticSignatures[i] = signatures[i];
+        mShadowParameters.CascadeViewProjections[i] = cascades[i].viewProjection;
+        mShadowParameters.CascadeSplits[i] = cascades[i].splitFar;
+        mShadowParameters.CascadeTexelSizes[i] = cascades[i].texelWorldSize;
+    }
+    mShadowCascades = cascades;
+    mShadowParameters.InverseViewMatrix = glm::inverse(mCameraParameters.ViewMatrix);
+    mShadowParameters.LightIndex = static_cast<int>(std::distance(mLightParameters.begin(), light));
+}
+void MRenderSystem::BeginShadowRenderPass(vk::CommandBuffer commandBuffer, const ShadowMap &shadowMap)
+{
+    // load render pass，未更新的级联保持原有内容
+    vk::RenderPassBeginInfo renderPassBeginInfo;
+    renderPassBeginInfo.setRenderPass(mRenderPassManager->GetShadowRenderPass())
+        .setFramebuffer(shadowMap.framebuffer.get())
+        .setRenderArea({{0, 0}, {ShadowAtlasSize, ShadowAtlasSize}});
+    commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+}
+void MRenderSystem::ShadowStaticPass(vk::CommandBuffer commandBuffer)
+{
+    BeginShadowRenderPass(commandBuffer, mShadowCache);
+    for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+    {
+        if (!(mShadowStaticRedrawMask & (1u << i)))
+        {
+            continue;
+        }
+        vk::ClearAttachment clearAttachment{vk::ImageAspectFlagBits::eDepth, 0, vk::ClearDepthStencilValue(1.0f, 0)};
+        vk::ClearRect clearRect{GetShadowCascadeRegion(i, ShadowCascadeSize), 0, 1};
+        commandBuffer.clearAttachments(clearAttachment, clearRect);
+        DrawShadowCasters(commandBuffer, i, mShadowStaticCasters[i]);
+    }
+    commandBuffer.endRenderPass();
+}
+void MRenderSystem::ShadowCopyPass(vk::CommandBuffer commandBuffer)
+{
+    std::vector<vk::ImageCopy> regions;
+    for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+    {
+        if (!(mShadowRefreshMask & (1u << i)))
+        {
+            continue;
+        }
+        auto region = GetShadowCascadeRegion(i, ShadowCascadeSize);
+        vk::ImageSubresourceLayers subresource{vk::ImageAspectFlagBits::eDepth, 0, 0, 1};
+        auto offset = vk::Offset3D{region.offset.x, region.offset.y, 0};
+        regions.emplace_back(subresource, offset, subresource, offset,
+                             vk::Extent3D{region.extent.width, region.extent.height, 1});
+    }
+    commandBuffer.copyImage(mShadowCache.image, vk::ImageLayout::eTransferSrcOptimal, mShadowAtlas.image,
+                            vk::ImageLayout::eTransferDstOptimal, regions);
+}
+void MRenderSystem::ShadowDynamicPass(vk::CommandBuffer commandBuffer)
+{
+    BeginShadowRenderPass(commandBuffer, mShadowAtlas);
+    for (uint32_t i = 0; i < ShadowCascadeCount; ++i)
+    {
+        if (mShadowRefreshMask & (1u << i))
+        {
+            DrawShadowCasters(commandBuffer, i, mShadowDynamicCasters[i]);
+        }
+    }
+    commandBuffer.endRenderPass();
+}
+void MRenderSystem::DrawShadowCasters(vk::CommandBuffer commandBuffer, uint32_t cascadeIndex,
+                                      const std::vector<entt::entity> &entities)
+{
+    if (entities.empty())
+    {
+        return;
+    }
+    auto pipeline = mPipelineManager->GetByName(PipelineType::ShadowDepth);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
+    mRenderStatistics->BindPipeline();
+    // 不翻转y，与着色器中的atlas坐标一致
+    auto region = GetShadowCascadeRegion(cascadeIndex, ShadowCascadeSize);
+    vk::Viewport viewport;
+    viewport.setX(static_cast<float>(region.offset.x))
+        .setY(static_cast<float>(region.offset.y))
+        .setWidth(static_cast<float>(region.extent.width))
+        .setHeight(static_cast<float>(region.extent.height))
+        .setMinDepth(0.0f)
+        .setMaxDepth(1.0f);
+    commandBuffer.setViewport(0, {viewport});
+    commandBuffer.setScissor(0, {region});
+    for (auto entity : entities)
+    {
+        auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
+        auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
+        auto lightModelViewProjection = mShadowCascades[cascadeIndex].viewProjection * transformComponent.modelMatrix;
+        commandBuffer.pushConstants(pipeline->GetPipelineLayout(),
+                                    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
+                                    sizeof(glm::mat4), &lightModelViewProjection);
+        commandBuffer.bindVertexBuffers(0, meshComponent.mesh->GetPositionBuffer(), {0});
+        commandBuffer.bindIndexBuffer(meshComponent.mesh->GetIndexBuffer(), 0, vk::IndexType::eUint32);
+        // 静态批次投射整个网格，不受相机剔除的区间影响
+        commandBuffer.drawIndexed(meshComponent.mesh->GetIndexCount(), 1, 0, 0, 0);
+        mRenderStatistics->BindBuffers(2);
+        mRenderStatistics->Draw(meshComponent.mesh->GetIndexCount());
+    }
+}
+void MRenderSystem::LateScenePass(vk::CommandBuffer commandBuffer)
+{
+    // 只补绘制前向不透明物体，G-buffer、光照和天空已在第一阶段完成
+    mHiZPhase = 1;
+    BeginCompositionRenderPass(commandBuffer, mRenderPassManager->GetCompositionLoadRenderPass());
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    RenderForwardCompositePass();
+    commandBuffer.nextSubpass(vk::SubpassContents::eInline);
+    commandBuffer.endRenderPass();
+    mHiZPhase = 0;
+}
+void MRenderSystem::CreateHiZPyramid(uint32_t width, uint32_t height)
+{
+    DestroyHiZPyramid();
+    mHiZLevelCount = Core::Utils::HiZPyramid::GetMipLevelCount(width, height);
+    vk::ImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.setImageType(vk::ImageType::e2D)
+        .setFormat(vk::Format::eR32Sfloat)
+        .setExtent({width, height, 1})
+        .setMipLevels(mHiZLevelCount)
+        .setArrayLayers(1)
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setUsage(vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled)
+        .setSharingMode(mAsyncComputeQueueFamilies.empty() ? vk::SharingMode::eExclusive
+                                                           : vk::SharingMode::eConcurrent)
+        .setQueueFamilyIndices(mAsyncComputeQueueFamilies)
+        .setInitialLayout(vk::ImageLayout::eUndefined);
+    VmaAllocationCreateInfo allocationCreateInfo{};
+    allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+    if (vmaCreateImage(mVulkanContext->GetVmaAllocator(), &static_cast<VkImageCreateInfo &>(imageCreateInfo),
+                       &allocationCreateInfo, reinterpret_cast<VkImage *>(&mHiZImage), &mHiZAllocation,
+                       nullptr) != VK_SUCCESS)
+    {
+        LogError("Failed to create Hi-Z pyramid {}x{}", width, height);
+        throw std::runtime_error("Failed to create Hi-Z pyramid");
+    }
+    vk::ImageViewCreateInfo imageViewCreateInfo{};
+    imageViewCreateInfo.setImage(mHiZImage)
+        .setViewType(vk::ImageViewType::e2D)
+        .setFormat(vk::Format::eR32Sfloat)
+        .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, mHiZLevelCount, 0, 1});
+    mHiZImageView = mVulkanContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
+    // 生成时每级单独作为storage image读写
+    for (uint32_t level = 0; level < mHiZLevelCount; ++level)
+    {
+        imageViewCreateInfo.setSubresourceRange({vk::ImageAspectFlagBits::eColor, level, 1, 0, 1});
+        mHiZMipImageViews.push_back(mVulkanContext->GetDevice().createImageViewUnique(imageViewCreateInfo));
+    }
+    mHiZExtent = vk::Extent2D{width, height};
+    mHiZLayout = vk::ImageLayout::eUndefined;
+    mHiZValid = false;
+}
+void MRenderSystem::DestroyHiZPyramid()
+{
+    if (!mHiZImage)
+    {
+        return;
+    }
+    // in-flight的帧可能仍在读写
+    auto &deletionQueue = mVulkanContext->GetDeletionQueue();
+    deletionQueue.Push([imageView = std::move(mHiZImageView), mipImageViews = std::move(mHiZMipImageViews)]() mutable {
+        mipImageViews.clear();
+        imageView.reset();
+    });
+    deletionQueue.PushImage(mVulkanContext->GetVmaAllocator(), mHiZImage, mHiZAllocation);
+    mHiZImage = nullptr;
+    mHiZAllocation = nullptr;
+    mHiZMipImageViews.clear();
+    mHiZExtent = vk::Extent2D{0, 0};
+    mHiZLevelCount = 0;
+    mHiZValid = false;
+}
+void MRenderSystem::DestroyHiZFrameBuffers(HiZFrameBuffers &frameBuffers)
+{
+    // 只在等待过该帧的fence后调用，buffer已不被GPU使用
+    if (frameBuffers.drawBuffer)
+    {
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), frameBuffers.drawBuffer, frameBuffers.drawAllocation);
+    }
+    if (frameBuffers.commandBuffer)
+    {
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), frameBuffers.commandBuffer,
+                         frameBuffers.commandAllocation);
+    }
+    frameBuffers = HiZFrameBuffers{};
+}
+void MRenderSystem::UpdateHiZDraws()
+{
+    auto &frameBuffers = mHiZFrameBuffers[mCurrentFrameIndex];
+    mHiZDraws.clear();
+    frameBuffers.drawCount = 0;
+    if (!IsHiZCullingEnabled())
+    {
+        return;
+    }
+    auto &forwardQueue = mRenderQueue[RenderPassType::ForwardComposition];
+    uint32_t drawCount = 0;
+    for (const auto &[pipeline, entities] : forwardQueue)
+    {
+        // 只剔除写入深度的不透明物体，它们带有eEqual变体
+        if (!pipeline->GetDepthEqualPipeline())
+        {
+            continue;
+        }
+        // 静态批次的每个可见区间各占一条命令
+        for (auto entity : entities)
+        {
+            mHiZDraws[entity] = drawCount;
+            auto ranges = mStaticBatchRanges.find(entity);
+            drawCount += ranges == mStaticBatchRanges.end() ? 1 : static_cast<uint32_t>(ranges->second.size());
+        }
+    }
+    if (drawCount == 0)
+    {
+        return;
+    }
+    if (drawCount > frameBuffers.capacity)
+    {
+        DestroyHiZFrameBuffers(frameBuffers);
+        frameBuffers.capacity = std::max(64u, std::bit_ceil(drawCount));
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+        auto sharingMode =
+            mAsyncComputeQueueFamilies.empty() ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent;
+        vk::BufferCreateInfo drawBufferCreateInfo{};
+        drawBufferCreateInfo.setSize(sizeof(HiZDrawData) * frameBuffers.capacity)
+            .setUsage(vk::BufferUsageFlagBits::eStorageBuffer)
+            .setSharingMode(sharingMode)
+            .setQueueFamilyIndices(mAsyncComputeQueueFamilies);
+        vk::BufferCreateInfo commandBufferCreateInfo{};
+        commandBufferCreateInfo.setSize(sizeof(vk::DrawIndexedIndirectCommand) * frameBuffers.capacity * 2)
+            .setUsage(vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer)
+            .setSharingMode(sharingMode)
+            .setQueueFamilyIndices(mAsyncComputeQueueFamilies);
+        if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(drawBufferCreateInfo),
+                            &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&frameBuffers.drawBuffer),
+                            &frameBuffers.drawAllocation, &frameBuffers.drawAllocationInfo) != VK_SUCCESS ||
+            vmaCreateBuffer(mVulkanContext->GetVmaAllocator(),
+                            &static_cast<VkBufferCreateInfo &>(commandBufferCreateInfo), &allocationCreateInfo,
+                            reinterpret_cast<VkBuffer *>(&frameBuffers.commandBuffer),
+                            &frameBuffers.commandAllocation, &frameBuffers.commandAllocationInfo) != VK_SUCCESS)
+        {
+            LogError("Failed to create Hi-Z culling buffers for {} draws", frameBuffers.capacity);
+            throw std::runtime_error("Failed to create Hi-Z culling buffers");
+        }
+    }
+    frameBuffers.drawCount = drawCount;
+    auto draws = static_cast<HiZDrawData *>(frameBuffers.drawAllocationInfo.pMappedData);
+    auto commands = static_cast<vk::DrawIndexedIndirectCommand *>(frameBuffers.commandAllocationInfo.pMappedData);
+    auto writeDraw = [&](uint32_t drawIndex, const MStaticBatchSection &range, const glm::mat4 &model) {
+        draws[drawIndex] =
+            HiZDrawData{glm::vec4(range.boundsMin, 1.0f), glm::vec4(range.boundsMax, 1.0f), model};
+        // instanceCount由HiZCull.comp写入
+        auto command = vk::DrawIndexedIndirectCommand{range.indexCount, 0, range.firstIndex, 0, 0};
+        commands[drawIndex] = command;
+        commands[drawCount + drawIndex] = command;
+    };
+    for (const auto &[entity, firstDraw] : mHiZDraws)
+    {
+        auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
+        auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
+        auto ranges = mStaticBatchRanges.find(entity);
+        if (ranges == mStaticBatchRanges.end())
+        {
+            writeDraw(firstDraw,
+                      {0, meshComponent.mesh->GetIndexCount(), meshComponent.mesh->GetBoundsMin(),
+                       meshComponent.mesh->GetBoundsMax()},
+                      transformComponent.modelMatrix);
+            continue;
+        }
+        for (uint32_t i = 0; i < ranges->second.size(); ++i)
+        {
+            writeDraw(firstDraw + i, ranges->second[i], transformComponent.modelMatrix);
+        }
+    }
+    vmaFlushAllocation(mVulkanContext->GetVmaAllocator(), frameBuffers.drawAllocation, 0,
+                       sizeof(HiZDrawData) * drawCount);
+    vmaFlushAllocation(mVulkanContext->GetVmaAllocator(), frameBuffers.commandAllocation, 0,
+                       sizeof(vk::DrawIndexedIndirectCommand) * drawCount * 2);
+}
+void MRenderSystem::HiZCullPass(vk::CommandBuffer commandBuffer, uint32_t phase)
+{
+    auto &frameBuffers = mHiZFrameBuffers[mCurrentFrameIndex];
+    auto pipeline = mPipelineManager->GetByName(PipelineType::HiZCull);
+    if (phase == 0)
+    {
+        // Hi-Z由之前提交的帧写入，render graph只跟踪帧内的访问
+        vk::MemoryBarrier memoryBarrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead};
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                      vk::PipelineStageFlagBits::eComputeShader, {}, memoryBarrier, {}, {});
+    }
+    std::array<DescriptorWrite, 3> writes{
+        DescriptorWrite{0, vk::DescriptorType::eSampledImage, {},
+                        vk::DescriptorImageInfo{{}, mHiZImageView.get(), vk::ImageLayout::eGeneral}},
+        DescriptorWrite{1, vk::DescriptorType::eStorageBuffer,
+                        vk::DescriptorBufferInfo{frameBuffers.drawBuffer, 0, vk::WholeSize}},
+        DescriptorWrite{2, vk::DescriptorType::eStorageBuffer,
+                        vk::DescriptorBufferInfo{frameBuffers.commandBuffer, 0, vk::WholeSize}},
+    };
+    auto descriptorSet =
+        mDescriptorAllocator->AllocateTransient(mCurrentFrameIndex, pipeline->GetMaterialDescriptorSetLayout(), writes);
+    // 与HiZCull.comp的push constant一致
+    struct
+    {
+        glm::mat4 viewProjection;
+        glm::vec2 viewportSize;
+        uint32_t drawCount;
+        uint32_t phase;
+        uint32_t levelCount;
+        uint32_t hiZValid;
+    } pushConstants{mHiZViewProjection,
+                    glm::vec2(static_cast<float>(mHiZViewport.width), static_cast<float>(mHiZViewport.height)),
+                    frameBuffers.drawCount,
+                    phase,
+                    mHiZLevelCount,
+                    mHiZValid ? 1u : 0u};
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->GetPipeline());
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline->GetPipelineLayout(), 0,
+                                     descriptorSet, {});
+    commandBuffer.pushConstants(pipeline->GetPipelineLayout(), vk::ShaderStageFlagBits::eCompute, 0,
+                                sizeof(pushConstants), &pushConstants);
+    commandBuffer.dispatch((frameBuffers.drawCount + 63) / 64, 1, 1);
+    mRenderStatistics->BindPipeline();
+    mRenderStatistics->BindDescriptorSets();
+    mRenderStatistics->Dispatch();
+    // 命令供本帧的indirect draw和第二阶段使用，帧结束后由CPU读取统计
+    vk::BufferMemoryBarrier bufferBarrier;
+    bufferBarrier.setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+        .setDstAccessMask(vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead |
+                          vk::AccessFlagBits::eHostRead)
+        .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+        .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+        .setBuffer(frameBuffers.commandBuffer)
+        .setOffset(0)
+        .setSize(vk::WholeSize);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                  vk::PipelineStageFlagBits::eDrawIndirect |
+                                      vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eHost,
+                                  {}, {}, bufferBarrier, {});
+}
+void MRenderSystem::RecordAsyncCompute()
+{
+    auto commandBuffer = mComputeCommandBuffers[mCurrentFrameIndex].get();
+    commandBuffer.reset();
+    vk::CommandBufferBeginInfo beginInfo;
+    beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    commandBuffer.begin(beginInfo);
+    {
+        // query在graphics命令缓冲区上，计算队列上的pass只统计CPU端的计数
+        RenderStatisticsScope statisticsScope(mRenderStatistics.get(), nullptr, "HiZ Cull Early (Async)");
+        HiZCullPass(commandBuffer, 0);
+    }
+    commandBuffer.end();
+    mAsyncComputeRecorded = true;
+}
+void MRenderSystem::SubmitAsyncCompute()
+{
+    auto commandBuffer = mComputeCommandBuffers[mCurrentFrameIndex].get();
+    auto signalSemaphore = mComputeFinishedSemaphores[mCurrentFrameIndex].get();
+    // Hi-Z由上一帧graphics队列上的HiZ Build写入
+    auto waitSemaphore = mPendingGraphicsSemaphore;
+    vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eComputeShader;
+    vk::SubmitInfo submitInfo;
+    submitInfo.setCommandBuffers(commandBuffer).setSignalSemaphores(signalSemaphore);
+    if (waitSemaphore)
+    {
+        submitInfo.setWaitSemaphores(waitSemaphore).setWaitDstStageMask(waitStage);
+        mPendingGraphicsSemaphore = nullptr;
+    }
+    mVulkanContext->GetComputeQueue().submit(submitInfo);
+    mAsyncComputeRecorded = false;
+}
+void MRenderSystem::HiZBuildPass(vk::CommandBuffer commandBuffer, vk::Image depthImage)
+{
+    auto depthImageView = GetDepthSampledImageView(depthImage);
+    auto pipeline = mPipelineManager->GetByName(PipelineType::HiZBuild);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->GetPipeline());
+    mRenderStatistics->BindPipeline();
+    for (uint32_t level = 0; level < mHiZLevelCount; ++level)
+    {
+        auto srcLevel = level == 0 ? 0 : level - 1;
+        auto srcExtent = Core::Utils::HiZPyramid::GetMipExtent(mHiZExtent.width, mHiZExtent.height, srcLevel);
+        auto dstExtent = Core::Utils::HiZPyramid::GetMipExtent(mHiZExtent.width, mHiZExtent.height, level);
+        std::array<DescriptorWrite, 3> writes{
+            DescriptorWrite{0, vk::DescriptorType::eSampledImage, {},
+                            vk::DescriptorImageInfo{{}, depthImageView, vk::ImageLayout::eShaderReadOnlyOptimal}},
+            DescriptorWrite{1, vk::DescriptorType::eStorageImage, {},
+                            vk::DescriptorImageInfo{{}, mHiZMipImageViews[srcLevel].get(), vk::ImageLayout::eGeneral}},
+            DescriptorWrite{2, vk::DescriptorType::eStorageImage, {},
+                            vk::DescriptorImageInfo{{}, mHiZMipImageViews[level].get(), vk::ImageLayout::eGeneral}},
+        };
+        auto descriptorSet = mDescriptorAllocator->AllocateTransient(
+            mCurrentFrameIndex, pipeline->GetMaterialDescriptorSetLayout(), writes);
+        // 与HiZBuild.comp的push constant一致
+        struct
+        {
+            glm::ivec2 srcSize;
+            glm::ivec2 dstSize;
+            glm::ivec2 validSize;
+            uint32_t level;
+        } pushConstants{glm::ivec2(srcExtent), glm::ivec2(dstExtent),
+                        glm::ivec2(mRenderExtent.width, mRenderExtent.height), level};
+        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline->GetPipelineLayout(), 0,
+                                         descriptorSet, {});
+        commandBuffer.pushConstants(pipeline->GetPipelineLayout(), vk::ShaderStageFlagBits::eCompute, 0,
+                                    sizeof(pushConstants), &pushConstants);
+        commandBuffer.dispatch((dstExtent.x + 7) / 8, (dstExtent.y + 7) / 8, 1);
+        mRenderStatistics->BindDescriptorSets();
+        mRenderStatistics->Dispatch();
+        // 下一级读取本级
+        vk::ImageMemoryBarrier barrier;
+        barrier.setImage(mHiZImage)
+            .setOldLayout(vk::ImageLayout::eGeneral)
+            .setNewLayout(vk::ImageLayout::eGeneral)
+            .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+            .setDstAccessMask(vk::AccessFlagBits::eShaderRead)
+            .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setSubresourceRange({vk::ImageAspectFlagBits::eColor, level, 1, 0, 1});
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                      vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, barrier);
+    }
+    // 下一帧第一阶段按生成时的相机投影
+    mHiZViewProjection = mCameraParameters.ProjectionMatrix * mCameraParameters.ViewMatrix;
+    mHiZViewport = mRenderExtent;
+    mHiZValid = true;
+}
+void MRenderSystem::ReadHiZCullingStats()
+{
+    auto &frameBuffers = mHiZFrameBuffers[mCurrentFrameIndex];
+    if (frameBuffers.drawCount == 0)
+    {
+        mHiZCullingStats = {};
+        return;
+    }
+    // 已等待过该帧的fence
+    vmaInvalidateAllocation(mVulkanContext->GetVmaAllocator(), frameBuffers.commandAllocation, 0,
+                            sizeof(vk::DrawIndexedIndirectCommand) * frameBuffers.drawCount * 2);
+    auto commands = static_cast<const vk::DrawIndexedIndirectCommand *>(frameBuffers.commandAllocationInfo.pMappedData);
+    HiZCullingStats stats{frameBuffers.drawCount, 0, 0};
+    for (uint32_t i = 0; i < frameBuffers.drawCount; ++i)
+    {
+        stats.firstPhaseCount += commands[i].instanceCount;
+        stats.secondPhaseCount += commands[frameBuffers.drawCount + i].instanceCount;
+    }
+    mHiZCullingStats = stats;
+}
+void MRenderSystem::DrawMesh(vk::CommandBuffer commandBuffer, entt::entity entity, const std::shared_ptr<MMesh> &mesh)
+{
+    auto ranges = mStaticBatchRanges.find(entity);
+    auto hiZDraw = mHiZDraws.find(entity);
+    auto rangeCount = ranges == mStaticBatchRanges.end() ? 1 : static_cast<uint32_t>(ranges->second.size());
+    for (uint32_t i = 0; i < rangeCount; ++i)
+    {
+        auto indexCount = ranges == mStaticBatchRanges.end() ? mesh->GetIndexCount() : ranges->second[i].indexCount;
+        auto firstIndex = ranges == mStaticBatchRanges.end() ? 0 : ranges->second[i].firstIndex;
+        if (hiZDraw != mHiZDraws.end())
+        {
+            // 可见性由HiZCull.comp写入当前阶段命令的instanceCount
+            auto &frameBuffers = mHiZFrameBuffers[mCurrentFrameIndex];
+            auto drawIndex = mHiZPhase * frameBuffers.drawCount + hiZDraw->second + i;
+            commandBuffer.drawIndexedIndirect(frameBuffers.commandBuffer,
+                                              sizeof(vk::DrawIndexedIndirectCommand) * drawIndex, 1,
+                                              sizeof(vk::DrawIndexedIndirectCommand));
+        }
+        else
+        {
+            commandBuffer.drawIndexed(indexCount, 1, firstIndex, 0, 0);
+        }
+        mRenderStatistics->Draw(indexCount);
     }
 }
 void MRenderSystem::CreateEnvironmentMap()
@@ -158,36 +1178,112 @@ void MRenderSystem::CreateEnvironmentMap()
 }
 void MRenderSystem::ReSizeFrameBuffer(uint32_t width, uint32_t height)
 {
-    mVulkanContext->GetDevice().waitIdle();
-    for (auto &renderTarget : mRenderTargets)
+    UseRenderTargets(width, height);
+    mRequestedExtent = vk::Extent2D{width, height};
+    mOutputExtent = mRequestedExtent;
+    mStableFrames = 0;
+    ApplyResolutionScale();
+}
+void MRenderSystem::RequestExtent(uint32_t width, uint32_t height)
+{
+    width = std::max(width, 1u);
+    height = std::max(height, 1u);
+    if (width != mRequestedExtent.width || height != mRequestedExtent.height)
+    {
+        mRequestedExtent = vk::Extent2D{width, height};
+        mStableFrames = 0;
+    }
+    else
+    {
+        mStableFrames++;
+    }
+    auto capacityWidth = mRenderTargets.front().width;
+    auto capacityHeight = mRenderTargets.front().height;
+    auto tooSmall = width > capacityWidth || height > capacityHeight;
+    auto tooLarge = static_cast<uint64_t>(capacityWidth) * capacityHeight >
+                    2ull * static_cast<uint64_t>(width) * static_cast<uint64_t>(height);
+    if ((tooSmall || tooLarge) && mStableFrames >= ResizeDebounceFrames)
     {
-        renderTarget.height = height;
-        renderTarget.width = width;
+        // 对齐后的尺寸更容易在池中命中
+        auto align = [](uint32_t value) {
+            return (value + RenderTargetAlignment - 1) / RenderTargetAlignment * RenderTargetAlignment;
+        };
+        UseRenderTargets(align(width), align(height));
+        capacityWidth = mRenderTargets.front().width;
+        capacityHeight = mRenderTargets.front().height;
     }
-    CreateRenderTarget();
-    CreateFramebuffer();
-    LogInfo("Frame buffer resized to {}x{}", width, height);
+    // 拖动过程中超出现有render target的部分等比缩小，不重新分配
+    auto scale = std::min({1.0f, static_cast<float>(capacityWidth) / static_cast<float>(width),
+                           static_cast<float>(capacityHeight) / static_cast<float>(height)});
+    mOutputExtent = vk::Extent2D{std::max(1u, static_cast<uint32_t>(width * scale)),
+                                 std::max(1u, static_cast<uint32_t>(height * scale))};
+    ApplyResolutionScale();
 }
-void MRenderSystem::Batch()
+void MRenderSystem::SetDynamicResolutionSetting(const Core::Utils::DynamicResolutionSetting &setting)
 {
-    mRenderQueue.clear();
-
-    auto view = mRegistry->view<MTransformComponent, MMeshComponent, MMaterialComponent>();
-    for (auto &entity : view)
+    mDynamicResolution.SetSetting(setting);
+    ApplyResolutionScale();
+}
+void MRenderSystem::ApplyResolutionScale()
+{
+    auto scale = mDynamicResolution.GetScale();
+    auto scaled = [scale](uint32_t size) {
+        return std::max(1u, static_cast<uint32_t>(static_cast<float>(size) * scale));
+    };
+    mRenderExtent = vk::Extent2D{scaled(mOutputExtent.width), scaled(mOutputExtent.height)};
+}
+void MRenderSystem::UseRenderTargets(uint32_t width, uint32_t height)
+{
+    if (!mRenderTargets.empty() && mRenderTargets.front().width == width && mRenderTargets.front().height == height)
     {
-        auto &transformComponent = view.get<MTransformComponent>(entity);
-        auto &meshComponent = view.get<MMeshComponent>(entity);
-        auto &materialComponent = view.get<MMaterialComponent>(entity);
-        auto renderPassType = materialComponent.material->GetPipeline()->GetSetting().RenderPassType;
-        auto pipeline = materialComponent.material->GetPipeline();
-        mRenderQueue[renderPassType][pipeline].push_back(entity);
+        return;
+    }
+    std::optional<RenderTargetSet> reused;
+    auto it = std::ranges::find_if(mRenderTargetPool, [width, height](const RenderTargetSet &renderTargetSet) {
+        return renderTargetSet.renderTargets.front().width == width &&
+               renderTargetSet.renderTargets.front().height == height;
+    });
+    if (it != mRenderTargetPool.end())
+    {
+        reused = std::move(*it);
+        mRenderTargetPool.erase(it);
+    }
+    // 当前的render target可能还被in-flight的帧使用，放回池中而不是立即销毁
+    if (!mRenderTargets.empty())
+    {
+        mRenderTargetPool.push_front(RenderTargetSet{std::move(mRenderTargets)});
+    }
+    while (mRenderTargetPool.size() > RenderTargetPoolSize)
+    {
+        RetireRenderTargets(mRenderTargetPool.back());
+        mRenderTargetPool.pop_back();
     }
+    if (reused)
+    {
+        mRenderTargets = std::move(reused->renderTargets);
+    }
+    else
+    {
+        CreateRenderTarget(width, height);
+    }
+    mRenderTargetVersion++;
+    LogInfo("Frame buffer resized to {}x{}{}", width, height, reused ? " (pooled)" : "");
 }
-void MRenderSystem::Prepare()
+void MRenderSystem::RetireRenderTargets(RenderTargetSet &renderTargetSet)
+{
+    // 纹理由MTexture析构时交给延迟释放队列，引用它的framebuffer在下次使用该帧时重建
+    auto textureManager = mResourceManager->GetManager<MTexture, IMTextureManager>();
+    for (auto &renderTarget : renderTargetSet.renderTargets)
+    {
+        if (renderTarget.colorTexture)
+        {
+            textureManager->Remove(renderTarget.colorTexture->GetID());
+        }
+    }
+    renderTargetSet.renderTargets.clear();
+}
+void MRenderSystem::UpdateCamera()
 {
-    auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
-    auto fence = mInFlightFences[mCurrentFrameIndex].get();
-    // 相机
     auto cameraView = mRegistry->view<MTransformComponent, MCameraComponent>();
     for (auto camera : cameraView)
     {
@@ -199,8 +1295,142 @@ void MRenderSystem::Prepare()
             mCameraParameters.Direction = transformComponent.worldRotation * glm::vec3(0.0f, 0.0f, -1.0f);
             mCameraParameters.ViewMatrix = cameraComponent.viewMatrix;
             mCameraParameters.ProjectionMatrix = cameraComponent.projectionMatrix;
+            mCameraNearPlane = cameraComponent.nearPlane;
+            mCameraFarPlane = cameraComponent.farPlane;
+        }
+    }
+}
+void MRenderSystem::CullOccluded(std::vector<entt::entity> &entities)
+{
+    mOcclusionCuller->BeginFrame(mCameraParameters.ProjectionMatrix * mCameraParameters.ViewMatrix);
+    std::vector<entt::entity> candidates;
+    std::vector<Core::Utils::OcclusionBounds> bounds;
+    std::vector<entt::entity> batches;
+    candidates.reserve(entities.size());
+    bounds.reserve(entities.size());
+    std::erase_if(entities, [&](entt::entity entity) {
+        auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
+        auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
+        if (meshComponent.isOccluder)
+        {
+            mOcclusionCuller->AddOccluder(meshComponent.mesh->GetPositions(), meshComponent.mesh->GetIndices(),
+                                          transformComponent.modelMatrix);
+            return false;
+        }
+        if (mRegistry->all_of<MStaticBatchComponent>(entity))
+        {
+            batches.push_back(entity);
+            return true;
+        }
+        candidates.push_back(entity);
+        bounds.push_back({meshComponent.mesh->GetBoundsMin(), meshComponent.mesh->GetBoundsMax(),
+                          transformComponent.modelMatrix});
+        return true;
+    });
+    // 静态批次逐段测试，各段的包围盒接在普通物体之后
+    for (auto batch : batches)
+    {
+        auto &modelMatrix = mRegistry->get<MTransformComponent>(batch).modelMatrix;
+        for (const auto &section : mRegistry->get<MStaticBatchComponent>(batch).sections)
+        {
+            bounds.push_back({section.boundsMin, section.boundsMax, modelMatrix});
+        }
+    }
+    // 遮挡体总是绘制，其余物体按可见性加入
+    mOcclusionCuller->Rasterize();
+    std::vector<uint8_t> visible;
+    mOcclusionCuller->TestVisibility(bounds, visible);
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if (visible[i])
+        {
+            entities.push_back(candidates[i]);
+        }
+    }
+    // 相邻的可见段合并为一个区间，包围盒取并集供Hi-Z剔除
+    auto sectionVisible = visible.begin() + static_cast<std::ptrdiff_t>(candidates.size());
+    for (auto batch : batches)
+    {
+        std::vector<MStaticBatchSection> ranges;
+        auto previousVisible = false;
+        for (const auto &section : mRegistry->get<MStaticBatchComponent>(batch).sections)
+        {
+            auto sectionIsVisible = *sectionVisible++ != 0;
+            if (sectionIsVisible && previousVisible &&
+                ranges.back().firstIndex + ranges.back().indexCount == section.firstIndex)
+            {
+                auto &range = ranges.back();
+                range.indexCount += section.indexCount;
+                range.boundsMin = glm::min(range.boundsMin, section.boundsMin);
+                range.boundsMax = glm::max(range.boundsMax, section.boundsMax);
+            }
+            else if (sectionIsVisible)
+            {
+                ranges.push_back(section);
+            }
+            previousVisible = sectionIsVisible;
+        }
+        if (!ranges.empty())
+        {
+            entities.push_back(batch);
+            mStaticBatchRanges[batch] = std::move(ranges);
         }
     }
+    mOcclusionCullingStats = mOcclusionCuller->GetStats();
+}
+void MRenderSystem::Batch()
+{
+    MENGINE_PROFILE_ZONE("MRenderSystem::Batch");
+    mRenderQueue.clear();
+    mStaticBatchRanges.clear();
+
+    // 已合并进静态批次的实体由批次绘制
+    auto view = mRegistry->view<MTransformComponent, MMeshComponent, MMaterialComponent>(
+        entt::exclude<MStaticBatchedComponent>);
+    std::vector<entt::entity> entities(view.begin(), view.end());
+    if (mOcclusionCullingEnabled)
+    {
+        CullOccluded(entities);
+    }
+    else
+    {
+        mOcclusionCullingStats = {};
+    }
+    for (auto entity : entities)
+    {
+        auto &materialComponent = view.get<MMaterialComponent>(entity);
+        auto renderPassType = materialComponent.material->GetPipeline()->GetSetting().RenderPassType;
+        auto pipeline = materialComponent.material->GetPipeline();
+        mRenderQueue[renderPassType][pipeline].push_back(entity);
+    }
+}
+void MRenderSystem::WaitForFrame()
+{
+    MENGINE_PROFILE_ZONE("MRenderSystem::WaitForFrame");
+    auto fence = mInFlightFences[mCurrentFrameIndex].get();
+    auto result = mVulkanContext->GetDevice().waitForFences({fence}, vk::True,
+                                                            1000000000); // 1s
+    if (result != vk::Result::eSuccess)
+    {
+        LogError("Failed to wait for in-flight fence: {}", vk::to_string(result));
+        throw std::runtime_error("Failed to wait fence");
+    }
+    mVulkanContext->GetDevice().resetFences({fence});
+    mVulkanContext->GetDeletionQueue().BeginFrame(mFrameCount);
+    // 该帧上次提交的命令已执行完毕，可以回收其临时描述符集和uniform数据
+    mDescriptorAllocator->ResetFrame(mCurrentFrameIndex);
+    mUniformArena->Reset(mCurrentFrameIndex);
+    ReadOverdrawStats();
+    ReadHiZCullingStats();
+    ReadTiledLightingStats();
+    ReadGpuFrameTime();
+    mRenderStatistics->Collect(mCurrentFrameIndex);
+    RecordMetrics();
+}
+void MRenderSystem::Prepare()
+{
+    MENGINE_PROFILE_ZONE("MRenderSystem::Prepare");
+    auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
     // 光照
     auto lightView = mRegistry->view<MTransformComponent, MLightComponent>();
     uint32_t lightCount = 0;
@@ -221,92 +1451,137 @@ void MRenderSystem::Prepare()
         mLightParameters[lightCount] = lightParams;
         lightCount++;
     }
-    auto result = mVulkanContext->GetDevice().waitForFences({fence}, vk::True,
-                                                            1000000000); // 1s
-    if (result != vk::Result::eSuccess)
-    {
-        LogError("MRenderSystem::Prepare", "Failed to wait for in-flight fence: {}", vk::to_string(result));
-        throw std::runtime_error("Failed to wait fence");
-    }
-    mVulkanContext->GetDevice().resetFences({fence});
+    UpdateTextureStreaming();
+    UpdateHiZDraws();
+    UpdateShadows();
     commandBuffer.reset();
     vk::CommandBufferBeginInfo beginInfo;
     beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
     commandBuffer.begin(beginInfo);
-    WriteGlobalDescriptorSet(mCurrentFrameIndex);
-    auto extent = mRenderTargets[mCurrentFrameIndex].GetExtent();
-    auto width = extent.width;
-    auto height = extent.height;
-    vk::Viewport viewport;
-    viewport.setX(0.0f)
-        .setY(height)
-        .setWidth(static_cast<float>(width))
-        .setHeight(-static_cast<float>(height))
-        .setMinDepth(0.0f)
-        .setMaxDepth(1.0f);
-    commandBuffer.setViewport(0, {viewport});
-    vk::Rect2D scissor;
-    scissor.setOffset({0, 0}).setExtent({width, height});
-    commandBuffer.setScissor(0, {scissor});
-
-    auto renderPass = mRenderPassManager->GetCompositionRenderPass();
-    auto framebuffer = mFramebuffers[mCurrentFrameIndex].get();
-    vk::RenderPassBeginInfo renderPassBeginInfo;
-    auto clearValues = RenderTarget::GetClearValues();
-    renderPassBeginInfo.setRenderPass(renderPass)
-        .setFramebuffer(framebuffer)
-        .setRenderArea({{0, 0}, {width, height}})
-        .setClearValues(clearValues);
-    commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+    if (mOverdrawQueryPool)
+    {
+        commandBuffer.resetQueryPool(mOverdrawQueryPool.get(), mCurrentFrameIndex, 1);
+        mOverdrawPixelCounts[mCurrentFrameIndex] = 0;
+    }
+    mGpuProfiler->BeginFrame(commandBuffer, mCurrentFrameIndex);
+    mFrameZone = mGpuProfiler->BeginZone(commandBuffer, FrameZoneName);
+    mRenderStatistics->BeginFrame(commandBuffer, mCurrentFrameIndex);
+    for (const auto &[renderPassType, pipelines] : mRenderQueue)
+    {
+        for (const auto &[pipeline, entities] : pipelines)
+        {
+            mRenderStatistics->AddSubmittedObjects(static_cast<uint32_t>(entities.size()));
+        }
+    }
+    // CPU遮挡剔除是本帧的结果，Hi-Z剔除是最近一次读回的GPU结果
+    mRenderStatistics->AddCulledObjects(mOcclusionCullingStats.culledCount + mHiZCullingStats.GetCulledCount());
+    UpdateGlobalUniforms();
 }
-void MRenderSystem::GBufferPass()
+void MRenderSystem::UpdateTextureStreaming()
 {
-    auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
-    auto globalDescriptorSet = mGlobalDescriptorSets[mCurrentFrameIndex].get();
-    for (const auto &[pipeline, entities] : mRenderQueue[RenderPassType::GBuffer])
+    MENGINE_PROFILE_ZONE("MRenderSystem::UpdateTextureStreaming");
+    auto textureManager = mResourceManager->GetManager<MTexture, IMTextureManager>();
+    // 按缩放前的尺寸估算，动态分辨率调整时驻留的mip保持不变
+    auto height = static_cast<float>(mOutputExtent.height);
+    // 用包围球的屏幕投影尺寸估算所需mip，假设UV在物体上铺满一次
+    for (const auto &[renderPassType, pipelines] : mRenderQueue)
     {
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
-        for (auto entity : entities)
+        for (const auto &[pipeline, entities] : pipelines)
         {
-            // 1. 绑定 pipeline
-            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
-            // 2. 绑定Global描述符集
-            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 0,
-                                             globalDescriptorSet, {});
             for (auto entity : entities)
             {
                 auto &materialComponent = mRegistry->get<MMaterialComponent>(entity);
                 auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
                 auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
-                // 3. 绑定 push_constants
-                commandBuffer.pushConstants(pipeline->GetPipelineLayout(),
-                                            vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
-                                            sizeof(glm::mat4), &transformComponent.modelMatrix);
-                // 4. 绑定材质描述符集
-                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 1,
-                                                 materialComponent.material->GetMaterialDescriptorSet(), {});
-                // 5. 绑定顶点缓冲区
-                auto vertexBuffer = meshComponent.mesh->GetVertexBuffer();
-                commandBuffer.bindVertexBuffers(0, vertexBuffer, {0});
-                // 6. 绑定索引缓冲区
-                auto indexBuffer = meshComponent.mesh->GetIndexBuffer();
-                commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
-                // 7. 绘制Draw Call
-                commandBuffer.drawIndexed(meshComponent.mesh->GetIndexCount(), 1, 0, 0, 0);
+                auto pbrMaterial = std::dynamic_pointer_cast<MPBRMaterial>(materialComponent.material);
+                if (!pbrMaterial || !meshComponent.mesh)
+                {
+                    continue;
+                }
+                auto &modelMatrix = transformComponent.modelMatrix;
+                auto center = glm::vec3(modelMatrix * glm::vec4(meshComponent.mesh->GetBoundsCenter(), 1.0f));
+                auto scale = std::max({glm::length(glm::vec3(modelMatrix[0])), glm::length(glm::vec3(modelMatrix[1])),
+                                       glm::length(glm::vec3(modelMatrix[2]))});
+                auto radius = meshComponent.mesh->GetBoundsRadius() * scale;
+                auto distance = std::max(glm::length(center - mCameraParameters.Position) - radius, 0.01f);
+                auto screenSize = radius * std::abs(mCameraParameters.ProjectionMatrix[1][1]) / distance * height;
+                auto &textures = pbrMaterial->GetTextures();
+                for (const auto &texture : {textures.Albedo, textures.Normal, textures.ARM, textures.Emissive})
+                {
+                    if (!texture || !texture->IsStreamable())
+                    {
+                        continue;
+                    }
+                    auto texels = static_cast<float>(std::max(texture->GetSize().width, texture->GetSize().height));
+                    auto mip = std::log2(texels / std::max(screenSize, 1.0f));
+                    textureManager->RequestMip(texture, static_cast<uint32_t>(std::max(0.0f, std::floor(mip))));
+                }
             }
         }
     }
+    auto changedTextures = textureManager->UpdateStreaming();
+    if (changedTextures.empty())
+    {
+        return;
+    }
+    auto materialManager = mResourceManager->GetManager<MPBRMaterial, IMPBRMaterialManager>();
+    for (auto &material : materialManager->GetAll())
+    {
+        auto &textures = material->GetTextures();
+        auto usesChangedTexture = std::ranges::any_of(changedTextures, [&textures](const auto &texture) {
+            return texture == textures.Albedo || texture == textures.Normal || texture == textures.ARM ||
+                   texture == textures.Emissive;
+        });
+        auto hasDescriptors = material->GetMaterialDescriptorSet() ||
+                              material->GetBindlessIndex() != BindlessManager::InvalidIndex;
+        // 旧描述符集(或bindless数组中的元素)可能还被其它in-flight帧读取，
+        // 重建资源时旧的经DeletionQueue延迟释放，新的写入后下一次录制才会引用
+        if (usesChangedTexture && hasDescriptors)
+        {
+            materialManager->CreateVulkanResources(material);
+            materialManager->Write(material);
+        }
+    }
+    LogTrace("Texture streaming: {} textures changed, resident {} / budget {} bytes", changedTextures.size(),
+             textureManager->GetStreamingStats().residentBytes, textureManager->GetStreamingStats().budget);
+}
+void MRenderSystem::GBufferPass()
+{
+    auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
+    RenderStatisticsScope statisticsScope(mRenderStatistics.get(), commandBuffer, "GBuffer");
+    for (const auto &[pipeline, entities] : mRenderQueue[RenderPassType::GBuffer])
+    {
+        // 1. 绑定 pipeline 和Global描述符集
+        BindPipeline(commandBuffer, pipeline);
+        for (auto entity : entities)
+        {
+            auto &materialComponent = mRegistry->get<MMaterialComponent>(entity);
+            auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
+            auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
+            // 2. 绑定 push_constants 和材质
+            BindMaterial(commandBuffer, pipeline, materialComponent.material, transformComponent.modelMatrix);
+            // 3. 绑定顶点缓冲区
+            auto vertexBuffer = meshComponent.mesh->GetVertexBuffer();
+            commandBuffer.bindVertexBuffers(0, vertexBuffer, {0});
+            // 4. 绑定索引缓冲区
+            auto indexBuffer = meshComponent.mesh->GetIndexBuffer();
+            commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
+            mRenderStatistics->BindBuffers(2);
+            // 5. 绘制Draw Call
+            DrawMesh(commandBuffer, entity, meshComponent.mesh);
+        }
+    }
 }
 void MRenderSystem::LightingPass()
 {
 
     auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
-    auto globalDescriptorSet = mGlobalDescriptorSets[mCurrentFrameIndex].get();
+    RenderStatisticsScope statisticsScope(mRenderStatistics.get(), commandBuffer, "Lighting");
     auto pipeline = mPipelineManager->GetByName(PipelineType::Lighting);
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
     // 绑定全局描述符集
     commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 0,
-                                     globalDescriptorSet, {});
+                                     mGlobalDescriptorSet.get(), mGlobalDynamicOffsets);
     auto fullscreenTriangleMesh =
         mResourceManager->GetManager<MMesh, IMMeshManager>()->GetMesh(DefaultMeshType::FullscreenTriangle);
     // 绑定全屏三角形网格
@@ -317,53 +1592,174 @@ void MRenderSystem::LightingPass()
     commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
     // 绘制全屏三角形
     commandBuffer.drawIndexed(fullscreenTriangleMesh->GetIndexCount(), 1, 0, 0, 0);
+    mRenderStatistics->BindPipeline();
+    mRenderStatistics->BindDescriptorSets();
+    mRenderStatistics->BindBuffers(2);
+    mRenderStatistics->Draw(fullscreenTriangleMesh->GetIndexCount());
+}
+void MRenderSystem::DepthPrepass(vk::CommandBuffer commandBuffer)
+{
+    RenderStatisticsScope statisticsScope(mRenderStatistics.get(), commandBuffer, "Depth Prepass");
+    auto pipeline = mPipelineManager->GetByName(PipelineType::DepthPrepass);
+    BindPipeline(commandBuffer, pipeline);
+    for (const auto &[forwardPipeline, entities] : mRenderQueue[RenderPassType::ForwardComposition])
+    {
+        // 只有带eEqual变体的不透明管线参与预渲染，透明物体不写深度
+        if (!forwardPipeline->GetDepthEqualPipeline())
+        {
+            continue;
+        }
+        for (uint32_t i = 0; i < entities.size(); ++i)
+        {
+            auto &meshComponent = mRegistry->get<MMeshComponent>(entities[i]);
+            auto &transformComponent = mRegistry->get<MTransformComponent>(entities[i]);
+            commandBuffer.pushConstants(pipeline->GetPipelineLayout(),
+                                        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
+                                        sizeof(glm::mat4), &transformComponent.modelMatrix);
+            commandBuffer.bindVertexBuffers(0, meshComponent.mesh->GetPositionBuffer(), {0});
+            commandBuffer.bindIndexBuffer(meshComponent.mesh->GetIndexBuffer(), 0, vk::IndexType::eUint32);
+            mRenderStatistics->BindBuffers(2);
+            DrawMesh(commandBuffer, entities[i], meshComponent.mesh);
+        }
+    }
 }
 void MRenderSystem::RenderForwardCompositePass()
 {
     auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
-    auto globalDescriptorSet = mGlobalDescriptorSets[mCurrentFrameIndex].get();
+    RenderStatisticsScope statisticsScope(mRenderStatistics.get(), commandBuffer, "Forward");
+    // Hi-Z第二阶段只补绘制参与剔除的管线，不重复统计overdraw
+    auto lateDraw = mHiZPhase == 1;
+    // 按pass的pipeline statistics query开启时不能再嵌套同类型的query
+    auto overdrawQuery = mOverdrawQueryPool && !lateDraw && !mRenderStatistics->IsPipelineStatisticsEnabled();
+    if (mDepthPrepassEnabled)
+    {
+        DepthPrepass(commandBuffer);
+    }
+    // query只统计着色阶段，不包含预渲染
+    if (overdrawQuery)
+    {
+        commandBuffer.beginQuery(mOverdrawQueryPool.get(), mCurrentFrameIndex, {});
+        mOverdrawPixelCounts[mCurrentFrameIndex] =
+            static_cast<uint64_t>(mRenderExtent.width) * static_cast<uint64_t>(mRenderExtent.height);
+    }
     for (const auto &[pipeline, entities] : mRenderQueue[RenderPassType::ForwardComposition])
     {
-        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
-        for (auto entity : entities)
+        if (lateDraw && !pipeline->GetDepthEqualPipeline())
         {
-            auto &materialComponent = mRegistry->get<MMaterialComponent>(entity);
-            auto &meshComponent = mRegistry->get<MMeshComponent>(entity);
-            auto &transformComponent = mRegistry->get<MTransformComponent>(entity);
-            // 1. 绑定 push_constants
-            commandBuffer.pushConstants(materialComponent.material->GetPipeline()->GetPipelineLayout(),
-                                        vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0,
-                                        sizeof(glm::mat4), &transformComponent.modelMatrix);
-            // 2. 绑定Global描述符集
-            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                             materialComponent.material->GetPipeline()->GetPipelineLayout(), 0,
-                                             globalDescriptorSet, {});
-            // 3. 绑定材质描述符集
-            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics,
-                                             materialComponent.material->GetPipeline()->GetPipelineLayout(), 1,
-                                             materialComponent.material->GetMaterialDescriptorSet(), {});
-            // 4. 绑定顶点缓冲区
+            continue;
+        }
+        // 1. 绑定 pipeline 和Global描述符集
+        BindPipeline(commandBuffer, pipeline, mDepthPrepassEnabled && pipeline->GetDepthEqualPipeline());
+        for (uint32_t i = 0; i < entities.size(); ++i)
+        {
+            auto &materialComponent = mRegistry->get<MMaterialComponent>(entities[i]);
+            auto &meshComponent = mRegistry->get<MMeshComponent>(entities[i]);
+            auto &transformComponent = mRegistry->get<MTransformComponent>(entities[i]);
+            // 2. 绑定 push_constants 和材质
+            BindMaterial(commandBuffer, pipeline, materialComponent.material, transformComponent.modelMatrix);
+            // 3. 绑定顶点缓冲区
             auto vertexBuffer = meshComponent.mesh->GetVertexBuffer();
             commandBuffer.bindVertexBuffers(0, vertexBuffer, {0});
-            // 5. 绑定索引缓冲区
+            // 4. 绑定索引缓冲区
             auto indexBuffer = meshComponent.mesh->GetIndexBuffer();
             commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
-            // 6. 绘制Draw Call
-            commandBuffer.drawIndexed(meshComponent.mesh->GetIndexCount(), 1, 0, 0, 0);
+            mRenderStatistics->BindBuffers(2);
+            // 5. 绘制Draw Call，参与Hi-Z剔除时使用indirect命令
+            DrawMesh(commandBuffer, entities[i], meshComponent.mesh);
         }
     }
+    if (overdrawQuery)
+    {
+        commandBuffer.endQuery(mOverdrawQueryPool.get(), mCurrentFrameIndex);
+    }
+}
+void MRenderSystem::ReadOverdrawStats()
+{
+    auto pixelCount = mOverdrawPixelCounts.empty() ? 0 : mOverdrawPixelCounts[mCurrentFrameIndex];
+    if (!mOverdrawQueryPool || pixelCount == 0)
+    {
+        return;
+    }
+    // 已等待过该帧的fence，结果一定可用
+    auto queryResult = mVulkanContext->GetDevice().getQueryPoolResult<uint64_t>(
+        mOverdrawQueryPool.get(), mCurrentFrameIndex, 1, sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (queryResult.result != vk::Result::eSuccess)
+    {
+        return;
+    }
+    mDepthPrepassStats.shadedFragments = queryResult.value;
+    mDepthPrepassStats.overdraw = static_cast<float>(queryResult.value) / static_cast<float>(pixelCount);
+}
+void MRenderSystem::ReadGpuFrameTime()
+{
+    if (!mGpuProfiler->Collect(mCurrentFrameIndex))
+    {
+        return;
+    }
+    mGpuFrameMs = mGpuProfiler->GetLastMs(FrameZoneName);
+    mDynamicResolution.Update(mGpuFrameMs);
+    static auto &gpuFrameMetric = Metrics::GetHistogram(GpuFrameMetric, 0.001);
+    gpuFrameMetric.Record(mGpuFrameMs);
+}
+void MRenderSystem::RecordMetrics()
+{
+    // 每帧只读取一次最近发布的统计，注册在第一次调用时完成
+    static auto &drawCallMetric = Metrics::GetHistogram("render.draw_calls");
+    static auto &triangleMetric = Metrics::GetGauge("render.triangles");
+    static auto &culledObjectMetric = Metrics::GetGauge("render.culled_objects");
+    static auto &uploadedBytesMetric = Metrics::GetCounter("render.uploaded_bytes");
+    static auto &resolutionScaleMetric = Metrics::GetGauge("render.resolution_scale");
+    auto &frame = mRenderStatistics->GetLastFrame();
+    auto total = frame.GetTotal();
+    drawCallMetric.Record(total.drawCalls);
+    triangleMetric.Set(static_cast<double>(total.triangles));
+    culledObjectMetric.Set(frame.culledObjects);
+    uploadedBytesMetric.Add(frame.uploadedBytes);
+    resolutionScaleMetric.Set(mDynamicResolution.GetScale());
+}
+void MRenderSystem::BindPipeline(vk::CommandBuffer commandBuffer, const std::shared_ptr<MPipeline> &pipeline,
+                                 bool depthEqual)
+{
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                               depthEqual ? pipeline->GetDepthEqualPipeline() : pipeline->GetPipeline());
+    // bindless管线的set:1对所有draw相同，随Global描述符集一起绑定一次
+    std::vector<vk::DescriptorSet> descriptorSets{mGlobalDescriptorSet.get()};
+    if (pipeline->GetSetting().Bindless)
+    {
+        descriptorSets.push_back(mBindlessManager->GetDescriptorSet());
+    }
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 0,
+                                     descriptorSets, mGlobalDynamicOffsets);
+    mRenderStatistics->BindPipeline();
+    mRenderStatistics->BindDescriptorSets();
+}
+void MRenderSystem::BindMaterial(vk::CommandBuffer commandBuffer, const std::shared_ptr<MPipeline> &pipeline,
+                                 const std::shared_ptr<MMaterial> &material, const glm::mat4 &modelMatrix)
+{
+    auto stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment;
+    commandBuffer.pushConstants(pipeline->GetPipelineLayout(), stageFlags, 0, sizeof(glm::mat4), &modelMatrix);
+    if (pipeline->GetSetting().Bindless)
+    {
+        auto materialIndex = material->GetBindlessIndex();
+        commandBuffer.pushConstants(pipeline->GetPipelineLayout(), stageFlags, sizeof(glm::mat4), sizeof(uint32_t),
+                                    &materialIndex);
+        return;
+    }
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 1,
+                                     material->GetMaterialDescriptorSet(), {});
+    mRenderStatistics->BindDescriptorSets();
 }
 void MRenderSystem::RenderSkyPass()
 {
     auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
-    auto globalDescriptorSet = mGlobalDescriptorSets[mCurrentFrameIndex].get();
+    RenderStatisticsScope statisticsScope(mRenderStatistics.get(), commandBuffer, "Sky");
     // 绑定天空盒管线
     auto pipeline = mPipelineManager->GetByName(PipelineType::Sky);
     commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline->GetPipeline());
 
     // 绑定全局描述符集
     commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline->GetPipelineLayout(), 0,
-                                     globalDescriptorSet, {});
+                                     mGlobalDescriptorSet.get(), mGlobalDynamicOffsets);
     // 绑定天空盒网格
     auto skyMesh = mResourceManager->GetManager<MMesh, IMMeshManager>()->GetMesh(DefaultMeshType::Sky);
     auto vertexBuffer = skyMesh->GetVertexBuffer();
@@ -373,87 +1769,123 @@ void MRenderSystem::RenderSkyPass()
     commandBuffer.bindIndexBuffer(indexBuffer, 0, vk::IndexType::eUint32);
     // 绘制天空盒
     commandBuffer.drawIndexed(skyMesh->GetIndexCount(), 1, 0, 0, 0);
+    mRenderStatistics->BindPipeline();
+    mRenderStatistics->BindDescriptorSets();
+    mRenderStatistics->BindBuffers(2);
+    mRenderStatistics->Draw(skyMesh->GetIndexCount());
 }
 void MRenderSystem::End()
 {
+    MENGINE_PROFILE_ZONE("MRenderSystem::End");
     auto commandBuffer = mGraphicsCommandBuffers[mCurrentFrameIndex].get();
     auto fence = mInFlightFences[mCurrentFrameIndex].get();
-    auto signalSemaphore = mRenderFinishedSemaphores[mCurrentFrameIndex].get();
-    auto waitSemaphore = mImageAvailableSemaphores[mCurrentFrameIndex];
-    commandBuffer.endRenderPass();
+    std::vector<vk::Semaphore> signalSemaphores{mRenderFinishedSemaphores[mCurrentFrameIndex].get()};
+    std::vector<vk::Semaphore> waitSemaphores;
+    std::vector<vk::PipelineStageFlags> waitStages;
+    mGpuProfiler->EndZone(commandBuffer, mFrameZone);
+    // uniform每帧重新写入，纹理按累计上传量求差
+    auto &streamingStats = mResourceManager->GetManager<MTexture, IMTextureManager>()->GetStreamingStats();
+    mRenderStatistics->AddUploadedBytes(mUniformArena->GetUsedBytes() + streamingStats.uploadedBytes -
+                                        mTextureUploadedBytes);
+    mTextureUploadedBytes = streamingStats.uploadedBytes;
+    mRenderStatistics->EndFrame();
     commandBuffer.end();
+    // compute提交必须先于等待它的graphics提交，剔除结果在indirect draw之前可见，
+    // HiZ Build写入Hi-Z之前compute队列已读取完毕
+    if (mAsyncComputeRecorded)
+    {
+        SubmitAsyncCompute();
+        waitSemaphores.push_back(mComputeFinishedSemaphores[mCurrentFrameIndex].get());
+        waitStages.push_back(vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eComputeShader);
+    }
+    // 本帧没有异步计算时由graphics提交消耗上一帧的信号，binary semaphore再次signal前必须被等待
+    if (mPendingGraphicsSemaphore)
+    {
+        waitSemaphores.push_back(mPendingGraphicsSemaphore);
+        waitStages.push_back(vk::PipelineStageFlagBits::eTopOfPipe);
+        mPendingGraphicsSemaphore = nullptr;
+    }
+    if (IsAsyncComputeEnabled())
+    {
+        mPendingGraphicsSemaphore = mGraphicsFinishedSemaphores[mCurrentFrameIndex].get();
+        signalSemaphores.push_back(mPendingGraphicsSemaphore);
+    }
     vk::SubmitInfo submitInfo;
-    vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eColorAttachmentOutput;
-    submitInfo.setCommandBuffers(commandBuffer).setSignalSemaphores(signalSemaphore);
+    submitInfo.setCommandBuffers(commandBuffer)
+        .setWaitSemaphores(waitSemaphores)
+        .setWaitDstStageMask(waitStages)
+        .setSignalSemaphores(signalSemaphores);
     mVulkanContext->GetGraphicsQueue().submit(submitInfo, fence);
 }
-void MRenderSystem::WriteGlobalDescriptorSet(uint32_t globalDescriptorSetIndex)
+void MRenderSystem::WriteGlobalDescriptorSet()
 {
-    memcpy(mCameraUBOAllocationInfo.pMappedData, &mCameraParameters, sizeof(CameraParameters));
-    memcpy(mLightUBOAllocationInfo.pMappedData, mLightParameters.data(), sizeof(LightParameters) * MAX_LIGHT_COUNT);
-
-    // 更新全局描述集
+    mGlobalDescriptorSet = mDescriptorAllocator->Allocate(mPipelineManager->GetGlobalDescriptorSetLayout());
     std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
     writeDescriptorSets.resize(mPipelineManager->GetGlobalDescriptorSetLayoutBindings().size());
+    // 绑定整个arena buffer，range为单帧数据大小，偏移在绑定时给出
     vk::DescriptorBufferInfo cameraParamsBufferInfo;
-    cameraParamsBufferInfo.setBuffer(mCameraUBO).setOffset(0).setRange(sizeof(CameraParameters));
+    cameraParamsBufferInfo.setBuffer(mUniformArena->GetBuffer()).setOffset(0).setRange(sizeof(CameraParameters));
     writeDescriptorSets[0]
         .setBufferInfo(cameraParamsBufferInfo)
-        .setDstSet(mGlobalDescriptorSets[globalDescriptorSetIndex].get())
+        .setDstSet(mGlobalDescriptorSet.get())
         .setDstBinding(0)
         .setDstArrayElement(0)
-        .setDescriptorType(vk::DescriptorType::eUniformBuffer)
+        .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
         .setDescriptorCount(1);
     vk::DescriptorBufferInfo lightParamsBufferInfo;
-
-    lightParamsBufferInfo.setBuffer(mLightUBO).setOffset(0).setRange(sizeof(LightParameters) * MAX_LIGHT_COUNT);
-
+    lightParamsBufferInfo.setBuffer(mUniformArena->GetBuffer())
+        .setOffset(0)
+        .setRange(sizeof(LightParameters) * MAX_LIGHT_COUNT);
     writeDescriptorSets[1]
         .setBufferInfo(lightParamsBufferInfo)
-        .setDstSet(mGlobalDescriptorSets[globalDescriptorSetIndex].get())
+        .setDstSet(mGlobalDescriptorSet.get())
         .setDstBinding(1)
         .setDstArrayElement(0)
-        .setDescriptorType(vk::DescriptorType::eUniformBuffer)
-        .setDescriptorCount(1);
-
-    vk::DescriptorImageInfo environmentMapImageInfo;
-    environmentMapImageInfo.setImageView(mEnvironmentMap->GetImageView())
-        .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-        .setSampler(mEnvironmentMap->GetSampler())
-        .setImageView(mEnvironmentMap->GetImageView());
-    writeDescriptorSets[2]
-        .setImageInfo(environmentMapImageInfo)
-        .setDstSet(mGlobalDescriptorSets[globalDescriptorSetIndex].get())
-        .setDstBinding(2)
-        .setDstArrayElement(0)
-        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+        .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
         .setDescriptorCount(1);
-    vk::DescriptorImageInfo irradianceMapImageInfo;
-    irradianceMapImageInfo.setImageView(mIrradianceMap->GetImageView())
-        .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-        .setSampler(mIrradianceMap->GetSampler())
-        .setImageView(mIrradianceMap->GetImageView());
-    writeDescriptorSets[3]
-        .setImageInfo(irradianceMapImageInfo)
-        .setDstSet(mGlobalDescriptorSets[globalDescriptorSetIndex].get())
-        .setDstBinding(3)
+    std::array<std::shared_ptr<MTexture>, 3> textures{mEnvironmentMap, mIrradianceMap, mBRDFLUT};
+    std::array<vk::DescriptorImageInfo, 3> imageInfos;
+    for (uint32_t i = 0; i < textures.size(); ++i)
+    {
+        imageInfos[i]
+            .setImageView(textures[i]->GetImageView())
+            .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+            .setSampler(textures[i]->GetSampler());
+        writeDescriptorSets[i + 2]
+            .setImageInfo(imageInfos[i])
+            .setDstSet(mGlobalDescriptorSet.get())
+            .setDstBinding(i + 2)
+            .setDstArrayElement(0)
+            .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+            .setDescriptorCount(1);
+    }
+    vk::DescriptorBufferInfo shadowParamsBufferInfo;
+    shadowParamsBufferInfo.setBuffer(mUniformArena->GetBuffer()).setOffset(0).setRange(sizeof(ShadowParameters));
+    writeDescriptorSets[5]
+        .setBufferInfo(shadowParamsBufferInfo)
+        .setDstSet(mGlobalDescriptorSet.get())
+        .setDstBinding(5)
         .setDstArrayElement(0)
-        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
+        .setDescriptorType(vk::DescriptorType::eUniformBufferDynamic)
         .setDescriptorCount(1);
-    vk::DescriptorImageInfo brdfLUTImageInfo;
-    brdfLUTImageInfo.setImageView(mBRDFLUT->GetImageView())
+    vk::DescriptorImageInfo shadowAtlasImageInfo;
+    shadowAtlasImageInfo.setImageView(mShadowAtlas.imageView.get())
         .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-        .setSampler(mBRDFLUT->GetSampler())
-        .setImageView(mBRDFLUT->GetImageView());
-    writeDescriptorSets[4]
-        .setImageInfo(brdfLUTImageInfo)
-        .setDstSet(mGlobalDescriptorSets[globalDescriptorSetIndex].get())
-        .setDstBinding(4)
+        .setSampler(mShadowSampler.get());
+    writeDescriptorSets[6]
+        .setImageInfo(shadowAtlasImageInfo)
+        .setDstSet(mGlobalDescriptorSet.get())
+        .setDstBinding(6)
         .setDstArrayElement(0)
         .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
         .setDescriptorCount(1);
-
     mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSets, {});
 }
+void MRenderSystem::UpdateGlobalUniforms()
+{
+    mGlobalDynamicOffsets[0] = mUniformArena->Push(mCameraParameters).offset;
+    mGlobalDynamicOffsets[1] = mUniformArena->Push(mLightParameters).offset;
+    mGlobalDynamicOffsets[2] = mUniformArena->Push(mShadowParameters).offset;
+}
 
 } // namespace MEngine::Function::System
\ No newline at end of file
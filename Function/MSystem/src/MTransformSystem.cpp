@@ -1,4 +1,5 @@
 #include "MTransformSystem.hpp"
+#include "CpuProfiler.hpp"
 #include "Math.hpp"
 using namespace MEngine::Function::Component;
 namespace MEngine::Function::System
@@ -8,6 +9,7 @@ void MTransformSystem::Init()
 }
 void MTransformSystem::Update(float deltaTime)
 {
+    MENGINE_PROFILE_ZONE("MTransformSystem::Update");
     auto view = mRegistry->view<MTransformComponent>();
     for (auto entity : view)
     {
@@ -1,17 +1,44 @@
 #pragma once
 #include "IMModelManager.hpp"
 #include "MModel.hpp"
+#include "MStaticBatchComponent.hpp"
 #include "ResourceManager.hpp"
+#include "Vertex.hpp"
+#include <cstdint>
 #include <entt/entt.hpp>
 #include <memory>
+#include <span>
+#include <vector>
 using namespace MEngine::Core::Asset;
 namespace MEngine::Function::Utils
 {
+struct StaticBatchStats
+{
+    uint32_t batchCount{0};
+    uint32_t entityCount{0}; // 被合并的源实体数
+};
 class EntityUtils
 {
   public:
     static entt::entity CreateEntity(std::shared_ptr<entt::registry> registry, std::shared_ptr<MModel> model);
     static std::shared_ptr<MModel> GetModelFromEntity(std::shared_ptr<Resource::ResourceManager> resourceManager,
                                                       std::shared_ptr<entt::registry> registry, entt::entity entity);
+    /**
+     * @brief 静态合批
+     * 把isStatic且管线、材质相同的实体的网格变换到世界空间后用MMeshManager::Create合并为一个网格，
+     * 生成带MStaticBatchComponent的实体，源实体加上MStaticBatchedComponent后不再单独绘制。
+     * 遮挡体保持独立以参与CPU遮挡剔除。源实体移动或修改后需要重新构建
+     */
+    static StaticBatchStats BuildStaticBatches(std::shared_ptr<Resource::ResourceManager> resourceManager,
+                                               std::shared_ptr<entt::registry> registry);
+    // 销毁批次实体和合并网格，恢复源实体的独立绘制
+    static void ClearStaticBatches(std::shared_ptr<Resource::ResourceManager> resourceManager,
+                                   std::shared_ptr<entt::registry> registry);
+    // 把网格变换到世界空间后追加到vertices/indices末尾，返回对应的段
+    static Component::MStaticBatchSection AppendStaticMesh(std::vector<Vertex> &vertices,
+                                                           std::vector<uint32_t> &indices,
+                                                           std::span<const Vertex> meshVertices,
+                                                           std::span<const uint32_t> meshIndices,
+                                                           const glm::mat4 &modelMatrix);
 };
 } // namespace MEngine::Function::Utils
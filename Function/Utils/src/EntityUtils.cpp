@@ -1,11 +1,17 @@
 #include "EntityUtils.hpp"
+#include "IMMeshManager.hpp"
 #include "MMaterialComponent.hpp"
 #include "MMeshComponent.hpp"
 #include "MModel.hpp"
 #include "MTransformComponent.hpp"
 #include <entt/entt.hpp>
+#include <format>
 #include <functional>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <limits>
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 using namespace MEngine::Function::Component;
 namespace MEngine::Function::Utils
@@ -92,4 +98,120 @@ std::shared_ptr<MModel> EntityUtils::GetModelFromEntity(std::shared_ptr<Resource
     }
     return nullptr;
 }
+StaticBatchStats EntityUtils::BuildStaticBatches(std::shared_ptr<Resource::ResourceManager> resourceManager,
+                                                 std::shared_ptr<entt::registry> registry)
+{
+    ClearStaticBatches(resourceManager, registry);
+    auto meshManager = resourceManager->GetManager<MMesh, IMMeshManager>();
+    // 材质决定管线，按(管线, 材质)分组使批次按管线排列
+    std::map<std::pair<std::shared_ptr<MPipeline>, std::shared_ptr<MMaterial>>, std::vector<entt::entity>> groups;
+    auto view = registry->view<MTransformComponent, MMeshComponent, MMaterialComponent>();
+    for (auto entity : view)
+    {
+        auto &transformComponent = view.get<MTransformComponent>(entity);
+        auto &meshComponent = view.get<MMeshComponent>(entity);
+        auto &materialComponent = view.get<MMaterialComponent>(entity);
+        if (!transformComponent.isStatic || meshComponent.isOccluder || !meshComponent.mesh ||
+            !materialComponent.material)
+        {
+            continue;
+        }
+        groups[{materialComponent.material->GetPipeline(), materialComponent.material}].push_back(entity);
+    }
+    StaticBatchStats stats{};
+    for (const auto &[key, entities] : groups)
+    {
+        // 只有一个实体时合并不会减少绘制
+        if (entities.size() < 2)
+        {
+            continue;
+        }
+        const auto &material = key.second;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        Component::MStaticBatchComponent batchComponent{};
+        for (auto entity : entities)
+        {
+            auto &mesh = registry->get<MMeshComponent>(entity).mesh;
+            auto &modelMatrix = registry->get<MTransformComponent>(entity).modelMatrix;
+            batchComponent.sections.push_back(
+                AppendStaticMesh(vertices, indices, mesh->GetVertices(), mesh->GetIndices(), modelMatrix));
+            batchComponent.sources.push_back(entity);
+        }
+        auto mesh = meshManager->Create(std::format("Static Batch ({})", material->GetName()), vertices, indices,
+                                        MMeshSetting{});
+        meshManager->CreateVulkanResources(mesh);
+        meshManager->Write(mesh);
+
+        auto batchEntity = registry->create();
+        auto &transformComponent = registry->emplace<MTransformComponent>(batchEntity, MTransformComponent{});
+        transformComponent.name = mesh->GetName();
+        transformComponent.isStatic = true;
+        auto &meshComponent = registry->emplace<MMeshComponent>(batchEntity, MMeshComponent{});
+        meshComponent.meshID = mesh->GetID();
+        meshComponent.mesh = mesh;
+        auto &materialComponent = registry->emplace<MMaterialComponent>(batchEntity, MMaterialComponent{});
+        materialComponent.materialID = material->GetID();
+        materialComponent.material = material;
+        for (auto entity : entities)
+        {
+            registry->emplace_or_replace<Component::MStaticBatchedComponent>(
+                entity, Component::MStaticBatchedComponent{.batch = batchEntity});
+        }
+        registry->emplace<Component::MStaticBatchComponent>(batchEntity, std::move(batchComponent));
+        stats.batchCount++;
+        stats.entityCount += static_cast<uint32_t>(entities.size());
+    }
+    return stats;
+}
+void EntityUtils::ClearStaticBatches(std::shared_ptr<Resource::ResourceManager> resourceManager,
+                                     std::shared_ptr<entt::registry> registry)
+{
+    auto meshManager = resourceManager->GetManager<MMesh, IMMeshManager>();
+    auto batchView = registry->view<Component::MStaticBatchComponent, MMeshComponent>();
+    std::vector<entt::entity> batches(batchView.begin(), batchView.end());
+    for (auto batch : batches)
+    {
+        // 合并网格的buffer由MMesh析构时推入删除队列
+        meshManager->Remove(registry->get<MMeshComponent>(batch).mesh->GetID());
+        registry->destroy(batch);
+    }
+    registry->clear<Component::MStaticBatchedComponent>();
+}
+Component::MStaticBatchSection EntityUtils::AppendStaticMesh(std::vector<Vertex> &vertices,
+                                                             std::vector<uint32_t> &indices,
+                                                             std::span<const Vertex> meshVertices,
+                                                             std::span<const uint32_t> meshIndices,
+                                                             const glm::mat4 &modelMatrix)
+{
+    Component::MStaticBatchSection section{};
+    section.firstIndex = static_cast<uint32_t>(indices.size());
+    section.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+    section.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+    auto baseVertex = static_cast<uint32_t>(vertices.size());
+    auto normalMatrix = glm::inverseTranspose(glm::mat3(modelMatrix));
+    for (const auto &vertex : meshVertices)
+    {
+        auto position = glm::vec3(modelMatrix * glm::vec4(vertex.position, 1.0f));
+        auto normal = normalMatrix * vertex.normal;
+        auto length = glm::length(normal);
+        vertices.push_back(Vertex{position, length > 0.0f ? normal / length : normal, vertex.texCoords});
+        section.boundsMin = glm::min(section.boundsMin, position);
+        section.boundsMax = glm::max(section.boundsMax, position);
+    }
+    if (meshVertices.empty())
+    {
+        section.boundsMin = section.boundsMax = glm::vec3(0.0f);
+    }
+    // 镜像变换会翻转三角形环绕方向，交换两个顶点以保持正面朝向
+    auto mirrored = glm::determinant(glm::mat3(modelMatrix)) < 0.0f;
+    for (size_t i = 0; i + 2 < meshIndices.size(); i += 3)
+    {
+        indices.push_back(baseVertex + meshIndices[i]);
+        indices.push_back(baseVertex + meshIndices[mirrored ? i + 2 : i + 1]);
+        indices.push_back(baseVertex + meshIndices[mirrored ? i + 1 : i + 2]);
+    }
+    section.indexCount = static_cast<uint32_t>(indices.size()) - section.firstIndex;
+    return section;
+}
 } // namespace MEngine::Function::Utils
@@ -0,0 +1,43 @@
+#pragma once
+#include "VMA.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+/**
+ * @brief 按帧延迟释放的GPU资源队列
+ * 第N帧提交的释放任务在第N+framesInFlight帧开始(该帧fence已等待)时执行，
+ * 替换资源时不再需要device.waitIdle()
+ */
+class DeletionQueue final
+{
+  private:
+    struct Entry
+    {
+        uint64_t frame{0};
+        std::move_only_function<void()> deleter;
+    };
+    std::mutex mMutex;
+    std::deque<Entry> mEntries;
+    uint64_t mFrame{0};
+
+  public:
+    DeletionQueue() = default;
+    ~DeletionQueue();
+    DeletionQueue(const DeletionQueue &) = delete;
+    DeletionQueue &operator=(const DeletionQueue &) = delete;
+    void Push(std::move_only_function<void()> deleter);
+    void PushBuffer(VmaAllocator allocator, vk::Buffer buffer, VmaAllocation allocation);
+    void PushImage(VmaAllocator allocator, vk::Image image, VmaAllocation allocation);
+    // 在等待完本帧fence后调用，执行已不被任何in-flight帧引用的释放任务
+    void BeginFrame(uint32_t framesInFlight);
+    // 立即执行所有释放任务，调用前需确保GPU空闲
+    void Flush();
+    std::size_t GetPendingCount();
+};
+} // namespace MEngine
@@ -0,0 +1,82 @@
+#pragma once
+#include "VulkanContext.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+struct DescriptorAllocatorStats
+{
+    uint32_t persistentPoolCount{0};
+    uint32_t transientPoolCount{0};
+    uint64_t persistentSetCount{0}; // 累计分配的持久描述符集
+    uint32_t transientSetCount{0};  // 当前帧分配的临时描述符集
+    uint32_t cacheHitCount{0};      // 当前帧内容相同而复用的临时描述符集
+};
+// 描述符集中一个binding的内容，用于写入和计算内容哈希
+struct DescriptorWrite
+{
+    uint32_t binding{0};
+    vk::DescriptorType type{vk::DescriptorType::eUniformBuffer};
+    vk::DescriptorBufferInfo bufferInfo{};
+    vk::DescriptorImageInfo imageInfo{};
+    bool operator==(const DescriptorWrite &other) const = default;
+};
+/**
+ * @brief 可增长的描述符分配器
+ * 持久描述符集从池链分配，所有池(包括有描述符集被释放的旧池)都耗尽时才追加新池；临时描述符集从每帧的池分配，帧开始时整体重置，
+ * 同一帧内布局和内容相同的临时描述符集只分配一次
+ */
+class DescriptorAllocator final
+{
+  private:
+    // DI
+    std::shared_ptr<VulkanContext> mVulkanContext;
+
+  public:
+    static constexpr uint32_t SetsPerPool = 256;
+
+  private:
+    // 哈希相同时还要比较布局和内容
+    struct TransientSet
+    {
+        vk::DescriptorSetLayout layout;
+        std::vector<DescriptorWrite> writes;
+        vk::DescriptorSet descriptorSet;
+    };
+    struct FramePools
+    {
+        std::vector<vk::UniqueDescriptorPool> pools;
+        uint32_t usedPoolCount{0};
+        std::unordered_multimap<std::size_t, TransientSet> cache;
+    };
+    std::vector<vk::UniqueDescriptorPool> mPersistentPools;
+    std::size_t mPersistentPoolIndex{0}; // 上次分配成功的池
+    std::vector<FramePools> mFramePools;
+    DescriptorAllocatorStats mStats{};
+
+  private:
+    vk::UniqueDescriptorPool CreatePool(vk::DescriptorPoolCreateFlags flags) const;
+    static std::size_t Hash(vk::DescriptorSetLayout layout, std::span<const DescriptorWrite> writes);
+    void Write(vk::DescriptorSet descriptorSet, std::span<const DescriptorWrite> writes) const;
+
+  public:
+    DescriptorAllocator(std::shared_ptr<VulkanContext> vulkanContext);
+    // 分配生命周期由调用者管理的描述符集，释放回所属的池
+    vk::UniqueDescriptorSet Allocate(vk::DescriptorSetLayout layout);
+    // 重置frameIndex的临时池，调用前需确保该帧的命令缓冲区已执行完毕
+    void ResetFrame(uint32_t frameIndex);
+    // 分配只在frameIndex这一帧有效的描述符集并写入内容
+    vk::DescriptorSet AllocateTransient(uint32_t frameIndex, vk::DescriptorSetLayout layout,
+                                        std::span<const DescriptorWrite> writes);
+    inline const DescriptorAllocatorStats &GetStats() const
+    {
+        return mStats;
+    }
+};
+} // namespace MEngine
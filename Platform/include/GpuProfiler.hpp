@@ -0,0 +1,117 @@
+#pragma once
+#include "RollingStatistics.hpp"
+#include "VulkanContext.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+struct GpuProfilerZoneStats
+{
+    std::string name;
+    uint32_t depth{0}; // 嵌套层级，0为最外层
+    float lastMs{0.0f};
+    float meanMs{0.0f};
+    float p95Ms{0.0f};
+    float maxMs{0.0f};
+};
+/**
+ * @brief 基于timestamp query的GPU分段计时
+ * 每个in-flight帧一个query pool，zone首尾各写入一个timestamp；
+ * 在该帧的fence之后读取上次提交的结果，不等待GPU，同名zone在一帧内的时间累加后记入滚动统计
+ */
+class GpuProfiler final
+{
+  public:
+    static constexpr uint32_t InvalidZone = UINT32_MAX;
+    static constexpr uint32_t HistoryFrames = 256;
+
+  private:
+    std::shared_ptr<VulkanContext> mVulkanContext;
+    struct Zone
+    {
+        std::string name;
+        uint32_t depth{0};
+        uint32_t beginQuery{0};
+        bool ended{false};
+    };
+    struct Frame
+    {
+        vk::UniqueQueryPool queryPool;
+        std::vector<Zone> zones;
+        uint32_t queryCount{0};
+    };
+    std::vector<Frame> mFrames; // 不支持timestamp时为空
+    uint32_t mMaxQueries{0};
+    uint32_t mCurrentFrame{UINT32_MAX}; // 正在记录的帧
+    uint32_t mDepth{0};
+    struct ZoneHistory
+    {
+        uint32_t depth{0};
+        RollingStatistics stats{HistoryFrames};
+    };
+    std::vector<std::string> mZoneOrder; // 首次出现的顺序
+    std::unordered_map<std::string, ZoneHistory> mHistory;
+    uint64_t mCollectedFrames{0};
+
+  public:
+    GpuProfiler(std::shared_ptr<VulkanContext> vulkanContext, uint32_t framesInFlight,
+                uint32_t maxZonesPerFrame = 64);
+    GpuProfiler(const GpuProfiler &) = delete;
+    GpuProfiler &operator=(const GpuProfiler &) = delete;
+    inline bool IsSupported() const
+    {
+        return !mFrames.empty();
+    }
+    // 在该帧的fence之后调用，结果尚不可用时返回false
+    bool Collect(uint32_t frameIndex);
+    // 在该帧第一个命令缓冲区的开头调用，之后提交的命令缓冲区都可以记录zone
+    void BeginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex);
+    uint32_t BeginZone(vk::CommandBuffer commandBuffer, std::string_view name);
+    void EndZone(vk::CommandBuffer commandBuffer, uint32_t zone);
+    // 最近一次读取到的耗时，zone不存在时为0
+    float GetLastMs(const std::string &name) const;
+    std::vector<GpuProfilerZoneStats> GetStats() const;
+    inline uint64_t GetCollectedFrames() const
+    {
+        return mCollectedFrames;
+    }
+    void Reset();
+    nlohmann::json ToJson() const;
+    void DumpJson(const std::filesystem::path &path) const;
+};
+// 作用域内的命令计入一个zone
+class GpuProfileScope final
+{
+  private:
+    GpuProfiler *mProfiler;
+    vk::CommandBuffer mCommandBuffer;
+    uint32_t mZone{GpuProfiler::InvalidZone};
+
+  public:
+    GpuProfileScope(GpuProfiler *profiler, vk::CommandBuffer commandBuffer, std::string_view name)
+        : mProfiler(profiler), mCommandBuffer(commandBuffer)
+    {
+        if (mProfiler)
+        {
+            mZone = mProfiler->BeginZone(mCommandBuffer, name);
+        }
+    }
+    ~GpuProfileScope()
+    {
+        if (mProfiler)
+        {
+            mProfiler->EndZone(mCommandBuffer, mZone);
+        }
+    }
+    GpuProfileScope(const GpuProfileScope &) = delete;
+    GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+};
+} // namespace MEngine
@@ -0,0 +1,186 @@
+#pragma once
+#include "GpuProfiler.hpp"
+#include "RenderStatistics.hpp"
+#include "VMA.hpp"
+#include "VulkanContext.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+using RenderGraphResource = uint32_t;
+enum class RenderGraphAccessType
+{
+    // attachment由render pass自身的layout转换和subpass依赖同步
+    ColorAttachment,
+    DepthStencilAttachment,
+    InputAttachment,
+    // 以下由render graph插入barrier
+    SampledRead,
+    StorageRead,
+    StorageWrite,
+    TransferRead,
+    TransferWrite,
+};
+struct RenderGraphAccess
+{
+    RenderGraphResource resource{0};
+    RenderGraphAccessType type{RenderGraphAccessType::SampledRead};
+    vk::PipelineStageFlags stage{}; // 为空时按type推断
+    // attachment在render pass结束后的布局，eUndefined表示与使用时的布局相同
+    vk::ImageLayout finalLayout{vk::ImageLayout::eUndefined};
+};
+struct RenderGraphImageDesc
+{
+    vk::Format format{vk::Format::eR8G8B8A8Unorm};
+    vk::Extent2D extent{1, 1};
+    vk::ImageUsageFlags usage{};
+    vk::ImageAspectFlags aspect{vk::ImageAspectFlagBits::eColor};
+    // 只在一个render pass内读写(load clear/store don't care)，支持时放入lazily allocated内存
+    bool lazy{false};
+    bool operator==(const RenderGraphImageDesc &) const = default;
+};
+struct RenderGraphStats
+{
+    uint32_t passCount{0};
+    uint32_t barrierCount{0};      // 本帧插入的image barrier
+    uint32_t barrierBatchCount{0}; // 本帧的vkCmdPipelineBarrier调用
+    uint32_t transientImageCount{0};
+    uint32_t lazyImageCount{0};
+    uint32_t aliasedImageCount{0};            // 与其他transient共享内存的image
+    vk::DeviceSize transientBytes{0};         // 实际分配的transient内存(不含lazy)
+    vk::DeviceSize transientRequiredBytes{0}; // 每个transient单独分配时所需的内存
+};
+// transient内存别名规划的输入，lifetime为首次/最后使用的pass序号
+struct RenderGraphAliasRequest
+{
+    vk::DeviceSize size{0};
+    vk::DeviceSize alignment{1};
+    uint32_t memoryTypeBits{~0u};
+    uint32_t firstPass{0};
+    uint32_t lastPass{0};
+};
+struct RenderGraphAliasPlan
+{
+    std::vector<uint32_t> blockOfRequest;
+    std::vector<vk::DeviceSize> blockSizes;
+};
+/**
+ * @brief 每帧重新声明的render graph
+ * pass声明对资源的读写，编译时按声明顺序推导layout转换和barrier，同一pass前的barrier合并为一次调用；
+ * transient image按生命周期不重叠的原则共享VMA内存块，物理资源在声明不变时跨帧复用
+ */
+class RenderGraph final
+{
+  private:
+    // DI
+    std::shared_ptr<VulkanContext> mVulkanContext;
+
+  private:
+    struct ResourceState
+    {
+        vk::ImageLayout layout{vk::ImageLayout::eUndefined};
+        vk::PipelineStageFlags pendingStages{}; // 后续写入需要等待的stage
+        vk::AccessFlags pendingWrite{};         // 尚未对所有stage可见的写入
+        vk::PipelineStageFlags visibleStages{}; // 已对其可见的stage
+        bool attachment{false};                 // 最后一次访问来自render pass
+    };
+    struct Resource
+    {
+        std::string name;
+        bool imported{false};
+        vk::Image image{};
+        vk::ImageView imageView{};
+        vk::ImageAspectFlags aspect{vk::ImageAspectFlagBits::eColor};
+        vk::ImageLayout exportLayout{vk::ImageLayout::eUndefined};
+        RenderGraphImageDesc desc{};
+        uint32_t transientIndex{0};
+        ResourceState state{};
+    };
+    struct Pass
+    {
+        std::string name;
+        std::vector<RenderGraphAccess> accesses;
+        std::function<void(vk::CommandBuffer)> execute;
+        std::vector<vk::ImageMemoryBarrier> barriers;
+        vk::PipelineStageFlags srcStages{};
+        vk::PipelineStageFlags dstStages{};
+    };
+    struct PhysicalImage
+    {
+        RenderGraphImageDesc desc{};
+        vk::Image image{};
+        vk::UniqueImageView imageView;
+        std::pair<uint32_t, uint32_t> lifetime{0, 0};
+        VmaAllocation allocation{}; // lazy image独占的分配
+        uint32_t block{0};
+    };
+    // 内存块上最后一个使用者结束时的同步状态，下一个使用者(本帧或下一帧)从这里开始
+    struct MemoryBlock
+    {
+        VmaAllocation allocation{};
+        vk::PipelineStageFlags pendingStages{};
+        vk::AccessFlags pendingWrite{};
+        bool attachment{false};
+    };
+    std::vector<Resource> mResources;
+    std::vector<Pass> mPasses;
+    std::vector<RenderGraphResource> mTransients;
+    std::vector<PhysicalImage> mPhysicalImages;
+    std::vector<MemoryBlock> mMemoryBlocks;
+    std::vector<vk::ImageMemoryBarrier> mExportBarriers;
+    vk::PipelineStageFlags mExportSrcStages{};
+    uint64_t mPhysicalVersion{0};
+    bool mLazyMemorySupported{false};
+    bool mCompiled{false};
+    RenderGraphStats mStats{};
+
+  private:
+    void AllocateTransients(const std::vector<std::pair<uint32_t, uint32_t>> &lifetimes);
+    void ReleasePhysicalImages();
+    void Transition(Pass &pass, Resource &resource, const RenderGraphAccess &access);
+
+  public:
+    RenderGraph(std::shared_ptr<VulkanContext> vulkanContext);
+    ~RenderGraph();
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+    // 每帧声明前调用，保留transient的物理资源
+    void Reset();
+    // 外部持有的image，layout为进入本帧时的布局
+    // pendingStages为之前提交的帧可能仍在访问的stage，跨帧保留的image在本帧首次写入前等待这些stage
+    RenderGraphResource ImportImage(const std::string &name, vk::Image image, vk::ImageView imageView,
+                                    vk::ImageAspectFlags aspect, vk::ImageLayout layout,
+                                    vk::PipelineStageFlags pendingStages = {});
+    // 由render graph分配、内容不跨帧保留的image
+    RenderGraphResource CreateImage(const std::string &name, const RenderGraphImageDesc &desc);
+    // 帧结束时资源需要处于的布局，跨submit的内存可见性由semaphore保证
+    void ExportImage(RenderGraphResource resource, vk::ImageLayout layout);
+    void AddPass(const std::string &name, std::vector<RenderGraphAccess> accesses,
+                 std::function<void(vk::CommandBuffer)> execute);
+    void Compile();
+    // profiler不为空时每个pass(含其前的barrier)记为一个GPU zone，statistics不为空时按pass统计渲染计数
+    void Execute(vk::CommandBuffer commandBuffer, GpuProfiler *profiler = nullptr,
+                 RenderStatistics *statistics = nullptr);
+    vk::Image GetImage(RenderGraphResource resource) const;
+    vk::ImageView GetImageView(RenderGraphResource resource) const;
+    const std::vector<vk::ImageMemoryBarrier> &GetBarriers(uint32_t passIndex) const;
+    // transient物理资源被重新分配时递增，引用其image view的framebuffer需要重建
+    inline uint64_t GetPhysicalVersion() const
+    {
+        return mPhysicalVersion;
+    }
+    inline const RenderGraphStats &GetStats() const
+    {
+        return mStats;
+    }
+    // 按生命周期为transient分配内存块，生命周期不重叠且内存类型兼容的请求共享同一块
+    static RenderGraphAliasPlan PlanAliasing(std::span<const RenderGraphAliasRequest> requests);
+};
+} // namespace MEngine
@@ -0,0 +1,140 @@
+#pragma once
+#include "VulkanContext.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+struct RenderPassStatistics
+{
+    std::string name;
+    uint32_t depth{0};      // 嵌套层级，0为render graph的pass
+    uint32_t drawCalls{0};  // indirect命令按提交时的上限统计，不含GPU剔除
+    uint32_t instances{0};
+    uint64_t triangles{0};
+    uint32_t dispatches{0};
+    uint32_t pipelineBinds{0};
+    uint32_t descriptorBinds{0}; // vkCmdBindDescriptorSets调用
+    uint32_t bufferBinds{0};     // 顶点和索引缓冲区
+    // pipeline statistics query，未开启或不支持时为0，只统计depth为0的pass
+    uint64_t vertexInvocations{0};
+    uint64_t fragmentInvocations{0};
+    RenderPassStatistics &operator+=(const RenderPassStatistics &other);
+};
+struct RenderFrameStatistics
+{
+    std::vector<RenderPassStatistics> passes; // 按开始顺序
+    uint32_t submittedObjects{0}; // CPU剔除之后提交绘制的物体
+    uint32_t culledObjects{0};    // CPU剔除和GPU剔除之和
+    vk::DeviceSize uploadedBytes{0};
+    bool hasPipelineStatistics{false};
+    // 计数只记在最内层的pass，所有pass直接相加
+    RenderPassStatistics GetTotal() const;
+};
+/**
+ * @brief 每帧按pass统计的渲染计数
+ * 计数记到最内层打开的pass，pass之外的命令记到UnscopedPassName；
+ * 开启pipeline statistics时每个in-flight帧一个query pool，每个最外层pass一个query，在该帧的fence之后读取
+ */
+class RenderStatistics final
+{
+  public:
+    static constexpr const char *UnscopedPassName = "Other";
+    static constexpr uint32_t InvalidPass = UINT32_MAX;
+
+  private:
+    std::shared_ptr<VulkanContext> mVulkanContext;
+    struct Frame
+    {
+        vk::UniqueQueryPool queryPool;
+        std::vector<uint32_t> queryPasses; // 每个query对应的pass
+        RenderFrameStatistics statistics;
+    };
+    std::vector<Frame> mFrames;
+    uint32_t mMaxQueries{0};
+    bool mPipelineStatisticsEnabled{false};
+    uint32_t mCurrentFrame{UINT32_MAX};
+    bool mFrameUsesQueries{false};
+    bool mQueryActive{false};
+    RenderFrameStatistics mCurrent;
+    RenderFrameStatistics mLast;
+    std::vector<uint32_t> mPassStack;
+
+  private:
+    uint32_t FindOrAddPass(std::string_view name, uint32_t depth);
+    RenderPassStatistics &GetCurrentPass();
+
+  public:
+    // vulkanContext为空或设备不支持时不创建query，只统计CPU端的计数
+    RenderStatistics(std::shared_ptr<VulkanContext> vulkanContext, uint32_t framesInFlight,
+                     uint32_t maxPassesPerFrame = 64);
+    RenderStatistics(const RenderStatistics &) = delete;
+    RenderStatistics &operator=(const RenderStatistics &) = delete;
+    inline bool IsPipelineStatisticsSupported() const
+    {
+        return !mFrames.empty() && mFrames.front().queryPool;
+    }
+    inline void SetPipelineStatisticsEnabled(bool enabled)
+    {
+        mPipelineStatisticsEnabled = enabled;
+    }
+    // 开启时与其它pipeline statistics query不能同时进行
+    inline bool IsPipelineStatisticsEnabled() const
+    {
+        return mPipelineStatisticsEnabled && IsPipelineStatisticsSupported();
+    }
+    // 在该帧的fence之后调用，填入该帧的pipeline statistics并发布
+    void Collect(uint32_t frameIndex);
+    // commandBuffer为空时本帧不使用query
+    void BeginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex);
+    // 没有使用query的帧立即发布
+    void EndFrame();
+    // 同一帧中同名同层级的pass合并，commandBuffer为空时不使用query
+    uint32_t BeginPass(vk::CommandBuffer commandBuffer, std::string_view name);
+    void EndPass(vk::CommandBuffer commandBuffer, uint32_t pass);
+    void Draw(uint32_t indexCount, uint32_t instanceCount = 1);
+    void Dispatch();
+    void BindPipeline();
+    void BindDescriptorSets();
+    void BindBuffers(uint32_t count);
+    void AddSubmittedObjects(uint32_t count);
+    void AddCulledObjects(uint32_t count);
+    void AddUploadedBytes(vk::DeviceSize bytes);
+    // 最近一个完整的帧
+    inline const RenderFrameStatistics &GetLastFrame() const
+    {
+        return mLast;
+    }
+};
+// 作用域内的命令计入一个pass
+class RenderStatisticsScope final
+{
+  private:
+    RenderStatistics *mStatistics;
+    vk::CommandBuffer mCommandBuffer;
+    uint32_t mPass{RenderStatistics::InvalidPass};
+
+  public:
+    RenderStatisticsScope(RenderStatistics *statistics, vk::CommandBuffer commandBuffer, std::string_view name)
+        : mStatistics(statistics), mCommandBuffer(commandBuffer)
+    {
+        if (mStatistics)
+        {
+            mPass = mStatistics->BeginPass(mCommandBuffer, name);
+        }
+    }
+    ~RenderStatisticsScope()
+    {
+        if (mStatistics)
+        {
+            mStatistics->EndPass(mCommandBuffer, mPass);
+        }
+    }
+    RenderStatisticsScope(const RenderStatisticsScope &) = delete;
+    RenderStatisticsScope &operator=(const RenderStatisticsScope &) = delete;
+};
+} // namespace MEngine
@@ -0,0 +1,64 @@
+#pragma once
+#include "VMA.hpp"
+#include "VulkanContext.hpp"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+
+namespace MEngine
+{
+struct UniformAllocation
+{
+    vk::Buffer buffer{};
+    uint32_t offset{0}; // 用作dynamic offset
+    vk::DeviceSize size{0};
+    void *data{nullptr};
+};
+/**
+ * @brief 按帧划分的线性uniform/storage分配器
+ * 一个持久映射的buffer按in-flight帧数分成若干段，每帧只在自己的段内线性分配，
+ * 描述符绑定整个buffer，通过dynamic offset定位本帧数据
+ */
+class UniformArena final
+{
+  private:
+    std::shared_ptr<VulkanContext> mVulkanContext;
+    vk::Buffer mBuffer{};
+    VmaAllocation mAllocation{};
+    VmaAllocationInfo mAllocationInfo{};
+    vk::DeviceSize mAlignment{256};
+    vk::DeviceSize mBytesPerFrame{0};
+    uint32_t mFrameCount{0};
+    uint32_t mFrameIndex{0};
+    vk::DeviceSize mHead{0};
+
+  public:
+    UniformArena(std::shared_ptr<VulkanContext> vulkanContext, uint32_t frameCount, vk::DeviceSize bytesPerFrame);
+    ~UniformArena();
+    UniformArena(const UniformArena &) = delete;
+    UniformArena &operator=(const UniformArena &) = delete;
+    // 帧开始时调用，调用前需确保该帧上次提交的命令已执行完毕
+    void Reset(uint32_t frameIndex);
+    UniformAllocation Allocate(vk::DeviceSize size);
+    template <typename T> UniformAllocation Push(const T &value)
+    {
+        auto allocation = Allocate(sizeof(T));
+        std::memcpy(allocation.data, &value, sizeof(T));
+        vmaFlushAllocation(mVulkanContext->GetVmaAllocator(), mAllocation, allocation.offset, sizeof(T));
+        return allocation;
+    }
+    inline vk::Buffer GetBuffer() const
+    {
+        return mBuffer;
+    }
+    inline vk::DeviceSize GetUsedBytes() const
+    {
+        return mHead;
+    }
+    inline vk::DeviceSize GetBytesPerFrame() const
+    {
+        return mBytesPerFrame;
+    }
+};
+} // namespace MEngine
@@ -1,4 +1,5 @@
 #pragma once
+#include "DeletionQueue.hpp"
 #include "VMA.hpp"
 #include <memory>
 #include <optional>
@@ -13,6 +14,11 @@ struct VulkanContextConfig
     std::vector<const char *> DeviceRequiredExtensions;
     std::vector<const char *> DeviceRequiredLayers;
 };
+struct VulkanMemoryBudget
+{
+    vk::DeviceSize budget{0}; // 当前进程可用的显存预算
+    vk::DeviceSize usage{0};  // 当前进程已使用的显存
+};
 class VulkanContext
 {
   private:
@@ -28,6 +34,8 @@ class VulkanContext
         std::optional<uint32_t> presentFamilyCount;
         std::optional<uint32_t> transferFamily;
         std::optional<uint32_t> transferFamilyCount;
+        std::optional<uint32_t> computeFamily; // 没有独立的compute family时与graphics family相同
+        std::optional<uint32_t> computeFamilyCount;
     } QueueFamilyIndicates;
     struct SurfaceInfo
     {
@@ -42,14 +50,22 @@ class VulkanContext
     vk::UniqueCommandPool GraphicsCommandPool;
     vk::UniqueCommandPool TransferCommandPool;
     vk::UniqueCommandPool PresentCommandPool;
+    vk::UniqueCommandPool ComputeCommandPool;
     vk::Queue GraphicsQueue;
     vk::Queue TransferQueue;
     vk::Queue PresentQueue;
+    vk::Queue ComputeQueue;
     uint32_t Version = 0;
-    vk::UniqueDescriptorPool DescriptorPool;
+    bool MemoryBudgetSupported = false;
+    bool BindlessSupported = false;
+    bool PipelineStatisticsSupported = false;
+    float TimestampPeriod = 0.0f; // 每个tick的纳秒数，graphics队列不支持timestamp时为0
+    uint32_t TimestampValidBits = 0;
 
     // VMA
     VmaAllocator VmaAllocator;
+    // 延迟到GPU不再使用时释放的资源
+    DeletionQueue DeferredDeletion;
 
     // Swapchain
     vk::UniqueSwapchainKHR mSwapchain;
@@ -89,6 +105,10 @@ class VulkanContext
     {
         return PresentQueue;
     }
+    inline const vk::Queue &GetComputeQueue() const
+    {
+        return ComputeQueue;
+    }
     inline const vk::CommandPool &GetGraphicsCommandPool() const
     {
         return *GraphicsCommandPool;
@@ -101,6 +121,20 @@ class VulkanContext
     {
         return *PresentCommandPool;
     }
+    inline const vk::CommandPool &GetComputeCommandPool() const
+    {
+        return *ComputeCommandPool;
+    }
+    // compute队列属于独立的family时才能与graphics队列并行执行
+    inline bool IsAsyncComputeSupported() const
+    {
+        return QueueFamilyIndicates.computeFamily != QueueFamilyIndicates.graphicsFamily;
+    }
+    // transfer队列属于独立的family时，上传的资源需要在两个队列之间转移所有权
+    inline bool IsDedicatedTransferSupported() const
+    {
+        return QueueFamilyIndicates.transferFamily != QueueFamilyIndicates.graphicsFamily;
+    }
     inline const struct QueueFamilyIndicates &GetQueueFamilyIndicates() const
     {
         return QueueFamilyIndicates;
@@ -130,10 +164,34 @@ class VulkanContext
     {
         return SurfaceInfo;
     }
-    inline const vk::DescriptorPool GetDescriptorPool() const
+    inline DeletionQueue &GetDeletionQueue()
+    {
+        return DeferredDeletion;
+    }
+    // 设备支持descriptor indexing(update after bind + partially bound + runtime array)
+    inline bool IsBindlessSupported() const
+    {
+        return BindlessSupported;
+    }
+    inline bool IsPipelineStatisticsSupported() const
+    {
+        return PipelineStatisticsSupported;
+    }
+    inline bool IsTimestampSupported() const
+    {
+        return TimestampPeriod > 0.0f;
+    }
+    inline float GetTimestampPeriod() const
+    {
+        return TimestampPeriod;
+    }
+    // 两个timestamp相减后与该掩码相与
+    inline uint64_t GetTimestampMask() const
     {
-        return DescriptorPool.get();
+        return TimestampValidBits >= 64 ? ~0ull : (1ull << TimestampValidBits) - 1;
     }
+    // 所有DEVICE_LOCAL堆的预算与用量之和
+    VulkanMemoryBudget GetDeviceLocalMemoryBudget() const;
     void RecreateSwapchain();
 
   private:
@@ -148,7 +206,6 @@ class VulkanContext
     void CreateSwapchain(vk::SwapchainKHR oldSwapchain = nullptr);
     void CreateSwapchainImages();
     void CreateSwapchainImageViews();
-    void CreateDescriptorPool();
 
   public:
     VulkanContext();
@@ -0,0 +1,64 @@
+#include "DeletionQueue.hpp"
+
+namespace MEngine
+{
+DeletionQueue::~DeletionQueue()
+{
+    Flush();
+}
+void DeletionQueue::Push(std::move_only_function<void()> deleter)
+{
+    std::lock_guard lock(mMutex);
+    mEntries.push_back({mFrame, std::move(deleter)});
+}
+void DeletionQueue::PushBuffer(VmaAllocator allocator, vk::Buffer buffer, VmaAllocation allocation)
+{
+    Push([allocator, buffer, allocation]() { vmaDestroyBuffer(allocator, buffer, allocation); });
+}
+void DeletionQueue::PushImage(VmaAllocator allocator, vk::Image image, VmaAllocation allocation)
+{
+    Push([allocator, image, allocation]() { vmaDestroyImage(allocator, image, allocation); });
+}
+void DeletionQueue::BeginFrame(uint32_t framesInFlight)
+{
+    std::deque<Entry> expired;
+    {
+        std::lock_guard lock(mMutex);
+        mFrame++;
+        while (!mEntries.empty() && mEntries.front().frame + framesInFlight <= mFrame)
+        {
+            expired.push_back(std::move(mEntries.front()));
+            mEntries.pop_front();
+        }
+    }
+    // 释放任务可能析构其它资源并再次Push，不能持锁执行
+    for (auto &entry : expired)
+    {
+        entry.deleter();
+    }
+}
+void DeletionQueue::Flush()
+{
+    while (true)
+    {
+        std::deque<Entry> entries;
+        {
+            std::lock_guard lock(mMutex);
+            entries.swap(mEntries);
+        }
+        if (entries.empty())
+        {
+            break;
+        }
+        for (auto &entry : entries)
+        {
+            entry.deleter();
+        }
+    }
+}
+std::size_t DeletionQueue::GetPendingCount()
+{
+    std::lock_guard lock(mMutex);
+    return mEntries.size();
+}
+} // namespace MEngine
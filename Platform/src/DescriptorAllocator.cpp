@@ -0,0 +1,191 @@
+#include "DescriptorAllocator.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+namespace MEngine
+{
+DescriptorAllocator::DescriptorAllocator(std::shared_ptr<VulkanContext> vulkanContext) : mVulkanContext(vulkanContext)
+{
+}
+vk::UniqueDescriptorPool DescriptorAllocator::CreatePool(vk::DescriptorPoolCreateFlags flags) const
+{
+    std::vector<std::pair<vk::DescriptorType, float>> proportion = {
+        {vk::DescriptorType::eSampler, 0.5f},
+        {vk::DescriptorType::eCombinedImageSampler, 4.0f},
+        {vk::DescriptorType::eSampledImage, 4.0f},
+        {vk::DescriptorType::eStorageImage, 1.0f},
+        {vk::DescriptorType::eUniformBuffer, 2.0f},
+        {vk::DescriptorType::eStorageBuffer, 2.0f},
+        {vk::DescriptorType::eUniformBufferDynamic, 1.0f},
+        {vk::DescriptorType::eStorageBufferDynamic, 1.0f},
+        {vk::DescriptorType::eInputAttachment, 1.0f},
+    };
+    std::vector<vk::DescriptorPoolSize> descriptorPoolSize;
+    descriptorPoolSize.reserve(proportion.size());
+    for (auto &[type, ratio] : proportion)
+    {
+        descriptorPoolSize.emplace_back(type, static_cast<uint32_t>(ratio * SetsPerPool));
+    }
+    // 带eUpdateAfterBindPool的布局(材质)只能从带eUpdateAfterBind的池分配，其余布局(全局)也可以
+    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+    descriptorPoolCreateInfo.setPoolSizes(descriptorPoolSize)
+        .setMaxSets(SetsPerPool)
+        .setFlags(flags | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
+    auto descriptorPool = mVulkanContext->GetDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
+    if (!descriptorPool)
+    {
+        LogError("Failed to create descriptor pool");
+        throw std::runtime_error("Failed to create descriptor pool");
+    }
+    return descriptorPool;
+}
+vk::UniqueDescriptorSet DescriptorAllocator::Allocate(vk::DescriptorSetLayout layout)
+{
+    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+    descriptorSetAllocateInfo.setDescriptorSetCount(1).setSetLayouts(layout);
+    // 从上次成功的池开始依次尝试，旧池中的描述符集被释放后可以再次分配
+    for (std::size_t i = 0; i < mPersistentPools.size(); ++i)
+    {
+        auto index = (mPersistentPoolIndex + i) % mPersistentPools.size();
+        descriptorSetAllocateInfo.setDescriptorPool(mPersistentPools[index].get());
+        try
+        {
+            auto descriptorSets = mVulkanContext->GetDevice().allocateDescriptorSetsUnique(descriptorSetAllocateInfo);
+            mPersistentPoolIndex = index;
+            mStats.persistentSetCount++;
+            return std::move(descriptorSets[0]);
+        }
+        catch (const vk::OutOfPoolMemoryError &)
+        {
+        }
+        catch (const vk::FragmentedPoolError &)
+        {
+        }
+    }
+    // 所有池都已耗尽，追加新池
+    mPersistentPools.push_back(CreatePool(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet));
+    mPersistentPoolIndex = mPersistentPools.size() - 1;
+    mStats.persistentPoolCount = static_cast<uint32_t>(mPersistentPools.size());
+    LogDebug("Descriptor pool chain grown to {} pools", mPersistentPools.size());
+    descriptorSetAllocateInfo.setDescriptorPool(mPersistentPools.back().get());
+    auto descriptorSets = mVulkanContext->GetDevice().allocateDescriptorSetsUnique(descriptorSetAllocateInfo);
+    mStats.persistentSetCount++;
+    return std::move(descriptorSets[0]);
+}
+void DescriptorAllocator::ResetFrame(uint32_t frameIndex)
+{
+    if (frameIndex >= mFramePools.size())
+    {
+        mFramePools.resize(frameIndex + 1);
+    }
+    auto &framePools = mFramePools[frameIndex];
+    for (uint32_t i = 0; i < framePools.usedPoolCount; ++i)
+    {
+        mVulkanContext->GetDevice().resetDescriptorPool(framePools.pools[i].get());
+    }
+    framePools.usedPoolCount = 0;
+    framePools.cache.clear();
+    mStats.transientSetCount = 0;
+    mStats.cacheHitCount = 0;
+}
+vk::DescriptorSet DescriptorAllocator::AllocateTransient(uint32_t frameIndex, vk::DescriptorSetLayout layout,
+                                                         std::span<const DescriptorWrite> writes)
+{
+    if (frameIndex >= mFramePools.size())
+    {
+        mFramePools.resize(frameIndex + 1);
+    }
+    auto &framePools = mFramePools[frameIndex];
+    auto hash = Hash(layout, writes);
+    auto [first, last] = framePools.cache.equal_range(hash);
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second.layout == layout && std::ranges::equal(it->second.writes, writes))
+        {
+            mStats.cacheHitCount++;
+            return it->second.descriptorSet;
+        }
+    }
+    vk::DescriptorSetAllocateInfo descriptorSetAllocateInfo;
+    descriptorSetAllocateInfo.setDescriptorSetCount(1).setSetLayouts(layout);
+    vk::DescriptorSet descriptorSet{};
+    while (!descriptorSet)
+    {
+        // usedPoolCount为当前使用的池序号+1，池不够时追加
+        framePools.usedPoolCount = std::max(framePools.usedPoolCount, 1u);
+        if (framePools.usedPoolCount > framePools.pools.size())
+        {
+            framePools.pools.push_back(CreatePool({}));
+            mStats.transientPoolCount++;
+        }
+        descriptorSetAllocateInfo.setDescriptorPool(framePools.pools[framePools.usedPoolCount - 1].get());
+        try
+        {
+            descriptorSet = mVulkanContext->GetDevice().allocateDescriptorSets(descriptorSetAllocateInfo)[0];
+        }
+        catch (const vk::OutOfPoolMemoryError &)
+        {
+            framePools.usedPoolCount++;
+        }
+        catch (const vk::FragmentedPoolError &)
+        {
+            framePools.usedPoolCount++;
+        }
+    }
+    Write(descriptorSet, writes);
+    framePools.cache.emplace(hash, TransientSet{layout, {writes.begin(), writes.end()}, descriptorSet});
+    mStats.transientSetCount++;
+    return descriptorSet;
+}
+std::size_t DescriptorAllocator::Hash(vk::DescriptorSetLayout layout, std::span<const DescriptorWrite> writes)
+{
+    std::size_t hash = 14695981039346656037ULL; // FNV-1a
+    auto combine = [&hash](auto value) {
+        hash ^= std::hash<decltype(value)>{}(value);
+        hash *= 1099511628211ULL;
+    };
+    combine(reinterpret_cast<uintptr_t>(static_cast<VkDescriptorSetLayout>(layout)));
+    for (const auto &write : writes)
+    {
+        combine(write.binding);
+        combine(write.type);
+        combine(reinterpret_cast<uintptr_t>(static_cast<VkBuffer>(write.bufferInfo.buffer)));
+        combine(write.bufferInfo.offset);
+        combine(write.bufferInfo.range);
+        combine(reinterpret_cast<uintptr_t>(static_cast<VkImageView>(write.imageInfo.imageView)));
+        combine(reinterpret_cast<uintptr_t>(static_cast<VkSampler>(write.imageInfo.sampler)));
+        combine(write.imageInfo.imageLayout);
+    }
+    return hash;
+}
+void DescriptorAllocator::Write(vk::DescriptorSet descriptorSet, std::span<const DescriptorWrite> writes) const
+{
+    std::vector<vk::WriteDescriptorSet> writeDescriptorSets;
+    writeDescriptorSets.reserve(writes.size());
+    for (const auto &write : writes)
+    {
+        vk::WriteDescriptorSet writeDescriptorSet;
+        writeDescriptorSet.setDstSet(descriptorSet)
+            .setDstBinding(write.binding)
+            .setDstArrayElement(0)
+            .setDescriptorType(write.type)
+            .setDescriptorCount(1);
+        switch (write.type)
+        {
+        case vk::DescriptorType::eUniformBuffer:
+        case vk::DescriptorType::eStorageBuffer:
+        case vk::DescriptorType::eUniformBufferDynamic:
+        case vk::DescriptorType::eStorageBufferDynamic:
+            writeDescriptorSet.setPBufferInfo(&write.bufferInfo);
+            break;
+        default:
+            writeDescriptorSet.setPImageInfo(&write.imageInfo);
+            break;
+        }
+        writeDescriptorSets.push_back(writeDescriptorSet);
+    }
+    mVulkanContext->GetDevice().updateDescriptorSets(writeDescriptorSets, {});
+}
+} // namespace MEngine
@@ -0,0 +1,171 @@
+#include "GpuProfiler.hpp"
+#include "Logger.hpp"
+#include <fstream>
+
+namespace MEngine
+{
+GpuProfiler::GpuProfiler(std::shared_ptr<VulkanContext> vulkanContext, uint32_t framesInFlight,
+                         uint32_t maxZonesPerFrame)
+    : mVulkanContext(vulkanContext), mMaxQueries(maxZonesPerFrame * 2)
+{
+    if (!mVulkanContext->IsTimestampSupported())
+    {
+        LogWarn("Graphics queue does not support timestamps, GPU profiler is disabled");
+        return;
+    }
+    mFrames.resize(framesInFlight);
+    for (auto &frame : mFrames)
+    {
+        vk::QueryPoolCreateInfo queryPoolCreateInfo;
+        queryPoolCreateInfo.setQueryType(vk::QueryType::eTimestamp).setQueryCount(mMaxQueries);
+        frame.queryPool = mVulkanContext->GetDevice().createQueryPoolUnique(queryPoolCreateInfo);
+    }
+}
+bool GpuProfiler::Collect(uint32_t frameIndex)
+{
+    if (!IsSupported())
+    {
+        return false;
+    }
+    auto &frame = mFrames[frameIndex];
+    if (mCurrentFrame == frameIndex)
+    {
+        mCurrentFrame = UINT32_MAX;
+    }
+    if (frame.queryCount == 0)
+    {
+        return false;
+    }
+    std::vector<uint64_t> timestamps(frame.queryCount);
+    auto result = mVulkanContext->GetDevice().getQueryPoolResults(
+        frame.queryPool.get(), 0, frame.queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(),
+        sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    auto zones = std::move(frame.zones);
+    frame.zones.clear();
+    frame.queryCount = 0;
+    if (result != vk::Result::eSuccess)
+    {
+        return false;
+    }
+    // 同名zone在一帧内累加
+    std::unordered_map<std::string, float> frameMs;
+    for (const auto &zone : zones)
+    {
+        if (!zone.ended)
+        {
+            continue;
+        }
+        auto ticks =
+            (timestamps[zone.beginQuery + 1] - timestamps[zone.beginQuery]) & mVulkanContext->GetTimestampMask();
+        frameMs[zone.name] +=
+            static_cast<float>(static_cast<double>(ticks) * mVulkanContext->GetTimestampPeriod() / 1e6);
+        auto [history, created] = mHistory.try_emplace(zone.name);
+        if (created)
+        {
+            history->second.depth = zone.depth;
+            mZoneOrder.push_back(zone.name);
+        }
+    }
+    for (const auto &[name, ms] : frameMs)
+    {
+        mHistory[name].stats.Add(ms);
+    }
+    mCollectedFrames++;
+    return true;
+}
+void GpuProfiler::BeginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    if (!IsSupported())
+    {
+        return;
+    }
+    auto &frame = mFrames[frameIndex];
+    frame.zones.clear();
+    frame.queryCount = 0;
+    commandBuffer.resetQueryPool(frame.queryPool.get(), 0, mMaxQueries);
+    mCurrentFrame = frameIndex;
+    mDepth = 0;
+}
+uint32_t GpuProfiler::BeginZone(vk::CommandBuffer commandBuffer, std::string_view name)
+{
+    if (mCurrentFrame == UINT32_MAX)
+    {
+        return InvalidZone;
+    }
+    auto &frame = mFrames[mCurrentFrame];
+    if (frame.queryCount + 2 > mMaxQueries)
+    {
+        return InvalidZone;
+    }
+    auto zone = static_cast<uint32_t>(frame.zones.size());
+    frame.zones.push_back({std::string(name), mDepth, frame.queryCount, false});
+    frame.queryCount += 2;
+    mDepth++;
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, frame.queryPool.get(),
+                                 frame.zones[zone].beginQuery);
+    return zone;
+}
+void GpuProfiler::EndZone(vk::CommandBuffer commandBuffer, uint32_t zone)
+{
+    if (zone == InvalidZone || mCurrentFrame == UINT32_MAX)
+    {
+        return;
+    }
+    auto &frame = mFrames[mCurrentFrame];
+    frame.zones[zone].ended = true;
+    mDepth = frame.zones[zone].depth;
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, frame.queryPool.get(),
+                                 frame.zones[zone].beginQuery + 1);
+}
+float GpuProfiler::GetLastMs(const std::string &name) const
+{
+    auto it = mHistory.find(name);
+    return it == mHistory.end() ? 0.0f : it->second.stats.GetLast();
+}
+std::vector<GpuProfilerZoneStats> GpuProfiler::GetStats() const
+{
+    std::vector<GpuProfilerZoneStats> stats;
+    stats.reserve(mZoneOrder.size());
+    for (const auto &name : mZoneOrder)
+    {
+        auto &history = mHistory.at(name);
+        stats.push_back({name, history.depth, history.stats.GetLast(), history.stats.GetMean(),
+                         history.stats.GetPercentile(0.95f), history.stats.GetMax()});
+    }
+    return stats;
+}
+void GpuProfiler::Reset()
+{
+    mZoneOrder.clear();
+    mHistory.clear();
+    mCollectedFrames = 0;
+}
+nlohmann::json GpuProfiler::ToJson() const
+{
+    auto zones = nlohmann::json::array();
+    for (const auto &zone : GetStats())
+    {
+        zones.push_back({{"name", zone.name},
+                         {"depth", zone.depth},
+                         {"meanMs", zone.meanMs},
+                         {"p95Ms", zone.p95Ms},
+                         {"maxMs", zone.maxMs}});
+    }
+    return {{"frames", mCollectedFrames}, {"historyFrames", HistoryFrames}, {"zones", zones}};
+}
+void GpuProfiler::DumpJson(const std::filesystem::path &path) const
+{
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path());
+    }
+    std::ofstream file(path);
+    if (!file.is_open())
+    {
+        LogError("Failed to open GPU profile file {}", path.string());
+        throw std::runtime_error("Failed to open GPU profile file");
+    }
+    file << ToJson().dump(4);
+    LogInfo("GPU profile written to {}", path.string());
+}
+} // namespace MEngine
@@ -0,0 +1,505 @@
+#include "RenderGraph.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace MEngine
+{
+namespace
+{
+struct AccessInfo
+{
+    vk::PipelineStageFlags stage;
+    vk::AccessFlags access;
+    vk::ImageLayout layout;
+    bool write;
+    bool attachment;
+};
+constexpr vk::AccessFlags WriteAccessMask =
+    vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+    vk::AccessFlagBits::eShaderWrite | vk::AccessFlagBits::eTransferWrite;
+AccessInfo GetAccessInfo(const RenderGraphAccess &access)
+{
+    auto stageOr = [&access](vk::PipelineStageFlags stage) { return access.stage ? access.stage : stage; };
+    switch (access.type)
+    {
+    case RenderGraphAccessType::ColorAttachment:
+        return {vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+                vk::ImageLayout::eColorAttachmentOptimal, true, true};
+    case RenderGraphAccessType::DepthStencilAttachment:
+        return {vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                vk::ImageLayout::eDepthStencilAttachmentOptimal, true, true};
+    case RenderGraphAccessType::InputAttachment:
+        return {vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eInputAttachmentRead,
+                vk::ImageLayout::eShaderReadOnlyOptimal, false, true};
+    case RenderGraphAccessType::SampledRead:
+        return {stageOr(vk::PipelineStageFlagBits::eFragmentShader), vk::AccessFlagBits::eShaderRead,
+                vk::ImageLayout::eShaderReadOnlyOptimal, false, false};
+    case RenderGraphAccessType::StorageRead:
+        return {stageOr(vk::PipelineStageFlagBits::eComputeShader), vk::AccessFlagBits::eShaderRead,
+                vk::ImageLayout::eGeneral, false, false};
+    case RenderGraphAccessType::StorageWrite:
+        return {stageOr(vk::PipelineStageFlagBits::eComputeShader),
+                vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite, vk::ImageLayout::eGeneral, true,
+                false};
+    case RenderGraphAccessType::TransferRead:
+        return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead,
+                vk::ImageLayout::eTransferSrcOptimal, false, false};
+    case RenderGraphAccessType::TransferWrite:
+        return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite,
+                vk::ImageLayout::eTransferDstOptimal, true, false};
+    }
+    LogError("Unknown render graph access type");
+    throw std::runtime_error("Unknown render graph access type");
+}
+} // namespace
+RenderGraph::RenderGraph(std::shared_ptr<VulkanContext> vulkanContext) : mVulkanContext(vulkanContext)
+{
+    // 没有设备时只能编译只包含导入资源的graph
+    if (!mVulkanContext)
+    {
+        return;
+    }
+    auto memoryProperties = mVulkanContext->GetPhysicalDevice().getMemoryProperties();
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        if (memoryProperties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated)
+        {
+            mLazyMemorySupported = true;
+        }
+    }
+    LogDebug("Render graph created, lazily allocated memory {}", mLazyMemorySupported ? "supported" : "unsupported");
+}
+RenderGraph::~RenderGraph()
+{
+    ReleasePhysicalImages();
+}
+void RenderGraph::Reset()
+{
+    mResources.clear();
+    mPasses.clear();
+    mTransients.clear();
+    mExportBarriers.clear();
+    mExportSrcStages = {};
+    mCompiled = false;
+}
+RenderGraphResource RenderGraph::ImportImage(const std::string &name, vk::Image image, vk::ImageView imageView,
+                                             vk::ImageAspectFlags aspect, vk::ImageLayout layout,
+                                             vk::PipelineStageFlags pendingStages)
+{
+    auto &resource = mResources.emplace_back();
+    resource.name = name;
+    resource.imported = true;
+    resource.image = image;
+    resource.imageView = imageView;
+    resource.aspect = aspect;
+    resource.state.layout = layout;
+    resource.state.pendingStages = pendingStages;
+    return static_cast<RenderGraphResource>(mResources.size() - 1);
+}
+RenderGraphResource RenderGraph::CreateImage(const std::string &name, const RenderGraphImageDesc &desc)
+{
+    auto &resource = mResources.emplace_back();
+    resource.name = name;
+    resource.aspect = desc.aspect;
+    resource.desc = desc;
+    resource.desc.extent = vk::Extent2D{std::max(desc.extent.width, 1u), std::max(desc.extent.height, 1u)};
+    resource.transientIndex = static_cast<uint32_t>(mTransients.size());
+    mTransients.push_back(static_cast<RenderGraphResource>(mResources.size() - 1));
+    return mTransients.back();
+}
+void RenderGraph::ExportImage(RenderGraphResource resource, vk::ImageLayout layout)
+{
+    mResources.at(resource).exportLayout = layout;
+}
+void RenderGraph::AddPass(const std::string &name, std::vector<RenderGraphAccess> accesses,
+                          std::function<void(vk::CommandBuffer)> execute)
+{
+    auto &pass = mPasses.emplace_back();
+    pass.name = name;
+    pass.accesses = std::move(accesses);
+    pass.execute = std::move(execute);
+}
+void RenderGraph::Compile()
+{
+    // transient的生命周期
+    std::vector<std::pair<uint32_t, uint32_t>> lifetimes(mTransients.size(), {UINT32_MAX, 0});
+    for (uint32_t passIndex = 0; passIndex < mPasses.size(); ++passIndex)
+    {
+        for (const auto &access : mPasses[passIndex].accesses)
+        {
+            auto &resource = mResources.at(access.resource);
+            if (!resource.imported)
+            {
+                auto &lifetime = lifetimes[resource.transientIndex];
+                lifetime.first = std::min(lifetime.first, passIndex);
+                lifetime.second = std::max(lifetime.second, passIndex);
+            }
+        }
+    }
+    for (uint32_t i = 0; i < mTransients.size(); ++i)
+    {
+        if (lifetimes[i].first == UINT32_MAX)
+        {
+            LogWarn("Render graph transient {} is never used", mResources[mTransients[i]].name);
+            lifetimes[i] = {0, 0};
+        }
+    }
+    // 声明和生命周期都不变时复用上一帧的物理资源
+    auto reuse = mPhysicalImages.size() == mTransients.size();
+    for (uint32_t i = 0; reuse && i < mTransients.size(); ++i)
+    {
+        reuse = mPhysicalImages[i].desc == mResources[mTransients[i]].desc &&
+                mPhysicalImages[i].lifetime == lifetimes[i];
+    }
+    if (!reuse)
+    {
+        ReleasePhysicalImages();
+        AllocateTransients(lifetimes);
+    }
+    for (uint32_t i = 0; i < mTransients.size(); ++i)
+    {
+        auto &resource = mResources[mTransients[i]];
+        resource.image = mPhysicalImages[i].image;
+        resource.imageView = mPhysicalImages[i].imageView.get();
+    }
+
+    mStats.passCount = static_cast<uint32_t>(mPasses.size());
+    mStats.barrierCount = 0;
+    mStats.barrierBatchCount = 0;
+    for (uint32_t passIndex = 0; passIndex < mPasses.size(); ++passIndex)
+    {
+        auto &pass = mPasses[passIndex];
+        pass.barriers.clear();
+        pass.srcStages = {};
+        pass.dstStages = {};
+        for (const auto &access : pass.accesses)
+        {
+            auto &resource = mResources[access.resource];
+            // transient的内容不跨帧保留，从所在内存块上一个使用者结束时的状态开始
+            if (!resource.imported && lifetimes[resource.transientIndex].first == passIndex)
+            {
+                auto &memoryBlock = mMemoryBlocks[mPhysicalImages[resource.transientIndex].block];
+                resource.state = ResourceState{};
+                resource.state.pendingStages = memoryBlock.pendingStages;
+                resource.state.pendingWrite = memoryBlock.pendingWrite;
+                resource.state.attachment = memoryBlock.attachment;
+            }
+            Transition(pass, resource, access);
+        }
+        for (const auto &access : pass.accesses)
+        {
+            auto &resource = mResources[access.resource];
+            if (!resource.imported && lifetimes[resource.transientIndex].second == passIndex)
+            {
+                auto &memoryBlock = mMemoryBlocks[mPhysicalImages[resource.transientIndex].block];
+                memoryBlock.pendingStages = resource.state.pendingStages;
+                memoryBlock.pendingWrite = resource.state.pendingWrite;
+                memoryBlock.attachment = resource.state.attachment;
+            }
+        }
+        mStats.barrierCount += static_cast<uint32_t>(pass.barriers.size());
+        mStats.barrierBatchCount += pass.barriers.empty() ? 0 : 1;
+    }
+    for (auto &resource : mResources)
+    {
+        if (resource.exportLayout == vk::ImageLayout::eUndefined || resource.exportLayout == resource.state.layout)
+        {
+            continue;
+        }
+        vk::ImageMemoryBarrier barrier;
+        barrier.setImage(resource.image)
+            .setOldLayout(resource.state.layout)
+            .setNewLayout(resource.exportLayout)
+            .setSrcAccessMask(resource.state.pendingWrite)
+            .setDstAccessMask({})
+            .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setSubresourceRange({resource.aspect, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers});
+        mExportBarriers.push_back(barrier);
+        mExportSrcStages |= resource.state.pendingStages
+                                ? resource.state.pendingStages
+                                : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+        resource.state.layout = resource.exportLayout;
+    }
+    mStats.barrierCount += static_cast<uint32_t>(mExportBarriers.size());
+    mStats.barrierBatchCount += mExportBarriers.empty() ? 0 : 1;
+    mCompiled = true;
+}
+void RenderGraph::Transition(Pass &pass, Resource &resource, const RenderGraphAccess &access)
+{
+    auto info = GetAccessInfo(access);
+    auto &state = resource.state;
+    bool needBarrier;
+    if (info.attachment)
+    {
+        // render pass的initialLayout为eUndefined，前一次访问同样来自render pass时由subpass依赖同步
+        needBarrier = state.pendingStages && !state.attachment;
+    }
+    else if (info.write)
+    {
+        needBarrier = state.layout != info.layout || state.pendingStages;
+    }
+    else
+    {
+        needBarrier = state.layout != info.layout ||
+                      (state.pendingWrite && (state.visibleStages & info.stage) != info.stage);
+    }
+    if (needBarrier)
+    {
+        vk::ImageMemoryBarrier barrier;
+        barrier.setImage(resource.image)
+            .setOldLayout(state.layout)
+            .setNewLayout(info.layout)
+            .setSrcAccessMask(state.pendingWrite)
+            .setDstAccessMask(info.access)
+            .setSrcQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setDstQueueFamilyIndex(vk::QueueFamilyIgnored)
+            .setSubresourceRange({resource.aspect, 0, vk::RemainingMipLevels, 0, vk::RemainingArrayLayers});
+        pass.barriers.push_back(barrier);
+        pass.srcStages |=
+            state.pendingStages ? state.pendingStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+        pass.dstStages |= info.stage;
+    }
+    if (info.write)
+    {
+        state.pendingStages = info.stage;
+        state.pendingWrite = info.access & WriteAccessMask;
+        state.visibleStages = {};
+    }
+    else
+    {
+        state.pendingStages |= info.stage;
+        state.visibleStages |= needBarrier ? info.stage : vk::PipelineStageFlags{};
+    }
+    state.layout = info.attachment && access.finalLayout != vk::ImageLayout::eUndefined ? access.finalLayout
+                                                                                         : info.layout;
+    state.attachment = info.attachment;
+}
+void RenderGraph::Execute(vk::CommandBuffer commandBuffer, GpuProfiler *profiler, RenderStatistics *statistics)
+{
+    if (!mCompiled)
+    {
+        LogError("Render graph must be compiled before execution");
+        throw std::runtime_error("Render graph is not compiled");
+    }
+    for (auto &pass : mPasses)
+    {
+        GpuProfileScope scope(profiler, commandBuffer, pass.name);
+        RenderStatisticsScope statisticsScope(statistics, commandBuffer, pass.name);
+        if (!pass.barriers.empty())
+        {
+            commandBuffer.pipelineBarrier(pass.srcStages, pass.dstStages, {}, {}, {}, pass.barriers);
+        }
+        if (pass.execute)
+        {
+            pass.execute(commandBuffer);
+        }
+    }
+    if (!mExportBarriers.empty())
+    {
+        commandBuffer.pipelineBarrier(mExportSrcStages, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, {},
+                                      mExportBarriers);
+    }
+}
+void RenderGraph::AllocateTransients(const std::vector<std::pair<uint32_t, uint32_t>> &lifetimes)
+{
+    auto device = mVulkanContext->GetDevice();
+    auto allocator = mVulkanContext->GetVmaAllocator();
+    mStats.transientImageCount = static_cast<uint32_t>(mTransients.size());
+    mStats.lazyImageCount = 0;
+    mStats.aliasedImageCount = 0;
+    mStats.transientBytes = 0;
+    mStats.transientRequiredBytes = 0;
+    std::vector<RenderGraphAliasRequest> requests;
+    std::vector<uint32_t> aliasedImages;
+    std::vector<uint32_t> lazyImages;
+    for (uint32_t i = 0; i < mTransients.size(); ++i)
+    {
+        auto &desc = mResources[mTransients[i]].desc;
+        auto &physicalImage = mPhysicalImages.emplace_back();
+        physicalImage.desc = desc;
+        physicalImage.lifetime = lifetimes[i];
+        auto lazy = desc.lazy && mLazyMemorySupported;
+        vk::ImageCreateInfo imageCreateInfo{};
+        imageCreateInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(desc.format)
+            .setExtent({desc.extent.width, desc.extent.height, 1})
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setSamples(vk::SampleCountFlagBits::e1)
+            .setTiling(vk::ImageTiling::eOptimal)
+            .setUsage(lazy ? desc.usage | vk::ImageUsageFlagBits::eTransientAttachment : desc.usage)
+            .setSharingMode(vk::SharingMode::eExclusive)
+            .setInitialLayout(vk::ImageLayout::eUndefined);
+        if (lazy)
+        {
+            VmaAllocationCreateInfo allocationCreateInfo{};
+            allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+            if (vmaCreateImage(allocator, &static_cast<VkImageCreateInfo &>(imageCreateInfo), &allocationCreateInfo,
+                               reinterpret_cast<VkImage *>(&physicalImage.image), &physicalImage.allocation,
+                               nullptr) != VK_SUCCESS)
+            {
+                LogError("Failed to create lazily allocated image {}", mResources[mTransients[i]].name);
+                throw std::runtime_error("Failed to create render graph image");
+            }
+            mStats.transientRequiredBytes += device.getImageMemoryRequirements(physicalImage.image).size;
+            lazyImages.push_back(i);
+        }
+        else
+        {
+            physicalImage.image = device.createImage(imageCreateInfo);
+            auto requirements = device.getImageMemoryRequirements(physicalImage.image);
+            requests.push_back(RenderGraphAliasRequest{requirements.size, requirements.alignment,
+                                                       requirements.memoryTypeBits, lifetimes[i].first,
+                                                       lifetimes[i].second});
+            mStats.transientRequiredBytes += requirements.size;
+            aliasedImages.push_back(i);
+        }
+    }
+    // 生命周期不重叠的image绑定到同一块内存
+    auto plan = PlanAliasing(requests);
+    mMemoryBlocks.resize(plan.blockSizes.size());
+    std::vector<uint32_t> blockUsers(plan.blockSizes.size(), 0);
+    for (uint32_t block = 0; block < plan.blockSizes.size(); ++block)
+    {
+        VkMemoryRequirements requirements{plan.blockSizes[block], 1, ~0u};
+        for (uint32_t request = 0; request < requests.size(); ++request)
+        {
+            if (plan.blockOfRequest[request] == block)
+            {
+                requirements.alignment = std::max(requirements.alignment, requests[request].alignment);
+                requirements.memoryTypeBits &= requests[request].memoryTypeBits;
+                blockUsers[block]++;
+            }
+        }
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        if (vmaAllocateMemory(allocator, &requirements, &allocationCreateInfo, &mMemoryBlocks[block].allocation,
+                              nullptr) != VK_SUCCESS)
+        {
+            LogError("Failed to allocate render graph memory block of {} bytes", requirements.size);
+            throw std::runtime_error("Failed to allocate render graph memory");
+        }
+        mStats.transientBytes += requirements.size;
+    }
+    for (uint32_t request = 0; request < requests.size(); ++request)
+    {
+        auto &physicalImage = mPhysicalImages[aliasedImages[request]];
+        physicalImage.block = plan.blockOfRequest[request];
+        vmaBindImageMemory(allocator, mMemoryBlocks[physicalImage.block].allocation, physicalImage.image);
+        mStats.aliasedImageCount += blockUsers[physicalImage.block] > 1 ? 1 : 0;
+    }
+    // lazy image各自占一个块，只用于跟踪同步状态
+    for (auto lazyImage : lazyImages)
+    {
+        mPhysicalImages[lazyImage].block = static_cast<uint32_t>(mMemoryBlocks.size());
+        mMemoryBlocks.emplace_back();
+    }
+    mStats.lazyImageCount = static_cast<uint32_t>(lazyImages.size());
+    for (uint32_t i = 0; i < mTransients.size(); ++i)
+    {
+        auto &resource = mResources[mTransients[i]];
+        vk::ImageViewCreateInfo imageViewCreateInfo{};
+        imageViewCreateInfo.setImage(mPhysicalImages[i].image)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(resource.desc.format)
+            .setSubresourceRange({resource.desc.aspect, 0, 1, 0, 1});
+        mPhysicalImages[i].imageView = device.createImageViewUnique(imageViewCreateInfo);
+    }
+    mPhysicalVersion++;
+    LogDebug("Render graph transients allocated: {} images, {} bytes ({} bytes without aliasing), {} lazy",
+             mTransients.size(), mStats.transientBytes, mStats.transientRequiredBytes, mStats.lazyImageCount);
+}
+void RenderGraph::ReleasePhysicalImages()
+{
+    if (mPhysicalImages.empty() && mMemoryBlocks.empty())
+    {
+        return;
+    }
+    // 可能仍被in-flight的帧使用
+    mVulkanContext->GetDeletionQueue().Push(
+        [device = mVulkanContext->GetDevice(), allocator = mVulkanContext->GetVmaAllocator(),
+         physicalImages = std::move(mPhysicalImages), memoryBlocks = std::move(mMemoryBlocks)]() mutable {
+            for (auto &physicalImage : physicalImages)
+            {
+                physicalImage.imageView.reset();
+                if (physicalImage.allocation)
+                {
+                    vmaDestroyImage(allocator, physicalImage.image, physicalImage.allocation);
+                }
+                else
+                {
+                    device.destroyImage(physicalImage.image);
+                }
+            }
+            for (auto &memoryBlock : memoryBlocks)
+            {
+                if (memoryBlock.allocation)
+                {
+                    vmaFreeMemory(allocator, memoryBlock.allocation);
+                }
+            }
+        });
+    mPhysicalImages.clear();
+    mMemoryBlocks.clear();
+}
+vk::Image RenderGraph::GetImage(RenderGraphResource resource) const
+{
+    return mResources.at(resource).image;
+}
+vk::ImageView RenderGraph::GetImageView(RenderGraphResource resource) const
+{
+    return mResources.at(resource).imageView;
+}
+const std::vector<vk::ImageMemoryBarrier> &RenderGraph::GetBarriers(uint32_t passIndex) const
+{
+    return mPasses.at(passIndex).barriers;
+}
+RenderGraphAliasPlan RenderGraph::PlanAliasing(std::span<const RenderGraphAliasRequest> requests)
+{
+    RenderGraphAliasPlan plan;
+    plan.blockOfRequest.resize(requests.size(), 0);
+    // 从大到小放置，块大小由第一个(最大的)请求决定
+    std::vector<uint32_t> order(requests.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::ranges::stable_sort(order,
+                             [&requests](uint32_t a, uint32_t b) { return requests[a].size > requests[b].size; });
+    std::vector<std::vector<uint32_t>> blockRequests;
+    std::vector<uint32_t> blockMemoryTypeBits;
+    for (auto request : order)
+    {
+        const auto &current = requests[request];
+        auto block = static_cast<uint32_t>(blockRequests.size());
+        for (uint32_t candidate = 0; candidate < blockRequests.size(); ++candidate)
+        {
+            if ((blockMemoryTypeBits[candidate] & current.memoryTypeBits) == 0)
+            {
+                continue;
+            }
+            auto overlapped = std::ranges::any_of(blockRequests[candidate], [&](uint32_t other) {
+                return requests[other].firstPass <= current.lastPass && current.firstPass <= requests[other].lastPass;
+            });
+            if (!overlapped)
+            {
+                block = candidate;
+                break;
+            }
+        }
+        if (block == blockRequests.size())
+        {
+            blockRequests.emplace_back();
+            blockMemoryTypeBits.push_back(current.memoryTypeBits);
+            plan.blockSizes.push_back(current.size);
+        }
+        blockRequests[block].push_back(request);
+        blockMemoryTypeBits[block] &= current.memoryTypeBits;
+        plan.blockSizes[block] = std::max(plan.blockSizes[block], current.size);
+        plan.blockOfRequest[request] = block;
+    }
+    return plan;
+}
+} // namespace MEngine
@@ -0,0 +1,196 @@
+#include "RenderStatistics.hpp"
+#include "Logger.hpp"
+
+namespace MEngine
+{
+RenderPassStatistics &RenderPassStatistics::operator+=(const RenderPassStatistics &other)
+{
+    drawCalls += other.drawCalls;
+    instances += other.instances;
+    triangles += other.triangles;
+    dispatches += other.dispatches;
+    pipelineBinds += other.pipelineBinds;
+    descriptorBinds += other.descriptorBinds;
+    bufferBinds += other.bufferBinds;
+    vertexInvocations += other.vertexInvocations;
+    fragmentInvocations += other.fragmentInvocations;
+    return *this;
+}
+RenderPassStatistics RenderFrameStatistics::GetTotal() const
+{
+    RenderPassStatistics total{"Total"};
+    for (const auto &pass : passes)
+    {
+        total += pass;
+    }
+    return total;
+}
+RenderStatistics::RenderStatistics(std::shared_ptr<VulkanContext> vulkanContext, uint32_t framesInFlight,
+                                   uint32_t maxPassesPerFrame)
+    : mVulkanContext(vulkanContext), mMaxQueries(maxPassesPerFrame)
+{
+    mFrames.resize(framesInFlight);
+    if (!mVulkanContext || !mVulkanContext->IsPipelineStatisticsSupported())
+    {
+        return;
+    }
+    for (auto &frame : mFrames)
+    {
+        vk::QueryPoolCreateInfo queryPoolCreateInfo;
+        queryPoolCreateInfo.setQueryType(vk::QueryType::ePipelineStatistics)
+            .setQueryCount(mMaxQueries)
+            .setPipelineStatistics(vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+                                   vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations);
+        frame.queryPool = mVulkanContext->GetDevice().createQueryPoolUnique(queryPoolCreateInfo);
+    }
+}
+void RenderStatistics::Collect(uint32_t frameIndex)
+{
+    auto &frame = mFrames[frameIndex];
+    if (frame.queryPasses.empty())
+    {
+        return;
+    }
+    // 每个query按flag位从低到高依次为vertex、fragment调用次数
+    std::vector<uint64_t> results(frame.queryPasses.size() * 2);
+    auto result = mVulkanContext->GetDevice().getQueryPoolResults(
+        frame.queryPool.get(), 0, static_cast<uint32_t>(frame.queryPasses.size()), results.size() * sizeof(uint64_t),
+        results.data(), 2 * sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (result == vk::Result::eSuccess)
+    {
+        for (size_t i = 0; i < frame.queryPasses.size(); ++i)
+        {
+            auto &pass = frame.statistics.passes[frame.queryPasses[i]];
+            pass.vertexInvocations += results[i * 2];
+            pass.fragmentInvocations += results[i * 2 + 1];
+        }
+        frame.statistics.hasPipelineStatistics = true;
+    }
+    mLast = std::move(frame.statistics);
+    frame.statistics = {};
+    frame.queryPasses.clear();
+}
+void RenderStatistics::BeginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex)
+{
+    mCurrentFrame = frameIndex;
+    mCurrent = {};
+    mPassStack.clear();
+    mQueryActive = false;
+    mFrameUsesQueries = commandBuffer && IsPipelineStatisticsEnabled();
+    auto &frame = mFrames[frameIndex];
+    frame.queryPasses.clear();
+    if (mFrameUsesQueries)
+    {
+        commandBuffer.resetQueryPool(frame.queryPool.get(), 0, mMaxQueries);
+    }
+}
+void RenderStatistics::EndFrame()
+{
+    if (mCurrentFrame == UINT32_MAX)
+    {
+        return;
+    }
+    if (!mPassStack.empty())
+    {
+        LogWarn("{} render statistics passes are still open at the end of the frame", mPassStack.size());
+    }
+    auto &frame = mFrames[mCurrentFrame];
+    if (frame.queryPasses.empty())
+    {
+        mLast = std::move(mCurrent);
+    }
+    else
+    {
+        frame.statistics = std::move(mCurrent);
+    }
+    mCurrent = {};
+    mCurrentFrame = UINT32_MAX;
+}
+uint32_t RenderStatistics::FindOrAddPass(std::string_view name, uint32_t depth)
+{
+    for (uint32_t i = 0; i < mCurrent.passes.size(); ++i)
+    {
+        if (mCurrent.passes[i].depth == depth && mCurrent.passes[i].name == name)
+        {
+            return i;
+        }
+    }
+    mCurrent.passes.push_back({std::string(name), depth});
+    return static_cast<uint32_t>(mCurrent.passes.size() - 1);
+}
+RenderPassStatistics &RenderStatistics::GetCurrentPass()
+{
+    if (mPassStack.empty())
+    {
+        return mCurrent.passes[FindOrAddPass(UnscopedPassName, 0)];
+    }
+    return mCurrent.passes[mPassStack.back()];
+}
+uint32_t RenderStatistics::BeginPass(vk::CommandBuffer commandBuffer, std::string_view name)
+{
+    auto depth = static_cast<uint32_t>(mPassStack.size());
+    auto pass = FindOrAddPass(name, depth);
+    mPassStack.push_back(pass);
+    // 同类型的query不能嵌套，只有最外层的pass使用query
+    if (depth == 0 && mFrameUsesQueries && commandBuffer)
+    {
+        auto &frame = mFrames[mCurrentFrame];
+        if (frame.queryPasses.size() < mMaxQueries)
+        {
+            commandBuffer.beginQuery(frame.queryPool.get(), static_cast<uint32_t>(frame.queryPasses.size()), {});
+            frame.queryPasses.push_back(pass);
+            mQueryActive = true;
+        }
+    }
+    return pass;
+}
+void RenderStatistics::EndPass(vk::CommandBuffer commandBuffer, uint32_t pass)
+{
+    if (pass == InvalidPass || mPassStack.empty())
+    {
+        return;
+    }
+    mPassStack.pop_back();
+    if (mPassStack.empty() && mQueryActive)
+    {
+        auto &frame = mFrames[mCurrentFrame];
+        commandBuffer.endQuery(frame.queryPool.get(), static_cast<uint32_t>(frame.queryPasses.size() - 1));
+        mQueryActive = false;
+    }
+}
+void RenderStatistics::Draw(uint32_t indexCount, uint32_t instanceCount)
+{
+    auto &pass = GetCurrentPass();
+    pass.drawCalls++;
+    pass.instances += instanceCount;
+    pass.triangles += static_cast<uint64_t>(indexCount / 3) * instanceCount;
+}
+void RenderStatistics::Dispatch()
+{
+    GetCurrentPass().dispatches++;
+}
+void RenderStatistics::BindPipeline()
+{
+    GetCurrentPass().pipelineBinds++;
+}
+void RenderStatistics::BindDescriptorSets()
+{
+    GetCurrentPass().descriptorBinds++;
+}
+void RenderStatistics::BindBuffers(uint32_t count)
+{
+    GetCurrentPass().bufferBinds += count;
+}
+void RenderStatistics::AddSubmittedObjects(uint32_t count)
+{
+    mCurrent.submittedObjects += count;
+}
+void RenderStatistics::AddCulledObjects(uint32_t count)
+{
+    mCurrent.culledObjects += count;
+}
+void RenderStatistics::AddUploadedBytes(vk::DeviceSize bytes)
+{
+    mCurrent.uploadedBytes += bytes;
+}
+} // namespace MEngine
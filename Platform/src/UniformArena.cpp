@@ -0,0 +1,62 @@
+#include "UniformArena.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+
+namespace MEngine
+{
+UniformArena::UniformArena(std::shared_ptr<VulkanContext> vulkanContext, uint32_t frameCount,
+                           vk::DeviceSize bytesPerFrame)
+    : mVulkanContext(vulkanContext), mFrameCount(frameCount)
+{
+    auto limits = mVulkanContext->GetPhysicalDevice().getProperties().limits;
+    mAlignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    // 每段的起始位置同样需要满足对齐
+    mBytesPerFrame = (bytesPerFrame + mAlignment - 1) / mAlignment * mAlignment;
+
+    vk::BufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.setSize(mBytesPerFrame * mFrameCount)
+        .setUsage(vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer)
+        .setSharingMode(vk::SharingMode::eExclusive);
+    VmaAllocationCreateInfo allocationCreateInfo{};
+    allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+    allocationCreateInfo.flags =
+        VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+    if (vmaCreateBuffer(mVulkanContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                        &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&mBuffer), &mAllocation,
+                        &mAllocationInfo) != VK_SUCCESS)
+    {
+        LogError("Failed to create uniform arena buffer");
+        throw std::runtime_error("Failed to create uniform arena buffer");
+    }
+    LogDebug("Uniform arena created: {} frames x {} bytes", mFrameCount, mBytesPerFrame);
+}
+UniformArena::~UniformArena()
+{
+    if (mBuffer)
+    {
+        vmaDestroyBuffer(mVulkanContext->GetVmaAllocator(), mBuffer, mAllocation);
+    }
+}
+void UniformArena::Reset(uint32_t frameIndex)
+{
+    mFrameIndex = frameIndex % mFrameCount;
+    mHead = 0;
+}
+UniformAllocation UniformArena::Allocate(vk::DeviceSize size)
+{
+    auto offset = (mHead + mAlignment - 1) / mAlignment * mAlignment;
+    if (offset + size > mBytesPerFrame)
+    {
+        LogError("Uniform arena out of memory: {} + {} > {} bytes", offset, size, mBytesPerFrame);
+        throw std::runtime_error("Uniform arena out of memory");
+    }
+    mHead = offset + size;
+    auto bufferOffset = mBytesPerFrame * mFrameIndex + offset;
+    UniformAllocation allocation;
+    allocation.buffer = mBuffer;
+    allocation.offset = static_cast<uint32_t>(bufferOffset);
+    allocation.size = size;
+    allocation.data = static_cast<uint8_t *>(mAllocationInfo.pMappedData) + bufferOffset;
+    return allocation;
+}
+} // namespace MEngine
@@ -2,6 +2,7 @@
 #include "Logger.hpp"
 #include <algorithm>
 #include <set>
+#include <string_view>
 #include <vector>
 #include <vulkan/vulkan_to_string.hpp>
 namespace MEngine
@@ -27,7 +28,6 @@ void VulkanContext::Init()
     GetQueues();
     CreateCommandPools();
     CreateVMA();
-    CreateDescriptorPool();
     if (Surface)
     {
         QuerySurfaceInfo();
@@ -38,6 +38,11 @@ void VulkanContext::Init()
 }
 void VulkanContext::Destroy()
 {
+    if (Device)
+    {
+        Device->waitIdle();
+        DeferredDeletion.Flush();
+    }
     if (VmaAllocator)
     {
         vmaDestroyAllocator(VmaAllocator);
@@ -155,6 +160,34 @@ void VulkanContext::QueryQueueFamilyIndicates()
             break;
         }
     }
+    // 优先使用不支持graphics的compute family(异步计算)，否则回退到graphics队列
+    for (uint32_t i = 0; i < queueFamilyProperties.size(); i++)
+    {
+        auto &queueFlags = queueFamilyProperties[i].queueFlags;
+        if ((queueFlags & vk::QueueFlagBits::eCompute) && !(queueFlags & vk::QueueFlagBits::eGraphics))
+        {
+            QueueFamilyIndicates.computeFamily = i;
+            QueueFamilyIndicates.computeFamilyCount = queueFamilyProperties[i].queueCount;
+            break;
+        }
+    }
+    if (!QueueFamilyIndicates.computeFamily.has_value())
+    {
+        QueueFamilyIndicates.computeFamily = QueueFamilyIndicates.graphicsFamily;
+        QueueFamilyIndicates.computeFamilyCount = QueueFamilyIndicates.graphicsFamilyCount;
+    }
+    // 只支持transfer的family对应DMA引擎，上传可以与渲染并行
+    for (uint32_t i = 0; i < queueFamilyProperties.size(); i++)
+    {
+        auto &queueFlags = queueFamilyProperties[i].queueFlags;
+        if ((queueFlags & vk::QueueFlagBits::eTransfer) &&
+            !(queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute)))
+        {
+            QueueFamilyIndicates.transferFamily = i;
+            QueueFamilyIndicates.transferFamilyCount = queueFamilyProperties[i].queueCount;
+            break;
+        }
+    }
     LogTrace("Queue Family Indications:");
     if (QueueFamilyIndicates.graphicsFamily.has_value())
     {
@@ -171,6 +204,11 @@ void VulkanContext::QueryQueueFamilyIndicates()
         LogTrace(" - Transfer Family: {}, Count: {}", QueueFamilyIndicates.transferFamily.value(),
                  QueueFamilyIndicates.transferFamilyCount.value());
     }
+    if (QueueFamilyIndicates.computeFamily.has_value())
+    {
+        LogTrace(" - Compute Family: {}, Count: {}", QueueFamilyIndicates.computeFamily.value(),
+                 QueueFamilyIndicates.computeFamilyCount.value());
+    }
 }
 void VulkanContext::CreateLogicalDevice()
 {
@@ -191,6 +229,12 @@ void VulkanContext::CreateLogicalDevice()
         uniqueQueueFamilies.insert(QueueFamilyIndicates.presentFamily.value());
     }
 
+    if (QueueFamilyIndicates.computeFamily.has_value() &&
+        QueueFamilyIndicates.computeFamily.value() != QueueFamilyIndicates.graphicsFamily.value())
+    {
+        uniqueQueueFamilies.insert(QueueFamilyIndicates.computeFamily.value());
+    }
+
     const float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies)
     {
@@ -205,11 +249,54 @@ void VulkanContext::CreateLogicalDevice()
         LogTrace("Available Vulkan device extension: {}", ext.extensionName.data());
     }
     std::vector<const char *> extensions = {"VK_KHR_maintenance1"};
+    // VMA读取显存预算需要VK_EXT_memory_budget
+    MemoryBudgetSupported = std::ranges::any_of(availableExtensions, [](const vk::ExtensionProperties &ext) {
+        return std::string_view(ext.extensionName.data()) == VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    });
+    if (MemoryBudgetSupported)
+    {
+        extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
     mConfig.DeviceRequiredExtensions.insert_range(mConfig.DeviceRequiredExtensions.end(), extensions);
+    // bindless材质需要Vulkan 1.2的descriptor indexing特性
+    vk::StructureChain<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features> enabledFeatures;
+    if (PhysicalDevice.getProperties().apiVersion >= VK_API_VERSION_1_2)
+    {
+        auto supportedFeatures =
+            PhysicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        auto &supported12 = supportedFeatures.get<vk::PhysicalDeviceVulkan12Features>();
+        BindlessSupported = supported12.runtimeDescriptorArray && supported12.descriptorBindingPartiallyBound &&
+                            supported12.descriptorBindingSampledImageUpdateAfterBind &&
+                            supported12.descriptorBindingStorageBufferUpdateAfterBind &&
+                            supported12.descriptorBindingUpdateUnusedWhilePending;
+    }
+    if (BindlessSupported)
+    {
+        enabledFeatures.get<vk::PhysicalDeviceVulkan12Features>()
+            .setRuntimeDescriptorArray(vk::True)
+            .setDescriptorBindingPartiallyBound(vk::True)
+            .setDescriptorBindingSampledImageUpdateAfterBind(vk::True)
+            .setDescriptorBindingStorageBufferUpdateAfterBind(vk::True)
+            .setDescriptorBindingUpdateUnusedWhilePending(vk::True);
+    }
+    else
+    {
+        enabledFeatures.unlink<vk::PhysicalDeviceVulkan12Features>();
+    }
+    LogDebug("Bindless descriptors {}", BindlessSupported ? "supported" : "not supported");
+    // 深度预渲染的overdraw统计使用pipeline statistics query
+    PipelineStatisticsSupported = PhysicalDevice.getFeatures().pipelineStatisticsQuery == vk::True;
+    enabledFeatures.get<vk::PhysicalDeviceFeatures2>().features.setPipelineStatisticsQuery(
+        PipelineStatisticsSupported ? vk::True : vk::False);
+    // GPU帧时间使用timestamp query，graphics队列的timestampValidBits为0时不支持
+    TimestampValidBits =
+        PhysicalDevice.getQueueFamilyProperties()[QueueFamilyIndicates.graphicsFamily.value()].timestampValidBits;
+    TimestampPeriod = TimestampValidBits > 0 ? PhysicalDevice.getProperties().limits.timestampPeriod : 0.0f;
     deviceCreateInfo.setQueueCreateInfos(queueCreateInfos)
         .setPEnabledExtensionNames(mConfig.DeviceRequiredExtensions)
         .setPEnabledLayerNames(mConfig.DeviceRequiredLayers)
-        .setPEnabledFeatures(nullptr);
+        .setPEnabledFeatures(nullptr)
+        .setPNext(&enabledFeatures.get<vk::PhysicalDeviceFeatures2>());
     Device = PhysicalDevice.createDeviceUnique(deviceCreateInfo);
     if (!Device)
     {
@@ -263,6 +350,18 @@ void VulkanContext::GetQueues()
         }
         LogDebug("Transfer queue obtained successfully");
     }
+    if (QueueFamilyIndicates.computeFamily.has_value())
+    {
+        auto computeQueueIndex = QueueFamilyIndicates.computeFamily.value();
+        ComputeQueue = Device->getQueue(computeQueueIndex, 0);
+        if (!ComputeQueue)
+        {
+            LogError("Failed to get compute queue from Vulkan device");
+            throw std::runtime_error("Failed to get compute queue from Vulkan device");
+        }
+        LogDebug("Compute queue obtained successfully, async compute {}",
+                 IsAsyncComputeSupported() ? "supported" : "not supported");
+    }
 }
 
 void VulkanContext::CreateCommandPools()
@@ -308,6 +407,20 @@ void VulkanContext::CreateCommandPools()
         }
         LogDebug("Present command pool created successfully");
     }
+
+    if (QueueFamilyIndicates.computeFamily.has_value())
+    {
+        vk::CommandPoolCreateInfo commandPoolCreateInfo;
+        commandPoolCreateInfo.setQueueFamilyIndex(QueueFamilyIndicates.computeFamily.value())
+            .setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+        ComputeCommandPool = Device->createCommandPoolUnique(commandPoolCreateInfo);
+        if (!ComputeCommandPool)
+        {
+            LogError("Failed to create compute command pool");
+            throw std::runtime_error("Failed to create compute command pool");
+        }
+        LogDebug("Compute command pool created successfully");
+    }
 }
 void VulkanContext::CreateVMA()
 {
@@ -315,8 +428,11 @@ void VulkanContext::CreateVMA()
     allocatorCreateInfo.device = Device.get();
     allocatorCreateInfo.physicalDevice = PhysicalDevice;
     allocatorCreateInfo.instance = Instance.get();
-    allocatorCreateInfo.flags =
-        VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT | VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_KHR_DEDICATED_ALLOCATION_BIT;
+    if (MemoryBudgetSupported)
+    {
+        allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
     auto variant = vk::apiVersionVariant(Version);
     auto major = vk::apiVersionMajor(Version);
     auto minor = vk::apiVersionMinor(Version);
@@ -326,6 +442,23 @@ void VulkanContext::CreateVMA()
     vmaCreateAllocator(&allocatorCreateInfo, &VmaAllocator);
     LogDebug("VMA Allocator created successfully");
 }
+VulkanMemoryBudget VulkanContext::GetDeviceLocalMemoryBudget() const
+{
+    const VkPhysicalDeviceMemoryProperties *memoryProperties = nullptr;
+    vmaGetMemoryProperties(VmaAllocator, &memoryProperties);
+    std::vector<VmaBudget> budgets(memoryProperties->memoryHeapCount);
+    vmaGetHeapBudgets(VmaAllocator, budgets.data());
+    VulkanMemoryBudget memoryBudget{};
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+    {
+        if (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+        {
+            memoryBudget.budget += budgets[i].budget;
+            memoryBudget.usage += budgets[i].usage;
+        }
+    }
+    return memoryBudget;
+}
 void VulkanContext::QuerySurfaceInfo()
 {
     auto formats = PhysicalDevice.getSurfaceFormatsKHR(Surface.get());
@@ -484,38 +617,4 @@ void VulkanContext::CreateSwapchainImageViews()
     LogTrace("Swapchain Image Count: {}", mSwapchainImageViews.size());
     LogDebug("Swapchain Image Views Created");
 }
-void VulkanContext::CreateDescriptorPool()
-{
-    auto maxDescriptorSize = 1000;
-    std::vector<std::pair<vk::DescriptorType, float>> proportion = {
-        {vk::DescriptorType::eSampler, 0.5f},
-        {vk::DescriptorType::eCombinedImageSampler, 4.0f},
-        {vk::DescriptorType::eSampledImage, 4.0f},
-        {vk::DescriptorType::eStorageImage, 1.0f},
-        {vk::DescriptorType::eUniformBuffer, 2.0f},
-        {vk::DescriptorType::eStorageBuffer, 2.0f},
-        {vk::DescriptorType::eUniformBufferDynamic, 1.0f},
-        {vk::DescriptorType::eStorageBufferDynamic, 1.0f},
-    };
-
-    std::vector<vk::DescriptorPoolSize> descriptorPoolSize;
-    descriptorPoolSize.reserve(proportion.size());
-    for (auto &proportion : proportion)
-    {
-        descriptorPoolSize.emplace_back(proportion.first, static_cast<uint32_t>(proportion.second * maxDescriptorSize));
-    }
-    vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
-    descriptorPoolCreateInfo
-        .setPoolSizes(descriptorPoolSize) // 设置池中各类描述符的数量
-        .setMaxSets(maxDescriptorSize)    // 设置池最多可分配的 Descriptor Set 数量
-        .setFlags(vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet |
-                  vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind); // 设置池的标志位
-    DescriptorPool = Device->createDescriptorPoolUnique(descriptorPoolCreateInfo);
-    if (!DescriptorPool)
-    {
-        LogError("Failed to create descriptor pool");
-        throw std::runtime_error("Failed to create descriptor pool");
-    }
-    LogDebug("Descriptor Pool created successfully");
-}
 } // namespace MEngine
\ No newline at end of file
@@ -0,0 +1,25 @@
+#version 460 core
+struct CameraParameters
+{
+    vec3 Position;
+    vec3 Direction;
+    mat4 projectionMatrix;
+    mat4 viewMatrix;
+};
+layout(location = 0) in vec3 inPosition; // Location 0
+
+layout(std140, set = 0, binding = 0) uniform CameraUBO
+{
+    CameraParameters parameters;
+} cameraParams;
+layout(push_constant) uniform PushConstant
+{
+    mat4 modelMatrix;
+} pushConstants;
+// 与ForwardOpaquePBR.vert的计算顺序一致，保证深度逐位相等
+invariant gl_Position;
+void main()
+{
+    vec4 viewPosition = (cameraParams.parameters.viewMatrix * pushConstants.modelMatrix * vec4(inPosition, 1.0));
+    gl_Position = cameraParams.parameters.projectionMatrix * viewPosition;
+}
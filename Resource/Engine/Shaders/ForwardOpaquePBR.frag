@@ -1,5 +1,9 @@
 #version 460 core
+#ifdef MENGINE_BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
 #define MAX_LIGHT_COUNT 6
+#define SHADOW_CASCADE_COUNT 4
 const float PI = 3.14159265359f;
 
 float DistributionGGX(vec3 N, vec3 H, float roughness)
@@ -121,6 +125,15 @@ struct CameraParameters
     mat4 projectionMatrix;
     mat4 viewMatrix;
 };
+struct ShadowParameters
+{
+    mat4 CascadeViewProjections[SHADOW_CASCADE_COUNT];
+    mat4 InverseViewMatrix;
+    vec4 CascadeSplits;     // 每级在相机空间的远端距离
+    vec4 CascadeTexelSizes; // 每级一个texel在世界空间的边长
+    int LightIndex;         // 投射阴影的平行光，-1表示没有阴影
+    float AtlasTexelSize;
+};
 
 layout(location = 0) out vec4 OutColor;
 layout(location = 2) in vec3 fragViewNormal;   // Location 2
@@ -141,6 +154,45 @@ lights;
 layout(set = 0, binding = 2) uniform sampler2D environmentMap;
 layout(set = 0, binding = 3) uniform sampler2D irradianceMap;
 layout(set = 0, binding = 4) uniform sampler2D brdfLUT;
+layout(std140, set = 0, binding = 5) uniform ShadowUBO
+{
+    ShadowParameters parameters;
+}
+shadowParams;
+layout(set = 0, binding = 6) uniform sampler2DShadow shadowAtlas;
+#ifdef MENGINE_BINDLESS
+// set:1 为全局bindless描述符集，材质通过push constant中的索引查找
+struct BindlessMaterial
+{
+    MaterialParameters parameters;
+    uvec4 textureIndices; // albedo, normal, arm, emissive
+    uvec4 samplerIndices;
+};
+layout(std430, set = 1, binding = 0) readonly buffer BindlessMaterialBuffer
+{
+    BindlessMaterial materials[];
+}
+bindlessMaterials;
+layout(set = 1, binding = 1) uniform texture2D bindlessTextures[];
+layout(set = 1, binding = 2) uniform sampler bindlessSamplers[];
+layout(push_constant) uniform PushConstant
+{
+    layout(offset = 64) uint materialIndex;
+}
+pushConstants;
+
+MaterialParameters GetMaterialParameters()
+{
+    return bindlessMaterials.materials[pushConstants.materialIndex].parameters;
+}
+vec4 SampleMaterialTexture(uint slot, vec2 uv)
+{
+    BindlessMaterial material = bindlessMaterials.materials[pushConstants.materialIndex];
+    return texture(sampler2D(bindlessTextures[material.textureIndices[slot]],
+                             bindlessSamplers[material.samplerIndices[slot]]),
+                   uv);
+}
+#else
 layout(std140, set = 1, binding = 0) uniform PBRMaterialParamsUBO
 {
     MaterialParameters parameters;
@@ -152,14 +204,73 @@ layout(set = 1, binding = 2) uniform sampler2D normalMap;
 layout(set = 1, binding = 3) uniform sampler2D metallicRoughnessMap;
 layout(set = 1, binding = 4) uniform sampler2D emissiveMap;
 
+MaterialParameters GetMaterialParameters()
+{
+    return materialParameters.parameters;
+}
+vec4 SampleMaterialTexture(uint slot, vec2 uv)
+{
+    switch (slot)
+    {
+    case 0:
+        return texture(albedoMap, uv);
+    case 1:
+        return texture(normalMap, uv);
+    case 2:
+        return texture(metallicRoughnessMap, uv);
+    default:
+        return texture(emissiveMap, uv);
+    }
+}
+#endif
+
+// 按相机空间深度选择级联，在2x2 atlas中对应的区域内做3x3 PCF，1为完全照亮
+float SampleShadow(vec3 viewPosition, vec3 viewNormal)
+{
+    float viewDepth = -viewPosition.z;
+    vec4 splits = shadowParams.parameters.CascadeSplits;
+    if (shadowParams.parameters.LightIndex < 0 || viewDepth >= splits[SHADOW_CASCADE_COUNT - 1])
+    {
+        return 1.0;
+    }
+    int cascade = 0;
+    for (int i = 0; i < SHADOW_CASCADE_COUNT - 1; ++i)
+    {
+        cascade += viewDepth > splits[i] ? 1 : 0;
+    }
+    // 沿法线偏移1.5个texel，减少自阴影
+    mat4 inverseViewMatrix = shadowParams.parameters.InverseViewMatrix;
+    vec3 worldPosition = (inverseViewMatrix * vec4(viewPosition, 1.0)).xyz;
+    vec3 worldNormal = normalize(mat3(inverseViewMatrix) * viewNormal);
+    worldPosition += worldNormal * shadowParams.parameters.CascadeTexelSizes[cascade] * 1.5;
+    vec4 clip = shadowParams.parameters.CascadeViewProjections[cascade] * vec4(worldPosition, 1.0);
+    float texelSize = shadowParams.parameters.AtlasTexelSize;
+    vec2 tileOffset = vec2(cascade % 2, cascade / 2) * 0.5;
+    vec2 uv = tileOffset + (clip.xy * 0.5 + 0.5) * 0.5;
+    // PCF不能采样到相邻级联
+    vec2 tileMin = tileOffset + vec2(texelSize * 1.5);
+    vec2 tileMax = tileOffset + vec2(0.5 - texelSize * 1.5);
+    float shadow = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            vec2 sampleUV = clamp(uv + vec2(x, y) * texelSize, tileMin, tileMax);
+            shadow += texture(shadowAtlas, vec3(sampleUV, clip.z));
+        }
+    }
+    return shadow / 9.0;
+}
+
 void main()
 {
-    vec3 albedoColor = texture(albedoMap, fragTexCoord).rgb * materialParameters.parameters.Albedo;
-    vec3 normalColor = texture(normalMap, fragTexCoord).rgb * materialParameters.parameters.Normal;
-    vec3 arm = texture(metallicRoughnessMap, fragTexCoord).rgb;
-    float ao = arm.r * materialParameters.parameters.AO;
-    float roughness = arm.g * materialParameters.parameters.Roughness;
-    float metallic = arm.b * materialParameters.parameters.Metallic;
+    MaterialParameters parameters = GetMaterialParameters();
+    vec3 albedoColor = SampleMaterialTexture(0, fragTexCoord).rgb * parameters.Albedo;
+    vec3 normalColor = SampleMaterialTexture(1, fragTexCoord).rgb * parameters.Normal;
+    vec3 arm = SampleMaterialTexture(2, fragTexCoord).rgb;
+    float ao = arm.r * parameters.AO;
+    float roughness = arm.g * parameters.Roughness;
+    float metallic = arm.b * parameters.Metallic;
     vec4 finalColor = vec4(0.0, 0.0, 0.0, 1.0);
     vec3 VIEW = -fragViewPosition; // 相机空间
     vec3 V = normalize(VIEW);
@@ -182,6 +293,8 @@ void main()
             vec3 H = normalize(L + V);
             float VoH = clamp(dot(V, H), 0, 1.0f);
             float NoL = clamp(dot(N, L), 0, 1.0f);
+            float shadow =
+                i == shadowParams.parameters.LightIndex ? SampleShadow(fragViewPosition, fragViewNormal) : 1.0;
             if (NoV > 0.0f)
             {
                 vec3 F = FresnelSchlick(VoH, F0);
@@ -193,7 +306,7 @@ void main()
                 vec3 kS = F;
                 vec3 kD = vec3(1.0) - kS;
                 kD *= 1.0 - metallic;
-                finalColor += vec4((kD * albedoColor / PI + specular) * (LIGHT_COLOR)*NoL, 1.0);
+                finalColor += vec4((kD * albedoColor / PI + specular) * (LIGHT_COLOR)*NoL * shadow, 1.0);
             }
         }
         else if (lights.parameters[i].LightType == 1) // 点光源
@@ -21,6 +21,8 @@ layout(push_constant) uniform PushConstant
 {
     mat4 modelMatrix;
 } pushConstants;
+// 深度预渲染开启时使用eEqual深度测试，需要与DepthPrepass.vert得到相同的深度
+invariant gl_Position;
 void main()
 {
    
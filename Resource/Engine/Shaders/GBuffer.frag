@@ -1,4 +1,7 @@
 #version 460 core
+#ifdef MENGINE_BINDLESS
+#extension GL_EXT_nonuniform_qualifier : require
+#endif
 struct MaterialParameters
 {
     vec3 Albedo;
@@ -47,6 +50,39 @@ layout(std140, set = 0, binding = 0) uniform CameraUBO
 }
 cameraParams;
 
+#ifdef MENGINE_BINDLESS
+// set:1 为全局bindless描述符集，材质通过push constant中的索引查找
+struct BindlessMaterial
+{
+    MaterialParameters parameters;
+    uvec4 textureIndices; // albedo, normal, arm, emissive
+    uvec4 samplerIndices;
+};
+layout(std430, set = 1, binding = 0) readonly buffer BindlessMaterialBuffer
+{
+    BindlessMaterial materials[];
+}
+bindlessMaterials;
+layout(set = 1, binding = 1) uniform texture2D bindlessTextures[];
+layout(set = 1, binding = 2) uniform sampler bindlessSamplers[];
+layout(push_constant) uniform PushConstant
+{
+    layout(offset = 64) uint materialIndex;
+}
+pushConstants;
+
+MaterialParameters GetMaterialParameters()
+{
+    return bindlessMaterials.materials[pushConstants.materialIndex].parameters;
+}
+vec4 SampleMaterialTexture(uint slot, vec2 uv)
+{
+    BindlessMaterial material = bindlessMaterials.materials[pushConstants.materialIndex];
+    return texture(sampler2D(bindlessTextures[material.textureIndices[slot]],
+                             bindlessSamplers[material.samplerIndices[slot]]),
+                   uv);
+}
+#else
 layout(std140, set = 1, binding = 0) uniform PBRMaterialParamsUBO
 {
     MaterialParameters parameters;
@@ -58,14 +94,36 @@ layout(set = 1, binding = 2) uniform sampler2D normalMap;
 layout(set = 1, binding = 3) uniform sampler2D metallicRoughnessMap;
 layout(set = 1, binding = 4) uniform sampler2D emissiveMap;
 
+MaterialParameters GetMaterialParameters()
+{
+    return materialParameters.parameters;
+}
+vec4 SampleMaterialTexture(uint slot, vec2 uv)
+{
+    switch (slot)
+    {
+    case 0:
+        return texture(albedoMap, uv);
+    case 1:
+        return texture(normalMap, uv);
+    case 2:
+        return texture(metallicRoughnessMap, uv);
+    default:
+        return texture(emissiveMap, uv);
+    }
+}
+#endif
+
 void main()
 {
-    vec3 albedo = texture(albedoMap, fragTexCoord).rgb * materialParameters.parameters.Albedo;
-    vec3 normal = texture(normalMap, fragTexCoord).rgb * materialParameters.parameters.Normal;
-    float ao = texture(metallicRoughnessMap, fragTexCoord).r * materialParameters.parameters.AO;
-    float roughness = texture(metallicRoughnessMap, fragTexCoord).g * materialParameters.parameters.Roughness;
-    float metallic = texture(metallicRoughnessMap, fragTexCoord).b * materialParameters.parameters.Metallic;
-    vec3 emissive = texture(emissiveMap, fragTexCoord).rgb * materialParameters.parameters.EmissiveIntensity;
+    MaterialParameters parameters = GetMaterialParameters();
+    vec3 albedo = SampleMaterialTexture(0, fragTexCoord).rgb * parameters.Albedo;
+    vec3 normal = SampleMaterialTexture(1, fragTexCoord).rgb * parameters.Normal;
+    vec3 arm = SampleMaterialTexture(2, fragTexCoord).rgb;
+    float ao = arm.r * parameters.AO;
+    float roughness = arm.g * parameters.Roughness;
+    float metallic = arm.b * parameters.Metallic;
+    vec3 emissive = SampleMaterialTexture(3, fragTexCoord).rgb * parameters.EmissiveIntensity;
     vec3 position = fragViewPosition;
 
     OutColor = vec4(albedo, 1.0);
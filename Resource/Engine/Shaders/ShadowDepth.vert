@@ -0,0 +1,11 @@
+#version 460 core
+layout(location = 0) in vec3 inPosition; // Location 0
+
+layout(push_constant) uniform PushConstant
+{
+    mat4 lightModelViewProjection; // 级联viewProjection * modelMatrix，在CPU上相乘
+} pushConstants;
+void main()
+{
+    gl_Position = pushConstants.lightModelViewProjection * vec4(inPosition, 1.0);
+}
@@ -0,0 +1,122 @@
+#include "CpuProfiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+
+using namespace MEngine;
+
+namespace
+{
+// 每个测试在新线程中记录，避免与其它测试的事件混在一起
+CpuProfileThread CaptureThread(const std::string &name)
+{
+    auto threads = CpuProfiler::Capture();
+    auto it = std::ranges::find(threads, name, &CpuProfileThread::name);
+    return it == threads.end() ? CpuProfileThread{} : *it;
+}
+} // namespace
+
+TEST(CpuProfilerTest, NestedZones)
+{
+    std::thread([] {
+        CpuProfiler::SetThreadName("NestedZones");
+        CpuProfileScope outer("Outer");
+        {
+            CpuProfileScope inner("Inner");
+        }
+    }).join();
+    auto thread = CaptureThread("NestedZones");
+    ASSERT_EQ(thread.events.size(), 2u);
+    // 事件按结束顺序写入
+    EXPECT_STREQ(thread.events[0].name, "Inner");
+    EXPECT_EQ(thread.events[0].depth, 1u);
+    EXPECT_STREQ(thread.events[1].name, "Outer");
+    EXPECT_EQ(thread.events[1].depth, 0u);
+    EXPECT_LE(thread.events[1].begin, thread.events[0].begin);
+    EXPECT_GE(thread.events[1].end, thread.events[0].end);
+}
+TEST(CpuProfilerTest, DisabledZonesAreSkipped)
+{
+    std::thread([] {
+        CpuProfiler::SetThreadName("DisabledZones");
+        CpuProfiler::SetEnabled(false);
+        {
+            CpuProfileScope skipped("Skipped");
+        }
+        CpuProfiler::SetEnabled(true);
+        CpuProfileScope recorded("Recorded");
+    }).join();
+    auto thread = CaptureThread("DisabledZones");
+    ASSERT_EQ(thread.events.size(), 1u);
+    EXPECT_STREQ(thread.events[0].name, "Recorded");
+}
+TEST(CpuProfilerTest, RingBufferKeepsRecentEvents)
+{
+    std::thread([] {
+        CpuProfiler::SetThreadName("RingBuffer");
+        for (uint32_t i = 0; i < CpuProfiler::EventCapacity + 10; ++i)
+        {
+            CpuProfileScope zone(i < 10 ? "Old" : "New");
+        }
+    }).join();
+    auto thread = CaptureThread("RingBuffer");
+    EXPECT_GE(thread.events.size(), CpuProfiler::EventCapacity - 1);
+    EXPECT_TRUE(std::ranges::all_of(thread.events, [](const auto &event) { return std::string(event.name) == "New"; }));
+}
+TEST(CpuProfilerTest, ChromeTrace)
+{
+    std::thread([] {
+        CpuProfiler::SetThreadName("ChromeTrace");
+        CpuProfileScope zone(CpuProfiler::InternName(std::string("Traced")));
+    }).join();
+    auto trace = CpuProfiler::ToChromeTrace();
+    ASSERT_TRUE(trace.contains("traceEvents"));
+    auto &events = trace["traceEvents"];
+    auto traced = std::ranges::find_if(events, [](const auto &event) { return event["name"] == "Traced"; });
+    ASSERT_NE(traced, events.end());
+    EXPECT_EQ((*traced)["ph"], "X");
+    EXPECT_GE((*traced)["dur"].template get<double>(), 0.0);
+}
+TEST(CpuProfilerTest, ZoneOverhead)
+{
+    // 一对BeginZone/EndZone的开销，取多轮中最快的一轮以排除调度干扰
+    constexpr uint32_t Iterations = 100000;
+    double enabledNs = 0.0;
+    double disabledNs = 0.0;
+    std::thread([&] {
+        CpuProfiler::SetThreadName("ZoneOverhead");
+        auto measure = [] {
+            auto best = std::chrono::nanoseconds::max();
+            for (uint32_t round = 0; round < 5; ++round)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                for (uint32_t i = 0; i < Iterations; ++i)
+                {
+                    CpuProfiler::BeginZone("Overhead");
+                    CpuProfiler::EndZone();
+                }
+                best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - begin));
+            }
+            return static_cast<double>(best.count()) / Iterations;
+        };
+        enabledNs = measure();
+        CpuProfiler::SetEnabled(false);
+        disabledNs = measure();
+        CpuProfiler::SetEnabled(true);
+    }).join();
+    RecordProperty("EnabledNs", std::to_string(enabledNs));
+    RecordProperty("DisabledNs", std::to_string(disabledNs));
+    // 暂停时不读时钟，应明显快于记录时
+    EXPECT_LT(disabledNs, enabledNs);
+    // 绝对耗时受构建类型和机器负载影响，只在设置MENGINE_PROFILER_BENCHMARK的优化构建上检查
+    if (!std::getenv("MENGINE_PROFILER_BENCHMARK"))
+    {
+        GTEST_SKIP() << "Set MENGINE_PROFILER_BENCHMARK to check the absolute zone overhead";
+    }
+    EXPECT_LT(enabledNs, 50.0);
+    EXPECT_LT(disabledNs, 50.0);
+}
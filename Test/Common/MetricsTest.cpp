@@ -0,0 +1,97 @@
+#include "Metrics.hpp"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace MEngine;
+
+TEST(MetricsTest, HistogramBucketsCoverAllValues)
+{
+    // 相邻桶首尾相接，桶宽不超过下界的1/SubBucketCount
+    for (uint32_t i = 1; i < MetricHistogram::BucketCount; ++i)
+    {
+        ASSERT_EQ(MetricHistogram::GetBucketLowerBound(i), MetricHistogram::GetBucketUpperBound(i - 1) + 1);
+    }
+    for (uint64_t value : std::vector<uint64_t>{0, 63, 64, 1000, 123456789, UINT64_MAX})
+    {
+        auto index = MetricHistogram::GetBucketIndex(value);
+        EXPECT_LE(MetricHistogram::GetBucketLowerBound(index), value);
+        EXPECT_GE(MetricHistogram::GetBucketUpperBound(index), value);
+    }
+}
+TEST(MetricsTest, HistogramPercentiles)
+{
+    MetricHistogram histogram(0.001);
+    for (uint32_t i = 1; i <= 1000; ++i)
+    {
+        histogram.Record(static_cast<double>(i) * 0.1);
+    }
+    auto snapshot = histogram.Snapshot(true);
+    EXPECT_EQ(snapshot.count, 1000u);
+    EXPECT_NEAR(snapshot.GetMean(), 50.05, 1e-6);
+    EXPECT_NEAR(snapshot.GetPercentile(0.5), 50.0, 50.0 / MetricHistogram::SubBucketCount);
+    EXPECT_NEAR(snapshot.GetPercentile(0.99), 99.0, 99.0 / MetricHistogram::SubBucketCount);
+    EXPECT_DOUBLE_EQ(snapshot.GetPercentile(0.999), 100.0);
+    EXPECT_DOUBLE_EQ(snapshot.max, 100.0);
+    EXPECT_NEAR(static_cast<double>(snapshot.CountAbove(90.0)), 100.0, 5.0);
+    // reset后从零开始
+    EXPECT_EQ(histogram.Snapshot().count, 0u);
+}
+TEST(MetricsTest, ConcurrentRecording)
+{
+    auto &counter = Metrics::GetCounter("test.concurrent_counter");
+    auto &histogram = Metrics::GetHistogram("test.concurrent_histogram");
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&] {
+            for (uint32_t j = 0; j < 10000; ++j)
+            {
+                counter.Add();
+                histogram.Record(static_cast<double>(j));
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(counter.Get(), 40000u);
+    EXPECT_EQ(&Metrics::GetCounter("test.concurrent_counter"), &counter);
+    auto snapshot = Metrics::Snapshot();
+    EXPECT_EQ(snapshot["counters"]["test.concurrent_counter"]["delta"], 40000u);
+    EXPECT_EQ(snapshot["histograms"]["test.concurrent_histogram"]["count"], 40000u);
+    EXPECT_EQ(Metrics::Snapshot()["counters"]["test.concurrent_counter"]["delta"], 0u);
+}
+TEST(MetricsTest, ReporterWritesAndRotates)
+{
+    auto directory = std::filesystem::temp_directory_path() / "MEngineMetricsTest";
+    std::filesystem::remove_all(directory);
+    Metrics::GetHistogram("test.frame_ms", 0.001);
+    Metrics::SetHitchThreshold("test.frame_ms", 33.3);
+    MetricsSetting setting;
+    setting.enabled = false; // 不启动后台线程，手动Flush
+    setting.maxFileSize = 1;
+    setting.maxFiles = 2;
+    MetricsReporter reporter(setting, directory);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        Metrics::GetHistogram("test.frame_ms").Record(i == 0 ? 50.0 : 16.0);
+        reporter.Flush();
+    }
+    EXPECT_TRUE(std::filesystem::exists(directory / "metrics.jsonl"));
+    EXPECT_TRUE(std::filesystem::exists(directory / "metrics.1.jsonl"));
+    EXPECT_TRUE(std::filesystem::exists(directory / "metrics.2.csv"));
+    EXPECT_FALSE(std::filesystem::exists(directory / "metrics.3.csv"));
+    // 最早的一次快照记录了一次卡顿
+    std::ifstream file(directory / "metrics.2.jsonl");
+    auto json = nlohmann::json::parse(file);
+    EXPECT_EQ(json["histograms"]["test.frame_ms"]["hitches"], 1u);
+    std::ifstream csv(directory / "metrics.csv");
+    std::string header;
+    std::getline(csv, header);
+    EXPECT_EQ(header + "\n", Metrics::CsvHeader);
+    std::filesystem::remove_all(directory);
+}
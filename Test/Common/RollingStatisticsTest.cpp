@@ -0,0 +1,42 @@
+#include "RollingStatistics.hpp"
+#include <gtest/gtest.h>
+
+using namespace MEngine;
+
+TEST(RollingStatisticsTest, EmptyIsZero)
+{
+    RollingStatistics stats;
+    EXPECT_EQ(stats.GetCount(), 0u);
+    EXPECT_FLOAT_EQ(stats.GetMean(), 0.0f);
+    EXPECT_FLOAT_EQ(stats.GetMax(), 0.0f);
+    EXPECT_FLOAT_EQ(stats.GetPercentile(0.95f), 0.0f);
+}
+TEST(RollingStatisticsTest, MeanPercentileMax)
+{
+    RollingStatistics stats(100);
+    for (uint32_t i = 1; i <= 100; ++i)
+    {
+        stats.Add(static_cast<float>(i));
+    }
+    EXPECT_FLOAT_EQ(stats.GetMean(), 50.5f);
+    EXPECT_FLOAT_EQ(stats.GetPercentile(0.95f), 95.0f);
+    EXPECT_FLOAT_EQ(stats.GetPercentile(0.5f), 50.0f);
+    EXPECT_FLOAT_EQ(stats.GetPercentile(0.0f), 1.0f);
+    EXPECT_FLOAT_EQ(stats.GetMax(), 100.0f);
+    EXPECT_FLOAT_EQ(stats.GetLast(), 100.0f);
+}
+TEST(RollingStatisticsTest, KeepsOnlyRecentSamples)
+{
+    RollingStatistics stats(4);
+    stats.Add(100.0f);
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        stats.Add(2.0f);
+    }
+    // 最早的样本已被覆盖
+    EXPECT_EQ(stats.GetCount(), 4u);
+    EXPECT_FLOAT_EQ(stats.GetMean(), 2.0f);
+    EXPECT_FLOAT_EQ(stats.GetMax(), 2.0f);
+    stats.Reset();
+    EXPECT_EQ(stats.GetCount(), 0u);
+}
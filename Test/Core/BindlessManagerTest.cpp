@@ -0,0 +1,346 @@
+#include "BindlessManager.hpp"
+#include "ShaderUtils.hpp"
+#include "UUID.hpp"
+#include "VMA.hpp"
+#include "VulkanDeviceTest.hpp"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace MEngine;
+using namespace MEngine::Core;
+using namespace MEngine::Core::Manager;
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+constexpr uint32_t FramesInFlight = 2;
+constexpr vk::Extent2D TargetExtent{4, 4};
+// 全屏三角形
+constexpr const char *VertexShader = R"(#version 460 core
+void main()
+{
+    vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+// 与ForwardOpaquePBR.frag的bindless分支相同的查找方式，输出材质的albedo纹理
+constexpr const char *FragmentShader = R"(
+#extension GL_EXT_nonuniform_qualifier : require
+struct BindlessMaterial
+{
+    uint properties[PROPERTY_WORDS];
+    uvec4 textureIndices;
+    uvec4 samplerIndices;
+};
+layout(std430, set = 0, binding = 0) readonly buffer BindlessMaterialBuffer
+{
+    BindlessMaterial materials[];
+}
+bindlessMaterials;
+layout(set = 0, binding = 1) uniform texture2D bindlessTextures[];
+layout(set = 0, binding = 2) uniform sampler bindlessSamplers[];
+layout(push_constant) uniform PushConstant
+{
+    uint materialIndex;
+}
+pushConstants;
+layout(location = 0) out vec4 outColor;
+void main()
+{
+    BindlessMaterial material = bindlessMaterials.materials[pushConstants.materialIndex];
+    outColor = texture(sampler2D(bindlessTextures[material.textureIndices[0]],
+                                 bindlessSamplers[material.samplerIndices[0]]),
+                       vec2(0.5));
+}
+)";
+struct Image
+{
+    vk::Image image{};
+    VmaAllocation allocation{};
+    vk::UniqueImageView imageView;
+};
+} // namespace
+
+class BindlessManagerTest : public VulkanDeviceTest
+{
+  protected:
+    std::shared_ptr<BindlessManager> mBindlessManager;
+    std::vector<Image> mImages;
+    vk::Buffer mReadbackBuffer{};
+    VmaAllocation mReadbackAllocation{};
+    VmaAllocationInfo mReadbackAllocationInfo{};
+    vk::UniqueSampler mSampler;
+    vk::UniqueRenderPass mRenderPass;
+    vk::UniqueFramebuffer mFramebuffer;
+    vk::UniquePipelineLayout mPipelineLayout;
+    vk::UniquePipeline mPipeline;
+
+    void SetUp() override
+    {
+        VulkanDeviceTest::SetUp();
+        mBindlessManager = std::make_shared<BindlessManager>(mContext);
+        if (!mBindlessManager->IsEnabled())
+        {
+            GTEST_SKIP() << "Bindless descriptors are not supported";
+        }
+        mSampler = mContext->GetDevice().createSamplerUnique(vk::SamplerCreateInfo{});
+        CreateTarget();
+        CreatePipeline();
+    }
+    void TearDown() override
+    {
+        if (!mContext)
+        {
+            return;
+        }
+        mContext->GetDevice().waitIdle();
+        for (auto &image : mImages)
+        {
+            image.imageView.reset();
+            vmaDestroyImage(mContext->GetVmaAllocator(), image.image, image.allocation);
+        }
+        if (mReadbackBuffer)
+        {
+            vmaDestroyBuffer(mContext->GetVmaAllocator(), mReadbackBuffer, mReadbackAllocation);
+        }
+    }
+    Image &CreateImage(vk::ImageUsageFlags usage)
+    {
+        vk::ImageCreateInfo imageCreateInfo;
+        imageCreateInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(vk::Format::eR8G8B8A8Unorm)
+            .setExtent({TargetExtent.width, TargetExtent.height, 1})
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setUsage(usage);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        auto &image = mImages.emplace_back();
+        EXPECT_EQ(vmaCreateImage(mContext->GetVmaAllocator(), &static_cast<VkImageCreateInfo &>(imageCreateInfo),
+                                 &allocationCreateInfo, reinterpret_cast<VkImage *>(&image.image), &image.allocation,
+                                 nullptr),
+                  VK_SUCCESS);
+        vk::ImageViewCreateInfo imageViewCreateInfo;
+        imageViewCreateInfo.setImage(image.image)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(vk::Format::eR8G8B8A8Unorm)
+            .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+        image.imageView = mContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
+        return image;
+    }
+    // 纯色纹理，清除后转换到shader读布局
+    vk::ImageView CreateTexture(const std::array<float, 4> &color)
+    {
+        auto &image = CreateImage(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            vk::ImageSubresourceRange range{vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+            vk::ImageMemoryBarrier barrier;
+            barrier.setImage(image.image)
+                .setSubresourceRange(range)
+                .setOldLayout(vk::ImageLayout::eUndefined)
+                .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+                .setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                          {}, {}, {}, barrier);
+            commandBuffer.clearColorImage(image.image, vk::ImageLayout::eTransferDstOptimal,
+                                          vk::ClearColorValue{color}, range);
+            barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+                .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                          vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, barrier);
+        });
+        return image.imageView.get();
+    }
+    void CreateTarget()
+    {
+        auto &target = CreateImage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc);
+        vk::AttachmentDescription attachment;
+        attachment.setFormat(vk::Format::eR8G8B8A8Unorm)
+            .setLoadOp(vk::AttachmentLoadOp::eClear)
+            .setStoreOp(vk::AttachmentStoreOp::eStore)
+            .setInitialLayout(vk::ImageLayout::eUndefined)
+            .setFinalLayout(vk::ImageLayout::eTransferSrcOptimal);
+        vk::AttachmentReference colorReference{0, vk::ImageLayout::eColorAttachmentOptimal};
+        vk::SubpassDescription subpass;
+        subpass.setPipelineBindPoint(vk::PipelineBindPoint::eGraphics).setColorAttachments(colorReference);
+        vk::RenderPassCreateInfo renderPassCreateInfo;
+        renderPassCreateInfo.setAttachments(attachment).setSubpasses(subpass);
+        mRenderPass = mContext->GetDevice().createRenderPassUnique(renderPassCreateInfo);
+        auto imageView = target.imageView.get();
+        vk::FramebufferCreateInfo framebufferCreateInfo;
+        framebufferCreateInfo.setRenderPass(mRenderPass.get())
+            .setAttachments(imageView)
+            .setWidth(TargetExtent.width)
+            .setHeight(TargetExtent.height)
+            .setLayers(1);
+        mFramebuffer = mContext->GetDevice().createFramebufferUnique(framebufferCreateInfo);
+
+        vk::BufferCreateInfo bufferCreateInfo;
+        bufferCreateInfo.setSize(TargetExtent.width * TargetExtent.height * 4)
+            .setUsage(vk::BufferUsageFlagBits::eTransferDst);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_TO_CPU;
+        allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;
+        ASSERT_EQ(vmaCreateBuffer(mContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                                  &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&mReadbackBuffer),
+                                  &mReadbackAllocation, &mReadbackAllocationInfo),
+                  VK_SUCCESS);
+    }
+    vk::UniqueShaderModule CreateShaderModule(const std::string &source, shaderc_shader_kind kind)
+    {
+        auto result = ShaderUtils::CompileShader(source, kind, "BindlessManagerTest");
+        std::vector<uint32_t> spirv(result.cbegin(), result.cend());
+        vk::ShaderModuleCreateInfo shaderModuleCreateInfo;
+        shaderModuleCreateInfo.setCode(spirv);
+        return mContext->GetDevice().createShaderModuleUnique(shaderModuleCreateInfo);
+    }
+    void CreatePipeline()
+    {
+        // 材质参数按uint数组跳过，纹理索引的偏移与BindlessMaterialData一致
+        auto propertyWords = offsetof(BindlessMaterialData, textureIndices) / sizeof(uint32_t);
+        auto fragmentSource =
+            "#version 460 core\n#define PROPERTY_WORDS " + std::to_string(propertyWords) + "\n" + FragmentShader;
+        auto vertexShaderModule = CreateShaderModule(VertexShader, shaderc_glsl_vertex_shader);
+        auto fragmentShaderModule = CreateShaderModule(fragmentSource, shaderc_glsl_fragment_shader);
+        std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages{
+            vk::PipelineShaderStageCreateInfo{{}, vk::ShaderStageFlagBits::eVertex, vertexShaderModule.get(), "main"},
+            vk::PipelineShaderStageCreateInfo{
+                {}, vk::ShaderStageFlagBits::eFragment, fragmentShaderModule.get(), "main"},
+        };
+        auto descriptorSetLayout = mBindlessManager->GetDescriptorSetLayout();
+        vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eFragment, 0, sizeof(uint32_t)};
+        vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.setSetLayouts(descriptorSetLayout).setPushConstantRanges(pushConstantRange);
+        mPipelineLayout = mContext->GetDevice().createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+        vk::PipelineVertexInputStateCreateInfo vertexInputState;
+        vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState{{}, vk::PrimitiveTopology::eTriangleList};
+        vk::Viewport viewport{0.0f, 0.0f, static_cast<float>(TargetExtent.width),
+                              static_cast<float>(TargetExtent.height), 0.0f, 1.0f};
+        vk::Rect2D scissor{{0, 0}, TargetExtent};
+        vk::PipelineViewportStateCreateInfo viewportState;
+        viewportState.setViewports(viewport).setScissors(scissor);
+        vk::PipelineRasterizationStateCreateInfo rasterizationState;
+        rasterizationState.setCullMode(vk::CullModeFlagBits::eNone).setLineWidth(1.0f);
+        vk::PipelineMultisampleStateCreateInfo multisampleState;
+        vk::PipelineColorBlendAttachmentState colorBlendAttachment;
+        colorBlendAttachment.setColorWriteMask(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                               vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA);
+        vk::PipelineColorBlendStateCreateInfo colorBlendState;
+        colorBlendState.setAttachments(colorBlendAttachment);
+        vk::GraphicsPipelineCreateInfo pipelineInfo;
+        pipelineInfo.setStages(shaderStages)
+            .setPVertexInputState(&vertexInputState)
+            .setPInputAssemblyState(&inputAssemblyState)
+            .setPViewportState(&viewportState)
+            .setPRasterizationState(&rasterizationState)
+            .setPMultisampleState(&multisampleState)
+            .setPColorBlendState(&colorBlendState)
+            .setLayout(mPipelineLayout.get())
+            .setRenderPass(mRenderPass.get());
+        auto pipelineResult = mContext->GetDevice().createGraphicsPipelineUnique(vk::PipelineCache(), pipelineInfo);
+        ASSERT_EQ(pipelineResult.result, vk::Result::eSuccess);
+        mPipeline = std::move(pipelineResult.value);
+    }
+    // 用材质索引绘制一次，返回左上角像素
+    std::array<uint8_t, 4> Draw(uint32_t materialIndex)
+    {
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            vk::ClearValue clearValue{vk::ClearColorValue{std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f}}};
+            vk::RenderPassBeginInfo renderPassBeginInfo;
+            renderPassBeginInfo.setRenderPass(mRenderPass.get())
+                .setFramebuffer(mFramebuffer.get())
+                .setRenderArea({{0, 0}, TargetExtent})
+                .setClearValues(clearValue);
+            commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, mPipeline.get());
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, mPipelineLayout.get(), 0,
+                                             mBindlessManager->GetDescriptorSet(), {});
+            commandBuffer.pushConstants(mPipelineLayout.get(), vk::ShaderStageFlagBits::eFragment, 0,
+                                        sizeof(uint32_t), &materialIndex);
+            commandBuffer.draw(3, 1, 0, 0);
+            commandBuffer.endRenderPass();
+            vk::BufferImageCopy region;
+            region.setImageSubresource({vk::ImageAspectFlagBits::eColor, 0, 0, 1})
+                .setImageExtent({TargetExtent.width, TargetExtent.height, 1});
+            commandBuffer.copyImageToBuffer(mImages[0].image, vk::ImageLayout::eTransferSrcOptimal, mReadbackBuffer,
+                                            region);
+        });
+        vmaInvalidateAllocation(mContext->GetVmaAllocator(), mReadbackAllocation, 0, VK_WHOLE_SIZE);
+        std::array<uint8_t, 4> pixel{};
+        std::memcpy(pixel.data(), mReadbackAllocationInfo.pMappedData, pixel.size());
+        return pixel;
+    }
+    uint32_t WriteMaterial(const UUID &texture, vk::ImageView imageView, uint32_t materialIndex)
+    {
+        BindlessMaterialData data{};
+        data.textureIndices[0] = mBindlessManager->WriteTexture(texture, imageView);
+        data.samplerIndices[0] = mBindlessManager->WriteSampler(mSampler.get());
+        mBindlessManager->WriteMaterial(materialIndex, data);
+        return data.textureIndices[0];
+    }
+    // 模拟经过了framesInFlight帧，执行延迟释放
+    void AdvanceFrames()
+    {
+        for (uint32_t i = 0; i < FramesInFlight; ++i)
+        {
+            mContext->GetDeletionQueue().BeginFrame(FramesInFlight);
+        }
+    }
+};
+
+TEST_F(BindlessManagerTest, DrawsMaterialTexture)
+{
+    auto red = CreateTexture({1.0f, 0.0f, 0.0f, 1.0f});
+    auto green = CreateTexture({0.0f, 1.0f, 0.0f, 1.0f});
+    auto redMaterial = mBindlessManager->AllocateMaterial();
+    auto greenMaterial = mBindlessManager->AllocateMaterial();
+    WriteMaterial(UUID{"00000000-0000-0000-0000-000000000001"}, red, redMaterial);
+    WriteMaterial(UUID{"00000000-0000-0000-0000-000000000002"}, green, greenMaterial);
+    EXPECT_EQ(Draw(redMaterial), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+    EXPECT_EQ(Draw(greenMaterial), (std::array<uint8_t, 4>{0, 255, 0, 255}));
+}
+TEST_F(BindlessManagerTest, ReplacedImageViewGetsNewSlot)
+{
+    UUID texture{"00000000-0000-0000-0000-000000000001"};
+    auto red = CreateTexture({1.0f, 0.0f, 0.0f, 1.0f});
+    auto blue = CreateTexture({0.0f, 0.0f, 1.0f, 1.0f});
+    auto oldMaterial = mBindlessManager->AllocateMaterial();
+    auto oldSlot = WriteMaterial(texture, red, oldMaterial);
+    EXPECT_EQ(mBindlessManager->WriteTexture(texture, red), oldSlot);
+    // 流式加载替换了image：旧材质和旧slot保持不变，in-flight的帧仍然读到旧纹理
+    auto newMaterial = mBindlessManager->AllocateMaterial();
+    auto newSlot = WriteMaterial(texture, blue, newMaterial);
+    EXPECT_NE(newSlot, oldSlot);
+    EXPECT_EQ(Draw(oldMaterial), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+    EXPECT_EQ(Draw(newMaterial), (std::array<uint8_t, 4>{0, 0, 255, 255}));
+    mBindlessManager->ReleaseMaterial(oldMaterial);
+    // in-flight帧完成前旧slot不会被复用
+    auto other = mBindlessManager->WriteTexture(UUID{"00000000-0000-0000-0000-000000000002"}, red);
+    EXPECT_NE(other, oldSlot);
+    EXPECT_NE(mBindlessManager->AllocateMaterial(), oldMaterial);
+    AdvanceFrames();
+    EXPECT_EQ(mBindlessManager->WriteTexture(UUID{"00000000-0000-0000-0000-000000000003"}, red), oldSlot);
+    EXPECT_EQ(mBindlessManager->AllocateMaterial(), oldMaterial);
+}
+TEST_F(BindlessManagerTest, ReleaseTextureIsDeferred)
+{
+    UUID texture{"00000000-0000-0000-0000-000000000001"};
+    auto red = CreateTexture({1.0f, 0.0f, 0.0f, 1.0f});
+    auto material = mBindlessManager->AllocateMaterial();
+    auto slot = WriteMaterial(texture, red, material);
+    mBindlessManager->ReleaseTexture(texture);
+    // 释放后slot中的描述符保持不变，in-flight的帧仍然可以采样
+    EXPECT_EQ(Draw(material), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+    // 同一纹理重新注册时分配新slot
+    EXPECT_NE(mBindlessManager->WriteTexture(texture, red), slot);
+    AdvanceFrames();
+    EXPECT_EQ(mBindlessManager->WriteTexture(UUID{"00000000-0000-0000-0000-000000000002"}, red), slot);
+}
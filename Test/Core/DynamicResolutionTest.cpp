@@ -0,0 +1,57 @@
+#include "DynamicResolution.hpp"
+#include <gtest/gtest.h>
+
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+DynamicResolutionSetting EnabledSetting()
+{
+    auto setting = DynamicResolutionSetting{};
+    setting.enabled = true;
+    setting.targetFrameMs = 10.0f;
+    setting.smoothing = 1.0f;
+    return setting;
+}
+// GPU时间与像素数成正比
+float FrameMs(float fullResolutionMs, float scale)
+{
+    return fullResolutionMs * scale * scale;
+}
+} // namespace
+TEST(DynamicResolutionTest, DisabledKeepsFullResolution)
+{
+    DynamicResolutionController controller;
+    EXPECT_FLOAT_EQ(controller.Update(100.0f), 1.0f);
+    EXPECT_FLOAT_EQ(controller.GetScale(), 1.0f);
+}
+TEST(DynamicResolutionTest, ConvergesUnderBudget)
+{
+    DynamicResolutionController controller(EnabledSetting());
+    constexpr float FullResolutionMs = 20.0f;
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        controller.Update(FrameMs(FullResolutionMs, controller.GetScale()));
+    }
+    auto scale = controller.GetScale();
+    EXPECT_LE(FrameMs(FullResolutionMs, scale), 10.0f);
+    // 再放大一个步长就会超出预算
+    EXPECT_GT(FrameMs(FullResolutionMs, scale + controller.GetSetting().scaleStep), 10.0f * 0.9f);
+    // 稳定后不再来回切换
+    for (uint32_t i = 0; i < 200; ++i)
+    {
+        EXPECT_FLOAT_EQ(controller.Update(FrameMs(FullResolutionMs, controller.GetScale())), scale);
+    }
+}
+TEST(DynamicResolutionTest, ClampsAndRecovers)
+{
+    DynamicResolutionController controller(EnabledSetting());
+    controller.Update(1000.0f);
+    EXPECT_FLOAT_EQ(controller.GetScale(), controller.GetSetting().minScale);
+    // 负载降低后逐步回到最大比例
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        controller.Update(FrameMs(4.0f, controller.GetScale()));
+    }
+    EXPECT_FLOAT_EQ(controller.GetScale(), controller.GetSetting().maxScale);
+}
@@ -0,0 +1,496 @@
+#include "HiZPyramid.hpp"
+#include "ShaderUtils.hpp"
+#include "VMA.hpp"
+#include "VulkanDeviceTest.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace MEngine;
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+constexpr uint32_t Width = 16;
+constexpr uint32_t Height = 12; // 第2级为4x3，覆盖奇数边的情况
+// 与MPipelineManager中HiZBuild/HiZCull的push constant一致
+struct BuildPushConstant
+{
+    glm::ivec2 srcSize;
+    glm::ivec2 dstSize;
+    glm::ivec2 validSize;
+    uint32_t level;
+};
+struct CullPushConstant
+{
+    glm::mat4 viewProjection;
+    glm::vec2 viewportSize;
+    uint32_t drawCount;
+    uint32_t phase;
+    uint32_t levelCount;
+    uint32_t hiZValid;
+};
+struct DrawData
+{
+    glm::vec4 boundsMin;
+    glm::vec4 boundsMax;
+    glm::mat4 modelMatrix;
+};
+struct Image
+{
+    vk::Image image{};
+    VmaAllocation allocation{};
+    vk::UniqueImageView imageView;
+};
+struct Buffer
+{
+    vk::Buffer buffer{};
+    VmaAllocation allocation{};
+    VmaAllocationInfo allocationInfo{};
+};
+using DepthFunction = std::function<float(uint32_t, uint32_t)>;
+} // namespace
+
+class HiZCullTest : public VulkanDeviceTest
+{
+  protected:
+    uint32_t mLevelCount{0};
+    std::vector<Image> mDepthImages;
+    Image mPyramid;
+    std::vector<vk::UniqueImageView> mPyramidLevelViews;
+    Buffer mStagingBuffer;
+    Buffer mDrawBuffer;
+    Buffer mCommandBuffer;
+    vk::UniqueDescriptorPool mDescriptorPool;
+    vk::UniqueDescriptorSetLayout mBuildDescriptorSetLayout;
+    vk::UniquePipelineLayout mBuildPipelineLayout;
+    vk::UniquePipeline mBuildPipeline;
+    vk::UniqueDescriptorSetLayout mCullDescriptorSetLayout;
+    vk::UniquePipelineLayout mCullPipelineLayout;
+    vk::UniquePipeline mCullPipeline;
+
+    void SetUp() override
+    {
+        VulkanDeviceTest::SetUp();
+        mLevelCount = HiZPyramid::GetMipLevelCount(Width, Height);
+        std::array<vk::DescriptorPoolSize, 3> poolSizes{
+            vk::DescriptorPoolSize{vk::DescriptorType::eSampledImage, 64},
+            vk::DescriptorPoolSize{vk::DescriptorType::eStorageImage, 128},
+            vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, 32},
+        };
+        vk::DescriptorPoolCreateInfo descriptorPoolCreateInfo;
+        descriptorPoolCreateInfo.setMaxSets(64).setPoolSizes(poolSizes);
+        mDescriptorPool = mContext->GetDevice().createDescriptorPoolUnique(descriptorPoolCreateInfo);
+        CreatePipelines();
+        CreatePyramid();
+        CreateBuffer(mStagingBuffer, sizeof(float) * Width * Height,
+                     vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst);
+    }
+    void TearDown() override
+    {
+        mContext->GetDevice().waitIdle();
+        mPyramidLevelViews.clear();
+        mPyramid.imageView.reset();
+        if (mPyramid.image)
+        {
+            vmaDestroyImage(mContext->GetVmaAllocator(), mPyramid.image, mPyramid.allocation);
+        }
+        for (auto &image : mDepthImages)
+        {
+            image.imageView.reset();
+            vmaDestroyImage(mContext->GetVmaAllocator(), image.image, image.allocation);
+        }
+        for (auto *buffer : {&mStagingBuffer, &mDrawBuffer, &mCommandBuffer})
+        {
+            if (buffer->buffer)
+            {
+                vmaDestroyBuffer(mContext->GetVmaAllocator(), buffer->buffer, buffer->allocation);
+            }
+        }
+    }
+    void CreateBuffer(Buffer &buffer, vk::DeviceSize size, vk::BufferUsageFlags usage)
+    {
+        vk::BufferCreateInfo bufferCreateInfo;
+        bufferCreateInfo.setSize(size).setUsage(usage);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
+        allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+        ASSERT_EQ(vmaCreateBuffer(mContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                                  &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&buffer.buffer),
+                                  &buffer.allocation, &buffer.allocationInfo),
+                  VK_SUCCESS);
+    }
+    vk::UniquePipeline CreateComputePipeline(const std::string &shaderPath, vk::PipelineLayout pipelineLayout)
+    {
+        // 与MPipelineManager相同，从bin目录下的Engine/Shaders读取
+        std::ifstream shaderFile(shaderPath);
+        EXPECT_TRUE(shaderFile.is_open()) << shaderPath;
+        std::stringstream shaderStream;
+        shaderStream << shaderFile.rdbuf();
+        auto result = ShaderUtils::CompileShader(shaderStream.str(), shaderc_glsl_compute_shader, shaderPath);
+        std::vector<uint32_t> spirv(result.cbegin(), result.cend());
+        vk::ShaderModuleCreateInfo shaderModuleCreateInfo;
+        shaderModuleCreateInfo.setCode(spirv);
+        auto shaderModule = mContext->GetDevice().createShaderModuleUnique(shaderModuleCreateInfo);
+        vk::ComputePipelineCreateInfo pipelineCreateInfo;
+        pipelineCreateInfo
+            .setStage(vk::PipelineShaderStageCreateInfo()
+                          .setStage(vk::ShaderStageFlagBits::eCompute)
+                          .setModule(shaderModule.get())
+                          .setPName("main"))
+            .setLayout(pipelineLayout);
+        auto pipelineResult =
+            mContext->GetDevice().createComputePipelineUnique(vk::PipelineCache(), pipelineCreateInfo, nullptr);
+        EXPECT_EQ(pipelineResult.result, vk::Result::eSuccess) << shaderPath;
+        return std::move(pipelineResult.value);
+    }
+    void CreatePipelines()
+    {
+        std::array<vk::DescriptorSetLayoutBinding, 3> buildBindings{
+            vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+            vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute},
+            vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute},
+        };
+        std::array<vk::DescriptorSetLayoutBinding, 3> cullBindings{
+            vk::DescriptorSetLayoutBinding{0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute},
+            vk::DescriptorSetLayoutBinding{1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+            vk::DescriptorSetLayoutBinding{2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute},
+        };
+        vk::DescriptorSetLayoutCreateInfo layoutCreateInfo;
+        layoutCreateInfo.setBindings(buildBindings);
+        mBuildDescriptorSetLayout = mContext->GetDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
+        layoutCreateInfo.setBindings(cullBindings);
+        mCullDescriptorSetLayout = mContext->GetDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
+
+        auto buildSetLayout = mBuildDescriptorSetLayout.get();
+        vk::PushConstantRange buildPushConstantRange{vk::ShaderStageFlagBits::eCompute, 0,
+                                                     sizeof(BuildPushConstant)};
+        vk::PipelineLayoutCreateInfo pipelineLayoutCreateInfo;
+        pipelineLayoutCreateInfo.setSetLayouts(buildSetLayout).setPushConstantRanges(buildPushConstantRange);
+        mBuildPipelineLayout = mContext->GetDevice().createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+        auto cullSetLayout = mCullDescriptorSetLayout.get();
+        vk::PushConstantRange cullPushConstantRange{vk::ShaderStageFlagBits::eCompute, 0, sizeof(CullPushConstant)};
+        pipelineLayoutCreateInfo.setSetLayouts(cullSetLayout).setPushConstantRanges(cullPushConstantRange);
+        mCullPipelineLayout = mContext->GetDevice().createPipelineLayoutUnique(pipelineLayoutCreateInfo);
+
+        mBuildPipeline = CreateComputePipeline("Engine/Shaders/HiZBuild.comp", mBuildPipelineLayout.get());
+        mCullPipeline = CreateComputePipeline("Engine/Shaders/HiZCull.comp", mCullPipelineLayout.get());
+    }
+    void CreatePyramid()
+    {
+        // 与MRenderSystem::CreateHiZPyramid相同：整条mip链一个视图供剔除采样，每级一个视图供生成时写入
+        vk::ImageCreateInfo imageCreateInfo;
+        imageCreateInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(vk::Format::eR32Sfloat)
+            .setExtent({Width, Height, 1})
+            .setMipLevels(mLevelCount)
+            .setArrayLayers(1)
+            .setUsage(vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled |
+                      vk::ImageUsageFlagBits::eTransferSrc);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        ASSERT_EQ(vmaCreateImage(mContext->GetVmaAllocator(), &static_cast<VkImageCreateInfo &>(imageCreateInfo),
+                                 &allocationCreateInfo, reinterpret_cast<VkImage *>(&mPyramid.image),
+                                 &mPyramid.allocation, nullptr),
+                  VK_SUCCESS);
+        vk::ImageViewCreateInfo imageViewCreateInfo;
+        imageViewCreateInfo.setImage(mPyramid.image)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(vk::Format::eR32Sfloat)
+            .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, mLevelCount, 0, 1});
+        mPyramid.imageView = mContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
+        for (uint32_t level = 0; level < mLevelCount; ++level)
+        {
+            imageViewCreateInfo.setSubresourceRange({vk::ImageAspectFlagBits::eColor, level, 1, 0, 1});
+            mPyramidLevelViews.push_back(mContext->GetDevice().createImageViewUnique(imageViewCreateInfo));
+        }
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            vk::ImageMemoryBarrier barrier;
+            barrier.setImage(mPyramid.image)
+                .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, mLevelCount, 0, 1})
+                .setOldLayout(vk::ImageLayout::eUndefined)
+                .setNewLayout(vk::ImageLayout::eGeneral)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderWrite);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                          vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, barrier);
+        });
+    }
+    // 用已知深度填充的R32Sfloat纹理代替深度缓冲，HiZBuild.comp只读取.r
+    vk::ImageView CreateDepth(const DepthFunction &depth)
+    {
+        auto data = static_cast<float *>(mStagingBuffer.allocationInfo.pMappedData);
+        for (uint32_t y = 0; y < Height; ++y)
+        {
+            for (uint32_t x = 0; x < Width; ++x)
+            {
+                data[y * Width + x] = depth(x, y);
+            }
+        }
+        vmaFlushAllocation(mContext->GetVmaAllocator(), mStagingBuffer.allocation, 0, VK_WHOLE_SIZE);
+        vk::ImageCreateInfo imageCreateInfo;
+        imageCreateInfo.setImageType(vk::ImageType::e2D)
+            .setFormat(vk::Format::eR32Sfloat)
+            .setExtent({Width, Height, 1})
+            .setMipLevels(1)
+            .setArrayLayers(1)
+            .setUsage(vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        auto &image = mDepthImages.emplace_back();
+        EXPECT_EQ(vmaCreateImage(mContext->GetVmaAllocator(), &static_cast<VkImageCreateInfo &>(imageCreateInfo),
+                                 &allocationCreateInfo, reinterpret_cast<VkImage *>(&image.image), &image.allocation,
+                                 nullptr),
+                  VK_SUCCESS);
+        vk::ImageViewCreateInfo imageViewCreateInfo;
+        imageViewCreateInfo.setImage(image.image)
+            .setViewType(vk::ImageViewType::e2D)
+            .setFormat(vk::Format::eR32Sfloat)
+            .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1});
+        image.imageView = mContext->GetDevice().createImageViewUnique(imageViewCreateInfo);
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            vk::ImageMemoryBarrier barrier;
+            barrier.setImage(image.image)
+                .setSubresourceRange({vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1})
+                .setOldLayout(vk::ImageLayout::eUndefined)
+                .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+                .setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                          {}, {}, {}, barrier);
+            vk::BufferImageCopy region;
+            region.setImageSubresource({vk::ImageAspectFlagBits::eColor, 0, 0, 1}).setImageExtent({Width, Height, 1});
+            commandBuffer.copyBufferToImage(mStagingBuffer.buffer, image.image,
+                                            vk::ImageLayout::eTransferDstOptimal, region);
+            barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+                .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+                .setSrcAccessMask(vk::AccessFlagBits::eTransferWrite)
+                .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                          vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, barrier);
+        });
+        return image.imageView.get();
+    }
+    vk::DescriptorSet AllocateDescriptorSet(vk::DescriptorSetLayout layout)
+    {
+        vk::DescriptorSetAllocateInfo allocateInfo;
+        allocateInfo.setDescriptorPool(mDescriptorPool.get()).setSetLayouts(layout);
+        return mContext->GetDevice().allocateDescriptorSets(allocateInfo)[0];
+    }
+    // 与MRenderSystem::HiZBuildPass相同的逐级dispatch和barrier
+    void BuildPyramid(vk::ImageView depthView, glm::ivec2 validSize = {Width, Height})
+    {
+        std::vector<vk::DescriptorSet> descriptorSets;
+        for (uint32_t level = 0; level < mLevelCount; ++level)
+        {
+            auto descriptorSet = AllocateDescriptorSet(mBuildDescriptorSetLayout.get());
+            vk::DescriptorImageInfo depthInfo{nullptr, depthView, vk::ImageLayout::eShaderReadOnlyOptimal};
+            // 第0级不读取上一级，绑定自身保证描述符有效
+            vk::DescriptorImageInfo srcInfo{nullptr, mPyramidLevelViews[level == 0 ? 0 : level - 1].get(),
+                                            vk::ImageLayout::eGeneral};
+            vk::DescriptorImageInfo dstInfo{nullptr, mPyramidLevelViews[level].get(), vk::ImageLayout::eGeneral};
+            std::array<vk::WriteDescriptorSet, 3> writes;
+            writes[0].setDstSet(descriptorSet)
+                .setDstBinding(0)
+                .setDescriptorType(vk::DescriptorType::eSampledImage)
+                .setImageInfo(depthInfo);
+            writes[1].setDstSet(descriptorSet)
+                .setDstBinding(1)
+                .setDescriptorType(vk::DescriptorType::eStorageImage)
+                .setImageInfo(srcInfo);
+            writes[2].setDstSet(descriptorSet)
+                .setDstBinding(2)
+                .setDescriptorType(vk::DescriptorType::eStorageImage)
+                .setImageInfo(dstInfo);
+            mContext->GetDevice().updateDescriptorSets(writes, {});
+            descriptorSets.push_back(descriptorSet);
+        }
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, mBuildPipeline.get());
+            for (uint32_t level = 0; level < mLevelCount; ++level)
+            {
+                auto src = HiZPyramid::GetMipExtent(Width, Height, level == 0 ? 0 : level - 1);
+                auto dst = HiZPyramid::GetMipExtent(Width, Height, level);
+                BuildPushConstant pushConstant{glm::ivec2(src), glm::ivec2(dst), validSize, level};
+                commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, mBuildPipelineLayout.get(), 0,
+                                                 descriptorSets[level], {});
+                commandBuffer.pushConstants(mBuildPipelineLayout.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                                            sizeof(BuildPushConstant), &pushConstant);
+                commandBuffer.dispatch((dst.x + 7) / 8, (dst.y + 7) / 8, 1);
+                vk::ImageMemoryBarrier barrier;
+                barrier.setImage(mPyramid.image)
+                    .setSubresourceRange({vk::ImageAspectFlagBits::eColor, level, 1, 0, 1})
+                    .setOldLayout(vk::ImageLayout::eGeneral)
+                    .setNewLayout(vk::ImageLayout::eGeneral)
+                    .setSrcAccessMask(vk::AccessFlagBits::eShaderWrite)
+                    .setDstAccessMask(vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eTransferRead);
+                commandBuffer.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eComputeShader,
+                    vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eTransfer, {}, {}, {},
+                    barrier);
+            }
+        });
+    }
+    std::vector<float> ReadPyramidLevel(uint32_t level)
+    {
+        auto extent = HiZPyramid::GetMipExtent(Width, Height, level);
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            vk::BufferImageCopy region;
+            region.setImageSubresource({vk::ImageAspectFlagBits::eColor, level, 0, 1})
+                .setImageExtent({extent.x, extent.y, 1});
+            commandBuffer.copyImageToBuffer(mPyramid.image, vk::ImageLayout::eGeneral, mStagingBuffer.buffer, region);
+            vk::MemoryBarrier barrier{vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {},
+                                          barrier, {}, {});
+        });
+        vmaInvalidateAllocation(mContext->GetVmaAllocator(), mStagingBuffer.allocation, 0, VK_WHOLE_SIZE);
+        auto data = static_cast<const float *>(mStagingBuffer.allocationInfo.pMappedData);
+        return {data, data + extent.x * extent.y};
+    }
+    // 第二阶段的instanceCount预先写成非0/1的值，确保结果由着色器写入
+    void SetDraws(const std::vector<DrawData> &draws)
+    {
+        CreateBuffer(mDrawBuffer, sizeof(DrawData) * draws.size(), vk::BufferUsageFlagBits::eStorageBuffer);
+        CreateBuffer(mCommandBuffer, sizeof(vk::DrawIndexedIndirectCommand) * draws.size() * 2,
+                     vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer);
+        std::memcpy(mDrawBuffer.allocationInfo.pMappedData, draws.data(), sizeof(DrawData) * draws.size());
+        auto commands = static_cast<vk::DrawIndexedIndirectCommand *>(mCommandBuffer.allocationInfo.pMappedData);
+        for (uint32_t i = 0; i < draws.size() * 2; ++i)
+        {
+            commands[i] = vk::DrawIndexedIndirectCommand{36, 7, 0, 0, i};
+        }
+        vmaFlushAllocation(mContext->GetVmaAllocator(), mDrawBuffer.allocation, 0, VK_WHOLE_SIZE);
+        vmaFlushAllocation(mContext->GetVmaAllocator(), mCommandBuffer.allocation, 0, VK_WHOLE_SIZE);
+    }
+    // 返回[0, 2 * drawCount)的instanceCount
+    std::vector<uint32_t> Cull(uint32_t drawCount, uint32_t phase, bool hiZValid)
+    {
+        auto descriptorSet = AllocateDescriptorSet(mCullDescriptorSetLayout.get());
+        vk::DescriptorImageInfo hiZInfo{nullptr, mPyramid.imageView.get(), vk::ImageLayout::eGeneral};
+        vk::DescriptorBufferInfo drawInfo{mDrawBuffer.buffer, 0, vk::WholeSize};
+        vk::DescriptorBufferInfo commandInfo{mCommandBuffer.buffer, 0, vk::WholeSize};
+        std::array<vk::WriteDescriptorSet, 3> writes;
+        writes[0].setDstSet(descriptorSet)
+            .setDstBinding(0)
+            .setDescriptorType(vk::DescriptorType::eSampledImage)
+            .setImageInfo(hiZInfo);
+        writes[1].setDstSet(descriptorSet)
+            .setDstBinding(1)
+            .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+            .setBufferInfo(drawInfo);
+        writes[2].setDstSet(descriptorSet)
+            .setDstBinding(2)
+            .setDescriptorType(vk::DescriptorType::eStorageBuffer)
+            .setBufferInfo(commandInfo);
+        mContext->GetDevice().updateDescriptorSets(writes, {});
+        // 单位矩阵：包围盒直接给出NDC坐标
+        CullPushConstant pushConstant{glm::mat4(1.0f), glm::vec2(Width, Height), drawCount, phase,
+                                      mLevelCount, hiZValid ? 1u : 0u};
+        Submit([&](vk::CommandBuffer commandBuffer) {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, mCullPipeline.get());
+            commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute, mCullPipelineLayout.get(), 0,
+                                             descriptorSet, {});
+            commandBuffer.pushConstants(mCullPipelineLayout.get(), vk::ShaderStageFlagBits::eCompute, 0,
+                                        sizeof(CullPushConstant), &pushConstant);
+            commandBuffer.dispatch((drawCount + 63) / 64, 1, 1);
+            vk::MemoryBarrier barrier{vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead};
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                          vk::PipelineStageFlagBits::eHost, {}, barrier, {}, {});
+        });
+        vmaInvalidateAllocation(mContext->GetVmaAllocator(), mCommandBuffer.allocation, 0, VK_WHOLE_SIZE);
+        auto commands = static_cast<const vk::DrawIndexedIndirectCommand *>(mCommandBuffer.allocationInfo.pMappedData);
+        std::vector<uint32_t> instanceCounts;
+        for (uint32_t i = 0; i < drawCount * 2; ++i)
+        {
+            instanceCounts.push_back(commands[i].instanceCount);
+        }
+        return instanceCounts;
+    }
+};
+
+TEST_F(HiZCullTest, BuildTakesMaxDepth)
+{
+    // 每个像素深度不同，validSize之外视为1.0
+    auto depth = [](uint32_t x, uint32_t y) { return static_cast<float>(y * Width + x) / (Width * Height * 2); };
+    glm::ivec2 validSize{Width - 3, Height - 1};
+    BuildPyramid(CreateDepth(depth), validSize);
+    std::vector<float> expected;
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        for (uint32_t x = 0; x < Width; ++x)
+        {
+            auto valid = x < static_cast<uint32_t>(validSize.x) && y < static_cast<uint32_t>(validSize.y);
+            expected.push_back(valid ? depth(x, y) : 1.0f);
+        }
+    }
+    EXPECT_EQ(ReadPyramidLevel(0), expected);
+    for (uint32_t level = 1; level < mLevelCount; ++level)
+    {
+        // 与着色器相同，奇数边上重复最后一行/列
+        auto src = HiZPyramid::GetMipExtent(Width, Height, level - 1);
+        auto dst = HiZPyramid::GetMipExtent(Width, Height, level);
+        std::vector<float> next;
+        for (uint32_t y = 0; y < dst.y; ++y)
+        {
+            for (uint32_t x = 0; x < dst.x; ++x)
+            {
+                auto x0 = std::min(x * 2, src.x - 1);
+                auto x1 = std::min(x * 2 + 1, src.x - 1);
+                auto y0 = std::min(y * 2, src.y - 1);
+                auto y1 = std::min(y * 2 + 1, src.y - 1);
+                next.push_back(std::max({expected[y0 * src.x + x0], expected[y0 * src.x + x1],
+                                         expected[y1 * src.x + x0], expected[y1 * src.x + x1]}));
+            }
+        }
+        expected = std::move(next);
+        EXPECT_EQ(ReadPyramidLevel(level), expected) << "level " << level;
+    }
+    // 左上角的有效区域不含1.0，最顶层因包含无效区域为1.0
+    EXPECT_LT(ReadPyramidLevel(1)[0], 1.0f);
+    EXPECT_EQ(ReadPyramidLevel(mLevelCount - 1)[0], 1.0f);
+}
+TEST_F(HiZCullTest, TwoPhaseCulling)
+{
+    constexpr float OccluderDepth = 0.3f;
+    auto box = [](glm::vec3 min, glm::vec3 max) {
+        return DrawData{glm::vec4(min, 1.0f), glm::vec4(max, 1.0f), glm::mat4(1.0f)};
+    };
+    std::vector<DrawData> draws{
+        box({-0.9f, -0.5f, 0.5f}, {-0.2f, 0.5f, 0.6f}), // 0: 左半屏，在遮挡物之后
+        box({0.2f, -0.5f, 0.5f}, {0.9f, 0.5f, 0.6f}),   // 1: 右半屏，在遮挡物之后
+        box({-0.9f, -0.5f, 0.1f}, {-0.2f, 0.5f, 0.2f}), // 2: 左半屏，在遮挡物之前
+        box({-0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.6f}),  // 3: 跨越左右两半，在遮挡物之后
+        box({1.2f, -0.5f, 0.1f}, {1.5f, 0.5f, 0.2f}),   // 4: 屏幕外
+    };
+    auto drawCount = static_cast<uint32_t>(draws.size());
+    SetDraws(draws);
+    // 上一帧遮挡物覆盖全屏，本帧只覆盖左半屏
+    auto previousDepth = CreateDepth([&](uint32_t, uint32_t) { return OccluderDepth; });
+    auto currentDepth = CreateDepth([&](uint32_t x, uint32_t) { return x < Width / 2 ? OccluderDepth : 1.0f; });
+
+    // 没有有效的Hi-Z时第一阶段全部绘制
+    auto instanceCounts = Cull(drawCount, 0, false);
+    EXPECT_EQ(std::vector<uint32_t>(instanceCounts.begin(), instanceCounts.begin() + drawCount),
+              std::vector<uint32_t>(drawCount, 1));
+
+    // 第一阶段：用上一帧的Hi-Z，只有遮挡物之前的物体可见
+    BuildPyramid(previousDepth);
+    instanceCounts = Cull(drawCount, 0, true);
+    EXPECT_EQ(std::vector<uint32_t>(instanceCounts.begin(), instanceCounts.begin() + drawCount),
+              (std::vector<uint32_t>{0, 0, 1, 0, 0}));
+    EXPECT_EQ(std::vector<uint32_t>(instanceCounts.begin() + drawCount, instanceCounts.end()),
+              std::vector<uint32_t>(drawCount, 7));
+
+    // 第二阶段：用本帧的Hi-Z补画第一阶段被剔除但实际可见的物体，已绘制的不重复
+    BuildPyramid(currentDepth);
+    instanceCounts = Cull(drawCount, 1, true);
+    EXPECT_EQ(std::vector<uint32_t>(instanceCounts.begin(), instanceCounts.begin() + drawCount),
+              (std::vector<uint32_t>{0, 0, 1, 0, 0}));
+    EXPECT_EQ(std::vector<uint32_t>(instanceCounts.begin() + drawCount, instanceCounts.end()),
+              (std::vector<uint32_t>{0, 1, 0, 1, 0}));
+}
@@ -0,0 +1,43 @@
+#include "HiZPyramid.hpp"
+#include <gtest/gtest.h>
+
+using namespace MEngine::Core::Utils;
+
+TEST(HiZPyramidTest, MipExtents)
+{
+    EXPECT_EQ(HiZPyramid::GetMipLevelCount(1, 1), 1u);
+    EXPECT_EQ(HiZPyramid::GetMipLevelCount(1280, 720), 12u);
+    EXPECT_EQ(HiZPyramid::GetMipExtent(1280, 720, 0), glm::uvec2(1280, 720));
+    // 向上取整: 5 -> 3 -> 2 -> 1
+    EXPECT_EQ(HiZPyramid::GetMipExtent(5, 3, 1), glm::uvec2(3, 2));
+    EXPECT_EQ(HiZPyramid::GetMipExtent(5, 3, 2), glm::uvec2(2, 1));
+    EXPECT_EQ(HiZPyramid::GetMipExtent(5, 3, 3), glm::uvec2(1, 1));
+    auto levelCount = HiZPyramid::GetMipLevelCount(1279, 719);
+    EXPECT_EQ(HiZPyramid::GetMipExtent(1279, 719, levelCount - 1), glm::uvec2(1, 1));
+}
+TEST(HiZPyramidTest, MipTexelsCoverAllPixels)
+{
+    // 每级的texel通过2x2取最大值覆盖上一级的全部texel
+    uint32_t width = 1279;
+    uint32_t height = 719;
+    for (uint32_t level = 1; level < HiZPyramid::GetMipLevelCount(width, height); ++level)
+    {
+        auto src = HiZPyramid::GetMipExtent(width, height, level - 1);
+        auto dst = HiZPyramid::GetMipExtent(width, height, level);
+        EXPECT_GE(dst.x * 2, src.x);
+        EXPECT_GE(dst.y * 2, src.y);
+        EXPECT_LE((dst.x - 1) * 2, src.x - 1);
+        EXPECT_LE((dst.y - 1) * 2, src.y - 1);
+    }
+}
+TEST(HiZPyramidTest, SelectMipLevel)
+{
+    EXPECT_EQ(HiZPyramid::SelectMipLevel({10, 10}, {11, 11}, 11), 0u);
+    EXPECT_EQ(HiZPyramid::SelectMipLevel({10, 10}, {12, 10}, 11), 1u);
+    auto level = HiZPyramid::SelectMipLevel({100, 37}, {300, 90}, 11);
+    EXPECT_LE((300 >> level) - (100 >> level), 1);
+    EXPECT_LE((90 >> level) - (37 >> level), 1);
+    EXPECT_GT((300 >> (level - 1)) - (100 >> (level - 1)), 1);
+    // 不超过最粗的一级
+    EXPECT_EQ(HiZPyramid::SelectMipLevel({0, 0}, {1279, 719}, 4), 3u);
+}
@@ -0,0 +1,92 @@
+#include "IBLBaker.hpp"
+#include "MipmapGenerator.hpp"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+std::vector<uint8_t> ConstantEnvironment(uint32_t width, uint32_t height, const glm::vec3 &color)
+{
+    std::vector<float> pixels(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        pixels[i + 0] = color.r;
+        pixels[i + 1] = color.g;
+        pixels[i + 2] = color.b;
+        pixels[i + 3] = 1.0f;
+    }
+    std::vector<uint8_t> data(pixels.size() * sizeof(float));
+    std::memcpy(data.data(), pixels.data(), data.size());
+    return data;
+}
+} // namespace
+TEST(IBLBakerTest, DirectionRoundTrip)
+{
+    for (auto direction : {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                           glm::normalize(glm::vec3(0.3f, 0.8f, -0.5f)), glm::normalize(glm::vec3(-0.6f, -0.2f, 0.7f))})
+    {
+        auto result = IBLBaker::UVToDirection(IBLBaker::DirectionToUV(direction));
+        EXPECT_NEAR(result.x, direction.x, 1e-5f);
+        EXPECT_NEAR(result.y, direction.y, 1e-5f);
+        EXPECT_NEAR(result.z, direction.z, 1e-5f);
+    }
+    // v = 1为+y
+    EXPECT_NEAR(IBLBaker::UVToDirection(glm::vec2(0.5f, 1.0f)).y, 1.0f, 1e-5f);
+}
+TEST(IBLBakerTest, ConstantEnvironment)
+{
+    constexpr uint32_t Width = 64;
+    constexpr uint32_t Height = 32;
+    auto color = glm::vec3(0.8f, 0.5f, 0.2f);
+    auto setting = IBLBakeSetting{};
+    setting.specularSampleCount = 32;
+    setting.irradianceWidth = 16;
+    setting.irradianceHeight = 8;
+    setting.brdfLUTSize = 8;
+    setting.brdfSampleCount = 64;
+    auto result = IBLBaker::Bake(ConstantEnvironment(Width, Height, color), Width, Height, setting);
+    EXPECT_EQ(result.specularMipLevels, MipmapGenerator::GetMipLevelCount(Width, Height));
+    // 常量环境的预滤波和辐照度仍为常量(辐照度存储E / PI)
+    auto levels = MipmapGenerator::GetMipLevels(Width, Height, result.specularMipLevels, 16);
+    ASSERT_EQ(result.specular.size(), levels.back().offset + levels.back().size);
+    for (const auto &level : levels)
+    {
+        auto pixels = reinterpret_cast<const float *>(result.specular.data() + level.offset);
+        for (size_t i = 0; i < static_cast<size_t>(level.width) * level.height * 4; i += 4)
+        {
+            EXPECT_NEAR(pixels[i + 0], color.r, 1e-3f);
+            EXPECT_NEAR(pixels[i + 1], color.g, 1e-3f);
+            EXPECT_NEAR(pixels[i + 2], color.b, 1e-3f);
+        }
+    }
+    auto irradiance = reinterpret_cast<const float *>(result.irradiance.data());
+    ASSERT_EQ(result.irradiance.size(), 16u * 8u * 4u * sizeof(float));
+    for (size_t i = 0; i < 16u * 8u * 4u; i += 4)
+    {
+        EXPECT_NEAR(irradiance[i + 0], color.r, 1e-2f);
+        EXPECT_NEAR(irradiance[i + 1], color.g, 1e-2f);
+        EXPECT_NEAR(irradiance[i + 2], color.b, 1e-2f);
+    }
+}
+TEST(IBLBakerTest, BRDFLUT)
+{
+    constexpr uint32_t Size = 16;
+    auto data = IBLBaker::BakeBRDFLUT(Size, 256);
+    ASSERT_EQ(data.size(), Size * Size * 2 * sizeof(float));
+    auto pixels = reinterpret_cast<const float *>(data.data());
+    for (uint32_t i = 0; i < Size * Size; ++i)
+    {
+        auto scale = pixels[i * 2 + 0];
+        auto bias = pixels[i * 2 + 1];
+        EXPECT_GE(scale, 0.0f);
+        EXPECT_GE(bias, 0.0f);
+        EXPECT_LE(scale + bias, 1.0f + 1e-3f);
+    }
+    // 光滑表面正视时几乎没有能量损失，F0直接通过
+    auto smooth = pixels + (Size - 1) * 2;
+    EXPECT_GT(smooth[0] + smooth[1], 0.9f);
+    EXPECT_LT(smooth[1], 0.05f);
+}
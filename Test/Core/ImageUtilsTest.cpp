@@ -1,7 +1,11 @@
 
 #include "ImageUtil.hpp"
 #include "gtest/gtest.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <gtest/gtest.h>
+#include <vector>
 
 class ImageUtilTest : public ::testing::Test
 {
@@ -27,4 +31,57 @@ TEST_F(ImageUtilTest, LoadAndSave)
                      << ", Channels: " << channels;
     stbi_write_png(outputImagePath.string().c_str(), width, height, channels, data, width * channels);
     stbi_image_free(data);
-}
\ No newline at end of file
+}
+TEST(ImageUtilConvertTest, FloatToHalf)
+{
+    using MEngine::Core::Utils::ImageUtil;
+    EXPECT_EQ(ImageUtil::FloatToHalf(0.0f), 0x0000);
+    EXPECT_EQ(ImageUtil::FloatToHalf(-0.0f), 0x8000);
+    EXPECT_EQ(ImageUtil::FloatToHalf(1.0f), 0x3C00);
+    EXPECT_EQ(ImageUtil::FloatToHalf(-2.0f), 0xC000);
+    EXPECT_EQ(ImageUtil::FloatToHalf(65504.0f), 0x7BFF);
+    EXPECT_EQ(ImageUtil::FloatToHalf(1e6f), 0x7C00);
+    EXPECT_EQ(ImageUtil::FloatToHalf(5.9604645e-8f), 0x0001);
+    // 1 + 2^-11正好位于两个half中间，舍入到偶数
+    EXPECT_EQ(ImageUtil::FloatToHalf(1.00048828125f), 0x3C00);
+    EXPECT_FLOAT_EQ(ImageUtil::HalfToFloat(ImageUtil::FloatToHalf(0.1f)), 0.0999755859375f);
+}
+TEST(ImageUtilConvertTest, RGB9E5)
+{
+    using MEngine::Core::Utils::ImageUtil;
+    EXPECT_EQ(ImageUtil::PackRGB9E5(0.0f, 0.0f, 0.0f), 0u);
+    auto one = ImageUtil::UnpackRGB9E5(ImageUtil::PackRGB9E5(1.0f, -1.0f, 0.5f));
+    EXPECT_FLOAT_EQ(one[0], 1.0f);
+    EXPECT_FLOAT_EQ(one[1], 0.0f);
+    EXPECT_FLOAT_EQ(one[2], 0.5f);
+    auto clamped = ImageUtil::UnpackRGB9E5(ImageUtil::PackRGB9E5(1e9f, 0.0f, 0.0f));
+    EXPECT_FLOAT_EQ(clamped[0], 65408.0f);
+}
+TEST(ImageUtilConvertTest, ConvertMatchesScalar)
+{
+    using MEngine::Core::Utils::ImageUtil;
+    // 奇数个像素，覆盖SIMD之后的尾部
+    constexpr size_t PixelCount = 4099;
+    std::vector<float> pixels(PixelCount * 4);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = std::ldexp(static_cast<float>(i % 97) / 97.0f, static_cast<int>(i % 23) - 12) *
+                    (i % 11 == 0 ? -1.0f : 1.0f);
+    }
+    std::vector<uint8_t> data(pixels.size() * sizeof(float));
+    std::memcpy(data.data(), pixels.data(), data.size());
+    auto halfData = ImageUtil::ConvertRGBA32FToRGBA16F(data);
+    ASSERT_EQ(halfData.size(), PixelCount * 8);
+    auto halves = reinterpret_cast<const uint16_t *>(halfData.data());
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        EXPECT_EQ(halves[i], ImageUtil::FloatToHalf(pixels[i]));
+    }
+    auto packedData = ImageUtil::ConvertRGBA32FToRGB9E5(data);
+    ASSERT_EQ(packedData.size(), PixelCount * 4);
+    auto packed = reinterpret_cast<const uint32_t *>(packedData.data());
+    for (size_t i = 0; i < PixelCount; ++i)
+    {
+        EXPECT_EQ(packed[i], ImageUtil::PackRGB9E5(pixels[i * 4], pixels[i * 4 + 1], pixels[i * 4 + 2]));
+    }
+}
@@ -0,0 +1,182 @@
+#include "MipmapGenerator.hpp"
+#include "TaskManager.hpp"
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+
+using namespace MEngine::Core::Utils;
+
+TEST(MipmapGeneratorTest, MipLevels)
+{
+    EXPECT_EQ(MipmapGenerator::GetMipLevelCount(256, 128), 9u);
+    EXPECT_EQ(MipmapGenerator::GetMipLevelCount(1, 1), 1u);
+    auto levels = MipmapGenerator::GetMipLevels(256, 128, 0, 4);
+    ASSERT_EQ(levels.size(), 9u);
+    EXPECT_EQ(levels[8].width, 1u);
+    EXPECT_EQ(levels[8].height, 1u);
+    EXPECT_EQ(levels[1].offset, 256u * 128u * 4u);
+    EXPECT_EQ(MipmapGenerator::GetMipChainSize(4, 4, 0, 4), (16u + 4u + 1u) * 4u);
+    EXPECT_EQ(MipmapGenerator::GetMipLevels(256, 128, 3, 4).size(), 3u);
+}
+TEST(MipmapGeneratorTest, ConstantColorIsPreserved)
+{
+    for (auto filter : {MipmapFilter::Box, MipmapFilter::Kaiser, MipmapFilter::Lanczos})
+    {
+        std::vector<uint8_t> image(64 * 32 * 4);
+        for (size_t i = 0; i < image.size(); i += 4)
+        {
+            image[i + 0] = 200;
+            image[i + 1] = 100;
+            image[i + 2] = 30;
+            image[i + 3] = 255;
+        }
+        auto setting = MipmapSetting{};
+        setting.filter = filter;
+        auto result = MipmapGenerator::GenerateRGBA8(image, 64, 32, setting);
+        ASSERT_EQ(result.size(), MipmapGenerator::GetMipChainSize(64, 32, 0, 4));
+        for (size_t i = 0; i < result.size(); i += 4)
+        {
+            EXPECT_NEAR(result[i + 0], 200, 1);
+            EXPECT_NEAR(result[i + 1], 100, 1);
+            EXPECT_NEAR(result[i + 2], 30, 1);
+            EXPECT_EQ(result[i + 3], 255);
+        }
+    }
+}
+TEST(MipmapGeneratorTest, SRGBFilteringInLinearSpace)
+{
+    // 黑白棋盘格，线性空间平均为0.5，对应sRGB约188
+    std::vector<uint8_t> image(2 * 2 * 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        uint8_t c = (i == 0 || i == 3) ? 255 : 0;
+        image[i * 4 + 0] = c;
+        image[i * 4 + 1] = c;
+        image[i * 4 + 2] = c;
+        image[i * 4 + 3] = 255;
+    }
+    auto setting = MipmapSetting{};
+    setting.filter = MipmapFilter::Box;
+    auto srgb = MipmapGenerator::GenerateRGBA8(image, 2, 2, setting);
+    ASSERT_EQ(srgb.size(), 5u * 4u);
+    EXPECT_NEAR(srgb[16], 188, 1);
+
+    setting.isSRGB = false;
+    auto linear = MipmapGenerator::GenerateRGBA8(image, 2, 2, setting);
+    EXPECT_NEAR(linear[16], 128, 1);
+}
+TEST(MipmapGeneratorTest, NormalMapIsRenormalized)
+{
+    const uint32_t size = 32;
+    std::vector<uint8_t> image(size * size * 4);
+    for (uint32_t y = 0; y < size; ++y)
+    {
+        for (uint32_t x = 0; x < size; ++x)
+        {
+            // 交替倾斜的法线，平均后长度小于1
+            float nx = (x % 2 == 0) ? 0.7f : -0.7f;
+            float nz = std::sqrt(1.0f - nx * nx);
+            auto *p = &image[(y * size + x) * 4];
+            p[0] = static_cast<uint8_t>((nx * 0.5f + 0.5f) * 255.0f + 0.5f);
+            p[1] = 128;
+            p[2] = static_cast<uint8_t>((nz * 0.5f + 0.5f) * 255.0f + 0.5f);
+            p[3] = 255;
+        }
+    }
+    auto setting = MipmapSetting{};
+    setting.isNormalMap = true;
+    auto result = MipmapGenerator::GenerateRGBA8(image, size, size, setting);
+    auto levels = MipmapGenerator::GetMipLevels(size, size, 0, 4);
+    for (size_t level = 1; level < levels.size(); ++level)
+    {
+        auto *p = result.data() + levels[level].offset;
+        for (size_t i = 0; i < levels[level].size; i += 4)
+        {
+            float x = p[i + 0] / 255.0f * 2.0f - 1.0f;
+            float y = p[i + 1] / 255.0f * 2.0f - 1.0f;
+            float z = p[i + 2] / 255.0f * 2.0f - 1.0f;
+            EXPECT_NEAR(std::sqrt(x * x + y * y + z * z), 1.0f, 0.02f);
+        }
+    }
+}
+TEST(MipmapGeneratorTest, AlphaCoverageIsPreserved)
+{
+    const uint32_t size = 64;
+    std::vector<uint8_t> image(size * size * 4, 255);
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < size * size; ++i)
+    {
+        // 随机alpha，cutoff 0.8 下覆盖率约0.2，直接平均会向0.5收敛导致覆盖率丢失
+        seed = seed * 1664525u + 1013904223u;
+        image[i * 4 + 3] = static_cast<uint8_t>(seed >> 24);
+    }
+    auto coverageOf = [&](const std::vector<uint8_t> &chain, const MipLevelInfo &info) {
+        size_t covered = 0;
+        for (size_t i = 0; i < info.size; i += 4)
+        {
+            covered += chain[info.offset + i + 3] > 204 ? 1 : 0;
+        }
+        return static_cast<float>(covered) / static_cast<float>(info.size / 4);
+    };
+    auto setting = MipmapSetting{};
+    setting.isSRGB = false;
+    setting.alphaCutoff = 0.8f;
+    auto levels = MipmapGenerator::GetMipLevels(size, size, 0, 4);
+    auto plain = MipmapGenerator::GenerateRGBA8(image, size, size, setting);
+    setting.preserveAlphaCoverage = true;
+    auto preserved = MipmapGenerator::GenerateRGBA8(image, size, size, setting);
+    auto target = coverageOf(preserved, levels[0]);
+    // 只检查像素数足够的level
+    for (size_t level = 1; level < 4; ++level)
+    {
+        auto coverage = coverageOf(preserved, levels[level]);
+        GTEST_LOG_(INFO) << "Level " << level << " coverage: " << coverage << " (plain "
+                         << coverageOf(plain, levels[level]) << ", target " << target << ")";
+        EXPECT_NEAR(coverage, target, 0.03f);
+        EXPECT_LT(coverageOf(plain, levels[level]), coverage);
+    }
+}
+TEST(MipmapGeneratorTest, HDRFloatChain)
+{
+    const uint32_t width = 16;
+    const uint32_t height = 8;
+    std::vector<float> pixels(width * height * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        pixels[i + 0] = 10.0f;
+        pixels[i + 1] = 2.0f;
+        pixels[i + 2] = 0.5f;
+        pixels[i + 3] = 1.0f;
+    }
+    std::vector<uint8_t> image(pixels.size() * sizeof(float));
+    std::memcpy(image.data(), pixels.data(), image.size());
+    auto setting = MipmapSetting{};
+    setting.isSRGB = false;
+    auto result = MipmapGenerator::GenerateRGBA32F(image, width, height, setting);
+    ASSERT_EQ(result.size(), MipmapGenerator::GetMipChainSize(width, height, 0, 16));
+    std::vector<float> chain(result.size() / sizeof(float));
+    std::memcpy(chain.data(), result.data(), result.size());
+    for (size_t i = 0; i < chain.size(); i += 4)
+    {
+        EXPECT_NEAR(chain[i + 0], 10.0f, 1e-3f);
+        EXPECT_NEAR(chain[i + 1], 2.0f, 1e-3f);
+        EXPECT_NEAR(chain[i + 2], 0.5f, 1e-3f);
+    }
+}
+TEST(MipmapGeneratorTest, RunsOnExecutorWorkers)
+{
+    // 每个工作线程都在生成mip链，嵌套的taskflow必须协作执行而不是阻塞等待
+    auto &executor = MEngine::Core::Thread::TaskManager::GetExecutor();
+    std::vector<uint8_t> image(64 * 64 * 4, 128);
+    tf::Taskflow taskflow;
+    std::vector<size_t> sizes(executor.num_workers() * 2);
+    for (size_t i = 0; i < sizes.size(); ++i)
+    {
+        taskflow.emplace([&, i] { sizes[i] = MipmapGenerator::GenerateRGBA8(image, 64, 64, {}).size(); });
+    }
+    executor.run(taskflow).wait();
+    for (auto size : sizes)
+    {
+        EXPECT_EQ(size, MipmapGenerator::GetMipChainSize(64, 64, 0, 4));
+    }
+}
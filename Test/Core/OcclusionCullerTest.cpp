@@ -0,0 +1,126 @@
+#include "OcclusionCuller.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+// 相机在原点看向-Z
+glm::mat4 ViewProjection()
+{
+    auto projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    auto view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+// z平面上边长为size的正方形
+void AddQuad(OcclusionCuller &culler, float size, float z)
+{
+    auto half = size * 0.5f;
+    std::vector<glm::vec3> positions{{-half, -half, z}, {half, -half, z}, {half, half, z}, {-half, half, z}};
+    std::vector<uint32_t> indices{0, 1, 2, 0, 2, 3};
+    culler.AddOccluder(positions, indices, glm::mat4(1.0f));
+}
+OcclusionBounds Box(const glm::vec3 &center, float halfSize)
+{
+    return OcclusionBounds{center - glm::vec3(halfSize), center + glm::vec3(halfSize), glm::mat4(1.0f)};
+}
+} // namespace
+TEST(OcclusionCullerTest, RasterizeOccluderDepth)
+{
+    OcclusionCuller culler(64, 36);
+    EXPECT_EQ(culler.GetWidth() % OcclusionCuller::TileSize, 0u);
+    EXPECT_EQ(culler.GetHeight() % OcclusionCuller::TileSize, 0u);
+    culler.BeginFrame(ViewProjection());
+    AddQuad(culler, 2.0f, -5.0f);
+    culler.Rasterize();
+    auto &depth = culler.GetDepth();
+    auto center = static_cast<size_t>(culler.GetHeight() / 2) * culler.GetWidth() + culler.GetWidth() / 2;
+    auto expected = ViewProjection() * glm::vec4(0.0f, 0.0f, -5.0f, 1.0f);
+    EXPECT_NEAR(depth[center], expected.z / expected.w, 1e-4f);
+    // 四角没有被覆盖
+    EXPECT_EQ(depth[0], 1.0f);
+    EXPECT_EQ(depth.back(), 1.0f);
+    EXPECT_EQ(culler.GetStats().occluderTriangleCount, 2u);
+}
+TEST(OcclusionCullerTest, BoxesBehindOccluderAreCulled)
+{
+    OcclusionCuller culler(64, 36);
+    culler.BeginFrame(ViewProjection());
+    AddQuad(culler, 4.0f, -5.0f);
+    culler.Rasterize();
+    EXPECT_FALSE(culler.IsVisible(Box({0.0f, 0.0f, -10.0f}, 0.5f)));
+    EXPECT_TRUE(culler.IsVisible(Box({0.0f, 0.0f, -3.0f}, 0.5f)));
+    // 部分露出在遮挡体边缘之外
+    EXPECT_TRUE(culler.IsVisible(Box({4.0f, 0.0f, -10.0f}, 0.5f)));
+    // 与遮挡体相交
+    EXPECT_TRUE(culler.IsVisible(Box({0.0f, 0.0f, -5.0f}, 0.5f)));
+    // 跨越近平面
+    EXPECT_TRUE(culler.IsVisible(Box({0.0f, 0.0f, 0.0f}, 0.5f)));
+    // 在相机后方
+    EXPECT_TRUE(culler.IsVisible(Box({0.0f, 0.0f, 5.0f}, 0.5f)));
+}
+TEST(OcclusionCullerTest, OccluderCrossingNearPlaneIsIgnored)
+{
+    OcclusionCuller culler(64, 36);
+    culler.BeginFrame(ViewProjection());
+    std::vector<glm::vec3> positions{{-1.0f, -1.0f, 1.0f}, {1.0f, -1.0f, -5.0f}, {0.0f, 1.0f, -5.0f}};
+    std::vector<uint32_t> indices{0, 1, 2};
+    culler.AddOccluder(positions, indices, glm::mat4(1.0f));
+    culler.Rasterize();
+    EXPECT_EQ(culler.GetStats().occluderTriangleCount, 0u);
+    EXPECT_TRUE(culler.IsVisible(Box({0.0f, 0.0f, -10.0f}, 0.5f)));
+}
+TEST(OcclusionCullerTest, CulledPercentage)
+{
+    OcclusionCuller culler(64, 36);
+    culler.BeginFrame(ViewProjection());
+    AddQuad(culler, 4.0f, -5.0f);
+    culler.Rasterize();
+    std::vector<OcclusionBounds> bounds;
+    for (int i = 0; i < 3; ++i)
+    {
+        bounds.push_back(Box({0.0f, 0.0f, -8.0f - static_cast<float>(i)}, 0.3f));
+    }
+    bounds.push_back(Box({0.0f, 0.0f, -2.0f}, 0.3f));
+    std::vector<uint8_t> visible;
+    culler.TestVisibility(bounds, visible);
+    ASSERT_EQ(visible.size(), bounds.size());
+    EXPECT_EQ(visible, (std::vector<uint8_t>{0, 0, 0, 1}));
+    EXPECT_EQ(culler.GetStats().testedCount, 4u);
+    EXPECT_EQ(culler.GetStats().culledCount, 3u);
+    EXPECT_FLOAT_EQ(culler.GetStats().GetCulledPercentage(), 75.0f);
+    // 新的一帧清空遮挡体和统计
+    culler.BeginFrame(ViewProjection());
+    culler.Rasterize();
+    culler.TestVisibility(bounds, visible);
+    EXPECT_EQ(culler.GetStats().culledCount, 0u);
+}
+TEST(OcclusionCullerTest, AVX2MatchesScalar)
+{
+    if (!OcclusionCuller::IsAVX2Supported())
+    {
+        GTEST_SKIP() << "AVX2 is not supported";
+    }
+    // 多个重叠、倾斜并超出屏幕的遮挡体，覆盖未按8对齐的三角形边缘
+    auto rasterize = [](bool avx2) {
+        OcclusionCuller culler(100, 60);
+        culler.SetAVX2Enabled(avx2);
+        EXPECT_EQ(culler.IsAVX2Enabled(), avx2);
+        culler.BeginFrame(ViewProjection());
+        AddQuad(culler, 2.0f, -5.0f);
+        AddQuad(culler, 7.0f, -12.0f);
+        std::vector<glm::vec3> positions{{-3.1f, -1.7f, -4.0f}, {2.3f, -0.4f, -9.0f}, {0.2f, 2.9f, -6.5f}};
+        std::vector<uint32_t> indices{0, 1, 2};
+        culler.AddOccluder(positions, indices, glm::mat4(1.0f));
+        culler.Rasterize();
+        return culler.GetDepth();
+    };
+    auto scalar = rasterize(false);
+    auto avx2 = rasterize(true);
+    ASSERT_EQ(scalar.size(), avx2.size());
+    for (size_t i = 0; i < scalar.size(); ++i)
+    {
+        ASSERT_FLOAT_EQ(scalar[i], avx2[i]) << "pixel " << i;
+    }
+}
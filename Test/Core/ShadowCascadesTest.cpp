@@ -0,0 +1,101 @@
+#include "ShadowCascades.hpp"
+#include <gtest/gtest.h>
+
+using namespace MEngine::Core::Utils;
+
+namespace
+{
+constexpr float NearPlane = 0.1f;
+constexpr float FarPlane = 1000.0f;
+constexpr float ShadowDistance = 100.0f;
+constexpr uint32_t Resolution = 2048;
+const glm::vec3 LightDirection = glm::normalize(glm::vec3(0.3f, -1.0f, 0.2f));
+
+glm::mat4 Projection()
+{
+    return glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, NearPlane, FarPlane);
+}
+glm::mat4 View(const glm::vec3 &position, const glm::vec3 &forward)
+{
+    return glm::lookAt(position, position + forward, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+std::array<ShadowCascade, ShadowCascades::CascadeCount> Cascades(const glm::mat4 &view)
+{
+    return ShadowCascades::ComputeCascades(view, Projection(), NearPlane, FarPlane, ShadowDistance, LightDirection,
+                                           Resolution, 50.0f);
+}
+} // namespace
+TEST(ShadowCascadesTest, Splits)
+{
+    auto splits = ShadowCascades::ComputeSplits(NearPlane, ShadowDistance, ShadowCascades::SplitLambda);
+    EXPECT_FLOAT_EQ(splits.front(), NearPlane);
+    EXPECT_FLOAT_EQ(splits.back(), ShadowDistance);
+    for (uint32_t i = 1; i < splits.size(); ++i)
+    {
+        EXPECT_GT(splits[i], splits[i - 1]);
+    }
+    // lambda为0时均匀划分
+    auto uniformSplits = ShadowCascades::ComputeSplits(1.0f, 101.0f, 0.0f);
+    EXPECT_FLOAT_EQ(uniformSplits[1], 26.0f);
+}
+TEST(ShadowCascadesTest, CascadesCoverFrustumSlices)
+{
+    auto view = View(glm::vec3(3.0f, 2.0f, 5.0f), glm::normalize(glm::vec3(0.2f, -0.1f, -1.0f)));
+    auto cascades = Cascades(view);
+    auto inverseView = glm::inverse(view);
+    auto tanHalfFovY = std::tan(glm::radians(30.0f));
+    for (const auto &cascade : cascades)
+    {
+        // 切片的角点都在正交投影范围内
+        for (auto distance : {cascade.splitNear, cascade.splitFar})
+        {
+            auto halfHeight = distance * tanHalfFovY;
+            auto halfWidth = halfHeight * 16.0f / 9.0f;
+            for (auto sx : {-1.0f, 1.0f})
+            {
+                for (auto sy : {-1.0f, 1.0f})
+                {
+                    auto corner = inverseView * glm::vec4(sx * halfWidth, sy * halfHeight, -distance, 1.0f);
+                    auto clip = cascade.viewProjection * corner;
+                    EXPECT_LE(std::abs(clip.x), 1.0f + 1e-4f);
+                    EXPECT_LE(std::abs(clip.y), 1.0f + 1e-4f);
+                    EXPECT_GE(clip.z, -1e-4f);
+                    EXPECT_LE(clip.z, 1.0f + 1e-4f);
+                }
+            }
+        }
+        EXPECT_GT(cascade.texelWorldSize, 0.0f);
+    }
+    EXPECT_FLOAT_EQ(cascades.back().splitFar, ShadowDistance);
+}
+TEST(ShadowCascadesTest, SmallCameraMotionKeepsCascades)
+{
+    auto forward = glm::vec3(0.0f, 0.0f, -1.0f);
+    auto cascades = Cascades(View(glm::vec3(0.0f), forward));
+    // 移动远小于取整步长时矩阵不变，缓存的静态阴影可以复用
+    auto moved = Cascades(View(glm::vec3(0.01f, 0.0f, -0.01f), forward));
+    EXPECT_EQ(moved.back(), cascades.back());
+    // 移动超过最近一级的宽度时该级必须重绘
+    auto far = Cascades(View(glm::vec3(50.0f, 0.0f, 0.0f), forward));
+    EXPECT_NE(far.front().viewProjection, cascades.front().viewProjection);
+    // 旋转不改变级联大小
+    auto rotated = Cascades(View(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+    for (uint32_t i = 0; i < ShadowCascades::CascadeCount; ++i)
+    {
+        EXPECT_FLOAT_EQ(rotated[i].texelWorldSize, cascades[i].texelWorldSize);
+    }
+}
+TEST(ShadowCascadesTest, Intersects)
+{
+    auto cascades = Cascades(View(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f)));
+    auto &cascade = cascades.front();
+    auto boundsMin = glm::vec3(-0.5f);
+    auto boundsMax = glm::vec3(0.5f);
+    auto inside = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+    EXPECT_TRUE(ShadowCascades::Intersects(cascade.viewProjection, boundsMin, boundsMax, inside));
+    auto outside = glm::translate(glm::mat4(1.0f), glm::vec3(500.0f, 0.0f, 0.0f));
+    EXPECT_FALSE(ShadowCascades::Intersects(cascade.viewProjection, boundsMin, boundsMax, outside));
+    // 在级联和光源之间，仍然投射阴影
+    auto towardLight = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -1.0f) - LightDirection * 20.0f);
+    EXPECT_TRUE(ShadowCascades::Intersects(cascade.viewProjection, boundsMin, boundsMax, towardLight));
+}
@@ -0,0 +1,53 @@
+#include "EntityUtils.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace MEngine::Function::Utils;
+
+namespace
+{
+// z=0平面上的单位正方形，法线+Z
+const std::vector<Vertex> QuadVertices{{{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}},
+                                       {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}},
+                                       {{1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 1.0f}},
+                                       {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}}};
+const std::vector<uint32_t> QuadIndices{0, 1, 2, 0, 2, 3};
+} // namespace
+TEST(EntityUtilsTest, AppendStaticMeshTransformsToWorldSpace)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    auto first = EntityUtils::AppendStaticMesh(vertices, indices, QuadVertices, QuadIndices, glm::mat4(1.0f));
+    auto model = glm::translate(glm::mat4(1.0f), glm::vec3(5.0f, 0.0f, 0.0f)) *
+                 glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)) *
+                 glm::scale(glm::mat4(1.0f), glm::vec3(2.0f, 4.0f, 1.0f));
+    auto second = EntityUtils::AppendStaticMesh(vertices, indices, QuadVertices, QuadIndices, model);
+    ASSERT_EQ(vertices.size(), 8u);
+    ASSERT_EQ(indices.size(), 12u);
+    EXPECT_EQ(first.firstIndex, 0u);
+    EXPECT_EQ(first.indexCount, 6u);
+    EXPECT_EQ(second.firstIndex, 6u);
+    EXPECT_EQ(second.indexCount, 6u);
+    // 第二段的索引偏移到自己的顶点
+    EXPECT_EQ(indices[6], 4u);
+    EXPECT_EQ(indices[11], 7u);
+    // 绕X轴旋转90度后平面位于y=0，法线变为-Y且保持单位长度
+    EXPECT_NEAR(vertices[6].position.x, 7.0f, 1e-5f);
+    EXPECT_NEAR(vertices[6].position.z, 4.0f, 1e-5f);
+    EXPECT_NEAR(vertices[6].normal.y, -1.0f, 1e-5f);
+    EXPECT_NEAR(glm::length(vertices[6].normal), 1.0f, 1e-5f);
+    EXPECT_NEAR(second.boundsMin.x, 5.0f, 1e-5f);
+    EXPECT_NEAR(second.boundsMax.x, 7.0f, 1e-5f);
+    EXPECT_NEAR(second.boundsMax.z, 4.0f, 1e-5f);
+    EXPECT_NEAR(second.boundsMax.y - second.boundsMin.y, 0.0f, 1e-5f);
+}
+TEST(EntityUtilsTest, AppendStaticMeshKeepsWindingWhenMirrored)
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    auto mirror = glm::scale(glm::mat4(1.0f), glm::vec3(-1.0f, 1.0f, 1.0f));
+    EntityUtils::AppendStaticMesh(vertices, indices, QuadVertices, QuadIndices, mirror);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 2, 1, 0, 3, 2}));
+    EXPECT_NEAR(vertices[0].normal.z, 1.0f, 1e-5f);
+}
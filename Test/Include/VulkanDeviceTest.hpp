@@ -0,0 +1,43 @@
+#pragma once
+#include "VulkanContext.hpp"
+#include <functional>
+#include <gtest/gtest.h>
+#include <memory>
+
+namespace MEngine
+{
+/**
+ * @brief 需要Vulkan设备的测试基类
+ * 不创建surface和交换链，lavapipe等软件实现上也能运行
+ */
+class VulkanDeviceTest : public ::testing::Test
+{
+  protected:
+    std::shared_ptr<VulkanContext> mContext;
+
+    void SetUp() override
+    {
+        mContext = std::make_shared<VulkanContext>();
+        mContext->InitContext({});
+        mContext->Init();
+    }
+    // 在graphics队列上录制并提交一次，等待执行完成
+    void Submit(const std::function<void(vk::CommandBuffer)> &record)
+    {
+        vk::CommandBufferAllocateInfo allocateInfo;
+        allocateInfo.setCommandPool(mContext->GetGraphicsCommandPool())
+            .setLevel(vk::CommandBufferLevel::ePrimary)
+            .setCommandBufferCount(1);
+        auto commandBuffers = mContext->GetDevice().allocateCommandBuffersUnique(allocateInfo);
+        auto commandBuffer = commandBuffers[0].get();
+        commandBuffer.begin(vk::CommandBufferBeginInfo{vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        record(commandBuffer);
+        commandBuffer.end();
+        auto fence = mContext->GetDevice().createFenceUnique(vk::FenceCreateInfo{});
+        vk::SubmitInfo submitInfo;
+        submitInfo.setCommandBuffers(commandBuffer);
+        mContext->GetGraphicsQueue().submit(submitInfo, fence.get());
+        ASSERT_EQ(mContext->GetDevice().waitForFences(fence.get(), vk::True, UINT64_MAX), vk::Result::eSuccess);
+    }
+};
+} // namespace MEngine
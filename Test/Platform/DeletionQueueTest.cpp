@@ -0,0 +1,35 @@
+#include "DeletionQueue.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+using namespace MEngine;
+
+TEST(DeletionQueueTest, ReleasedAfterFramesInFlight)
+{
+    DeletionQueue queue;
+    std::vector<int> released;
+    queue.Push([&released]() { released.push_back(0); });
+    queue.BeginFrame(2);
+    queue.Push([&released]() { released.push_back(1); });
+    EXPECT_TRUE(released.empty());
+    queue.BeginFrame(2);
+    ASSERT_EQ(released.size(), 1u);
+    EXPECT_EQ(released[0], 0);
+    queue.BeginFrame(2);
+    ASSERT_EQ(released.size(), 2u);
+    EXPECT_EQ(released[1], 1);
+    EXPECT_EQ(queue.GetPendingCount(), 0u);
+}
+TEST(DeletionQueueTest, FlushReleasesNestedEntries)
+{
+    DeletionQueue queue;
+    int count = 0;
+    // 释放任务中再次Push的任务也应被Flush执行
+    queue.Push([&queue, &count, owned = std::make_unique<int>(1)]() {
+        count += *owned;
+        queue.Push([&count]() { count++; });
+    });
+    queue.Flush();
+    EXPECT_EQ(count, 2);
+    EXPECT_EQ(queue.GetPendingCount(), 0u);
+}
@@ -0,0 +1,115 @@
+#include "DescriptorAllocator.hpp"
+#include "VulkanDeviceTest.hpp"
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+using namespace MEngine;
+class DescriptorAllocatorTest : public VulkanDeviceTest
+{
+  protected:
+    static constexpr vk::DeviceSize UniformSize = 256;
+    static constexpr uint32_t UniformCount = 512;
+    std::shared_ptr<DescriptorAllocator> mAllocator;
+    vk::UniqueDescriptorSetLayout mLayout;
+    vk::Buffer mBuffer{};
+    VmaAllocation mAllocation{};
+    void SetUp() override
+    {
+        VulkanDeviceTest::SetUp();
+        mAllocator = std::make_shared<DescriptorAllocator>(mContext);
+        vk::DescriptorSetLayoutBinding binding{0, vk::DescriptorType::eUniformBuffer, 1,
+                                               vk::ShaderStageFlagBits::eAllGraphics};
+        vk::DescriptorSetLayoutCreateInfo layoutCreateInfo;
+        layoutCreateInfo.setBindings(binding);
+        mLayout = mContext->GetDevice().createDescriptorSetLayoutUnique(layoutCreateInfo);
+        vk::BufferCreateInfo bufferCreateInfo;
+        bufferCreateInfo.setSize(UniformSize * UniformCount).setUsage(vk::BufferUsageFlagBits::eUniformBuffer);
+        VmaAllocationCreateInfo allocationCreateInfo{};
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+        ASSERT_EQ(vmaCreateBuffer(mContext->GetVmaAllocator(), &static_cast<VkBufferCreateInfo &>(bufferCreateInfo),
+                                  &allocationCreateInfo, reinterpret_cast<VkBuffer *>(&mBuffer), &mAllocation,
+                                  nullptr),
+                  VK_SUCCESS);
+    }
+    void TearDown() override
+    {
+        mAllocator.reset();
+        if (mBuffer)
+        {
+            vmaDestroyBuffer(mContext->GetVmaAllocator(), mBuffer, mAllocation);
+        }
+    }
+    // 第index个uniform区间
+    std::vector<DescriptorWrite> MakeWrites(uint32_t index) const
+    {
+        DescriptorWrite write;
+        write.binding = 0;
+        write.type = vk::DescriptorType::eUniformBuffer;
+        write.bufferInfo = vk::DescriptorBufferInfo{mBuffer, UniformSize * index, UniformSize};
+        return {write};
+    }
+};
+
+TEST_F(DescriptorAllocatorTest, PersistentPoolChaining)
+{
+    std::vector<vk::UniqueDescriptorSet> descriptorSets;
+    for (uint32_t i = 0; i < DescriptorAllocator::SetsPerPool; ++i)
+    {
+        descriptorSets.push_back(mAllocator->Allocate(mLayout.get()));
+    }
+    EXPECT_EQ(mAllocator->GetStats().persistentPoolCount, 1u);
+    // 第一个池返回eErrorOutOfPoolMemory后追加新池
+    descriptorSets.push_back(mAllocator->Allocate(mLayout.get()));
+    EXPECT_EQ(mAllocator->GetStats().persistentPoolCount, 2u);
+    for (uint32_t i = 1; i < DescriptorAllocator::SetsPerPool; ++i)
+    {
+        descriptorSets.push_back(mAllocator->Allocate(mLayout.get()));
+    }
+    EXPECT_EQ(mAllocator->GetStats().persistentPoolCount, 2u);
+    // 两个池都满了，第一个池释放一个描述符集后应复用它而不是追加新池
+    descriptorSets.front().reset();
+    descriptorSets.push_back(mAllocator->Allocate(mLayout.get()));
+    EXPECT_EQ(mAllocator->GetStats().persistentPoolCount, 2u);
+    descriptorSets.push_back(mAllocator->Allocate(mLayout.get()));
+    EXPECT_EQ(mAllocator->GetStats().persistentPoolCount, 3u);
+    EXPECT_EQ(mAllocator->GetStats().persistentSetCount, 2ull * DescriptorAllocator::SetsPerPool + 2);
+}
+TEST_F(DescriptorAllocatorTest, TransientPoolsResetPerFrame)
+{
+    auto count = DescriptorAllocator::SetsPerPool + 1;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(i));
+    }
+    EXPECT_EQ(mAllocator->GetStats().transientSetCount, count);
+    EXPECT_EQ(mAllocator->GetStats().transientPoolCount, 2u);
+    // 另一帧使用自己的池
+    mAllocator->AllocateTransient(1, mLayout.get(), MakeWrites(0));
+    EXPECT_EQ(mAllocator->GetStats().transientPoolCount, 3u);
+    // 重置后复用已有的池，不再创建
+    mAllocator->ResetFrame(0);
+    EXPECT_EQ(mAllocator->GetStats().transientSetCount, 0u);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(i));
+    }
+    EXPECT_EQ(mAllocator->GetStats().transientSetCount, count);
+    EXPECT_EQ(mAllocator->GetStats().transientPoolCount, 3u);
+    EXPECT_EQ(mAllocator->GetStats().cacheHitCount, 0u);
+}
+TEST_F(DescriptorAllocatorTest, TransientCacheHits)
+{
+    auto first = mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(0));
+    auto second = mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(1));
+    EXPECT_NE(first, second);
+    EXPECT_EQ(mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(0)), first);
+    EXPECT_EQ(mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(1)), second);
+    EXPECT_EQ(mAllocator->GetStats().transientSetCount, 2u);
+    EXPECT_EQ(mAllocator->GetStats().cacheHitCount, 2u);
+    // 缓存只在本帧有效
+    EXPECT_NE(mAllocator->AllocateTransient(1, mLayout.get(), MakeWrites(0)), first);
+    mAllocator->ResetFrame(0);
+    mAllocator->AllocateTransient(0, mLayout.get(), MakeWrites(0));
+    EXPECT_EQ(mAllocator->GetStats().cacheHitCount, 0u);
+    EXPECT_EQ(mAllocator->GetStats().transientSetCount, 1u);
+}
@@ -0,0 +1,112 @@
+#include "RenderGraph.hpp"
+#include <gtest/gtest.h>
+#include <vector>
+using namespace MEngine;
+
+namespace
+{
+vk::Image FakeImage(uintptr_t handle)
+{
+    return vk::Image(reinterpret_cast<VkImage>(handle));
+}
+} // namespace
+TEST(RenderGraphTest, BarriersFollowDeclaredAccesses)
+{
+    RenderGraph graph(nullptr);
+    auto color = graph.ImportImage("Color", FakeImage(1), {}, vk::ImageAspectFlagBits::eColor,
+                                   vk::ImageLayout::eUndefined);
+    auto storage = graph.ImportImage("Storage", FakeImage(2), {}, vk::ImageAspectFlagBits::eColor,
+                                     vk::ImageLayout::eGeneral);
+    graph.AddPass("Scene",
+                  {{color, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal}},
+                  nullptr);
+    graph.AddPass("Blur",
+                  {{color, RenderGraphAccessType::SampledRead, vk::PipelineStageFlagBits::eComputeShader},
+                   {storage, RenderGraphAccessType::StorageWrite}},
+                  nullptr);
+    graph.AddPass("Composite",
+                  {{color, RenderGraphAccessType::SampledRead, vk::PipelineStageFlagBits::eComputeShader},
+                   {storage, RenderGraphAccessType::SampledRead}},
+                  nullptr);
+    graph.Compile();
+    // render pass已把color转换到eShaderReadOnlyOptimal，只需要让写入对compute可见
+    ASSERT_EQ(graph.GetBarriers(0).size(), 0u);
+    ASSERT_EQ(graph.GetBarriers(1).size(), 1u);
+    EXPECT_EQ(graph.GetBarriers(1)[0].image, FakeImage(1));
+    EXPECT_EQ(graph.GetBarriers(1)[0].oldLayout, vk::ImageLayout::eShaderReadOnlyOptimal);
+    EXPECT_EQ(graph.GetBarriers(1)[0].newLayout, vk::ImageLayout::eShaderReadOnlyOptimal);
+    EXPECT_EQ(graph.GetBarriers(1)[0].srcAccessMask, vk::AccessFlagBits::eColorAttachmentWrite);
+    // color已对compute可见，storage需要转换布局并等待写入
+    ASSERT_EQ(graph.GetBarriers(2).size(), 1u);
+    EXPECT_EQ(graph.GetBarriers(2)[0].image, FakeImage(2));
+    EXPECT_EQ(graph.GetBarriers(2)[0].oldLayout, vk::ImageLayout::eGeneral);
+    EXPECT_EQ(graph.GetBarriers(2)[0].newLayout, vk::ImageLayout::eShaderReadOnlyOptimal);
+    EXPECT_EQ(graph.GetStats().barrierCount, 2u);
+    EXPECT_EQ(graph.GetStats().barrierBatchCount, 2u);
+}
+TEST(RenderGraphTest, ExportLayout)
+{
+    RenderGraph graph(nullptr);
+    auto color = graph.ImportImage("Color", FakeImage(1), {}, vk::ImageAspectFlagBits::eColor,
+                                   vk::ImageLayout::eUndefined);
+    graph.AddPass("Scene", {{color, RenderGraphAccessType::ColorAttachment}}, nullptr);
+    graph.ExportImage(color, vk::ImageLayout::eShaderReadOnlyOptimal);
+    graph.Compile();
+    EXPECT_EQ(graph.GetStats().barrierCount, 1u);
+
+    // render pass的finalLayout已满足导出布局时不需要barrier
+    graph.Reset();
+    color = graph.ImportImage("Color", FakeImage(1), {}, vk::ImageAspectFlagBits::eColor,
+                              vk::ImageLayout::eUndefined);
+    graph.AddPass("Scene",
+                  {{color, RenderGraphAccessType::ColorAttachment, {}, vk::ImageLayout::eShaderReadOnlyOptimal}},
+                  nullptr);
+    graph.ExportImage(color, vk::ImageLayout::eShaderReadOnlyOptimal);
+    graph.Compile();
+    EXPECT_EQ(graph.GetStats().barrierCount, 0u);
+}
+TEST(RenderGraphTest, ImportedPendingStages)
+{
+    RenderGraph graph(nullptr);
+    // 上一帧在fragment shader中采样，本帧作为attachment重绘
+    auto shadow =
+        graph.ImportImage("Shadow", FakeImage(1), {}, vk::ImageAspectFlagBits::eDepth,
+                          vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader);
+    graph.AddPass("Shadow", {{shadow, RenderGraphAccessType::DepthStencilAttachment}}, nullptr);
+    graph.AddPass("Scene", {{shadow, RenderGraphAccessType::SampledRead}}, nullptr);
+    graph.Compile();
+    ASSERT_EQ(graph.GetBarriers(0).size(), 1u);
+    EXPECT_EQ(graph.GetBarriers(0)[0].oldLayout, vk::ImageLayout::eShaderReadOnlyOptimal);
+    EXPECT_EQ(graph.GetBarriers(0)[0].newLayout, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    EXPECT_EQ(graph.GetBarriers(1).size(), 1u);
+
+    // 没有跨帧访问时第一次写入不需要等待
+    graph.Reset();
+    shadow = graph.ImportImage("Shadow", FakeImage(1), {}, vk::ImageAspectFlagBits::eDepth,
+                               vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    graph.AddPass("Shadow", {{shadow, RenderGraphAccessType::DepthStencilAttachment}}, nullptr);
+    graph.Compile();
+    EXPECT_EQ(graph.GetBarriers(0).size(), 0u);
+}
+TEST(RenderGraphTest, AliasingByLifetime)
+{
+    std::vector<RenderGraphAliasRequest> requests{
+        {1024, 256, 0b11, 0, 1}, // A
+        {512, 256, 0b01, 2, 3},  // B: 与A不重叠
+        {2048, 256, 0b11, 1, 2}, // C: 与A、B都重叠
+        {256, 256, 0b10, 2, 2},  // D: 与A不重叠，但内存类型不兼容
+    };
+    auto plan = RenderGraph::PlanAliasing(requests);
+    ASSERT_EQ(plan.blockOfRequest.size(), requests.size());
+    EXPECT_EQ(plan.blockOfRequest[0], plan.blockOfRequest[1]);
+    EXPECT_NE(plan.blockOfRequest[0], plan.blockOfRequest[2]);
+    EXPECT_NE(plan.blockOfRequest[2], plan.blockOfRequest[1]);
+    EXPECT_NE(plan.blockOfRequest[3], plan.blockOfRequest[0]);
+    vk::DeviceSize total = 0;
+    for (auto size : plan.blockSizes)
+    {
+        total += size;
+    }
+    EXPECT_EQ(plan.blockSizes[plan.blockOfRequest[0]], 1024u);
+    EXPECT_LT(total, 1024u + 512u + 2048u + 256u);
+}
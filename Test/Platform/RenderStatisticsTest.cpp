@@ -0,0 +1,80 @@
+#include "RenderStatistics.hpp"
+#include <gtest/gtest.h>
+using namespace MEngine;
+
+TEST(RenderStatisticsTest, CountsPerPass)
+{
+    RenderStatistics statistics(nullptr, 2);
+    statistics.BeginFrame(nullptr, 0);
+    {
+        RenderStatisticsScope scene(&statistics, nullptr, "Scene");
+        statistics.BindPipeline();
+        statistics.BindDescriptorSets();
+        statistics.BindBuffers(2);
+        statistics.Draw(36);
+        statistics.Draw(6, 4);
+        {
+            // 计数只记在最内层的pass
+            RenderStatisticsScope sky(&statistics, nullptr, "Sky");
+            statistics.Draw(3);
+        }
+    }
+    {
+        RenderStatisticsScope hiZ(&statistics, nullptr, "Hi-Z Build");
+        statistics.Dispatch();
+        statistics.Dispatch();
+    }
+    statistics.Draw(3);
+    statistics.AddSubmittedObjects(10);
+    statistics.AddCulledObjects(4);
+    statistics.AddUploadedBytes(256);
+    statistics.EndFrame();
+
+    auto &frame = statistics.GetLastFrame();
+    ASSERT_EQ(frame.passes.size(), 4u);
+    EXPECT_EQ(frame.passes[0].name, "Scene");
+    EXPECT_EQ(frame.passes[0].depth, 0u);
+    EXPECT_EQ(frame.passes[0].drawCalls, 2u);
+    EXPECT_EQ(frame.passes[0].instances, 5u);
+    EXPECT_EQ(frame.passes[0].triangles, 20u);
+    EXPECT_EQ(frame.passes[0].pipelineBinds, 1u);
+    EXPECT_EQ(frame.passes[0].descriptorBinds, 1u);
+    EXPECT_EQ(frame.passes[0].bufferBinds, 2u);
+    EXPECT_EQ(frame.passes[1].name, "Sky");
+    EXPECT_EQ(frame.passes[1].depth, 1u);
+    EXPECT_EQ(frame.passes[1].drawCalls, 1u);
+    EXPECT_EQ(frame.passes[2].dispatches, 2u);
+    EXPECT_EQ(frame.passes[3].name, RenderStatistics::UnscopedPassName);
+    EXPECT_EQ(frame.passes[3].drawCalls, 1u);
+    auto total = frame.GetTotal();
+    EXPECT_EQ(total.drawCalls, 4u);
+    EXPECT_EQ(total.triangles, 22u);
+    EXPECT_EQ(frame.submittedObjects, 10u);
+    EXPECT_EQ(frame.culledObjects, 4u);
+    EXPECT_EQ(frame.uploadedBytes, 256u);
+    EXPECT_FALSE(frame.hasPipelineStatistics);
+}
+TEST(RenderStatisticsTest, MergesPassesWithSameName)
+{
+    RenderStatistics statistics(nullptr, 1);
+    statistics.BeginFrame(nullptr, 0);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        RenderStatisticsScope shadow(&statistics, nullptr, "Shadow");
+        statistics.Draw(3);
+    }
+    statistics.EndFrame();
+    ASSERT_EQ(statistics.GetLastFrame().passes.size(), 1u);
+    EXPECT_EQ(statistics.GetLastFrame().passes[0].drawCalls, 3u);
+    // 新的一帧从零开始计数
+    statistics.BeginFrame(nullptr, 0);
+    statistics.EndFrame();
+    EXPECT_TRUE(statistics.GetLastFrame().passes.empty());
+}
+TEST(RenderStatisticsTest, PipelineStatisticsRequireDevice)
+{
+    RenderStatistics statistics(nullptr, 1);
+    statistics.SetPipelineStatisticsEnabled(true);
+    EXPECT_FALSE(statistics.IsPipelineStatisticsSupported());
+    EXPECT_FALSE(statistics.IsPipelineStatisticsEnabled());
+}
@@ -0,0 +1,73 @@
+#include "UniformArena.hpp"
+#include "VulkanDeviceTest.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+using namespace MEngine;
+class UniformArenaTest : public VulkanDeviceTest
+{
+  protected:
+    static constexpr uint32_t FrameCount = 2;
+    vk::DeviceSize mAlignment{0};
+    void SetUp() override
+    {
+        VulkanDeviceTest::SetUp();
+        auto limits = mContext->GetPhysicalDevice().getProperties().limits;
+        mAlignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    }
+};
+
+TEST_F(UniformArenaTest, AllocationsAreAligned)
+{
+    UniformArena arena(mContext, FrameCount, 4096);
+    EXPECT_EQ(arena.GetBytesPerFrame() % mAlignment, 0u);
+    arena.Reset(0);
+    auto first = arena.Allocate(1);
+    auto second = arena.Allocate(3);
+    auto third = arena.Push(uint64_t{42});
+    EXPECT_EQ(first.offset, 0u);
+    EXPECT_EQ(second.offset, mAlignment);
+    EXPECT_EQ(third.offset, 2 * mAlignment);
+    EXPECT_EQ(third.size, sizeof(uint64_t));
+    EXPECT_EQ(*static_cast<uint64_t *>(third.data), 42u);
+    EXPECT_EQ(third.buffer, arena.GetBuffer());
+    EXPECT_EQ(arena.GetUsedBytes(), 2 * mAlignment + sizeof(uint64_t));
+}
+TEST_F(UniformArenaTest, FramesUseSeparateSegments)
+{
+    UniformArena arena(mContext, FrameCount, 1000);
+    auto bytesPerFrame = arena.GetBytesPerFrame();
+    // 每段大小向上取整到对齐
+    EXPECT_GE(bytesPerFrame, 1000u);
+    EXPECT_LT(bytesPerFrame, 1000u + mAlignment);
+    for (uint32_t frame = 0; frame < 2 * FrameCount; ++frame)
+    {
+        arena.Reset(frame);
+        EXPECT_EQ(arena.GetUsedBytes(), 0u);
+        auto allocation = arena.Allocate(16);
+        auto segment = (frame % FrameCount) * bytesPerFrame;
+        EXPECT_EQ(allocation.offset, segment);
+        EXPECT_EQ(arena.Allocate(16).offset, segment + mAlignment);
+    }
+    // 不同帧的映射地址互不重叠
+    arena.Reset(0);
+    auto frame0 = static_cast<uint8_t *>(arena.Allocate(16).data);
+    arena.Reset(1);
+    auto frame1 = static_cast<uint8_t *>(arena.Allocate(16).data);
+    EXPECT_EQ(frame1 - frame0, static_cast<std::ptrdiff_t>(bytesPerFrame));
+}
+TEST_F(UniformArenaTest, ThrowsWhenFrameSegmentIsFull)
+{
+    UniformArena arena(mContext, FrameCount, 1024);
+    arena.Reset(0);
+    EXPECT_NO_THROW(arena.Allocate(arena.GetBytesPerFrame()));
+    EXPECT_THROW(arena.Allocate(1), std::runtime_error);
+    // 超出一帧的分配即使在空段中也失败，不会写入下一帧的段
+    arena.Reset(1);
+    EXPECT_THROW(arena.Allocate(arena.GetBytesPerFrame() + 1), std::runtime_error);
+    EXPECT_EQ(arena.GetUsedBytes(), 0u);
+    EXPECT_NO_THROW(arena.Allocate(1));
+}
@@ -1,3 +1,4 @@
+#include "DynamicResolution.hpp"
 #include "MEngineEditor.hpp"
 #include <nlohmann/adl_serializer.hpp>
 #include <nlohmann/json.hpp>
@@ -14,6 +15,7 @@ template <> struct adl_serializer<WindowConfig>
         j["WindowConfig"]["Resizable"] = config.resizable;
         j["WindowConfig"]["Fullscreen"] = config.fullscreen;
         j["WindowConfig"]["VSync"] = config.vsync;
+        j["WindowConfig"]["FramesInFlight"] = config.framesInFlight;
     }
 
     static void from_json(const json &j, WindowConfig &config)
@@ -24,6 +26,36 @@ template <> struct adl_serializer<WindowConfig>
         config.fullscreen = j["WindowConfig"].value("Fullscreen", false);
         config.resizable = j["WindowConfig"].value("Resizable", true);
         config.vsync = j["WindowConfig"].value("VSync", true);
+        config.framesInFlight = j["WindowConfig"].value("FramesInFlight", 2u);
+    }
+};
+template <> struct adl_serializer<MEngine::Core::Utils::DynamicResolutionSetting>
+{
+    static void to_json(json &j, const MEngine::Core::Utils::DynamicResolutionSetting &setting)
+    {
+        j["DynamicResolution"]["Enabled"] = setting.enabled;
+        j["DynamicResolution"]["TargetFrameMs"] = setting.targetFrameMs;
+        j["DynamicResolution"]["MinScale"] = setting.minScale;
+        j["DynamicResolution"]["MaxScale"] = setting.maxScale;
+        j["DynamicResolution"]["ScaleStep"] = setting.scaleStep;
+        j["DynamicResolution"]["Headroom"] = setting.headroom;
+        j["DynamicResolution"]["IncreaseDelayFrames"] = setting.increaseDelayFrames;
+        j["DynamicResolution"]["Smoothing"] = setting.smoothing;
+    }
+
+    static void from_json(const json &j, MEngine::Core::Utils::DynamicResolutionSetting &setting)
+    {
+        // 缺少该节时使用默认值(关闭)
+        auto defaults = MEngine::Core::Utils::DynamicResolutionSetting{};
+        auto config = j.value("DynamicResolution", json::object());
+        setting.enabled = config.value("Enabled", defaults.enabled);
+        setting.targetFrameMs = config.value("TargetFrameMs", defaults.targetFrameMs);
+        setting.minScale = config.value("MinScale", defaults.minScale);
+        setting.maxScale = config.value("MaxScale", defaults.maxScale);
+        setting.scaleStep = config.value("ScaleStep", defaults.scaleStep);
+        setting.headroom = config.value("Headroom", defaults.headroom);
+        setting.increaseDelayFrames = config.value("IncreaseDelayFrames", defaults.increaseDelayFrames);
+        setting.smoothing = config.value("Smoothing", defaults.smoothing);
     }
 };
 } // namespace nlohmann
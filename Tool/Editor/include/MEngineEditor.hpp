@@ -1,5 +1,6 @@
 #pragma once
 #include "AssetDatabase.hpp"
+#include "EntityUtils.hpp"
 #include "MAsset.hpp"
 #include "MFolder.hpp"
 #include "MTexture.hpp"
@@ -11,6 +12,7 @@
 #include <vector>
 #define GLFW_INCLUDE_VULKAN
 #include "MRenderSystem.hpp"
+#include "Metrics.hpp"
 #include "Reflect.hpp"
 #include <GLFW/glfw3.h>
 #include <entt/entt.hpp>
@@ -34,6 +36,12 @@ struct WindowConfig
     bool fullscreen = false;
     bool resizable = true;
     bool vsync = true;
+    uint32_t framesInFlight = 2;
+};
+struct FramePacingStats
+{
+    float fenceWaitMs = 0.0f; // CPU阻塞在帧fence上的时间，接近0说明CPU与GPU并行
+    float cpuFrameMs = 0.0f;  // 一帧的CPU时间(不含fence等待)
 };
 struct Resolution
 {
@@ -73,6 +81,9 @@ class MEngineEditor
     std::vector<Resolution> mResolutions = {{100, 100},   {800, 600},   {1280, 720}, {1920, 1080},
                                             {2560, 1440}, {3840, 2160}, {5120, 2880}};
     Resolution mCurrentResolution = {1280, 720};
+    bool mFitViewport = true; // 渲染分辨率跟随Viewport面板大小
+    uint64_t mViewPortVersion = 0;
+    float mViewPortAspect = 0.0f;
 
     // UI
     std::unordered_map<MAssetType, std::shared_ptr<MTexture>> mAssetIconTextures;
@@ -84,6 +95,9 @@ class MEngineEditor
     ImGuizmo::OPERATION mGuizmoOperation = ImGuizmo::TRANSLATE;
     ImGuizmo::MODE mGuizmoMode = ImGuizmo::LOCAL;
     entt::entity mEditorCameraEntity = entt::null; // 编辑器相机实体
+    bool mStaticBatchingEnabled = false; // 开启时合并isStatic的实体，关闭后恢复独立绘制
+    Function::Utils::StaticBatchStats mStaticBatchStats{};
+    bool mRenderStatisticsOverlay = true; // 在Viewport左上角显示本帧的渲染计数
     enum class InspectorTab
     {
         None = 0,
@@ -109,7 +123,9 @@ class MEngineEditor
     void InitDataBase();
     void InitEditorCamera();
     void InitSystem();
+    void InitMetrics();
     void SetViewPort();
+    void UpdateCameraAspect();
     void HandleSwapchainOutOfDate();
     void UI();
     void RenderToolbarPanel();
@@ -117,15 +133,25 @@ class MEngineEditor
     void RenderHierarchyPanel();
     void RenderInspectorPanel();
     void RenderAssetPanel();
+    void RenderProfilerPanel();
+    void RenderGpuProfilerTab();
+    void RenderCpuProfilerTab();
+    void RenderStatisticsTab();
+    void RenderStatisticsOverlay(ImVec2 position);
 
     void SetGLFWCallBacks();
-    uint32_t mFrameCount = 2;
+    uint32_t mFrameCount = 2; // frames in flight
     uint32_t mCurrentFrameIndex = 0;
+    FramePacingStats mFramePacingStats{};
+    // 相邻两帧开始的间隔，超过MetricsSetting::hitchThresholdMs记为卡顿
+    static constexpr const char *FrameTimeMetric = "frame.time_ms";
+    std::unique_ptr<MetricsReporter> mMetricsReporter;
     std::vector<VkDescriptorSet> mViewPortDescriptorSets{};
     std::vector<vk::UniqueFramebuffer> mUIFramebuffers;
     std::vector<vk::UniqueCommandBuffer> mUICmdBuffers;
     std::vector<vk::UniqueFence> mInFlightFences;
     std::vector<vk::UniqueSemaphore> mImageAvailableSemaphores;
+    // present等待的semaphore按swapchain image索引
     std::vector<vk::UniqueSemaphore> mRenderFinishedSemaphores;
 
     void CreateCommandBuffers();
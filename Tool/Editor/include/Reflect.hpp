@@ -233,6 +233,11 @@ static void RegisterComponent()
         .custom<Info>(Info{
             .DisplayName = "worldScale",
             .Editable = false,
+        })
+        .data<&MTransformComponent::isStatic>("isStatic"_hs)
+        .custom<Info>(Info{
+            .DisplayName = "Static",
+            .Editable = true,
         });
     entt::meta_factory<MCameraComponent>()
         .type("CameraComponent"_hs)
@@ -287,6 +292,12 @@ static void RegisterComponent()
             .DisplayName = "Mesh",
             .Editable = true,
             .Serializable = true,
+        })
+        .data<&MMeshComponent::isOccluder>("isOccluder"_hs)
+        .custom<Info>(Info{
+            .DisplayName = "Occluder",
+            .Editable = true,
+            .Serializable = true,
         });
     entt::meta_factory<MMaterialComponent>()
         .type("MMaterialComponent"_hs)
@@ -119,6 +119,8 @@ template <> struct adl_serializer<MTextureSetting>
         j = static_cast<const MAssetSetting &>(setting);
         // 序列化基础属性
         j["mipmapLevels"] = setting.mipmapLevels;
+        j["isMipmapBaked"] = setting.isMipmapBaked;
+        j["isStreamable"] = setting.isStreamable;
         j["arrayLayers"] = setting.arrayLayers;
         j["sampleCount"] = magic_enum::enum_name(setting.sampleCount);
 
@@ -156,6 +158,8 @@ template <> struct adl_serializer<MTextureSetting>
         j.get_to<MAssetSetting>(setting);
         // 反序列化基础属性
         setting.mipmapLevels = j["mipmapLevels"].get<uint32_t>();
+        setting.isMipmapBaked = j.value("isMipmapBaked", false);
+        setting.isStreamable = j.value("isStreamable", false);
         setting.arrayLayers = j["arrayLayers"].get<uint32_t>();
         auto sampleCountStr = j["sampleCount"].get<std::string>();
         setting.sampleCount =
@@ -205,7 +209,12 @@ template <> struct adl_serializer<MPipelineSetting>
         j = static_cast<const MAssetSetting &>(setting);
         j["VertexShaderPath"] = setting.VertexShaderPath.string();
         j["FragmentShaderPath"] = setting.FragmentShaderPath.string();
+        j["ComputeShaderPath"] = setting.ComputeShaderPath.string();
+        j["PushConstantSize"] = setting.PushConstantSize;
         j["RenderPassType"] = magic_enum::enum_name(setting.RenderPassType);
+        j["Bindless"] = setting.Bindless;
+        j["PositionOnly"] = setting.PositionOnly;
+        j["DepthEqualVariant"] = setting.DepthEqualVariant;
         // 光栅化状态
         j["DepthClampEnable"] = setting.DepthClampEnable;
         j["RasterizerDiscardEnable"] = setting.RasterizerDiscardEnable;
@@ -213,6 +222,8 @@ template <> struct adl_serializer<MPipelineSetting>
         j["CullMode"] = magic_enum::enum_name(setting.CullMode);
         j["FrontFace"] = magic_enum::enum_name(setting.FrontFace);
         j["DepthBiasEnable"] = setting.DepthBiasEnable;
+        j["DepthBiasConstantFactor"] = setting.DepthBiasConstantFactor;
+        j["DepthBiasSlopeFactor"] = setting.DepthBiasSlopeFactor;
         j["LineWidth"] = setting.LineWidth;
         // 多重采样
         j["MultisamplingEnable"] = setting.MultisamplingEnable;
@@ -238,9 +249,14 @@ template <> struct adl_serializer<MPipelineSetting>
         j.get_to<MAssetSetting>(setting);
         setting.VertexShaderPath = j["VertexShaderPath"].get<std::filesystem::path>();
         setting.FragmentShaderPath = j["FragmentShaderPath"].get<std::filesystem::path>();
+        setting.ComputeShaderPath = j.value("ComputeShaderPath", std::string{});
+        setting.PushConstantSize = j.value("PushConstantSize", 0u);
         auto renderPassTypeStr = j["RenderPassType"].get<std::string>();
         setting.RenderPassType =
             magic_enum::enum_cast<RenderPassType>(renderPassTypeStr).value_or(RenderPassType::ForwardComposition);
+        setting.Bindless = j.value("Bindless", false);
+        setting.PositionOnly = j.value("PositionOnly", false);
+        setting.DepthEqualVariant = j.value("DepthEqualVariant", false);
         // 光栅化状态
         setting.DepthClampEnable = j["DepthClampEnable"].get<bool>();
         setting.RasterizerDiscardEnable = j["RasterizerDiscardEnable"].get<bool>();
@@ -253,6 +269,8 @@ template <> struct adl_serializer<MPipelineSetting>
         setting.FrontFace =
             magic_enum::enum_cast<vk::FrontFace>(j["FrontFace"].get<std::string>()).value_or(vk::FrontFace::eClockwise);
         setting.DepthBiasEnable = j["DepthBiasEnable"].get<bool>();
+        setting.DepthBiasConstantFactor = j.value("DepthBiasConstantFactor", 0.0f);
+        setting.DepthBiasSlopeFactor = j.value("DepthBiasSlopeFactor", 0.0f);
         // 多重采样
         setting.MultisamplingEnable = j["MultisamplingEnable"].get<bool>();
         auto sampleCountStr = j["SampleCount"].get<std::string>();
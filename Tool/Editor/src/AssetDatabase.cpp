@@ -8,6 +8,7 @@
 #include "MPBRMaterial.hpp"
 #include "MPipeline.hpp"
 #include "MTexture.hpp"
+#include "MipmapGenerator.hpp"
 #include "Reflect.hpp"
 #include "Vertex.hpp"
 #include <MModel.hpp>
@@ -371,9 +372,19 @@ std::shared_ptr<MTexture> AssetDatabase::LoadPNG(const std::filesystem::path &pa
     auto &&[width, height, channels, imageData] = MEngine::Core::Utils::ImageUtil::LoadImage(path);
     auto textureSetting = MTextureSetting{};
     textureSetting.isShaderResource = true;
+    // 导入时在CPU上烘焙mip链，运行时加载不再生成
+    textureSetting.mipmapLevels = MEngine::Core::Utils::MipmapGenerator::GetMipLevelCount(
+        static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    textureSetting.maxLod = static_cast<float>(textureSetting.mipmapLevels);
+    textureSetting.isMipmapBaked = true;
+    textureSetting.isStreamable = true;
+    auto mipmapSetting = MEngine::Core::Utils::MipmapSetting{};
+    mipmapSetting.isSRGB = textureSetting.format == vk::Format::eR8G8B8A8Srgb;
+    auto mipmapData = MEngine::Core::Utils::MipmapGenerator::GenerateRGBA8(
+        imageData, static_cast<uint32_t>(width), static_cast<uint32_t>(height), mipmapSetting);
     auto texture = textureManager->Create(
         fileName, {static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(channels)},
-        imageData, textureSetting);
+        mipmapData, textureSetting);
     textureManager->CreateVulkanResources(texture);
     textureManager->Write(texture);
     return texture;
@@ -1,6 +1,9 @@
 #include "MEngineEditor.hpp"
 #include "AssetDatabase.hpp"
+#include "BindlessManager.hpp"
 #include "Configure.hpp"
+#include "CpuProfiler.hpp"
+#include "DescriptorAllocator.hpp"
 #include "EditorSerialize.hpp"
 #include "IMMeshManager.hpp"
 #include "IMModelManager.hpp"
@@ -33,12 +36,15 @@
 #include "Math.hpp"
 #include "RenderPassManager.hpp"
 #include "ResourceManager.hpp"
+#include "Spdlogger.hpp"
 #include "TaskManager.hpp"
 #include "UUIDGenerator.hpp"
 #include "VulkanContext.hpp"
 #include <GLFW/glfw3.h>
 #include <ImGuizmo.h>
+#include <algorithm>
 #include <boost/di.hpp>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <entt/entity/entity.hpp>
@@ -76,6 +82,8 @@ auto injector = DI::make_injector(
     DI::bind<IMMeshManager>().to<MMeshManager>().in(DI::singleton),
     DI::bind<IMPBRMaterialManager>().to<MPBRMaterialManager>().in(DI::singleton),
     DI::bind<RenderPassManager>().to<RenderPassManager>().in(DI::singleton),
+    DI::bind<BindlessManager>().to<BindlessManager>().in(DI::singleton),
+    DI::bind<DescriptorAllocator>().to<DescriptorAllocator>().in(DI::singleton),
     DI::bind<IUUIDGenerator>().to<UUIDGenerator>().in(DI::singleton),
     DI::bind<entt::registry>().to<entt::registry>().in(DI::singleton),
     DI::bind<MRenderSystem>().to<MRenderSystem>().in(DI::singleton),
@@ -93,6 +101,7 @@ void MEngineEditor::Init()
     RegisterMeta();
     InitEditorCamera();
     InitSystem();
+    InitMetrics();
     mIsRunning = true;
     auto modelManager = injector.create<std::shared_ptr<IMModelManager>>();
     auto materialManager = injector.create<std::shared_ptr<IMPBRMaterialManager>>();
@@ -176,7 +185,9 @@ void MEngineEditor::InitVulkan()
     glfwCreateWindowSurface(context->GetInstance(), mWindow, nullptr, &surface);
     context->InitSurface(surface);
     context->Init();
-    mFrameCount = context->GetSurfaceInfo().imageCount;
+    // in-flight帧数与swapchain image数无关，多于image数没有意义
+    mFrameCount = std::clamp(mWindowConfig.framesInFlight, 1u, context->GetSurfaceInfo().imageCount);
+    LogInfo("Frames in flight: {}", mFrameCount);
     LogDebug("Vulkan context initialized successfully");
 }
 void MEngineEditor::InitImGui()
@@ -206,7 +217,7 @@ void MEngineEditor::InitImGui()
     initInfo.Queue = vulkanContext->GetGraphicsQueue();
     initInfo.RenderPass = mUIRenderPass.get();
     initInfo.MinImageCount = 2;
-    initInfo.ImageCount = mFrameCount;
+    initInfo.ImageCount = vulkanContext->GetSurfaceInfo().imageCount;
     initInfo.DescriptorPoolSize = 1000;
     if (!ImGui_ImplVulkan_Init(&initInfo))
     {
@@ -284,13 +295,30 @@ void MEngineEditor::InitSystem()
     mRenderSystem->SetFrameCount(mFrameCount);
     mRenderSystem->SetExtent(800, 600);
     mRenderSystem->Init();
+    auto configure = injector.create<std::shared_ptr<IConfigure>>();
+    mRenderSystem->SetDynamicResolutionSetting(
+        configure->GetJson().get<MEngine::Core::Utils::DynamicResolutionSetting>());
     SetViewPort();
 }
+void MEngineEditor::InitMetrics()
+{
+    auto configure = injector.create<std::shared_ptr<IConfigure>>();
+    auto setting = configure->GetJson().get<MetricsSetting>();
+    Metrics::GetHistogram(FrameTimeMetric, 0.001);
+    Metrics::GetHistogram(MRenderSystem::GpuFrameMetric, 0.001);
+    Metrics::SetHitchThreshold(FrameTimeMetric, setting.hitchThresholdMs);
+    Metrics::SetHitchThreshold(MRenderSystem::GpuFrameMetric, setting.hitchThresholdMs);
+    // 与spdlog的日志文件放在同一目录
+    auto logFilePath = std::filesystem::path(configure->GetJson().get<LoggerConfig>().logFilePath);
+    mMetricsReporter = std::make_unique<MetricsReporter>(setting, logFilePath.parent_path());
+}
 void MEngineEditor::SetViewPort()
 {
+    // in-flight的UI命令可能还在使用旧的描述符集
+    auto &deletionQueue = injector.create<std::shared_ptr<VulkanContext>>()->GetDeletionQueue();
     for (auto &viewPortDescriptorSet : mViewPortDescriptorSets)
     {
-        ImGui_ImplVulkan_RemoveTexture(viewPortDescriptorSet);
+        deletionQueue.Push([viewPortDescriptorSet]() { ImGui_ImplVulkan_RemoveTexture(viewPortDescriptorSet); });
     }
     mViewPortDescriptorSets.clear();
     mViewPortDescriptorSets.resize(mFrameCount);
@@ -301,7 +329,19 @@ void MEngineEditor::SetViewPort()
             renderTarget.colorTexture->GetSampler(), renderTarget.colorTexture->GetImageView(),
             static_cast<VkImageLayout>(vk::ImageLayout::eShaderReadOnlyOptimal));
     }
-
+    mViewPortVersion = mRenderSystem->GetRenderTargetVersion();
+    UpdateCameraAspect();
+}
+void MEngineEditor::UpdateCameraAspect()
+{
+    // 动态分辨率缩放后的尺寸有取整误差，按缩放前的尺寸计算
+    auto extent = mRenderSystem->GetOutputExtent();
+    auto aspect = static_cast<float>(extent.width) / static_cast<float>(extent.height);
+    if (aspect == mViewPortAspect)
+    {
+        return;
+    }
+    mViewPortAspect = aspect;
     auto registry = injector.create<std::shared_ptr<entt::registry>>();
     auto view = registry->view<MCameraComponent>();
     for (auto entity : view)
@@ -309,7 +349,7 @@ void MEngineEditor::SetViewPort()
         auto &cameraComponent = registry->get<MCameraComponent>(entity);
         if (cameraComponent.isMainCamera)
         {
-            cameraComponent.aspectRatio = static_cast<float>(mCurrentResolution.width) / mCurrentResolution.height;
+            cameraComponent.aspectRatio = aspect;
             cameraComponent.dirty = true;
             break;
         }
@@ -334,17 +374,36 @@ void MEngineEditor::Run(float deltaTime)
     // });
     auto &executor = Thread::TaskManager::GetExecutor();
     executor.run(mTaskflow);
+    CpuProfiler::SetThreadName("Main");
+    auto &frameTimeMetric = Metrics::GetHistogram(FrameTimeMetric, 0.001);
+    auto &cpuFrameMetric = Metrics::GetHistogram("frame.cpu_ms", 0.001);
+    auto &fenceWaitMetric = Metrics::GetHistogram("frame.fence_wait_ms", 0.001);
+    auto &frameCountMetric = Metrics::GetCounter("frame.count");
+    auto lastFrameBegin = std::chrono::steady_clock::now();
     while (!glfwWindowShouldClose(mWindow))
     {
+        CpuProfiler::MarkFrame();
+        // 相邻两帧开始的间隔，包含fence等待和present
+        auto frameStart = std::chrono::steady_clock::now();
+        frameTimeMetric.Record(std::chrono::duration<double, std::milli>(frameStart - lastFrameBegin).count());
+        frameCountMetric.Add();
+        lastFrameBegin = frameStart;
+        MENGINE_PROFILE_ZONE("Frame");
         glfwPollEvents();
-        auto result = vulkanContext->GetDevice().waitForFences({mInFlightFences[mCurrentFrameIndex].get()}, vk::True,
-                                                               1000000000); // 1s
+        auto waitBegin = std::chrono::steady_clock::now();
+        vk::Result result;
+        {
+            MENGINE_PROFILE_ZONE("Wait For Fence");
+            result = vulkanContext->GetDevice().waitForFences({mInFlightFences[mCurrentFrameIndex].get()}, vk::True,
+                                                              1000000000); // 1s
+        }
         if (result != vk::Result::eSuccess)
         {
             LogError("Failed to wait for fence: {}", vk::to_string(result));
             continue;
         }
-        vulkanContext->GetDevice().resetFences({mInFlightFences[mCurrentFrameIndex].get()});
+        auto frameBegin = std::chrono::steady_clock::now();
+        mFramePacingStats.fenceWaitMs = std::chrono::duration<float, std::milli>(frameBegin - waitBegin).count();
 
         auto resultValue = vulkanContext->GetDevice().acquireNextImageKHR(
             vulkanContext->GetSwapchain(), 1000000000, mImageAvailableSemaphores[mCurrentFrameIndex].get(), nullptr);
@@ -353,6 +412,9 @@ void MEngineEditor::Run(float deltaTime)
             HandleSwapchainOutOfDate();
             continue;
         }
+        // acquire成功后才重置，避免out of date时fence永远不被signal
+        vulkanContext->GetDevice().resetFences({mInFlightFences[mCurrentFrameIndex].get()});
+        auto imageIndex = resultValue.value;
 
         ImGui_ImplVulkan_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -368,48 +430,28 @@ void MEngineEditor::Run(float deltaTime)
         ImGui::Render();
         mUICmdBuffers[mCurrentFrameIndex]->reset();
         mUICmdBuffers[mCurrentFrameIndex]->begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
-        // 转换图像布局
-        auto &renderTarget = mRenderSystem->GetRenderTarget(mCurrentFrameIndex);
-        vk::ImageMemoryBarrier preBarrier;
-        preBarrier.setImage(renderTarget.colorTexture->GetImage())
-            .setOldLayout(vk::ImageLayout::eColorAttachmentOptimal)
-            .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-            .setSrcQueueFamilyIndex(vulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setDstQueueFamilyIndex(vulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1))
-            .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite)
-            .setDstAccessMask(vk::AccessFlagBits::eShaderRead);
-        mUICmdBuffers[mCurrentFrameIndex]->pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                                                           vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {},
-                                                           preBarrier);
+        // Viewport采样的color已由composition render pass转换到eShaderReadOnlyOptimal
         vk::RenderPassBeginInfo renderPassInfo{};
         renderPassInfo.setRenderPass(mUIRenderPass.get())
-            .setFramebuffer(mUIFramebuffers[mCurrentFrameIndex].get())
+            .setFramebuffer(mUIFramebuffers[imageIndex].get())
             .setRenderArea(
                 {{0, 0}, {static_cast<uint32_t>(mWindowConfig.width), static_cast<uint32_t>(mWindowConfig.height)}})
             .setClearValues(
                 {vk::ClearValue().setColor(vk::ClearColorValue(std::array<float, 4>{0.0f, 0.0f, 0.0f, 1.0f}))});
-        mUICmdBuffers[mCurrentFrameIndex]->beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), mUICmdBuffers[mCurrentFrameIndex].get());
-        mUICmdBuffers[mCurrentFrameIndex]->endRenderPass();
-        vk::ImageMemoryBarrier postBarrier;
-        postBarrier.setImage(renderTarget.colorTexture->GetImage())
-            .setOldLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
-            .setNewLayout(vk::ImageLayout::eColorAttachmentOptimal)
-            .setSrcQueueFamilyIndex(vulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setDstQueueFamilyIndex(vulkanContext->GetQueueFamilyIndicates().graphicsFamily.value())
-            .setSubresourceRange(vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1))
-            .setSrcAccessMask(vk::AccessFlagBits::eShaderRead)
-            .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
-        mUICmdBuffers[mCurrentFrameIndex]->pipelineBarrier(vk::PipelineStageFlagBits::eFragmentShader,
-                                                           vk::PipelineStageFlagBits::eColorAttachmentOutput, {}, {},
-                                                           {}, postBarrier);
+        {
+            // 没有运行渲染系统时本帧的query没有重置，不记录
+            GpuProfileScope scope(mIsRunning ? &mRenderSystem->GetGpuProfiler() : nullptr,
+                                  mUICmdBuffers[mCurrentFrameIndex].get(), "Editor UI");
+            mUICmdBuffers[mCurrentFrameIndex]->beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), mUICmdBuffers[mCurrentFrameIndex].get());
+            mUICmdBuffers[mCurrentFrameIndex]->endRenderPass();
+        }
         mUICmdBuffers[mCurrentFrameIndex]->end();
         vk::SubmitInfo submitInfo;
 
         auto waitSemaphores = {mImageAvailableSemaphores[mCurrentFrameIndex].get(),
                                mRenderSystem->GetRenderFinishedSemaphore(mCurrentFrameIndex)};
-        auto signalSemaphores = {mRenderFinishedSemaphores[mCurrentFrameIndex].get()};
+        auto signalSemaphores = {mRenderFinishedSemaphores[imageIndex].get()};
         std::vector<vk::PipelineStageFlags> waitStage = {vk::PipelineStageFlagBits::eColorAttachmentOutput,
                                                          vk::PipelineStageFlagBits::eFragmentShader};
         submitInfo.setCommandBuffers(mUICmdBuffers[mCurrentFrameIndex].get())
@@ -420,12 +462,13 @@ void MEngineEditor::Run(float deltaTime)
         vulkanContext->GetGraphicsQueue().submit(submitInfo, mInFlightFences[mCurrentFrameIndex].get());
 
         vk::PresentInfoKHR presentInfo;
-        auto presentWaitSemaphores = {mRenderFinishedSemaphores[mCurrentFrameIndex].get()};
+        auto presentWaitSemaphores = {mRenderFinishedSemaphores[imageIndex].get()};
         presentInfo.setSwapchains(vulkanContext->GetSwapchain())
-            .setImageIndices({resultValue.value})
+            .setImageIndices({imageIndex})
             .setWaitSemaphores(presentWaitSemaphores);
         try
         {
+            MENGINE_PROFILE_ZONE("Present");
             auto presentResult = vulkanContext->GetPresentQueue().presentKHR(presentInfo);
             if (presentResult != vk::Result::eSuccess && presentResult != vk::Result::eSuboptimalKHR)
             {
@@ -437,6 +480,10 @@ void MEngineEditor::Run(float deltaTime)
         {
             HandleSwapchainOutOfDate();
         }
+        mFramePacingStats.cpuFrameMs =
+            std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameBegin).count();
+        cpuFrameMetric.Record(mFramePacingStats.cpuFrameMs);
+        fenceWaitMetric.Record(mFramePacingStats.fenceWaitMs);
         mCurrentFrameIndex = (mCurrentFrameIndex + 1) % mFrameCount;
     }
     // executor.wait_for_all();
@@ -451,11 +498,14 @@ void MEngineEditor::HandleSwapchainOutOfDate()
     mWindowConfig.width = surfaceInfo.extent.width;
     mWindowConfig.height = surfaceInfo.extent.height;
     CreateFramebuffer();
+    CreateSemaphores();
 }
 void MEngineEditor::Shutdown()
 {
     auto vulkanContext = injector.create<std::shared_ptr<VulkanContext>>();
     vulkanContext->GetDevice().waitIdle();
+    // 队列中有依赖ImGui后端的释放任务
+    vulkanContext->GetDeletionQueue().Flush();
     if (!ImGui::GetCurrentContext())
     {
         LogWarn("ImGui context already destroyed");
@@ -487,6 +537,8 @@ void MEngineEditor::Shutdown()
         mWindow = nullptr;
     }
     mRenderSystem->Shutdown();
+    // 写入最后一次快照
+    mMetricsReporter.reset();
     mIsRunning = false;
     LogInfo("MEngine Editor shutdown successfully");
 }
@@ -574,8 +626,9 @@ void MEngineEditor::CreateSemaphores()
 {
     auto vulkanContext = injector.create<std::shared_ptr<VulkanContext>>();
     vk::SemaphoreCreateInfo semaphoreInfo{};
+    mImageAvailableSemaphores.clear();
+    mRenderFinishedSemaphores.clear();
     mImageAvailableSemaphores.reserve(mFrameCount);
-    mRenderFinishedSemaphores.reserve(mFrameCount);
     for (size_t i = 0; i < mFrameCount; ++i)
     {
         auto imageAvailableSemaphore = vulkanContext->GetDevice().createSemaphoreUnique(semaphoreInfo);
@@ -585,7 +638,12 @@ void MEngineEditor::CreateSemaphores()
             throw std::runtime_error("Failed to create image available semaphore");
         }
         mImageAvailableSemaphores.push_back(std::move(imageAvailableSemaphore));
-
+    }
+    // present完成前semaphore不能复用，数量与swapchain image一致
+    auto imageCount = vulkanContext->GetSwapchainImageViews().size();
+    mRenderFinishedSemaphores.reserve(imageCount);
+    for (size_t i = 0; i < imageCount; ++i)
+    {
         auto renderFinishedSemaphore = vulkanContext->GetDevice().createSemaphoreUnique(semaphoreInfo);
         if (!renderFinishedSemaphore)
         {
@@ -598,6 +656,7 @@ void MEngineEditor::CreateSemaphores()
 }
 void MEngineEditor::UI()
 {
+    MENGINE_PROFILE_ZONE("MEngineEditor::UI");
     ImGuiViewport *viewport = ImGui::GetMainViewport();
 
     mDockSpaceID = ImGui::DockSpaceOverViewport();
@@ -627,6 +686,7 @@ void MEngineEditor::UI()
         ImGui::DockBuilderDockWindow("Hierarchy", dockLeftID);        // 左侧
         ImGui::DockBuilderDockWindow("Inspector", dockRightID);       // 右侧
         ImGui::DockBuilderDockWindow("Assets", dockBottomID);         // 底部
+        ImGui::DockBuilderDockWindow("Profiler", dockBottomID);       // 底部，与Assets同组
         ImGui::DockBuilderDockWindow("Toolbar", dockTopCenterID);     // 顶部
         ImGui::DockBuilderFinish(mDockSpaceID);
     }
@@ -635,6 +695,7 @@ void MEngineEditor::UI()
     RenderToolbarPanel();
     RenderViewportPanel();
     RenderHierarchyPanel();
+    RenderProfilerPanel();
 }
 void MEngineEditor::RenderToolbarPanel()
 {
@@ -642,6 +703,52 @@ void MEngineEditor::RenderToolbarPanel()
     ImGui::BeginGroup();
     {
         ImGui::TextColored(ImVec4(1, 1, 0, 1), "FPS: %1.f", ImGui::GetIO().Framerate);
+        auto textureManager = injector.create<std::shared_ptr<IMTextureManager>>();
+        auto &streamingStats = textureManager->GetStreamingStats();
+        ImGui::SameLine();
+        ImGui::Text("CPU: %.2f ms  Fence Wait: %.2f ms  (%u frames in flight)", mFramePacingStats.cpuFrameMs,
+                    mFramePacingStats.fenceWaitMs, mFrameCount);
+        ImGui::SameLine();
+        ImGui::Text("Texture Streaming: %.1f / %.1f MB", streamingStats.residentBytes / (1024.0 * 1024.0),
+                    streamingStats.budget / (1024.0 * 1024.0));
+        auto &descriptorStats = injector.create<std::shared_ptr<DescriptorAllocator>>()->GetStats();
+        ImGui::SameLine();
+        ImGui::Text("Descriptor Pools: %u + %u (%u sets, %u cached)", descriptorStats.persistentPoolCount,
+                    descriptorStats.transientPoolCount, descriptorStats.transientSetCount,
+                    descriptorStats.cacheHitCount);
+        auto &renderGraphStats = mRenderSystem->GetRenderGraphStats();
+        ImGui::SameLine();
+        ImGui::Text("Render Graph: %u passes, %u barriers, transient %.1f / %.1f MB (%u lazy, %u aliased)",
+                    renderGraphStats.passCount, renderGraphStats.barrierCount,
+                    renderGraphStats.transientBytes / (1024.0 * 1024.0),
+                    renderGraphStats.transientRequiredBytes / (1024.0 * 1024.0), renderGraphStats.lazyImageCount,
+                    renderGraphStats.aliasedImageCount);
+        auto &depthPrepassStats = mRenderSystem->GetDepthPrepassStats();
+        ImGui::SameLine();
+        ImGui::Text("Overdraw: %.2fx (%llu fragments)", depthPrepassStats.overdraw,
+                    static_cast<unsigned long long>(depthPrepassStats.shadedFragments));
+        auto &occlusionStats = mRenderSystem->GetOcclusionCullingStats();
+        ImGui::SameLine();
+        ImGui::Text("Occlusion: %.1f%% culled (%u / %u, %u occluders)", occlusionStats.GetCulledPercentage(),
+                    occlusionStats.culledCount, occlusionStats.testedCount, occlusionStats.occluderCount);
+        auto &hiZStats = mRenderSystem->GetHiZCullingStats();
+        ImGui::SameLine();
+        ImGui::Text("Hi-Z: %.1f%% culled (%u + %u / %u)", hiZStats.GetCulledPercentage(), hiZStats.firstPhaseCount,
+                    hiZStats.secondPhaseCount, hiZStats.drawCount);
+        ImGui::SameLine();
+        ImGui::Text("Static Batches: %u (%u entities)", mStaticBatchStats.batchCount, mStaticBatchStats.entityCount);
+        auto &tiledLightingStats = mRenderSystem->GetTiledLightingStats();
+        ImGui::SameLine();
+        ImGui::Text("Tiled Lighting: %.2f lights/tile, %.1f%% background tiles",
+                    tiledLightingStats.GetAverageLightsPerTile(), tiledLightingStats.GetBackgroundPercentage());
+        auto &shadowStats = mRenderSystem->GetShadowStats();
+        ImGui::SameLine();
+        ImGui::Text("Shadows: %u/4 cascades cached, %u static + %u dynamic draws", shadowStats.cachedCascadeCount,
+                    shadowStats.staticDrawCount, shadowStats.dynamicDrawCount);
+        auto renderExtent = mRenderSystem->GetRenderExtent();
+        ImGui::SameLine();
+        ImGui::Text("GPU: %.2f ms  Resolution: %.0f%% (%ux%u)", mRenderSystem->GetGpuFrameMs(),
+                    mRenderSystem->GetResolutionScale() * 100.0f, renderExtent.width, renderExtent.height);
         if (ImGui::RadioButton("Translate", mGuizmoOperation == ImGuizmo::TRANSLATE) || ImGui::IsKeyDown(ImGuiKey_W))
             mGuizmoOperation = ImGuizmo::TRANSLATE;
         ImGui::SameLine();
@@ -663,8 +770,9 @@ void MEngineEditor::RenderToolbarPanel()
         {
             for (Resolution &resolution : mResolutions)
             {
-                if (ImGui::Selectable(resolution.ToString().data(), mCurrentResolution == resolution))
+                if (ImGui::Selectable(resolution.ToString().data(), !mFitViewport && mCurrentResolution == resolution))
                 {
+                    mFitViewport = false;
                     mCurrentResolution = resolution;
                     mRenderSystem->ReSizeFrameBuffer(resolution.width, resolution.height);
                     SetViewPort();
@@ -672,6 +780,83 @@ void MEngineEditor::RenderToolbarPanel()
             }
             ImGui::EndCombo();
         }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("Fit Viewport", &mFitViewport) && !mFitViewport)
+        {
+            mRenderSystem->ReSizeFrameBuffer(mCurrentResolution.width, mCurrentResolution.height);
+            SetViewPort();
+        }
+        ImGui::SameLine();
+        auto depthPrepassEnabled = mRenderSystem->IsDepthPrepassEnabled();
+        if (ImGui::Checkbox("Depth Prepass", &depthPrepassEnabled))
+        {
+            mRenderSystem->SetDepthPrepassEnabled(depthPrepassEnabled);
+        }
+        ImGui::SameLine();
+        auto occlusionCullingEnabled = mRenderSystem->IsOcclusionCullingEnabled();
+        if (ImGui::Checkbox("Occlusion Culling", &occlusionCullingEnabled))
+        {
+            mRenderSystem->SetOcclusionCullingEnabled(occlusionCullingEnabled);
+        }
+        ImGui::SameLine();
+        auto hiZCullingEnabled = mRenderSystem->IsHiZCullingEnabled();
+        if (ImGui::Checkbox("Hi-Z Culling", &hiZCullingEnabled))
+        {
+            mRenderSystem->SetHiZCullingEnabled(hiZCullingEnabled);
+        }
+        ImGui::SameLine();
+        auto asyncComputeEnabled = mRenderSystem->IsAsyncComputeEnabled();
+        if (ImGui::Checkbox("Async Compute", &asyncComputeEnabled))
+        {
+            mRenderSystem->SetAsyncComputeEnabled(asyncComputeEnabled);
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Stats Overlay", &mRenderStatisticsOverlay);
+        auto &renderStatistics = mRenderSystem->GetRenderStatistics();
+        if (renderStatistics.IsPipelineStatisticsSupported())
+        {
+            ImGui::SameLine();
+            // 开启后overdraw统计暂停
+            auto pipelineStatisticsEnabled = renderStatistics.IsPipelineStatisticsEnabled();
+            if (ImGui::Checkbox("Pipeline Statistics", &pipelineStatisticsEnabled))
+            {
+                renderStatistics.SetPipelineStatisticsEnabled(pipelineStatisticsEnabled);
+            }
+        }
+        ImGui::SameLine();
+        // 源实体修改后重新勾选以重建批次
+        if (ImGui::Checkbox("Static Batching", &mStaticBatchingEnabled))
+        {
+            auto resourceManager = injector.create<std::shared_ptr<ResourceManager>>();
+            auto registry = injector.create<std::shared_ptr<entt::registry>>();
+            if (mStaticBatchingEnabled)
+            {
+                mStaticBatchStats = Function::Utils::EntityUtils::BuildStaticBatches(resourceManager, registry);
+            }
+            else
+            {
+                Function::Utils::EntityUtils::ClearStaticBatches(resourceManager, registry);
+                mStaticBatchStats = {};
+            }
+        }
+        ImGui::SameLine();
+        auto tiledLightingEnabled = mRenderSystem->IsTiledLightingEnabled();
+        if (ImGui::Checkbox("Tiled Lighting", &tiledLightingEnabled))
+        {
+            mRenderSystem->SetTiledLightingEnabled(tiledLightingEnabled);
+        }
+        ImGui::SameLine();
+        auto shadowsEnabled = mRenderSystem->IsShadowsEnabled();
+        if (ImGui::Checkbox("Shadows", &shadowsEnabled))
+        {
+            mRenderSystem->SetShadowsEnabled(shadowsEnabled);
+        }
+        ImGui::SameLine();
+        auto dynamicResolution = mRenderSystem->GetDynamicResolutionSetting();
+        if (ImGui::Checkbox("Dynamic Resolution", &dynamicResolution.enabled))
+        {
+            mRenderSystem->SetDynamicResolutionSetting(dynamicResolution);
+        }
         ImGui::EndGroup();
     }
     ImGui::End();
@@ -682,7 +867,24 @@ void MEngineEditor::RenderViewportPanel()
     ImVec2 windowPos = ImGui::GetWindowPos();
     ImVec2 windowSize = ImGui::GetContentRegionAvail();
     ImVec2 viewPortSize = {windowSize.x, windowSize.x * mCurrentResolution.height * 1.0f / mCurrentResolution.width};
-    ImGui::Image(reinterpret_cast<ImTextureID>(mViewPortDescriptorSets[mCurrentFrameIndex]), viewPortSize);
+    if (mFitViewport && windowSize.x >= 1.0f && windowSize.y >= 1.0f)
+    {
+        // 拖动面板时每帧请求新尺寸，render target的重建由MRenderSystem去抖
+        mRenderSystem->RequestExtent(static_cast<uint32_t>(windowSize.x), static_cast<uint32_t>(windowSize.y));
+        viewPortSize = windowSize;
+    }
+    if (mViewPortVersion != mRenderSystem->GetRenderTargetVersion())
+    {
+        SetViewPort();
+    }
+    UpdateCameraAspect();
+    // 只显示render target中实际渲染的区域
+    auto renderExtent = mRenderSystem->GetRenderExtent();
+    auto &renderTarget = mRenderSystem->GetRenderTarget(mCurrentFrameIndex);
+    ImVec2 uvMax = {static_cast<float>(renderExtent.width) / static_cast<float>(renderTarget.width),
+                    static_cast<float>(renderExtent.height) / static_cast<float>(renderTarget.height)};
+    ImGui::Image(reinterpret_cast<ImTextureID>(mViewPortDescriptorSets[mCurrentFrameIndex]), viewPortSize,
+                 ImVec2(0.0f, 0.0f), uvMax);
     // 设置 ImGuizmo 绘制区域
     ImVec2 imagePos = ImGui::GetItemRectMin();
     ImVec2 imageSize = ImGui::GetItemRectSize();
@@ -765,6 +967,235 @@ void MEngineEditor::RenderViewportPanel()
         }
     }
     ImGui::End();
+    if (mRenderStatisticsOverlay)
+    {
+        RenderStatisticsOverlay({imagePos.x + 8.0f, imagePos.y + 8.0f});
+    }
+}
+void MEngineEditor::RenderStatisticsOverlay(ImVec2 position)
+{
+    auto &frame = mRenderSystem->GetRenderStatistics().GetLastFrame();
+    auto total = frame.GetTotal();
+    ImGui::SetNextWindowPos(position);
+    ImGui::SetNextWindowBgAlpha(0.4f);
+    auto flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings |
+                 ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoDocking |
+                 ImGuiWindowFlags_NoInputs;
+    ImGui::Begin("##RenderStatisticsOverlay", nullptr, flags);
+    ImGui::Text("Draws: %u  Instances: %u  Triangles: %llu", total.drawCalls, total.instances,
+                static_cast<unsigned long long>(total.triangles));
+    ImGui::Text("Binds: %u pipeline, %u descriptor, %u buffer  Dispatches: %u", total.pipelineBinds,
+                total.descriptorBinds, total.bufferBinds, total.dispatches);
+    ImGui::Text("Objects: %u submitted, %u culled  Uploaded: %.1f KB", frame.submittedObjects, frame.culledObjects,
+                frame.uploadedBytes / 1024.0);
+    if (frame.hasPipelineStatistics)
+    {
+        ImGui::Text("Invocations: %llu vertex, %llu fragment", static_cast<unsigned long long>(total.vertexInvocations),
+                    static_cast<unsigned long long>(total.fragmentInvocations));
+    }
+    ImGui::End();
+}
+void MEngineEditor::RenderProfilerPanel()
+{
+    ImGui::Begin("Profiler", nullptr, ImGuiWindowFlags_None);
+    if (ImGui::BeginTabBar("ProfilerTabs"))
+    {
+        if (ImGui::BeginTabItem("GPU"))
+        {
+            RenderGpuProfilerTab();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("CPU"))
+        {
+            RenderCpuProfilerTab();
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Render Stats"))
+        {
+            RenderStatisticsTab();
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
+    ImGui::End();
+}
+void MEngineEditor::RenderGpuProfilerTab()
+{
+    auto &gpuProfiler = mRenderSystem->GetGpuProfiler();
+    if (!gpuProfiler.IsSupported())
+    {
+        ImGui::TextUnformatted("GPU timestamps are not supported on this device");
+        return;
+    }
+    if (ImGui::Button("Dump JSON"))
+    {
+        gpuProfiler.DumpJson("logs/GpuProfile.json");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+    {
+        gpuProfiler.Reset();
+    }
+    ImGui::SameLine();
+    ImGui::Text("%llu frames, last %u frames in statistics",
+                static_cast<unsigned long long>(gpuProfiler.GetCollectedFrames()), GpuProfiler::HistoryFrames);
+    if (ImGui::BeginTable("GpuProfilerZones", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+    {
+        ImGui::TableSetupColumn("Zone");
+        ImGui::TableSetupColumn("Last (ms)");
+        ImGui::TableSetupColumn("Mean (ms)");
+        ImGui::TableSetupColumn("P95 (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+        for (const auto &zone : gpuProfiler.GetStats())
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Indent(zone.depth * ImGui::GetStyle().IndentSpacing + 0.001f);
+            ImGui::TextUnformatted(zone.name.c_str());
+            ImGui::Unindent(zone.depth * ImGui::GetStyle().IndentSpacing + 0.001f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.lastMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.meanMs);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.p95Ms);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", zone.maxMs);
+        }
+        ImGui::EndTable();
+    }
+}
+void MEngineEditor::RenderStatisticsTab()
+{
+    auto &frame = mRenderSystem->GetRenderStatistics().GetLastFrame();
+    auto columnCount = frame.hasPipelineStatistics ? 10 : 8;
+    auto tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV;
+    if (!ImGui::BeginTable("RenderStatisticsPasses", columnCount, tableFlags))
+    {
+        return;
+    }
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("Draws");
+    ImGui::TableSetupColumn("Instances");
+    ImGui::TableSetupColumn("Triangles");
+    ImGui::TableSetupColumn("Dispatches");
+    ImGui::TableSetupColumn("Pipeline Binds");
+    ImGui::TableSetupColumn("Descriptor Binds");
+    ImGui::TableSetupColumn("Buffer Binds");
+    if (frame.hasPipelineStatistics)
+    {
+        ImGui::TableSetupColumn("VS Invocations");
+        ImGui::TableSetupColumn("FS Invocations");
+    }
+    ImGui::TableHeadersRow();
+    auto row = [&](const RenderPassStatistics &pass) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::Indent(pass.depth * ImGui::GetStyle().IndentSpacing + 0.001f);
+        ImGui::TextUnformatted(pass.name.c_str());
+        ImGui::Unindent(pass.depth * ImGui::GetStyle().IndentSpacing + 0.001f);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.drawCalls);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.instances);
+        ImGui::TableNextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(pass.triangles));
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.dispatches);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.pipelineBinds);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.descriptorBinds);
+        ImGui::TableNextColumn();
+        ImGui::Text("%u", pass.bufferBinds);
+        if (frame.hasPipelineStatistics)
+        {
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(pass.vertexInvocations));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(pass.fragmentInvocations));
+        }
+    };
+    for (const auto &pass : frame.passes)
+    {
+        row(pass);
+    }
+    row(frame.GetTotal());
+    ImGui::EndTable();
+}
+void MEngineEditor::RenderCpuProfilerTab()
+{
+    auto paused = !CpuProfiler::IsEnabled();
+    if (ImGui::Checkbox("Pause", &paused))
+    {
+        CpuProfiler::SetEnabled(!paused);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Export Trace"))
+    {
+        CpuProfiler::DumpChromeTrace("logs/CpuTrace.json");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Clear"))
+    {
+        CpuProfiler::Clear();
+    }
+    // 显示上一个完整的帧，暂停时不再标记新帧，停留在暂停前的最后一帧
+    auto frameMarks = CpuProfiler::GetFrameMarks(2);
+    if (frameMarks.size() < 2)
+    {
+        ImGui::TextUnformatted("No frame captured");
+        return;
+    }
+    auto frameBegin = frameMarks[0];
+    auto frameEnd = frameMarks[1];
+    auto msPerTick = CpuProfiler::TicksToMs(1);
+    ImGui::SameLine();
+    ImGui::Text("Frame %.3f ms", static_cast<double>(frameEnd - frameBegin) * msPerTick);
+
+    auto *drawList = ImGui::GetWindowDrawList();
+    auto width = ImGui::GetContentRegionAvail().x;
+    auto rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    auto pixelsPerTick = static_cast<double>(width) / static_cast<double>(frameEnd - frameBegin);
+    for (const auto &thread : CpuProfiler::Capture(frameBegin, frameEnd))
+    {
+        if (thread.events.empty())
+        {
+            continue;
+        }
+        uint32_t maxDepth = 0;
+        for (const auto &event : thread.events)
+        {
+            maxDepth = std::max(maxDepth, event.depth);
+        }
+        ImGui::TextUnformatted(thread.name.c_str());
+        auto origin = ImGui::GetCursorScreenPos();
+        ImGui::Dummy({width, rowHeight * static_cast<float>(maxDepth + 1)});
+        for (const auto &event : thread.events)
+        {
+            // 跨越帧边界的zone截断到帧内
+            auto begin = std::max(event.begin, frameBegin) - frameBegin;
+            auto end = std::min(event.end, frameEnd) - frameBegin;
+            ImVec2 rectMin{origin.x + static_cast<float>(static_cast<double>(begin) * pixelsPerTick),
+                           origin.y + rowHeight * static_cast<float>(event.depth)};
+            // 太短的zone至少画1个像素
+            auto rectRight = origin.x + static_cast<float>(static_cast<double>(end) * pixelsPerTick);
+            ImVec2 rectMax{std::max(rectRight, rectMin.x + 1.0f), rectMin.y + rowHeight - 1.0f};
+            auto hue = static_cast<float>(std::hash<std::string_view>{}(event.name) % 360) / 360.0f;
+            drawList->AddRectFilled(rectMin, rectMax, ImColor::HSV(hue, 0.45f, 0.85f));
+            if (rectMax.x - rectMin.x > 8.0f)
+            {
+                drawList->PushClipRect(rectMin, rectMax, true);
+                drawList->AddText({rectMin.x + 2.0f, rectMin.y}, IM_COL32_BLACK, event.name);
+                drawList->PopClipRect();
+            }
+            if (ImGui::IsMouseHoveringRect(rectMin, rectMax))
+            {
+                ImGui::SetTooltip("%s\n%.3f ms", event.name, static_cast<double>(event.end - event.begin) * msPerTick);
+            }
+        }
+    }
 }
 void MEngineEditor::RenderHierarchyPanel()
 {
@@ -916,8 +1347,6 @@ void MEngineEditor::RenderHierarchyPanel()
             {
                 if (ImGui::MenuItem("Delete"))
                 {
-                    auto vulkanContext = injector.create<std::shared_ptr<VulkanContext>>();
-                    vulkanContext->GetDevice().waitIdle();
                     std::function<void(entt::entity)> deleteEntity;
                     deleteEntity = [this, &registry, &deleteEntity](entt::entity entity) {
                         if (registry->valid(entity))